@@ -68,7 +68,7 @@ async def get_features(
 ):
     """Get extracted features for an asset."""
     service = get_asset_service()
-    result = service.get_features(asset_id, timestep)
+    result = await service.get_features(asset_id, timestep)
     if result is None:
         raise HTTPException(status_code=404, detail=f"Asset {asset_id} not found")
     return result
@@ -77,11 +77,15 @@ async def get_features(
 @router.get("/assets/{asset_id}/fft", response_model=FFTResponse)
 async def get_fft(
     asset_id: str,
-    timestep: int = Query(-1, description="Timestep index (-1 for latest)")
+    timestep: int = Query(-1, description="Timestep index (-1 for latest)"),
+    points: int = Query(256, ge=0, description="Maximum spectrum points returned (0 = all bins)"),
+    method: str = Query("minmax", pattern="^(minmax|lttb)$", description="Decimation method"),
+    log: bool = Query(False, description="Resample onto log-spaced frequencies"),
+    peaks: int = Query(5, ge=0, le=50, description="Number of spectral peaks to report"),
 ):
     """Get FFT spectrum for a specific timestep."""
     service = get_asset_service()
-    result = service.get_fft(asset_id, timestep)
+    result = await service.get_fft(asset_id, timestep, points, method, log, peaks)
     if result is None:
         raise HTTPException(status_code=404, detail=f"Asset {asset_id} not found or invalid timestep")
     return result
@@ -104,7 +108,7 @@ async def get_trajectory(
 ):
     """Get health trajectory prediction."""
     service = get_asset_service()
-    result = service.get_trajectory(asset_id, horizon)
+    result = await service.get_trajectory(asset_id, horizon)
     if result is None:
         raise HTTPException(status_code=404, detail=f"Asset {asset_id} not found")
     return result
@@ -66,6 +66,8 @@ class SignalFeatures(BaseModel):
     spectral_centroid: float
     spectral_spread: float
     bandpowers: dict[str, float]
+    shaft_rpm: Optional[float] = None
+    order_bandpowers: Optional[dict[str, float]] = None  # Speed-normalised ("1x", "2x", ...)
 
 
 class FeatureTimeseries(BaseModel):
@@ -75,14 +77,23 @@ class FeatureTimeseries(BaseModel):
     features: list[SignalFeatures]
 
 
+class SpectralPeak(BaseModel):
+    """Local maximum of a magnitude spectrum."""
+    frequency: float
+    magnitude: float
+
+
 class FFTResponse(BaseModel):
-    """FFT spectrum response."""
+    """FFT spectrum response (frequencies/magnitudes may be decimated)."""
     asset_id: str
     timestamp: datetime
     frequencies: list[float]
     magnitudes: list[float]
+    num_bins: int  # Bins of the full spectrum
+    peaks: list[SpectralPeak]
     dominant_frequency: float
     total_power: float
+    decimation: str  # Method applied: "minmax", "lttb", "log" or "none"
 
 
 # === RUL Schemas ===
@@ -112,6 +123,7 @@ class TrajectoryResponse(BaseModel):
     asset_id: str
     current_health: float
     trajectory: list[TrajectoryPoint]
+    vibration_rms_trend: Optional[float] = None  # RMS change per day over the last 48 hours
 
 
 # === Causal Schemas ===
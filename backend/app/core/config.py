@@ -21,6 +21,10 @@ class Settings(BaseSettings):
     sample_rate: float = 5000.0  # Hz for vibration signals
     samples_per_waveform: int = 2048
 
+    # Feature extraction settings
+    feature_threads: int = 0  # Native batch workers (0 = all cores)
+    feature_store_path: str = ""  # Shared on-disk feature cache (empty = off)
+
     # Model settings
     rul_horizon_days: int = 90
 
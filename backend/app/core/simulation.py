@@ -12,6 +12,13 @@ from dataclasses import dataclass, field
 from typing import Optional
 from .config import get_settings
 
+# Native waveform synthesis when the C++ module is built
+try:
+    import cpm_features as cpp_extractor
+    _USE_CPP = True
+except ImportError:
+    _USE_CPP = False
+
 
 @dataclass
 class Asset:
@@ -220,11 +227,20 @@ class CausalSimulator:
         - Harmonics (increase with wear)
         - Random noise
         - Occasional transients
+
+        The native synthesizer implements the same model with its own
+        counter-based random streams, seeded from this simulator's RNG so a
+        seeded run stays reproducible.
         """
         T = len(vibration_levels)
         N = self.samples_per_waveform
         sr = self.sample_rate
 
+        if _USE_CPP:
+            config = cpp_extractor.SynthesisConfig(sr, N, int(self.rng.integers(2**63)))
+            return cpp_extractor.WaveformSynthesizer(config).generate(
+                vibration_levels, speeds, wear_levels)
+
         waveforms = np.zeros((T, N))
         t = np.arange(N) / sr  # Time vector for one waveform
 
@@ -232,6 +232,21 @@ class RULModel:
             "failure_probability": failure_prob
         })
 
+    @staticmethod
+    def feature_trend(values: np.ndarray, window: int = 48) -> float:
+        """
+        Least-squares slope per day of the last window hourly feature values
+        (e.g. the vibration RMS history), or 0 with fewer than two values.
+        Reads the column in place, so a native feature view is not copied.
+        """
+        recent = np.asarray(values)[-window:]
+        recent = recent[np.isfinite(recent)]
+        if len(recent) < 2:
+            return 0.0
+        hours = np.arange(len(recent), dtype=float)
+        slope_per_hour = np.polyfit(hours, recent, 1)[0]
+        return float(slope_per_hour * 24)
+
 
 # Global model instance
 _rul_model: Optional[RULModel] = None
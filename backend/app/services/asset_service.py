@@ -1,15 +1,18 @@
 """
 Asset service for managing asset data and predictions.
 """
+import asyncio
+import threading
 import numpy as np
 import pandas as pd
 from typing import Optional
 from datetime import datetime
 
+from ..core.config import get_settings
 from ..core.simulation import get_simulation, SimulationResult, Asset
 from ..models.causal import CausalModel
 from ..models.rul import RULModel, get_rul_model
-from .feature_service import extract_features, SignalFeatures
+from .feature_service import extract_features_async, extract_order_bands, reduce_spectrum, FleetFeatures
 
 
 class AssetService:
@@ -19,7 +22,8 @@ class AssetService:
         self._simulation: Optional[SimulationResult] = None
         self._causal_model: Optional[CausalModel] = None
         self._rul_model: Optional[RULModel] = None
-        self._features_cache: dict[str, list[SignalFeatures]] = {}
+        self._fleet_features: Optional[FleetFeatures] = None
+        self._fleet_features_lock = threading.Lock()
 
     @property
     def simulation(self) -> SimulationResult:
@@ -38,6 +42,26 @@ class AssetService:
             self._causal_model.fit(all_data)
         return self._causal_model
 
+    @property
+    def fleet_features(self) -> FleetFeatures:
+        """Get or create the per-asset feature history."""
+        # Requests reach this from worker threads, so create it only once
+        if self._fleet_features is None:
+            with self._fleet_features_lock:
+                if self._fleet_features is None:
+                    settings = get_settings()
+                    self._fleet_features = FleetFeatures(
+                        num_threads=settings.feature_threads,
+                        store_path=settings.feature_store_path
+                    )
+        return self._fleet_features
+
+    def _feature_history(self, asset_id: str) -> FleetFeatures:
+        """Feature history of an asset, extended to its latest waveform."""
+        fleet = self.fleet_features
+        fleet.update(asset_id, self.simulation.waveforms[asset_id])
+        return fleet
+
     @property
     def rul_model(self) -> RULModel:
         """Get or create RUL model."""
@@ -115,7 +139,7 @@ class AssetService:
             "count": len(ts)
         }
 
-    def get_features(
+    async def get_features(
         self,
         asset_id: str,
         timestep: Optional[int] = None
@@ -132,7 +156,12 @@ class AssetService:
             if timestep >= len(waveforms):
                 return None
 
-            features = extract_features(waveforms[timestep])
+            features = await extract_features_async(waveforms[timestep])
+            # Order bands follow the shaft, so they compare across speed changes
+            rpm = float(ts["speed"].iloc[timestep])
+            order_bandpowers = await asyncio.to_thread(
+                extract_order_bands, waveforms[timestep], rpm, get_settings().sample_rate
+            )
             return {
                 "asset_id": asset_id,
                 "timestamp": ts["timestamp"].iloc[timestep].isoformat(),
@@ -143,36 +172,46 @@ class AssetService:
                 "skewness": features.skewness,
                 "spectral_centroid": features.spectral_centroid,
                 "spectral_spread": features.spectral_spread,
-                "bandpowers": features.bandpowers
+                "bandpowers": features.bandpowers,
+                "shaft_rpm": rpm,
+                "order_bandpowers": order_bandpowers
             }
         else:
-            # All timesteps (cached)
-            if asset_id not in self._features_cache:
-                self._features_cache[asset_id] = [
-                    extract_features(wf) for wf in waveforms
-                ]
-
-            features_list = self._features_cache[asset_id]
+            # All timesteps; only waveforms added since the last call are extracted
+            # (in a worker thread; native extraction releases the GIL)
+            fleet = await asyncio.to_thread(self._feature_history, asset_id)
+            batch = fleet.batch(asset_id)
             return {
                 "asset_id": asset_id,
                 "timestamps": [t.isoformat() for t in ts["timestamp"]],
                 "features": [
                     {
-                        "rms": f.rms,
-                        "peak": f.peak,
-                        "crest_factor": f.crest_factor,
-                        "kurtosis": f.kurtosis,
-                        "skewness": f.skewness,
-                        "spectral_centroid": f.spectral_centroid,
-                        "spectral_spread": f.spectral_spread,
-                        "bandpowers": f.bandpowers
+                        "rms": float(batch.rms[i]),
+                        "peak": float(batch.peak[i]),
+                        "crest_factor": float(batch.crest_factor[i]),
+                        "kurtosis": float(batch.kurtosis[i]),
+                        "skewness": float(batch.skewness[i]),
+                        "spectral_centroid": float(batch.spectral_centroid[i]),
+                        "spectral_spread": float(batch.spectral_spread[i]),
+                        "bandpowers": batch.row_bandpowers(i)
                     }
-                    for f in features_list
+                    for i in range(len(batch.rms))
                 ]
             }
 
-    def get_fft(self, asset_id: str, timestep: int = -1) -> Optional[dict]:
-        """Get FFT spectrum for a specific timestep."""
+    async def get_fft(
+        self,
+        asset_id: str,
+        timestep: int = -1,
+        points: int = 256,
+        method: str = "minmax",
+        log_frequency: bool = False,
+        num_peaks: int = 5
+    ) -> Optional[dict]:
+        """
+        Get FFT spectrum for a specific timestep, thinned to at most points
+        points (0 = every bin) with its largest peaks.
+        """
         if asset_id not in self.simulation.waveforms:
             return None
 
@@ -186,24 +225,24 @@ class AssetService:
         if timestep < 0 or timestep >= len(waveforms):
             return None
 
-        features = extract_features(waveforms[timestep])
+        # Only the spectrum is used here
+        features = await extract_features_async(waveforms[timestep], features="spectrum")
 
-        # Find dominant frequency
-        if len(features.fft_magnitude) > 0:
-            max_idx = np.argmax(features.fft_magnitude[1:]) + 1  # Skip DC
-            dominant_freq = features.fft_frequencies[max_idx]
-            total_power = np.sum(features.fft_magnitude ** 2)
-        else:
-            dominant_freq = 0.0
-            total_power = 0.0
+        spectrum = reduce_spectrum(
+            features.fft_frequencies, features.fft_magnitude, points=points, method=method,
+            log_frequency=log_frequency, num_peaks=num_peaks
+        )
 
         return {
             "asset_id": asset_id,
             "timestamp": ts["timestamp"].iloc[timestep].isoformat(),
-            "frequencies": features.fft_frequencies.tolist(),
-            "magnitudes": features.fft_magnitude.tolist(),
-            "dominant_frequency": float(dominant_freq),
-            "total_power": float(total_power)
+            "frequencies": spectrum.frequencies.tolist(),
+            "magnitudes": spectrum.magnitudes.tolist(),
+            "num_bins": spectrum.num_bins,
+            "peaks": [{"frequency": f, "magnitude": m} for f, m in spectrum.peaks],
+            "dominant_frequency": float(spectrum.dominant_frequency),
+            "total_power": float(spectrum.total_power),
+            "decimation": spectrum.decimation
         }
 
     def get_rul(self, asset_id: str) -> Optional[dict]:
@@ -227,7 +266,7 @@ class AssetService:
             "failure_probability_30d": rul.failure_probability_30d
         }
 
-    def get_trajectory(
+    async def get_trajectory(
         self,
         asset_id: str,
         horizon_days: int = 90
@@ -244,11 +283,16 @@ class AssetService:
             horizon_days=horizon_days
         )
 
-        return {
+        result = {
             "asset_id": asset_id,
             "current_health": 100 - latest["wear"],
             "trajectory": trajectory.to_dict(orient="records")
         }
+        if asset_id in self.simulation.waveforms:
+            fleet = await asyncio.to_thread(self._feature_history, asset_id)
+            rms = fleet.column(asset_id, "rms")
+            result["vibration_rms_trend"] = self.rul_model.feature_trend(rms)
+        return result
 
     def get_causal_effects(self, asset_id: str) -> Optional[dict]:
         """Get causal effects analysis for an asset."""
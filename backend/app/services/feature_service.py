@@ -4,7 +4,9 @@ Feature extraction service.
 Provides Python-native feature extraction that mirrors the C++ implementation.
 Used as fallback when C++ module is not available.
 """
+import asyncio
 import numpy as np
+import struct
 from dataclasses import dataclass
 from typing import Optional
 
@@ -24,6 +26,24 @@ class SignalFeatures:
     bandpowers: dict[str, float]
 
 
+@dataclass
+class BatchFeatures:
+    """Features for a batch of waveforms, one array entry per row."""
+    rms: np.ndarray
+    peak: np.ndarray
+    crest_factor: np.ndarray
+    kurtosis: np.ndarray
+    skewness: np.ndarray
+    spectral_centroid: np.ndarray
+    spectral_spread: np.ndarray
+    bandpowers: np.ndarray  # (rows, bands)
+    band_names: list[str]
+
+    def row_bandpowers(self, i: int) -> dict[str, float]:
+        """Bandpowers of one row keyed by band name."""
+        return {name: float(p) for name, p in zip(self.band_names, self.bandpowers[i])}
+
+
 class FeatureExtractor:
     """Python feature extractor (mirrors C++ implementation)."""
 
@@ -69,6 +89,25 @@ class FeatureExtractor:
             bandpowers=bandpowers
         )
 
+    def extract_batch(self, signals: np.ndarray) -> BatchFeatures:
+        """Extract features from each row of a 2D signal array."""
+        rows = [self.extract_all(signal) for signal in signals]
+        band_names = [name for name, _, _ in self.FREQ_BANDS]
+        return BatchFeatures(
+            rms=np.array([f.rms for f in rows], dtype=float),
+            peak=np.array([f.peak for f in rows], dtype=float),
+            crest_factor=np.array([f.crest_factor for f in rows], dtype=float),
+            kurtosis=np.array([f.kurtosis for f in rows], dtype=float),
+            skewness=np.array([f.skewness for f in rows], dtype=float),
+            spectral_centroid=np.array([f.spectral_centroid for f in rows], dtype=float),
+            spectral_spread=np.array([f.spectral_spread for f in rows], dtype=float),
+            bandpowers=np.array(
+                [[f.bandpowers[name] for name in band_names] for f in rows],
+                dtype=float
+            ).reshape(len(rows), len(band_names)),
+            band_names=band_names
+        )
+
     def compute_rms(self, signal: np.ndarray) -> float:
         """Compute Root Mean Square."""
         return float(np.sqrt(np.mean(signal ** 2)))
@@ -202,31 +241,668 @@ except ImportError:
     _USE_CPP = False
 
 
-def get_extractor(sample_rate: float = 5000.0):
+def get_extractor(sample_rate: float = 5000.0, num_threads: int = 1):
     """Get feature extractor (C++ if available, else Python)."""
     if _USE_CPP:
-        return cpp_extractor.FeatureExtractor(sample_rate)
+        return cpp_extractor.FeatureExtractor(sample_rate, num_threads)
     else:
         return FeatureExtractor(sample_rate)
 
 
-def extract_features(signal: np.ndarray, sample_rate: float = 5000.0) -> SignalFeatures:
-    """Extract features from signal using best available implementation."""
+_feature_stores = {}
+
+
+def get_feature_store(path: str, num_bands: int = 5):
+    """
+    The native feature store at path, opened once per process for each
+    (path, num_bands), or None when path is empty or the C++ module is not
+    available. Every worker process maps the same file, so features computed
+    by one are hits for the others and survive restarts.
+    """
+    if not path or not _USE_CPP:
+        return None
+    key = (path, num_bands)
+    store = _feature_stores.get(key)
+    if store is None:
+        store = _feature_stores.setdefault(key, cpp_extractor.FeatureStore(path, num_bands))
+    return store
+
+
+def extractor_stats() -> Optional[dict]:
+    """
+    Stage counters of the C++ extractor (cpm_features.stats()), or None when
+    the module is not available. Counters stay zero unless the module was
+    built with -DENABLE_STATS=ON.
+    """
+    if not _USE_CPP:
+        return None
+    return cpp_extractor.stats()
+
+
+def prometheus_metrics() -> str:
+    """Render extractor stage counters in the Prometheus text format."""
+    stats = extractor_stats()
+    lines = [
+        "# HELP cpm_extractor_native Whether the C++ feature extractor is loaded.",
+        "# TYPE cpm_extractor_native gauge",
+        f"cpm_extractor_native {int(stats is not None)}",
+    ]
+    if stats is None:
+        return "\n".join(lines) + "\n"
+
+    lines += [
+        "# HELP cpm_extractor_stats_enabled Whether stage instrumentation is compiled in.",
+        "# TYPE cpm_extractor_stats_enabled gauge",
+        f"cpm_extractor_stats_enabled {int(stats['enabled'])}",
+    ]
+    counters = [
+        ("calls", "calls_total", "Calls per extraction stage."),
+        ("nanoseconds", "seconds_total", "Time spent per extraction stage."),
+        ("cycles", "cycles_total", "CPU time-stamp counter cycles per extraction stage."),
+        ("bytes", "bytes_total", "Input bytes processed per extraction stage."),
+    ]
+    for field, suffix, help_text in counters:
+        name = f"cpm_extractor_stage_{suffix}"
+        lines += [f"# HELP {name} {help_text}", f"# TYPE {name} counter"]
+        for stage, values in stats["stages"].items():
+            value = values[field] / 1e9 if field == "nanoseconds" else values[field]
+            lines.append(f'{name}{{stage="{stage}"}} {value}')
+
+    plan_cache = stats["plan_cache"]
+    lines += [
+        "# HELP cpm_extractor_plan_cache_lookups_total FFT plan cache lookups.",
+        "# TYPE cpm_extractor_plan_cache_lookups_total counter",
+        f'cpm_extractor_plan_cache_lookups_total{{result="hit"}} {plan_cache["hits"]}',
+        f'cpm_extractor_plan_cache_lookups_total{{result="miss"}} {plan_cache["misses"]}',
+    ]
+    return "\n".join(lines) + "\n"
+
+
+def extract_features(
+    signal: np.ndarray,
+    sample_rate: float = 5000.0,
+    features: str = "all"
+) -> SignalFeatures:
+    """
+    Extract features from signal using best available implementation.
+
+    features is a comma-separated list such as "rms,kurtosis" or "spectrum".
+    The C++ module skips everything else (reported as NaN, the spectrum as
+    empty); the Python fallback always computes every feature.
+    """
     extractor = get_extractor(sample_rate)
 
     if _USE_CPP:
-        result = extractor.extract_all(signal)
-        return SignalFeatures(
-            rms=result.rms,
-            peak=result.peak,
-            crest_factor=result.crest_factor,
-            kurtosis=result.kurtosis,
-            skewness=result.skewness,
-            spectral_centroid=result.spectral_centroid,
-            spectral_spread=result.spectral_spread,
-            fft_magnitude=np.array(result.fft_magnitude),
-            fft_frequencies=np.array(result.fft_frequencies),
-            bandpowers=dict(zip(result.band_names, result.bandpowers))
-        )
+        extractor.features = cpp_extractor.parse_features(features)
+        return _from_native(extractor.extract_all(signal))
     else:
         return extractor.extract_all(signal)
+
+
+def _from_native(result) -> SignalFeatures:
+    """SignalFeatures of a native result."""
+    return SignalFeatures(
+        rms=result.rms,
+        peak=result.peak,
+        crest_factor=result.crest_factor,
+        kurtosis=result.kurtosis,
+        skewness=result.skewness,
+        spectral_centroid=result.spectral_centroid,
+        spectral_spread=result.spectral_spread,
+        # Zero-copy views into the native result
+        fft_magnitude=np.asarray(result.fft_magnitude),
+        fft_frequencies=np.asarray(result.fft_frequencies),
+        bandpowers=dict(zip(result.band_names, result.bandpowers))
+    )
+
+
+@dataclass
+class SpectrumSummary:
+    """A spectrum thinned for display, with values of the full spectrum."""
+    frequencies: np.ndarray
+    magnitudes: np.ndarray
+    peaks: list[tuple[float, float]]  # (frequency, magnitude), largest first
+    num_bins: int
+    dominant_frequency: float
+    total_power: float
+    decimation: str  # Method applied: "minmax", "lttb", "log" or "none"
+
+
+def reduce_spectrum(
+    frequencies: np.ndarray,
+    magnitudes: np.ndarray,
+    points: int = 256,
+    method: str = "minmax",
+    log_frequency: bool = False,
+    num_peaks: int = 0
+) -> SpectrumSummary:
+    """
+    Thin a magnitude spectrum to at most points points for plotting.
+
+    "minmax" keeps each bucket's extremes so no peak disappears, "lttb"
+    keeps the visually most significant bin per bucket, and log_frequency
+    resamples onto log-spaced frequencies (largest magnitude per bucket).
+    Peaks (local maxima above DC), the dominant frequency and the total
+    power are taken from the full spectrum. points=0 keeps every bin.
+    LTTB needs the native module and points >= 3; otherwise minmax is
+    applied, as the returned decimation says.
+    """
+    n = len(magnitudes)
+    if points == 0 or n < 3 or (n <= points and not log_frequency):
+        decimation = "none"
+    elif log_frequency and (_USE_CPP or frequencies[1] > 0):
+        decimation = "log"
+    elif method == "lttb" and _USE_CPP and points >= 3:
+        decimation = "lttb"
+    else:
+        decimation = "minmax"
+
+    if _USE_CPP:
+        r = cpp_extractor.reduce_spectrum(frequencies, magnitudes, points, method,
+                                          log_frequency, num_peaks=num_peaks)
+        return SpectrumSummary(
+            frequencies=np.asarray(r.frequencies),
+            magnitudes=np.asarray(r.magnitudes),
+            peaks=[(p.frequency, p.magnitude) for p in r.peaks],
+            num_bins=r.num_bins,
+            dominant_frequency=r.dominant_frequency,
+            total_power=r.total_power,
+            decimation=decimation
+        )
+
+    # numpy fallback: min/max buckets (LTTB is native-only), log buckets by maximum
+    dominant = float(frequencies[np.argmax(magnitudes[1:]) + 1]) if n > 1 else 0.0
+    total_power = float(np.sum(magnitudes ** 2))
+
+    peaks = []
+    if num_peaks > 0 and n >= 3:
+        m = magnitudes
+        idx = np.flatnonzero((m[1:-1] > m[:-2]) & (m[1:-1] >= m[2:])) + 1
+        idx = idx[np.argsort(-m[idx], kind="stable")[:num_peaks]]
+        peaks = [(float(frequencies[i]), float(magnitudes[i])) for i in idx]
+
+    if decimation == "none":
+        f, m = frequencies, magnitudes
+    elif decimation == "log":
+        edges = np.geomspace(frequencies[1], frequencies[-1], points + 1)
+        f = np.sqrt(edges[:-1] * edges[1:])
+        bucket = np.clip(np.searchsorted(edges, frequencies[1:], side="right") - 1, 0, points - 1)
+        m = np.full(points, -np.inf)
+        np.maximum.at(m, bucket, magnitudes[1:])
+        empty = np.isinf(m)
+        m[empty] = np.interp(f[empty], frequencies, magnitudes)
+    elif points == 1:
+        keep = [int(np.argmax(magnitudes))]
+        f, m = frequencies[keep], magnitudes[keep]
+    else:
+        keep = []
+        for chunk in np.array_split(np.arange(n), max(1, points // 2)):
+            if len(chunk):
+                lo, hi = chunk[np.argmin(magnitudes[chunk])], chunk[np.argmax(magnitudes[chunk])]
+                keep.extend(sorted({lo, hi}))
+        f, m = frequencies[keep], magnitudes[keep]
+
+    return SpectrumSummary(
+        frequencies=np.asarray(f), magnitudes=np.asarray(m), peaks=peaks,
+        num_bins=n, dominant_frequency=dominant, total_power=total_power,
+        decimation=decimation
+    )
+
+
+_extraction_queues: dict[tuple[float, str], object] = {}
+
+
+def get_extraction_queue(sample_rate: float = 5000.0, features: str = "all"):
+    """
+    Native extraction queue for one sample rate and feature list, created on
+    first use with a worker per core. None without the C++ module.
+    """
+    if not _USE_CPP:
+        return None
+    key = (sample_rate, features)
+    queue = _extraction_queues.get(key)
+    if queue is None:
+        extractor = get_extractor(sample_rate, num_threads=0)
+        extractor.features = cpp_extractor.parse_features(features)
+        queue = cpp_extractor.ExtractionQueue(extractor)
+        _extraction_queues[key] = queue
+    return queue
+
+
+async def extract_features_async(
+    signal: np.ndarray,
+    sample_rate: float = 5000.0,
+    features: str = "all"
+) -> SignalFeatures:
+    """
+    extract_features without blocking the event loop.
+
+    With the C++ module the signal goes to a native extraction queue:
+    requests submitted while others are in flight are extracted together
+    as one micro-batch on the worker pool, with the GIL released, and the
+    coroutine resumes when its own result is ready. The Python fallback
+    runs extract_features in the default executor.
+    """
+    queue = get_extraction_queue(sample_rate, features)
+    if queue is None:
+        return await asyncio.to_thread(extract_features, signal, sample_rate, features)
+    future = queue.submit(np.ascontiguousarray(signal, dtype=np.float64))
+    return _from_native(await asyncio.wrap_future(future))
+
+
+def extract_features_batch(
+    signals: np.ndarray,
+    sample_rate: float = 5000.0,
+    num_threads: int = 1,
+    features: str = "all",
+    store_path: str = ""
+) -> BatchFeatures:
+    """
+    Extract features from each row of a (T, N) waveform array.
+
+    With the C++ module, rows are spread over num_threads native workers
+    (0 = all cores) with the GIL released, and only the listed features
+    are computed (see extract_features). With store_path, rows already in
+    that feature store are read from it instead of being extracted.
+    """
+    extractor = get_extractor(sample_rate, num_threads)
+
+    if _USE_CPP:
+        extractor.features = cpp_extractor.parse_features(features)
+        # float32 waveforms are read natively; other dtypes are cast to float64
+        dtype = np.float32 if signals.dtype == np.float32 else np.float64
+        signals = np.ascontiguousarray(signals, dtype=dtype)
+        store = get_feature_store(store_path, len(extractor.bands))
+        if store is not None:
+            result = store.extract_batch(extractor, signals)
+        else:
+            result = extractor.extract_batch(signals)
+        return BatchFeatures(
+            rms=np.asarray(result.rms),
+            peak=np.asarray(result.peak),
+            crest_factor=np.asarray(result.crest_factor),
+            kurtosis=np.asarray(result.kurtosis),
+            skewness=np.asarray(result.skewness),
+            spectral_centroid=np.asarray(result.spectral_centroid),
+            spectral_spread=np.asarray(result.spectral_spread),
+            bandpowers=np.asarray(result.bandpowers),
+            band_names=list(result.band_names)
+        )
+    else:
+        return extractor.extract_batch(signals)
+
+
+_SCALAR_FIELDS = ("rms", "peak", "crest_factor", "kurtosis", "skewness",
+                  "spectral_centroid", "spectral_spread")
+
+
+class FleetFeatures:
+    """
+    Per-asset feature history that only extracts waveforms it has not seen.
+
+    update() takes an asset's full (T, N) waveform history and extracts the
+    rows past the ones already held, so serving a growing history costs
+    O(new rows). With the C++ module the history lives in a native
+    FleetFeatureTable and batch() / column() return zero-copy views that
+    stay valid as rows are appended, and with store_path new rows are read
+    from the shared feature store when another process already extracted
+    them. The Python fallback keeps the same interface but re-concatenates
+    its arrays after each update.
+    """
+
+    def __init__(self, sample_rate: float = 5000.0, num_threads: int = 0, store_path: str = ""):
+        self._extractor = get_extractor(sample_rate, num_threads)
+        if _USE_CPP:
+            store = get_feature_store(store_path, len(self._extractor.bands))
+            self._table = cpp_extractor.FleetFeatureTable(store)
+        else:
+            self._batches: dict[str, BatchFeatures] = {}
+
+    def rows(self, asset_id: str) -> int:
+        """Rows held for an asset."""
+        if _USE_CPP:
+            return self._table.rows(asset_id)
+        batch = self._batches.get(asset_id)
+        return 0 if batch is None else len(batch.rms)
+
+    def update(self, asset_id: str, waveforms: np.ndarray) -> tuple[int, int]:
+        """Extract rows of waveforms not held yet; returns the [begin, end) rows added."""
+        if _USE_CPP:
+            dtype = np.float32 if waveforms.dtype == np.float32 else np.float64
+            added = self._table.update(asset_id, self._extractor,
+                                       np.ascontiguousarray(waveforms, dtype=dtype))
+            return added.begin, added.end
+
+        held = self.rows(asset_id)
+        if len(waveforms) < held:
+            raise ValueError(f"Waveform history of {asset_id} is shorter than its features")
+        if len(waveforms) == held:
+            return held, held
+        fresh = self._extractor.extract_batch(waveforms[held:])
+        old = self._batches.get(asset_id)
+        if old is not None:
+            fresh = BatchFeatures(
+                **{name: np.concatenate([getattr(old, name), getattr(fresh, name)])
+                   for name in _SCALAR_FIELDS + ("bandpowers",)},
+                band_names=old.band_names
+            )
+        self._batches[asset_id] = fresh
+        return held, len(waveforms)
+
+    def column(self, asset_id: str, name: str) -> np.ndarray:
+        """One feature column of an asset (e.g. "rms"), oldest row first."""
+        if _USE_CPP:
+            return self._table.column(asset_id, name)
+        return getattr(self._batches[asset_id], name)
+
+    def batch(self, asset_id: str) -> BatchFeatures:
+        """All features held for an asset."""
+        if _USE_CPP:
+            return BatchFeatures(
+                **{name: self._table.column(asset_id, name) for name in _SCALAR_FIELDS},
+                bandpowers=self._table.column(asset_id, "bandpowers"),
+                band_names=self._table.band_names(asset_id)
+            )
+        return self._batches[asset_id]
+
+
+def extract_features_multichannel(
+    data: np.ndarray,
+    sample_rate: float = 5000.0,
+    interleaved: bool = False,
+    num_threads: int = 1
+) -> tuple[BatchFeatures, float]:
+    """
+    Per-channel features of a multichannel recording and its vector RMS.
+
+    data is (channels, samples), or (samples, channels) when interleaved.
+    The C++ module de-interleaves natively, so no transposed copy is made
+    in Python.
+    """
+    if _USE_CPP:
+        extractor = get_extractor(sample_rate, num_threads)
+        layout = (cpp_extractor.ChannelLayout.INTERLEAVED if interleaved
+                  else cpp_extractor.ChannelLayout.PLANAR)
+        result = extractor.extract_multichannel(
+            np.ascontiguousarray(data, dtype=np.float64), layout)
+        channels = result.channels
+        batch = BatchFeatures(
+            rms=np.asarray(channels.rms),
+            peak=np.asarray(channels.peak),
+            crest_factor=np.asarray(channels.crest_factor),
+            kurtosis=np.asarray(channels.kurtosis),
+            skewness=np.asarray(channels.skewness),
+            spectral_centroid=np.asarray(channels.spectral_centroid),
+            spectral_spread=np.asarray(channels.spectral_spread),
+            bandpowers=np.asarray(channels.bandpowers),
+            band_names=list(channels.band_names)
+        )
+        return batch, result.vector_rms
+
+    planar = data.T if interleaved else data
+    batch = extract_features_batch(planar, sample_rate, num_threads)
+    return batch, float(np.sqrt(np.sum(batch.rms ** 2)))
+
+
+# Defect frequencies as multiples of shaft speed (BPFO matches the simulator)
+DEFAULT_BEARING_ORDERS = {"BPFO": 3.5, "BPFI": 5.4, "BSF": 2.3, "FTF": 0.4}
+
+
+def find_demodulation_band(
+    signal: np.ndarray,
+    sample_rate: float,
+    max_level: int = 6
+) -> dict[str, float]:
+    """
+    Fast kurtogram: the band of a 1/3-binary tree over [0, Nyquist) whose
+    complex envelope has the largest spectral kurtosis, i.e. where impacts
+    stand out most. Returns band_low, band_high (Hz), level and kurtosis.
+    """
+    signal = np.ascontiguousarray(signal, dtype=np.float64)
+    if _USE_CPP:
+        extractor = cpp_extractor.FeatureExtractor(sample_rate)
+        k = extractor.compute_kurtogram(signal, cpp_extractor.KurtogramConfig(max_level))
+        return {"band_low": k.band_low, "band_high": k.band_high,
+                "level": k.best_level, "kurtosis": k.best_kurtosis}
+
+    # numpy fallback: same spectrum slicing as the C++ analyzer
+    n = len(signal)
+    bins = n // 2
+    spectrum = np.fft.rfft(signal)[:bins]
+    rows = [(0.0, 1)]
+    for k in range(1, max_level + 1):
+        if k > 1 and bins // (3 * 2 ** (k - 2)) >= 8:
+            rows.append((k - 0.4, 3 * 2 ** (k - 2)))
+        if bins // 2 ** k < 8:
+            break
+        rows.append((float(k), 2 ** k))
+    best = {"band_low": 0.0, "band_high": 0.0, "level": 0.0, "kurtosis": -np.inf}
+    for level, bands in rows:
+        size = 1 << int(np.ceil(np.log2(-(-bins // bands))))
+        guard = size // 16
+        for b in range(bands):
+            lo, hi = max(1, b * bins // bands), (b + 1) * bins // bands
+            envelope = np.zeros(size, dtype=complex)
+            envelope[:hi - lo] = spectrum[lo:hi]
+            power = np.abs(np.fft.ifft(envelope)[guard:size - guard]) ** 2
+            sk = power.size * np.sum(power ** 2) / np.sum(power) ** 2 - 2.0 if power.sum() > 0 else 0.0
+            if sk > best["kurtosis"]:
+                nyquist = sample_rate / 2
+                best = {"band_low": nyquist * b / bands, "band_high": nyquist * (b + 1) / bands,
+                        "level": level, "kurtosis": float(sk)}
+    return best
+
+
+def extract_bearing_faults(
+    signal: np.ndarray,
+    sample_rate: float,
+    shaft_hz: float,
+    band: Optional[tuple[float, float]] = None,
+    orders: Optional[dict[str, float]] = None,
+    harmonics: int = 3,
+    half_width_hz: float = 2.0
+) -> dict[str, float]:
+    """
+    Envelope-spectrum amplitudes at bearing defect frequencies.
+
+    The signal is band-passed to `band` (a structural resonance), demodulated
+    with the Hilbert transform, and the largest envelope-spectrum magnitude
+    within half_width_hz of each defect harmonic is returned, keyed as
+    "BPFO 1x", "BPFI 2x", ... Without a band, the kurtogram's best band is
+    demodulated (sharing the signal's FFT on the C++ path).
+    """
+    orders = {**DEFAULT_BEARING_ORDERS, **(orders or {})}
+
+    if _USE_CPP:
+        extractor = cpp_extractor.FeatureExtractor(sample_rate)
+        extractor.set_envelope(cpp_extractor.EnvelopeConfig(
+            *(band or (0.0, sample_rate / 2)), shaft_hz,
+            cpp_extractor.BearingFaultOrders(
+                orders["BPFO"], orders["BPFI"], orders["BSF"], orders["FTF"]),
+            harmonics, half_width_hz))
+        signal = np.ascontiguousarray(signal, dtype=np.float64)
+        if band is None:
+            result = extractor.compute_kurtogram_envelope(signal)
+        else:
+            result = extractor.extract_all(signal)
+        return dict(zip(result.fault_names, result.fault_amplitudes))
+
+    if band is None:
+        best = find_demodulation_band(signal, sample_rate)
+        band = (best["band_low"], best["band_high"])
+
+    n = len(signal)
+    spectrum = np.fft.fft(signal)
+    freqs = np.fft.fftfreq(n, 1.0 / sample_rate)
+    analytic_spectrum = np.where((freqs >= band[0]) & (freqs < band[1]), 2.0 * spectrum, 0.0)
+    envelope = np.abs(np.fft.ifft(analytic_spectrum))
+    envelope -= envelope.mean()
+
+    env_magnitude = np.abs(np.fft.rfft(envelope))[: n // 2] * 2.0 / n
+    env_freqs = np.arange(n // 2) * sample_rate / n
+
+    amplitudes = {}
+    for name, order in orders.items():
+        if order <= 0:
+            continue
+        for h in range(1, harmonics + 1):
+            centre = shaft_hz * order * h
+            mask = (env_freqs >= max(0.0, centre - half_width_hz)) & (env_freqs < centre + half_width_hz)
+            amplitudes[f"{name} {h}x"] = float(env_magnitude[mask].max()) if mask.any() else 0.0
+    return amplitudes
+
+
+# Sub-synchronous, 1x-3x (+/- 0.25 orders) and everything above, as the C++ defaults
+ORDER_BANDS = [("0.5x", 0.25, 0.75), ("1x", 0.75, 1.25), ("2x", 1.75, 2.25),
+               ("3x", 2.75, 3.25), ("4x+", 3.75, np.inf)]
+
+
+def extract_order_bands(
+    signal: np.ndarray,
+    rpm,
+    sample_rate: float = 5000.0,
+    samples_per_rev: int = 64
+) -> dict[str, float]:
+    """
+    Order-band powers of a signal, keyed "0.5x", "1x", "2x", "3x", "4x+".
+
+    The signal is resampled at samples_per_rev equal shaft-angle steps per
+    revolution (rpm is a constant speed or a trace spread over the signal)
+    and its whole revolutions are transformed, so shaft harmonics land in
+    the same bands at any speed.
+    """
+    signal = np.ascontiguousarray(signal, dtype=np.float64)
+    if _USE_CPP:
+        extractor = cpp_extractor.FeatureExtractor(sample_rate)
+        if samples_per_rev != 64:
+            extractor.set_order_tracking(cpp_extractor.OrderConfig(samples_per_rev))
+        if np.ndim(rpm) == 0:
+            result = extractor.compute_order_spectrum(signal, float(rpm))
+        else:
+            result = extractor.compute_order_spectrum(signal, np.ascontiguousarray(rpm, dtype=np.float64))
+        return dict(zip(result.band_names, (float(p) for p in result.band_powers)))
+
+    # numpy fallback: linear interpolation onto the angle grid (no anti-alias filter)
+    n = len(signal)
+    trace = np.atleast_1d(np.asarray(rpm, dtype=np.float64))
+    if np.any(trace <= 0):
+        raise ValueError("Shaft speed must be positive")
+    speed = np.interp(np.linspace(0.0, 1.0, n), np.linspace(0.0, 1.0, len(trace)), trace)
+    angle = np.concatenate(([0.0], np.cumsum(0.5 * (speed[1:] + speed[:-1])))) / (60.0 * sample_rate)
+    revolutions = int(np.floor(angle[-1] + 1e-9)) if n > 1 else 0
+    powers = dict.fromkeys((name for name, _, _ in ORDER_BANDS), 0.0)
+    if revolutions == 0:
+        return powers
+    m = revolutions * samples_per_rev
+    resampled = np.interp(np.arange(m) / samples_per_rev, angle, signal)
+    magnitudes = np.abs(np.fft.rfft(resampled))[: m // 2] * 2.0 / m
+    magnitudes[0] /= 2.0
+    orders = np.arange(m // 2) / revolutions
+    for name, low, high in ORDER_BANDS:
+        band = (orders >= low) & (orders < high)
+        powers[name] = float(np.sum(magnitudes[band] ** 2))
+    return powers
+
+
+@dataclass
+class FeatureTable:
+    """
+    Columnar features read from a CPMF file written by the C++ CLI or
+    cpm::FeatureTableWriter. Arrays are read-only views into a memory map.
+    """
+    columns: dict[str, np.ndarray]  # Scalar columns, (rows,)
+    bandpowers: np.ndarray          # (rows, bands), strided view over the band columns
+    band_names: list[str]
+    row_labels: list[str]           # Source file per row, empty if not recorded
+    frequencies: Optional[np.ndarray] = None  # (bins,)
+    spectrum: Optional[np.ndarray] = None     # (rows, bins); decoded copy for encoded files
+    spectrum_encoding: str = "f64"
+
+    def to_batch(self) -> BatchFeatures:
+        """View as BatchFeatures (no copies)."""
+        return BatchFeatures(
+            rms=self.columns["rms"],
+            peak=self.columns["peak"],
+            crest_factor=self.columns["crest_factor"],
+            kurtosis=self.columns["kurtosis"],
+            skewness=self.columns["skewness"],
+            spectral_centroid=self.columns["spectral_centroid"],
+            spectral_spread=self.columns["spectral_spread"],
+            bandpowers=self.bandpowers,
+            band_names=self.band_names
+        )
+
+
+_CPMF_HEADER = struct.Struct("<4sHHIIIIQQQQQ")
+
+# SpectrumEncoding values (feature_codec.hpp): name, code dtype, log levels
+_SPECTRUM_ENCODINGS = {
+    1: ("f16", "<f2", 0),
+    2: ("log8", "u1", 255),
+    3: ("log16", "<u2", 65535),
+}
+
+
+def _decode_spectrum_blocks(data: np.ndarray, offset: int, num_rows: int, num_bins: int,
+                            encoding: int) -> np.ndarray:
+    """Decode the per-row SpectrumBlockHeader + codes blocks of a version 2 CPMF file."""
+    _, code_dtype, levels = _SPECTRUM_ENCODINGS[encoding]
+    code_size = np.dtype(code_dtype).itemsize
+    blocks = np.ndarray(num_rows, dtype=np.dtype({
+        "names": ["num_values", "dynamic_range_db", "scale", "codes"],
+        "formats": ["<u4", "<u2", "<f8", (code_dtype, (num_bins,))],
+        "offsets": [4, 2, 8, 16],
+        "itemsize": 16 + (num_bins * code_size + 7) // 8 * 8,
+    }), buffer=data, offset=offset)
+
+    scale = blocks["scale"][:, None]
+    if levels == 0:
+        spectrum = blocks["codes"].astype(np.float64) * scale
+    else:
+        q = blocks["codes"].astype(np.float64)
+        range_db = blocks["dynamic_range_db"].astype(np.float64)[:, None]
+        spectrum = np.where(q > 0, scale * 10.0 ** (-range_db / 20.0 * (levels - q) / (levels - 1)), 0.0)
+    spectrum[blocks["num_values"] == 0] = np.nan  # Rows never written
+    return spectrum
+
+
+def read_feature_table(path: str) -> FeatureTable:
+    """Memory-map a CPMF feature table (see feature_table.hpp for the layout)."""
+    data = np.memmap(path, dtype=np.uint8, mode="r")
+    (magic, version, encoding, num_columns, num_bands, num_bins, _,
+     num_rows, names_size, columns_offset, column_stride,
+     spectrum_offset) = _CPMF_HEADER.unpack_from(data, 0)
+    if magic != b"CPMF" or version not in (1, 2):
+        raise ValueError(f"{path} is not a version 1 or 2 CPMF file")
+    if version == 2 and encoding not in _SPECTRUM_ENCODINGS:
+        raise ValueError(f"{path} has unknown spectrum encoding {encoding}")
+
+    start = _CPMF_HEADER.size
+    names = bytes(data[start:start + names_size]).decode("utf-8").split("\n")[:-1]
+    column_names, row_labels = names[:num_columns], names[num_columns:]
+
+    # All columns as one strided (columns, rows) view
+    block = np.ndarray(
+        (num_columns, num_rows), dtype="<f8", buffer=data,
+        offset=columns_offset, strides=(column_stride, 8)
+    )
+    num_scalars = num_columns - num_bands
+
+    frequencies = spectrum = None
+    if num_bins:
+        frequencies = np.ndarray((num_bins,), dtype="<f8", buffer=data, offset=spectrum_offset)
+        magnitudes_offset = spectrum_offset + (num_bins * 8 + 63) // 64 * 64
+        if version == 1:
+            spectrum = np.ndarray((num_rows, num_bins), dtype="<f8", buffer=data, offset=magnitudes_offset)
+        else:
+            spectrum = _decode_spectrum_blocks(data, magnitudes_offset, num_rows, num_bins, encoding)
+
+    return FeatureTable(
+        columns={name: block[i] for i, name in enumerate(column_names[:num_scalars])},
+        bandpowers=block[num_scalars:].T,
+        band_names=column_names[num_scalars:],
+        row_labels=row_labels,
+        frequencies=frequencies,
+        spectrum=spectrum,
+        spectrum_encoding=_SPECTRUM_ENCODINGS[encoding][0] if version == 2 else "f64"
+    )
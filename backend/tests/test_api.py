@@ -92,6 +92,8 @@ def test_get_features():
     assert "kurtosis" in data
     assert "spectral_centroid" in data
     assert "bandpowers" in data
+    assert set(data["order_bandpowers"]) == {"0.5x", "1x", "2x", "3x", "4x+"}
+    assert data["order_bandpowers"]["1x"] > 0
 
 
 def test_get_fft():
@@ -106,6 +108,39 @@ def test_get_fft():
     assert "magnitudes" in data
     assert "dominant_frequency" in data
     assert len(data["frequencies"]) == len(data["magnitudes"])
+    assert len(data["frequencies"]) <= 256 < data["num_bins"]
+    assert len(data["peaks"]) == 5
+    assert data["decimation"] == "minmax"
+
+    response = client.get(f"/api/assets/{asset_id}/fft?points=0&peaks=0")
+    full = response.json()
+    assert len(full["magnitudes"]) == full["num_bins"]
+    assert full["dominant_frequency"] == data["dominant_frequency"]
+    assert full["decimation"] == "none"
+
+    response = client.get(f"/api/assets/{asset_id}/fft?points=1")
+    single = response.json()
+    assert len(single["magnitudes"]) == 1
+    assert single["magnitudes"][0] == max(full["magnitudes"])
+
+
+def test_extract_features_async():
+    """Concurrent async extractions match extract_features."""
+    import asyncio
+    import numpy as np
+    from app.services.feature_service import extract_features, extract_features_async
+
+    t = np.arange(2048) / 5000.0
+    signals = [np.sin(2 * np.pi * (50 + 10 * i) * t) for i in range(16)]
+
+    async def extract_all():
+        return await asyncio.gather(*(extract_features_async(s) for s in signals))
+
+    for signal, result in zip(signals, asyncio.run(extract_all())):
+        expected = extract_features(signal)
+        assert result.rms == pytest.approx(expected.rms)
+        assert result.spectral_centroid == pytest.approx(expected.spectral_centroid)
+        assert len(result.fft_magnitude) == len(expected.fft_magnitude)
 
 
 def test_get_rul():
@@ -135,6 +170,7 @@ def test_get_trajectory():
     data = response.json()
     assert "trajectory" in data
     assert len(data["trajectory"]) == 31  # 0 to 30 days
+    assert isinstance(data["vibration_rms_trend"], float)
 
 
 def test_get_causal_effects():
@@ -179,6 +215,14 @@ def test_stats():
     assert "average_rul_days" in data
 
 
+def test_metrics():
+    """Test the Prometheus scrape endpoint."""
+    response = client.get("/metrics")
+    assert response.status_code == 200
+    assert response.headers["content-type"].startswith("text/plain")
+    assert "cpm_extractor_native" in response.text
+
+
 def test_causal_graph():
     """Test getting causal graph."""
     response = client.get("/api/causal-graph")
@@ -0,0 +1,433 @@
+/**
+ * Throughput benchmarks for the feature extractor (Google Benchmark).
+ *
+ * Every benchmark reports samples/s and heap allocations per call; the
+ * allocation count comes from a global operator new override, as in the
+ * unit tests. Filter with --benchmark_filter, e.g. 'extract_all<float>'.
+ */
+
+#include <benchmark/benchmark.h>
+#include "extraction_queue.hpp"
+#include "feature_codec.hpp"
+#include "feature_extractor.hpp"
+#include "streaming_extractor.hpp"
+#include "waveform_synth.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+std::atomic<size_t> allocation_count{0};
+
+constexpr double SAMPLE_RATE = 5000.0;
+constexpr double INT16_SCALE = 1.0 / 8192.0;
+
+// Deterministic vibration-like test signal: two tones, impacts and noise,
+// within +/-4 so int16 counts at INT16_SCALE do not clip
+std::vector<double> make_signal(size_t n, uint64_t seed = 7) {
+    std::vector<double> x(n);
+    uint64_t state = seed;
+    for (size_t i = 0; i < n; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        double noise = static_cast<double>(state >> 11) / 9007199254740992.0 - 0.5;
+        double t = static_cast<double>(i) / SAMPLE_RATE;
+        x[i] = 1.5 * std::sin(2.0 * cpm::PI * 120.0 * t) + 0.5 * std::sin(2.0 * cpm::PI * 1450.0 * t)
+             + (i % 211 == 0 ? 1.5 : 0.0) + 0.2 * noise;
+    }
+    return x;
+}
+
+// The test signal in sample type T
+template <typename T>
+std::vector<T> make_samples(size_t n, uint64_t seed = 7) {
+    auto x = make_signal(n, seed);
+    std::vector<T> out(n);
+    for (size_t i = 0; i < n; ++i) {
+        if constexpr (std::is_same_v<T, int16_t>) {
+            out[i] = static_cast<int16_t>(std::lround(x[i] / INT16_SCALE));
+        } else {
+            out[i] = static_cast<T>(x[i]);
+        }
+    }
+    return out;
+}
+
+// samples/s and allocations per iteration, from counts taken around the loop
+void report(benchmark::State& state, size_t samples_per_call, size_t allocations) {
+    state.counters["samples/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * static_cast<double>(samples_per_call),
+        benchmark::Counter::kIsRate);
+    state.counters["allocs/call"] = benchmark::Counter(
+        static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+// 256 to 1M samples
+void signal_sizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(4)->Range(256, 1 << 20);
+}
+
+// ---------------------------------------------------------------------------
+// Time-domain features
+
+template <typename Fn>
+void time_feature(benchmark::State& state, Fn fn) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto signal = make_signal(n);
+    cpm::FeatureExtractor extractor(SAMPLE_RATE);
+
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fn(extractor, std::span<const double>(signal)));
+    }
+    report(state, n, allocation_count.load() - before);
+}
+
+void BM_rms(benchmark::State& state) {
+    time_feature(state, [](const auto& e, auto s) { return e.compute_rms(s); });
+}
+
+void BM_peak(benchmark::State& state) {
+    time_feature(state, [](const auto& e, auto s) { return e.compute_peak(s); });
+}
+
+void BM_crest_factor(benchmark::State& state) {
+    time_feature(state, [](const auto& e, auto s) { return e.compute_crest_factor(s); });
+}
+
+void BM_kurtosis(benchmark::State& state) {
+    time_feature(state, [](const auto& e, auto s) { return e.compute_kurtosis(s); });
+}
+
+void BM_skewness(benchmark::State& state) {
+    time_feature(state, [](const auto& e, auto s) { return e.compute_skewness(s); });
+}
+
+BENCHMARK(BM_rms)->Apply(signal_sizes);
+BENCHMARK(BM_peak)->Apply(signal_sizes);
+BENCHMARK(BM_crest_factor)->Apply(signal_sizes);
+BENCHMARK(BM_kurtosis)->Apply(signal_sizes);
+BENCHMARK(BM_skewness)->Apply(signal_sizes);
+
+// Fused pass over all time-domain statistics, per sample type
+template <typename T>
+void BM_time_stats(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto signal = make_samples<T>(n);
+    cpm::FeatureExtractor extractor(SAMPLE_RATE);
+
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        if constexpr (std::is_same_v<T, int16_t>) {
+            benchmark::DoNotOptimize(extractor.compute_time_stats(std::span<const T>(signal), INT16_SCALE));
+        } else {
+            benchmark::DoNotOptimize(extractor.compute_time_stats(std::span<const T>(signal)));
+        }
+    }
+    report(state, n, allocation_count.load() - before);
+}
+
+BENCHMARK_TEMPLATE(BM_time_stats, double)->Apply(signal_sizes);
+BENCHMARK_TEMPLATE(BM_time_stats, float)->Apply(signal_sizes);
+BENCHMARK_TEMPLATE(BM_time_stats, int16_t)->Apply(signal_sizes);
+
+// ---------------------------------------------------------------------------
+// Spectrum
+
+void BM_compute_fft(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto signal = make_signal(n);
+    cpm::FeatureExtractor extractor(SAMPLE_RATE);
+    extractor.compute_fft(signal);  // Build the plan outside the timed loop
+
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(extractor.compute_fft(signal));
+    }
+    report(state, n, allocation_count.load() - before);
+}
+
+BENCHMARK(BM_compute_fft)->Apply(signal_sizes);
+
+// Non-power-of-two lengths take the mixed-radix and Bluestein paths
+BENCHMARK(BM_compute_fft)->Arg(1000)->Arg(5000)->Arg(10007)->Arg(100000);
+
+// Angle-domain resampling plus one whole-revolution transform; the
+// band-power helper is the per-waveform cost of speed-normalised features
+void BM_order_spectrum(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto signal = make_signal(n);
+    cpm::FeatureExtractor extractor(SAMPLE_RATE);
+    extractor.compute_order_spectrum(signal, 1800.0);
+
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(extractor.compute_order_spectrum(signal, 1800.0));
+    }
+    report(state, n, allocation_count.load() - before);
+}
+
+BENCHMARK(BM_order_spectrum)->Apply(signal_sizes);
+
+// One FFT shared by the spectral-kurtosis tree (levels up to 6 with thirds)
+// and the envelope spectrum of the band it selects
+void BM_kurtogram_envelope(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto signal = make_signal(n);
+    cpm::FeatureExtractor extractor(SAMPLE_RATE);
+    extractor.compute_kurtogram_envelope(signal);
+
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(extractor.compute_kurtogram_envelope(signal));
+    }
+    report(state, n, allocation_count.load() - before);
+}
+
+BENCHMARK(BM_kurtogram_envelope)->Apply(signal_sizes);
+
+// Encode and decode one magnitude spectrum of n / 2 bins; arg 1 is the SpectrumEncoding
+void BM_spectrum_codec(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto encoding = static_cast<cpm::SpectrumEncoding>(state.range(1));
+    cpm::FeatureExtractor extractor(SAMPLE_RATE);
+    const auto magnitudes = extractor.compute_fft(make_signal(n)).first;
+    std::vector<unsigned char> block(cpm::encoded_spectrum_size(encoding, magnitudes.size()));
+    std::vector<double> decoded(magnitudes.size());
+
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        cpm::encode_spectrum(magnitudes, encoding, block);
+        cpm::decode_spectrum(block, decoded);
+        benchmark::DoNotOptimize(decoded.data());
+    }
+    state.SetLabel(cpm::spectrum_encoding_name(encoding));
+    state.counters["ratio"] = static_cast<double>(magnitudes.size() * sizeof(double)) /
+                              static_cast<double>(block.size());
+    report(state, magnitudes.size(), allocation_count.load() - before);
+}
+
+BENCHMARK(BM_spectrum_codec)->ArgsProduct({{4096, 65536}, {1, 2, 3}});
+
+// ---------------------------------------------------------------------------
+// Full extraction
+
+// Convenience call: fresh result vectors every time
+template <typename T>
+void BM_extract_all(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto signal = make_samples<T>(n);
+    cpm::FeatureExtractor extractor(SAMPLE_RATE);
+
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        if constexpr (std::is_same_v<T, int16_t>) {
+            benchmark::DoNotOptimize(extractor.extract_all(std::span<const T>(signal), INT16_SCALE));
+        } else {
+            benchmark::DoNotOptimize(extractor.extract_all(std::span<const T>(signal)));
+        }
+    }
+    report(state, n, allocation_count.load() - before);
+}
+
+BENCHMARK_TEMPLATE(BM_extract_all, double)->Apply(signal_sizes);
+BENCHMARK_TEMPLATE(BM_extract_all, float)->Apply(signal_sizes);
+BENCHMARK_TEMPLATE(BM_extract_all, int16_t)->Apply(signal_sizes);
+
+// Reused workspace without the spectrum copy: expected to allocate nothing
+template <typename T>
+void BM_extract_workspace(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto samples = make_samples<T>(n);
+    const std::span<const T> signal(samples);
+    cpm::FeatureExtractor extractor(SAMPLE_RATE);
+    cpm::Workspace workspace;
+
+    auto extract = [&] {
+        if constexpr (std::is_same_v<T, int16_t>) {
+            return &extractor.extract_all(signal, INT16_SCALE, workspace, false);
+        } else {
+            return &extractor.extract_all(signal, workspace, false);
+        }
+    };
+    extract();  // Size the workspace
+
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(extract());
+    }
+    report(state, n, allocation_count.load() - before);
+}
+
+BENCHMARK_TEMPLATE(BM_extract_workspace, double)->Apply(signal_sizes);
+BENCHMARK_TEMPLATE(BM_extract_workspace, float)->Apply(signal_sizes);
+BENCHMARK_TEMPLATE(BM_extract_workspace, int16_t)->Apply(signal_sizes);
+
+// Time-domain feature mask: no transform at all
+void BM_extract_time_domain(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto signal = make_signal(n);
+    cpm::FeatureExtractor extractor(SAMPLE_RATE);
+    extractor.set_features(cpm::Feature::TimeDomain);
+    cpm::Workspace workspace;
+    extractor.extract_all(signal, workspace, false);
+
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&extractor.extract_all(signal, workspace, false));
+    }
+    report(state, n, allocation_count.load() - before);
+}
+
+BENCHMARK(BM_extract_time_domain)->Apply(signal_sizes);
+
+// ---------------------------------------------------------------------------
+// Batch and streaming
+
+// Args: samples per row, worker threads (0 = all cores). 256 rows per call.
+template <typename T>
+void BM_extract_batch(benchmark::State& state) {
+    constexpr size_t rows = 256;
+    const size_t length = static_cast<size_t>(state.range(0));
+    const auto data = make_samples<T>(rows * length);
+    cpm::FeatureExtractor extractor(SAMPLE_RATE, static_cast<size_t>(state.range(1)));
+
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        if constexpr (std::is_same_v<T, int16_t>) {
+            benchmark::DoNotOptimize(extractor.extract_batch(std::span<const T>(data), INT16_SCALE, rows, length));
+        } else {
+            benchmark::DoNotOptimize(extractor.extract_batch(std::span<const T>(data), rows, length));
+        }
+    }
+    report(state, rows * length, allocation_count.load() - before);
+}
+
+BENCHMARK_TEMPLATE(BM_extract_batch, double)
+    ->ArgsProduct({{1024, 8192}, {1, 2, 4, 0}})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_extract_batch, float)
+    ->ArgsProduct({{1024, 8192}, {1, 0}})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_extract_batch, int16_t)
+    ->ArgsProduct({{1024, 8192}, {1, 0}})->UseRealTime();
+
+// Args: window size, hop size, update strategy (0 = FFT, 1 = sliding DFT).
+// Each iteration pushes one hop of new samples.
+void BM_streaming(benchmark::State& state) {
+    const size_t window = static_cast<size_t>(state.range(0));
+    const size_t hop = static_cast<size_t>(state.range(1));
+    const auto update = state.range(2) ? cpm::SpectrumUpdate::SlidingDFT : cpm::SpectrumUpdate::FFT;
+    const auto signal = make_signal(window + 64 * hop);
+
+    cpm::StreamingFeatureExtractor stream(SAMPLE_RATE, window, hop, update);
+    auto on_features = [](const cpm::SignalFeatures& f) { benchmark::DoNotOptimize(f.rms); };
+    stream.push(std::span<const double>(signal).first(window), on_features);
+
+    size_t offset = window;
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        if (offset + hop > signal.size()) {
+            offset = window;
+        }
+        stream.push(std::span<const double>(signal).subspan(offset, hop), on_features);
+        offset += hop;
+    }
+    report(state, hop, allocation_count.load() - before);
+}
+
+BENCHMARK(BM_streaming)
+    ->Args({4096, 1024, 0})->Args({4096, 1024, 1})
+    ->Args({4096, 64, 0})->Args({4096, 64, 1})
+    ->Args({65536, 4096, 0});
+
+// Args: samples per signal, worker threads (0 = all cores). Each iteration
+// submits a burst of 256 single-signal requests, as concurrent API calls
+// would, and waits for all of them; p99_us is submit-to-callback latency.
+void BM_queue_burst(benchmark::State& state) {
+    constexpr size_t burst = 256;
+    const size_t length = static_cast<size_t>(state.range(0));
+    const auto signal = make_signal(length);
+    cpm::FeatureExtractor extractor(SAMPLE_RATE, static_cast<size_t>(state.range(1)));
+    cpm::ExtractionQueue queue(extractor);
+
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> latencies;
+    std::vector<double> burst_latencies(burst);
+    latencies.reserve(burst * 1024);
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        std::atomic<size_t> remaining{burst};
+        for (size_t i = 0; i < burst; ++i) {
+            const auto submitted = Clock::now();
+            queue.submit(signal, false, [&, i, submitted](cpm::SignalFeatures&& f, std::exception_ptr) {
+                benchmark::DoNotOptimize(f.rms);
+                burst_latencies[i] = std::chrono::duration<double, std::micro>(Clock::now() - submitted).count();
+                remaining.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+        latencies.insert(latencies.end(), burst_latencies.begin(), burst_latencies.end());
+    }
+
+    report(state, burst * length, allocation_count.load() - before);
+    auto p99 = latencies.begin() + static_cast<std::ptrdiff_t>(latencies.size() * 99 / 100);
+    std::nth_element(latencies.begin(), p99, latencies.end());
+    state.counters["p99_us"] = *p99;
+    state.counters["signals/batch"] = static_cast<double>(queue.completed()) /
+                                      static_cast<double>(std::max<uint64_t>(1, queue.batches()));
+}
+
+BENCHMARK(BM_queue_burst)->ArgsProduct({{1024, 4096}, {1, 0}})->UseRealTime();
+
+// ---------------------------------------------------------------------------
+// Waveform synthesis
+
+// Simulator rows of 2048 samples (range(0) rows per call); the fused
+// variant extracts each row from a per-worker buffer instead of the matrix
+void BM_synthesize(benchmark::State& state) {
+    const size_t rows = static_cast<size_t>(state.range(0));
+    const bool fused = state.range(1) != 0;
+    cpm::WaveformSynthesizer synth;
+    std::vector<double> vibration(rows), speed(rows), wear(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        vibration[r] = 8.0 + static_cast<double>(r % 5);
+        speed[r] = 1000.0 + 10.0 * static_cast<double>(r % 50);
+        wear[r] = static_cast<double>(r % 100);
+    }
+    cpm::FeatureExtractor extractor(SAMPLE_RATE, 0);
+
+    const size_t before = allocation_count.load();
+    for (auto _ : state) {
+        if (fused) {
+            benchmark::DoNotOptimize(synth.extract(extractor, vibration, speed, wear));
+        } else {
+            benchmark::DoNotOptimize(synth.generate(vibration, speed, wear));
+        }
+    }
+    report(state, rows * synth.config().samples, allocation_count.load() - before);
+}
+
+BENCHMARK(BM_synthesize)->ArgsProduct({{64, 1024}, {0, 1}})->UseRealTime();
+
+} // namespace
+
+// Count heap allocations; benchmarks read the counter around their loops
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+BENCHMARK_MAIN();
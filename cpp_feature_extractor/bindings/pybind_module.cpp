@@ -1,14 +1,195 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
+#include "extraction_queue.hpp"
+#include "feature_codec.hpp"
 #include "feature_extractor.hpp"
+#include "feature_store.hpp"
+#include "feature_table.hpp"
+#include "fleet_table.hpp"
+#include "simd_kernels.hpp"
+#include "spectrum_reduction.hpp"
+#include "stats.hpp"
+#include "streaming_extractor.hpp"
+#include "waveform_synth.hpp"
 
 namespace py = pybind11;
 
+namespace {
+
+// float64 C-contiguous arrays are borrowed as-is; anything else is converted once
+using InputArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+// float32 and int16 arrays bound without conversion. These overloads are
+// registered after the float64 ones with noconvert(), so they match only
+// exact C-contiguous arrays of their type and everything else is cast once.
+using FloatArray = py::array_t<float, py::array::c_style>;
+using CountArray = py::array_t<int16_t, py::array::c_style>;
+
+// InputArray for the extraction entry points: when the argument has to be
+// converted, the copy is counted as the python_input stage
+struct TimedInputArray : InputArray {
+    using InputArray::InputArray;
+};
+
+// View a 1D numpy array as a span without copying
+template <typename T, int Flags>
+std::span<const T> as_span(const py::array_t<T, Flags>& signal) {
+    if (signal.ndim() != 1) {
+        throw std::runtime_error("Signal must be a 1D array");
+    }
+    return {signal.data(), static_cast<size_t>(signal.shape(0))};
+}
+
+// View a 2D numpy array as a row-major span without copying
+template <typename T, int Flags>
+std::span<const T> as_matrix_span(const py::array_t<T, Flags>& signals, size_t& rows, size_t& cols) {
+    if (signals.ndim() != 2) {
+        throw std::runtime_error("Signals must be a 2D array (rows x samples)");
+    }
+    rows = static_cast<size_t>(signals.shape(0));
+    cols = static_cast<size_t>(signals.shape(1));
+    return {signals.data(), rows * cols};
+}
+
+// Numpy view over storage owned by a bound C++ object; owner is kept alive
+// by the array. Replacing the vector through a setter invalidates old views.
+py::array_t<double> view_of(const std::vector<double>& v, py::handle owner) {
+    return py::array_t<double>({v.size()}, {sizeof(double)}, v.data(), owner);
+}
+
+py::array_t<double> matrix_view_of(const std::vector<double>& v, size_t rows, size_t cols,
+                                   py::handle owner) {
+    return py::array_t<double>({rows, cols}, {cols * sizeof(double), sizeof(double)},
+                               v.data(), owner);
+}
+
+py::array_t<std::complex<double>> matrix_view_of(const std::vector<std::complex<double>>& v,
+                                                 size_t rows, size_t cols, py::handle owner) {
+    return py::array_t<std::complex<double>>(
+        {rows, cols}, {cols * sizeof(std::complex<double>), sizeof(std::complex<double>)},
+        v.data(), owner);
+}
+
+// Contiguous bytes of any buffer object (bytes, bytearray, memoryview, uint8 array)
+std::span<const unsigned char> bytes_of(const py::buffer& data) {
+    py::buffer_info info = data.request();
+    if (info.ndim != 1 || info.itemsize != 1 || info.strides[0] != 1) {
+        throw std::invalid_argument("Expected a contiguous byte buffer");
+    }
+    return {static_cast<const unsigned char*>(info.ptr), static_cast<size_t>(info.size)};
+}
+
+py::bytes to_bytes(const std::vector<unsigned char>& v) {
+    return py::bytes(reinterpret_cast<const char*>(v.data()), v.size());
+}
+
+// Move a vector into a capsule-owned numpy array
+py::array_t<double> to_numpy(std::vector<double>&& v) {
+    auto* owned = new std::vector<double>(std::move(v));
+    py::capsule free_when_done(owned, [](void* p) {
+        delete static_cast<std::vector<double>*>(p);
+    });
+    return py::array_t<double>({owned->size()}, {sizeof(double)}, owned->data(), free_when_done);
+}
+
+// Move a row-major rows x cols vector into a capsule-owned 2D numpy array
+py::array_t<double> to_numpy(std::vector<double>&& v, size_t rows, size_t cols) {
+    auto* owned = new std::vector<double>(std::move(v));
+    py::capsule free_when_done(owned, [](void* p) {
+        delete static_cast<std::vector<double>*>(p);
+    });
+    return py::array_t<double>({rows, cols}, {cols * sizeof(double), sizeof(double)},
+                               owned->data(), free_when_done);
+}
+
+// Numpy view of a fleet column; the array shares ownership of the buffer,
+// so it stays valid while the table keeps growing. Band and fault columns
+// are 2D (rows x width).
+py::array_t<double> fleet_column_view(cpm::FleetColumn column, bool matrix) {
+    auto* owned = new cpm::FleetColumn(std::move(column));
+    py::capsule release_when_done(owned, [](void* p) {
+        delete static_cast<cpm::FleetColumn*>(p);
+    });
+    if (matrix) {
+        return py::array_t<double>({owned->rows, owned->width},
+                                   {owned->width * sizeof(double), sizeof(double)},
+                                   owned->data, release_when_done);
+    }
+    return py::array_t<double>({owned->rows}, {sizeof(double)}, owned->data, release_when_done);
+}
+
+// Native exception as the Python exception pybind11 would raise for it
+py::object python_error(std::exception_ptr error) {
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::invalid_argument& e) {
+        return py::reinterpret_borrow<py::object>(PyExc_ValueError)(e.what());
+    } catch (const std::exception& e) {
+        return py::reinterpret_borrow<py::object>(PyExc_RuntimeError)(e.what());
+    } catch (...) {
+        return py::reinterpret_borrow<py::object>(PyExc_RuntimeError)("Unknown extraction error");
+    }
+}
+
+// Owns an ExtractionQueue for Python. Completion callbacks take the GIL, so
+// the queue is drained and joined with the GIL released.
+struct PyExtractionQueue {
+    std::unique_ptr<cpm::ExtractionQueue> queue;
+
+    void close() {
+        py::gil_scoped_release release;
+        queue->close();
+    }
+
+    ~PyExtractionQueue() {
+        if (queue) {
+            py::gil_scoped_release release;
+            queue.reset();
+        }
+    }
+};
+
+} // namespace
+
+namespace pybind11::detail {
+
+template <>
+struct type_caster<TimedInputArray> {
+    PYBIND11_TYPE_CASTER(TimedInputArray, const_name("numpy.ndarray[numpy.float64]"));
+
+    bool load(handle src, bool convert) {
+        if (InputArray::check_(src)) {
+            value = reinterpret_borrow<TimedInputArray>(src);
+            return true;
+        }
+        if (!convert) {
+            return false;
+        }
+#if CPM_ENABLE_STATS
+        const uint64_t start = cpm::stats::ticks();
+#endif
+        value = reinterpret_steal<TimedInputArray>(InputArray::ensure(src).release());
+        if (!value) {
+            return false;
+        }
+#if CPM_ENABLE_STATS
+        cpm::stats::record(cpm::stats::Stage::PythonInput, start, static_cast<uint64_t>(value.nbytes()));
+#endif
+        return true;
+    }
+
+    static handle cast(const TimedInputArray& src, return_value_policy, handle) {
+        return src.inc_ref();
+    }
+};
+
+} // namespace pybind11::detail
+
 PYBIND11_MODULE(cpm_features, m) {
     m.doc() = "CPM Feature Extractor - C++ signal processing for predictive maintenance";
 
-    // SignalFeatures struct
+    // SignalFeatures struct (spectra exposed as zero-copy numpy views)
     py::class_<cpm::SignalFeatures>(m, "SignalFeatures")
         .def(py::init<>())
         .def_readwrite("rms", &cpm::SignalFeatures::rms)
@@ -18,11 +199,27 @@ PYBIND11_MODULE(cpm_features, m) {
         .def_readwrite("skewness", &cpm::SignalFeatures::skewness)
         .def_readwrite("spectral_centroid", &cpm::SignalFeatures::spectral_centroid)
         .def_readwrite("spectral_spread", &cpm::SignalFeatures::spectral_spread)
-        .def_readwrite("fft_magnitude", &cpm::SignalFeatures::fft_magnitude)
-        .def_readwrite("fft_frequencies", &cpm::SignalFeatures::fft_frequencies)
+        .def_property("fft_magnitude",
+            [](py::object self) {
+                return view_of(self.cast<const cpm::SignalFeatures&>().fft_magnitude, self);
+            },
+            [](cpm::SignalFeatures& f, std::vector<double> v) { f.fft_magnitude = std::move(v); })
+        .def_property("fft_frequencies",
+            [](py::object self) {
+                return view_of(self.cast<const cpm::SignalFeatures&>().fft_frequencies, self);
+            },
+            [](cpm::SignalFeatures& f, std::vector<double> v) { f.fft_frequencies = std::move(v); })
         .def_readwrite("bandpowers", &cpm::SignalFeatures::bandpowers)
-        .def_readwrite("band_names", &cpm::SignalFeatures::band_names)
-        .def("to_dict", [](const cpm::SignalFeatures& f) {
+        .def_property("band_names",
+            [](const cpm::SignalFeatures& f) { return f.band_names.vector(); },
+            [](cpm::SignalFeatures& f, std::vector<std::string> names) {
+                f.band_names = cpm::BandNames(std::move(names));
+            })
+        .def_readwrite("fault_amplitudes", &cpm::SignalFeatures::fault_amplitudes)
+        .def_property_readonly("fault_names",
+            [](const cpm::SignalFeatures& f) { return f.fault_names.vector(); })
+        .def("to_dict", [](py::object self) {
+            const auto& f = self.cast<const cpm::SignalFeatures&>();
             py::dict d;
             d["rms"] = f.rms;
             d["peak"] = f.peak;
@@ -31,8 +228,8 @@ PYBIND11_MODULE(cpm_features, m) {
             d["skewness"] = f.skewness;
             d["spectral_centroid"] = f.spectral_centroid;
             d["spectral_spread"] = f.spectral_spread;
-            d["fft_magnitude"] = f.fft_magnitude;
-            d["fft_frequencies"] = f.fft_frequencies;
+            d["fft_magnitude"] = view_of(f.fft_magnitude, self);
+            d["fft_frequencies"] = view_of(f.fft_frequencies, self);
 
             py::dict bp;
             for (size_t i = 0; i < f.bandpowers.size() && i < f.band_names.size(); ++i) {
@@ -40,68 +237,372 @@ PYBIND11_MODULE(cpm_features, m) {
             }
             d["bandpowers"] = bp;
 
+            py::dict faults;
+            for (size_t i = 0; i < f.fault_amplitudes.size() && i < f.fault_names.size(); ++i) {
+                faults[py::cast(f.fault_names[i])] = f.fault_amplitudes[i];
+            }
+            d["fault_amplitudes"] = faults;
+
             return d;
         });
 
+    // BatchFeatures struct (struct-of-arrays, exposed as zero-copy numpy views)
+    py::class_<cpm::BatchFeatures>(m, "BatchFeatures")
+        .def_readonly("num_rows", &cpm::BatchFeatures::num_rows)
+        .def_readonly("num_bands", &cpm::BatchFeatures::num_bands)
+        .def_property_readonly("rms", [](py::object self) {
+            return view_of(self.cast<const cpm::BatchFeatures&>().rms, self);
+        })
+        .def_property_readonly("peak", [](py::object self) {
+            return view_of(self.cast<const cpm::BatchFeatures&>().peak, self);
+        })
+        .def_property_readonly("crest_factor", [](py::object self) {
+            return view_of(self.cast<const cpm::BatchFeatures&>().crest_factor, self);
+        })
+        .def_property_readonly("kurtosis", [](py::object self) {
+            return view_of(self.cast<const cpm::BatchFeatures&>().kurtosis, self);
+        })
+        .def_property_readonly("skewness", [](py::object self) {
+            return view_of(self.cast<const cpm::BatchFeatures&>().skewness, self);
+        })
+        .def_property_readonly("spectral_centroid", [](py::object self) {
+            return view_of(self.cast<const cpm::BatchFeatures&>().spectral_centroid, self);
+        })
+        .def_property_readonly("spectral_spread", [](py::object self) {
+            return view_of(self.cast<const cpm::BatchFeatures&>().spectral_spread, self);
+        })
+        .def_property_readonly("bandpowers", [](py::object self) {
+            const auto& b = self.cast<const cpm::BatchFeatures&>();
+            return matrix_view_of(b.bandpowers, b.num_rows, b.num_bands, self);
+        }, "Bandpower matrix of shape (num_rows, num_bands)")
+        .def_property_readonly("band_names", [](const cpm::BatchFeatures& b) {
+            return b.band_names.vector();
+        })
+        .def_readonly("num_faults", &cpm::BatchFeatures::num_faults)
+        .def_property_readonly("fault_amplitudes", [](py::object self) {
+            const auto& b = self.cast<const cpm::BatchFeatures&>();
+            return matrix_view_of(b.fault_amplitudes, b.num_rows, b.num_faults, self);
+        }, "Envelope defect amplitudes of shape (num_rows, num_faults)")
+        .def_property_readonly("fault_names", [](const cpm::BatchFeatures& b) {
+            return b.fault_names.vector();
+        });
+
+    // Multichannel features
+    py::enum_<cpm::ChannelLayout>(m, "ChannelLayout")
+        .value("PLANAR", cpm::ChannelLayout::Planar)
+        .value("INTERLEAVED", cpm::ChannelLayout::Interleaved);
+
+    py::class_<cpm::MultichannelFeatures>(m, "MultichannelFeatures")
+        .def_readonly("num_channels", &cpm::MultichannelFeatures::num_channels)
+        .def_readonly("num_samples", &cpm::MultichannelFeatures::num_samples)
+        .def_readonly("channels", &cpm::MultichannelFeatures::channels,
+                      "Per-channel features, one row per channel")
+        .def_readonly("vector_rms", &cpm::MultichannelFeatures::vector_rms)
+        .def_readonly("segment_length", &cpm::MultichannelFeatures::segment_length)
+        .def_readonly("num_segments", &cpm::MultichannelFeatures::num_segments)
+        .def_readonly("channel_pairs", &cpm::MultichannelFeatures::channel_pairs)
+        .def_property_readonly("frequencies", [](py::object self) {
+            return view_of(self.cast<const cpm::MultichannelFeatures&>().frequencies, self);
+        })
+        .def_property_readonly("psd", [](py::object self) {
+            const auto& f = self.cast<const cpm::MultichannelFeatures&>();
+            return matrix_view_of(f.psd, f.num_channels, f.frequencies.size(), self);
+        }, "Auto-spectral densities of shape (num_channels, num_bins)")
+        .def_property_readonly("csd", [](py::object self) {
+            const auto& f = self.cast<const cpm::MultichannelFeatures&>();
+            return matrix_view_of(f.csd, f.channel_pairs.size(), f.frequencies.size(), self);
+        }, "Cross-spectral densities of shape (num_pairs, num_bins)")
+        .def_property_readonly("coherence", [](py::object self) {
+            const auto& f = self.cast<const cpm::MultichannelFeatures&>();
+            return matrix_view_of(f.coherence, f.channel_pairs.size(), f.frequencies.size(), self);
+        }, "Magnitude-squared coherence of shape (num_pairs, num_bins)");
+
+    // Frequency band definitions
+    py::class_<cpm::FrequencyBand>(m, "FrequencyBand")
+        .def(py::init<std::string, double, double>(),
+             py::arg("name"), py::arg("low"), py::arg("high"))
+        .def_readonly("name", &cpm::FrequencyBand::name)
+        .def_readonly("low", &cpm::FrequencyBand::low)
+        .def_readonly("high", &cpm::FrequencyBand::high);
+
+    py::class_<cpm::BearingFaultOrders>(m, "BearingFaultOrders")
+        .def(py::init<double, double, double, double>(),
+             py::arg("bpfo"), py::arg("bpfi"), py::arg("bsf"), py::arg("ftf"))
+        .def_readwrite("bpfo", &cpm::BearingFaultOrders::bpfo)
+        .def_readwrite("bpfi", &cpm::BearingFaultOrders::bpfi)
+        .def_readwrite("bsf", &cpm::BearingFaultOrders::bsf)
+        .def_readwrite("ftf", &cpm::BearingFaultOrders::ftf);
+
+    py::class_<cpm::BandSet>(m, "BandSet")
+        .def(py::init<std::vector<cpm::FrequencyBand>>(), py::arg("bands"))
+        .def_static("defaults", &cpm::BandSet::defaults, "The five fixed default bands")
+        .def_static("octave", &cpm::BandSet::octave, py::arg("f_low"), py::arg("f_high"),
+                    "Base-2 octave bands with centres in [f_low, f_high]")
+        .def_static("third_octave", &cpm::BandSet::third_octave, py::arg("f_low"), py::arg("f_high"),
+                    "Base-2 1/3-octave bands with centres in [f_low, f_high]")
+        .def_static("bearing_faults", &cpm::BandSet::bearing_faults,
+                    py::arg("shaft_hz"), py::arg("orders"), py::arg("harmonics") = 3,
+                    py::arg("half_width_hz") = 2.0,
+                    "Bands around bearing defect frequencies and their harmonics")
+        .def("__len__", &cpm::BandSet::size)
+        .def_property_readonly("bands", &cpm::BandSet::bands)
+        .def_property_readonly("names", [](const cpm::BandSet& b) { return b.names().vector(); });
+
+    py::class_<cpm::EnvelopeConfig>(m, "EnvelopeConfig")
+        .def(py::init([](double band_low, double band_high, double shaft_hz,
+                         cpm::BearingFaultOrders orders, size_t harmonics, double half_width_hz) {
+                 return cpm::EnvelopeConfig{band_low, band_high, shaft_hz, orders,
+                                            harmonics, half_width_hz};
+             }),
+             py::arg("band_low"), py::arg("band_high"), py::arg("shaft_hz"), py::arg("orders"),
+             py::arg("harmonics") = 3, py::arg("half_width_hz") = 2.0)
+        .def_readwrite("band_low", &cpm::EnvelopeConfig::band_low)
+        .def_readwrite("band_high", &cpm::EnvelopeConfig::band_high)
+        .def_readwrite("shaft_hz", &cpm::EnvelopeConfig::shaft_hz)
+        .def_readwrite("orders", &cpm::EnvelopeConfig::orders)
+        .def_readwrite("harmonics", &cpm::EnvelopeConfig::harmonics)
+        .def_readwrite("half_width_hz", &cpm::EnvelopeConfig::half_width_hz);
+
+    // Spectral kurtosis
+    py::class_<cpm::KurtogramConfig>(m, "KurtogramConfig")
+        .def(py::init([](size_t max_level, bool third_levels, size_t min_band_bins) {
+                 return cpm::KurtogramConfig{max_level, third_levels, min_band_bins};
+             }),
+             py::arg("max_level") = 6, py::arg("third_levels") = true, py::arg("min_band_bins") = 8)
+        .def_readwrite("max_level", &cpm::KurtogramConfig::max_level)
+        .def_readwrite("third_levels", &cpm::KurtogramConfig::third_levels)
+        .def_readwrite("min_band_bins", &cpm::KurtogramConfig::min_band_bins);
+
+    py::class_<cpm::Kurtogram>(m, "Kurtogram")
+        .def_readonly("levels", &cpm::Kurtogram::levels)
+        .def_property_readonly("kurtosis", [](py::object self) {
+            return view_of(self.cast<const cpm::Kurtogram&>().kurtosis, self);
+        }, "Spectral kurtosis of every band, level by level; see offsets")
+        .def_readonly("offsets", &cpm::Kurtogram::offsets)
+        .def("row", [](py::object self, size_t r) {
+            const auto& k = self.cast<const cpm::Kurtogram&>();
+            if (r >= k.num_levels()) {
+                throw std::out_of_range("Kurtogram level out of range");
+            }
+            const auto row = k.row(r);
+            return py::array_t<double>({row.size()}, {sizeof(double)}, row.data(), self);
+        }, py::arg("r"), "Spectral kurtosis of the bands of level r, low to high frequency")
+        .def_readonly("best_level", &cpm::Kurtogram::best_level)
+        .def_readonly("best_band", &cpm::Kurtogram::best_band)
+        .def_readonly("band_low", &cpm::Kurtogram::band_low)
+        .def_readonly("band_high", &cpm::Kurtogram::band_high)
+        .def_readonly("best_kurtosis", &cpm::Kurtogram::best_kurtosis)
+        .def_property_readonly("num_levels", &cpm::Kurtogram::num_levels);
+
+    py::class_<cpm::KurtogramEnvelope>(m, "KurtogramEnvelope")
+        .def_readonly("kurtogram", &cpm::KurtogramEnvelope::kurtogram)
+        .def_property_readonly("envelope_magnitudes", [](py::object self) {
+            return view_of(self.cast<const cpm::KurtogramEnvelope&>().envelope_magnitudes, self);
+        })
+        .def_property_readonly("envelope_frequencies", [](py::object self) {
+            return view_of(self.cast<const cpm::KurtogramEnvelope&>().envelope_frequencies, self);
+        })
+        .def_readonly("fault_amplitudes", &cpm::KurtogramEnvelope::fault_amplitudes)
+        .def_property_readonly("fault_names", [](const cpm::KurtogramEnvelope& k) {
+            return k.fault_names.vector();
+        });
+
+    // Order tracking
+    py::class_<cpm::OrderConfig>(m, "OrderConfig")
+        .def(py::init([](size_t samples_per_rev, size_t taps, size_t phases,
+                         std::vector<cpm::FrequencyBand> bands) {
+                 return cpm::OrderConfig{samples_per_rev, taps, phases, std::move(bands)};
+             }),
+             py::arg("samples_per_rev") = 64, py::arg("taps") = 16, py::arg("phases") = 256,
+             py::arg("bands") = std::vector<cpm::FrequencyBand>{})
+        .def_readwrite("samples_per_rev", &cpm::OrderConfig::samples_per_rev)
+        .def_readwrite("taps", &cpm::OrderConfig::taps)
+        .def_readwrite("phases", &cpm::OrderConfig::phases)
+        .def_readwrite("bands", &cpm::OrderConfig::bands,
+                       "Order bands (low/high in orders); empty for the default 0.5x, 1x, 2x, 3x, 4x+");
+
+    py::class_<cpm::OrderSpectrum>(m, "OrderSpectrum")
+        .def_property_readonly("orders", [](py::object self) {
+            return view_of(self.cast<const cpm::OrderSpectrum&>().orders, self);
+        })
+        .def_property_readonly("magnitudes", [](py::object self) {
+            return view_of(self.cast<const cpm::OrderSpectrum&>().magnitudes, self);
+        })
+        .def_property_readonly("band_powers", [](py::object self) {
+            return view_of(self.cast<const cpm::OrderSpectrum&>().band_powers, self);
+        })
+        .def_property_readonly("band_names", [](const cpm::OrderSpectrum& o) {
+            return o.band_names.vector();
+        })
+        .def_readonly("revolutions", &cpm::OrderSpectrum::revolutions)
+        .def_readonly("mean_rpm", &cpm::OrderSpectrum::mean_rpm);
+
+    py::class_<cpm::BatchOrderFeatures>(m, "BatchOrderFeatures")
+        .def_readonly("num_rows", &cpm::BatchOrderFeatures::num_rows)
+        .def_readonly("num_bands", &cpm::BatchOrderFeatures::num_bands)
+        .def_property_readonly("band_powers", [](py::object self) {
+            const auto& b = self.cast<const cpm::BatchOrderFeatures&>();
+            return matrix_view_of(b.band_powers, b.num_rows, b.num_bands, self);
+        }, "Order-band power matrix of shape (num_rows, num_bands)")
+        .def_property_readonly("band_names", [](const cpm::BatchOrderFeatures& b) {
+            return b.band_names.vector();
+        })
+        .def_readonly("revolutions", &cpm::BatchOrderFeatures::revolutions);
+
+    py::enum_<cpm::WindowFunction>(m, "WindowFunction")
+        .value("RECTANGULAR", cpm::WindowFunction::Rectangular)
+        .value("HANN", cpm::WindowFunction::Hann)
+        .value("HAMMING", cpm::WindowFunction::Hamming)
+        .value("BLACKMAN", cpm::WindowFunction::Blackman);
+
+    // Flags combine with |, giving plain ints that FeatureExtractor.features accepts
+    py::enum_<cpm::Feature>(m, "Feature", py::arithmetic())
+        .value("NONE", cpm::Feature::None)
+        .value("RMS", cpm::Feature::Rms)
+        .value("PEAK", cpm::Feature::Peak)
+        .value("CREST_FACTOR", cpm::Feature::CrestFactor)
+        .value("KURTOSIS", cpm::Feature::Kurtosis)
+        .value("SKEWNESS", cpm::Feature::Skewness)
+        .value("SPECTRAL_CENTROID", cpm::Feature::SpectralCentroid)
+        .value("SPECTRAL_SPREAD", cpm::Feature::SpectralSpread)
+        .value("BANDPOWERS", cpm::Feature::Bandpowers)
+        .value("SPECTRUM", cpm::Feature::Spectrum)
+        .value("FAULT_AMPLITUDES", cpm::Feature::FaultAmplitudes)
+        .value("TIME_DOMAIN", cpm::Feature::TimeDomain)
+        .value("FREQUENCY_DOMAIN", cpm::Feature::FrequencyDomain)
+        .value("ALL", cpm::Feature::All);
+
+    m.def("parse_features", [](const std::string& list) {
+        return static_cast<uint32_t>(cpm::parse_features(list));
+    }, py::arg("names"), "Feature mask from a comma-separated list such as 'rms,kurtosis'");
+
+    py::class_<cpm::WelchConfig>(m, "WelchConfig")
+        .def(py::init([](size_t segment_length, double overlap, cpm::WindowFunction window) {
+                 return cpm::WelchConfig{segment_length, overlap, window};
+             }),
+             py::arg("segment_length") = 1024, py::arg("overlap") = 0.5,
+             py::arg("window") = cpm::WindowFunction::Hann)
+        .def_readwrite("segment_length", &cpm::WelchConfig::segment_length)
+        .def_readwrite("overlap", &cpm::WelchConfig::overlap)
+        .def_readwrite("window", &cpm::WelchConfig::window);
+
+    // Reusable extraction buffers
+    py::class_<cpm::Workspace>(m, "Workspace")
+        .def(py::init<>(), "Create an empty workspace for FeatureExtractor.extract_into")
+        .def_readonly("features", &cpm::Workspace::features);
+
     // FeatureExtractor class
     py::class_<cpm::FeatureExtractor>(m, "FeatureExtractor")
-        .def(py::init<double>(), py::arg("sample_rate") = 5000.0,
-             "Create a feature extractor with the given sample rate (Hz)")
+        .def(py::init<double, size_t>(), py::arg("sample_rate") = 5000.0,
+             py::arg("num_threads") = 1,
+             "Create a feature extractor with the given sample rate (Hz) and "
+             "batch worker count (0 = all cores)")
 
-        .def("extract_all", [](const cpm::FeatureExtractor& fe, py::array_t<double> signal) {
-            py::buffer_info buf = signal.request();
-            if (buf.ndim != 1) {
-                throw std::runtime_error("Signal must be a 1D array");
-            }
-            std::vector<double> vec(static_cast<double*>(buf.ptr),
-                                   static_cast<double*>(buf.ptr) + buf.shape[0]);
-            return fe.extract_all(vec);
+        .def("extract_all", [](const cpm::FeatureExtractor& fe, TimedInputArray signal) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            return fe.extract_all(view);
         }, py::arg("signal"), "Extract all features from a signal array")
+        .def("extract_all", [](const cpm::FeatureExtractor& fe, FloatArray signal) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            return fe.extract_all(view);
+        }, py::arg("signal").noconvert(), "Extract all features from a float32 array without copying")
+        .def("extract_all", [](const cpm::FeatureExtractor& fe, CountArray signal, double scale) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            return fe.extract_all(view, scale);
+        }, py::arg("signal").noconvert(), py::arg("scale"),
+           "Extract all features from int16 ADC counts (scale = physical units per count)")
 
-        .def("compute_rms", [](const cpm::FeatureExtractor& fe, py::array_t<double> signal) {
-            py::buffer_info buf = signal.request();
-            std::vector<double> vec(static_cast<double*>(buf.ptr),
-                                   static_cast<double*>(buf.ptr) + buf.shape[0]);
-            return fe.compute_rms(vec);
+        .def("extract_into", [](const cpm::FeatureExtractor& fe, TimedInputArray signal,
+                                cpm::Workspace& workspace, bool include_spectrum) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            return &fe.extract_all(view, workspace, include_spectrum);
+        }, py::arg("signal"), py::arg("workspace"), py::arg("include_spectrum") = true,
+           py::return_value_policy::reference, py::keep_alive<0, 3>(),
+           "Extract features into a reusable workspace; the result is overwritten by "
+           "the next call with the same workspace")
+        .def("extract_into", [](const cpm::FeatureExtractor& fe, FloatArray signal,
+                                cpm::Workspace& workspace, bool include_spectrum) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            return &fe.extract_all(view, workspace, include_spectrum);
+        }, py::arg("signal").noconvert(), py::arg("workspace"), py::arg("include_spectrum") = true,
+           py::return_value_policy::reference, py::keep_alive<0, 3>())
+        .def("extract_into", [](const cpm::FeatureExtractor& fe, CountArray signal, double scale,
+                                cpm::Workspace& workspace, bool include_spectrum) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            return &fe.extract_all(view, scale, workspace, include_spectrum);
+        }, py::arg("signal").noconvert(), py::arg("scale"), py::arg("workspace"),
+           py::arg("include_spectrum") = true,
+           py::return_value_policy::reference, py::keep_alive<0, 4>())
+
+        .def("extract_batch", [](const cpm::FeatureExtractor& fe, TimedInputArray signals) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            // signals keeps the buffer alive while the GIL is released
+            py::gil_scoped_release release;
+            return fe.extract_batch(view, rows, cols);
+        }, py::arg("signals"), "Extract features from each row of a 2D signal array")
+        .def("extract_batch", [](const cpm::FeatureExtractor& fe, FloatArray signals) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            py::gil_scoped_release release;
+            return fe.extract_batch(view, rows, cols);
+        }, py::arg("signals").noconvert(), "Extract features from each row of a 2D float32 array")
+        .def("extract_batch", [](const cpm::FeatureExtractor& fe, CountArray signals, double scale) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            py::gil_scoped_release release;
+            return fe.extract_batch(view, scale, rows, cols);
+        }, py::arg("signals").noconvert(), py::arg("scale"),
+           "Extract features from each row of a 2D int16 count array")
+
+        .def("extract_multichannel", [](const cpm::FeatureExtractor& fe, InputArray data,
+                                        cpm::ChannelLayout layout, size_t cross_segment) {
+            // Planar is (channels, samples); interleaved is (samples, channels)
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(data, rows, cols);
+            size_t channels = layout == cpm::ChannelLayout::Planar ? rows : cols;
+            py::gil_scoped_release release;
+            return fe.extract_multichannel(view, channels, layout, cross_segment);
+        }, py::arg("data"), py::arg("layout") = cpm::ChannelLayout::Planar,
+           py::arg("cross_segment") = 0,
+           "Extract per-channel features of a multichannel recording; a positive "
+           "cross_segment also computes Welch PSD, CSD and coherence")
+
+        .def("compute_rms", [](const cpm::FeatureExtractor& fe, InputArray signal) {
+            return fe.compute_rms(as_span(signal));
         }, py::arg("signal"), "Compute Root Mean Square")
 
-        .def("compute_peak", [](const cpm::FeatureExtractor& fe, py::array_t<double> signal) {
-            py::buffer_info buf = signal.request();
-            std::vector<double> vec(static_cast<double*>(buf.ptr),
-                                   static_cast<double*>(buf.ptr) + buf.shape[0]);
-            return fe.compute_peak(vec);
+        .def("compute_peak", [](const cpm::FeatureExtractor& fe, InputArray signal) {
+            return fe.compute_peak(as_span(signal));
         }, py::arg("signal"), "Compute peak (max absolute value)")
 
-        .def("compute_crest_factor", [](const cpm::FeatureExtractor& fe, py::array_t<double> signal) {
-            py::buffer_info buf = signal.request();
-            std::vector<double> vec(static_cast<double*>(buf.ptr),
-                                   static_cast<double*>(buf.ptr) + buf.shape[0]);
-            return fe.compute_crest_factor(vec);
+        .def("compute_crest_factor", [](const cpm::FeatureExtractor& fe, InputArray signal) {
+            return fe.compute_crest_factor(as_span(signal));
         }, py::arg("signal"), "Compute Crest Factor (peak/RMS)")
 
-        .def("compute_kurtosis", [](const cpm::FeatureExtractor& fe, py::array_t<double> signal) {
-            py::buffer_info buf = signal.request();
-            std::vector<double> vec(static_cast<double*>(buf.ptr),
-                                   static_cast<double*>(buf.ptr) + buf.shape[0]);
-            return fe.compute_kurtosis(vec);
+        .def("compute_kurtosis", [](const cpm::FeatureExtractor& fe, InputArray signal) {
+            return fe.compute_kurtosis(as_span(signal));
         }, py::arg("signal"), "Compute excess kurtosis")
 
-        .def("compute_skewness", [](const cpm::FeatureExtractor& fe, py::array_t<double> signal) {
-            py::buffer_info buf = signal.request();
-            std::vector<double> vec(static_cast<double*>(buf.ptr),
-                                   static_cast<double*>(buf.ptr) + buf.shape[0]);
-            return fe.compute_skewness(vec);
+        .def("compute_skewness", [](const cpm::FeatureExtractor& fe, InputArray signal) {
+            return fe.compute_skewness(as_span(signal));
         }, py::arg("signal"), "Compute skewness")
 
-        .def("compute_fft", [](const cpm::FeatureExtractor& fe, py::array_t<double> signal) {
-            py::buffer_info buf = signal.request();
-            std::vector<double> vec(static_cast<double*>(buf.ptr),
-                                   static_cast<double*>(buf.ptr) + buf.shape[0]);
-            auto [mags, freqs] = fe.compute_fft(vec);
-            return py::make_tuple(
-                py::array_t<double>(mags.size(), mags.data()),
-                py::array_t<double>(freqs.size(), freqs.data())
-            );
+        .def("compute_fft", [](const cpm::FeatureExtractor& fe, InputArray signal) {
+            auto view = as_span(signal);
+            std::pair<std::vector<double>, std::vector<double>> spectrum;
+            {
+                py::gil_scoped_release release;
+                spectrum = fe.compute_fft(view);
+            }
+            return py::make_tuple(to_numpy(std::move(spectrum.first)),
+                                  to_numpy(std::move(spectrum.second)));
         }, py::arg("signal"), "Compute FFT, returns (magnitudes, frequencies)")
 
         .def_property("sample_rate",
@@ -109,21 +610,551 @@ PYBIND11_MODULE(cpm_features, m) {
             &cpm::FeatureExtractor::set_sample_rate,
             "Sample rate in Hz")
 
+        .def_property("num_threads",
+            &cpm::FeatureExtractor::get_num_threads,
+            &cpm::FeatureExtractor::set_num_threads,
+            "Worker threads for batch extraction (0 = all cores)")
+
+        .def_property("bands",
+            &cpm::FeatureExtractor::get_bands,
+            &cpm::FeatureExtractor::set_bands,
+            "Frequency bands used for bandpower features")
+
         .def("get_band_names", &cpm::FeatureExtractor::get_band_names,
-             "Get names of frequency bands");
+             "Get names of frequency bands")
+
+        .def_property("features",
+            [](const cpm::FeatureExtractor& fe) { return static_cast<uint32_t>(fe.get_features()); },
+            [](cpm::FeatureExtractor& fe, uint32_t mask) { fe.set_features(static_cast<cpm::Feature>(mask)); },
+            "Feature mask (Feature flags or'ed together); unselected features read NaN")
+
+        .def("set_welch", &cpm::FeatureExtractor::set_welch, py::arg("config"),
+             "Compute spectral features from a Welch averaged spectrum")
+        .def("clear_welch", &cpm::FeatureExtractor::clear_welch,
+             "Return to one full-length FFT per signal")
+
+        .def("compute_welch", [](const cpm::FeatureExtractor& fe, InputArray signal) {
+            auto view = as_span(signal);
+            std::pair<std::vector<double>, std::vector<double>> spectrum;
+            {
+                py::gil_scoped_release release;
+                spectrum = fe.compute_welch(view);
+            }
+            return py::make_tuple(to_numpy(std::move(spectrum.first)),
+                                  to_numpy(std::move(spectrum.second)));
+        }, py::arg("signal"), "Compute a Welch averaged spectrum, returns (magnitudes, frequencies)")
+
+        .def("set_envelope", &cpm::FeatureExtractor::set_envelope, py::arg("config"),
+             "Report envelope amplitudes at bearing defect frequencies in extracted features")
+        .def("clear_envelope", &cpm::FeatureExtractor::clear_envelope,
+             "Disable envelope analysis")
+
+        .def("compute_envelope_spectrum", [](const cpm::FeatureExtractor& fe, InputArray signal) {
+            auto view = as_span(signal);
+            std::pair<std::vector<double>, std::vector<double>> spectrum;
+            {
+                py::gil_scoped_release release;
+                spectrum = fe.compute_envelope_spectrum(view);
+            }
+            return py::make_tuple(to_numpy(std::move(spectrum.first)),
+                                  to_numpy(std::move(spectrum.second)));
+        }, py::arg("signal"), "Compute the envelope spectrum, returns (magnitudes, frequencies)")
+        .def("compute_kurtogram", [](const cpm::FeatureExtractor& fe, InputArray signal,
+                                     const cpm::KurtogramConfig& config) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            return fe.compute_kurtogram(view, config);
+        }, py::arg("signal"), py::arg("config") = cpm::KurtogramConfig{},
+           "Fast kurtogram: spectral kurtosis per band and level, and the band where it peaks")
+        .def("compute_kurtogram_envelope", [](const cpm::FeatureExtractor& fe, InputArray signal,
+                                              const cpm::KurtogramConfig& config) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            return fe.compute_kurtogram_envelope(view, config);
+        }, py::arg("signal"), py::arg("config") = cpm::KurtogramConfig{},
+           "Kurtogram plus the envelope spectrum (and defect amplitudes, with set_envelope) "
+           "of its best band, from one FFT")
+
+        .def("set_order_tracking", &cpm::FeatureExtractor::set_order_tracking, py::arg("config"),
+             "Configure angle-domain resampling for order spectra")
+        .def("clear_order_tracking", &cpm::FeatureExtractor::clear_order_tracking,
+             "Return to the default order tracking settings")
+        .def("compute_order_spectrum", [](const cpm::FeatureExtractor& fe, InputArray signal, double rpm) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            return fe.compute_order_spectrum(view, rpm);
+        }, py::arg("signal"), py::arg("rpm"), "Order spectrum and order-band powers at a constant speed")
+        .def("compute_order_spectrum", [](const cpm::FeatureExtractor& fe, InputArray signal, InputArray rpm) {
+            auto view = as_span(signal);
+            auto trace = as_span(rpm);
+            py::gil_scoped_release release;
+            return fe.compute_order_spectrum(view, trace);
+        }, py::arg("signal"), py::arg("rpm"),
+           "Order spectrum following an RPM trace spread evenly over the signal")
+        .def("extract_order_batch", [](const cpm::FeatureExtractor& fe, InputArray signals, InputArray rpm) {
+            size_t rows = 0, cols = 0;
+            auto data = as_matrix_span(signals, rows, cols);
+            auto speeds = as_span(rpm);
+            py::gil_scoped_release release;
+            return fe.extract_order_batch(data, speeds, rows, cols);
+        }, py::arg("signals"), py::arg("rpm"),
+           "Order-band powers for a 2D array of signals, one shaft speed per row");
+
+    // Waveform synthesis
+    py::class_<cpm::SynthesisConfig>(m, "SynthesisConfig")
+        .def(py::init([](double sample_rate, size_t samples, uint64_t seed) {
+                 cpm::SynthesisConfig config;
+                 config.sample_rate = sample_rate;
+                 config.samples = samples;
+                 config.seed = seed;
+                 return config;
+             }),
+             py::arg("sample_rate") = 5000.0, py::arg("samples") = 2048, py::arg("seed") = 42)
+        .def_readwrite("sample_rate", &cpm::SynthesisConfig::sample_rate)
+        .def_readwrite("samples", &cpm::SynthesisConfig::samples)
+        .def_readwrite("seed", &cpm::SynthesisConfig::seed)
+        .def_readwrite("max_harmonic", &cpm::SynthesisConfig::max_harmonic)
+        .def_readwrite("bpfo_order", &cpm::SynthesisConfig::bpfo_order)
+        .def_readwrite("defect_wear", &cpm::SynthesisConfig::defect_wear)
+        .def_readwrite("impact_probability", &cpm::SynthesisConfig::impact_probability)
+        .def_readwrite("impact_length", &cpm::SynthesisConfig::impact_length)
+        .def_readwrite("impact_decay", &cpm::SynthesisConfig::impact_decay);
+
+    py::class_<cpm::WaveformSynthesizer>(m, "WaveformSynthesizer")
+        .def(py::init<const cpm::SynthesisConfig&>(), py::arg("config") = cpm::SynthesisConfig{})
+        .def_property_readonly("config", &cpm::WaveformSynthesizer::config)
+        .def("generate_row", [](const cpm::WaveformSynthesizer& ws, size_t row, double vibration_level,
+                                double speed, double wear) {
+            std::vector<double> out(ws.config().samples);
+            ws.generate_row(row, vibration_level, speed, wear, out);
+            return to_numpy(std::move(out));
+        }, py::arg("row"), py::arg("vibration_level"), py::arg("speed"), py::arg("wear"),
+           "Synthesise one waveform; row selects its random stream")
+        .def("generate", [](const cpm::WaveformSynthesizer& ws, InputArray vibration_levels,
+                            InputArray speeds, InputArray wear_levels, size_t first_row,
+                            size_t num_threads) {
+            auto vib = as_span(vibration_levels);
+            auto speed = as_span(speeds);
+            auto wear = as_span(wear_levels);
+            std::vector<double> out;
+            {
+                py::gil_scoped_release release;
+                out = ws.generate(vib, speed, wear, first_row, num_threads);
+            }
+            return to_numpy(std::move(out), vib.size(), ws.config().samples);
+        }, py::arg("vibration_levels"), py::arg("speeds"), py::arg("wear_levels"),
+           py::arg("first_row") = 0, py::arg("num_threads") = 0,
+           "Synthesise a (timesteps, samples) waveform array; the same rows come out for any "
+           "thread count or chunking via first_row")
+        .def("extract", [](const cpm::WaveformSynthesizer& ws, const cpm::FeatureExtractor& fe,
+                           InputArray vibration_levels, InputArray speeds, InputArray wear_levels,
+                           size_t first_row) {
+            auto vib = as_span(vibration_levels);
+            auto speed = as_span(speeds);
+            auto wear = as_span(wear_levels);
+            py::gil_scoped_release release;
+            return ws.extract(fe, vib, speed, wear, first_row);
+        }, py::arg("extractor"), py::arg("vibration_levels"), py::arg("speeds"),
+           py::arg("wear_levels"), py::arg("first_row") = 0,
+           "Synthesise and extract features row by row without materialising the waveforms");
+
+    // Streaming extractor
+    py::enum_<cpm::SpectrumUpdate>(m, "SpectrumUpdate")
+        .value("AUTO", cpm::SpectrumUpdate::Auto)
+        .value("FFT", cpm::SpectrumUpdate::FFT)
+        .value("SLIDING_DFT", cpm::SpectrumUpdate::SlidingDFT);
+
+    py::class_<cpm::StreamingFeatureExtractor>(m, "StreamingFeatureExtractor")
+        .def(py::init<double, size_t, size_t, cpm::SpectrumUpdate>(),
+             py::arg("sample_rate"), py::arg("window_size"), py::arg("hop_size"),
+             py::arg("update") = cpm::SpectrumUpdate::Auto,
+             "Create a sliding-window extractor emitting features every hop_size samples")
+        .def("push", [](cpm::StreamingFeatureExtractor& se, InputArray samples) {
+            auto view = as_span(samples);
+            std::vector<cpm::SignalFeatures> out;
+            {
+                py::gil_scoped_release release;
+                out = se.push(view);
+            }
+            return out;
+        }, py::arg("samples"), "Push samples; returns features for each completed window")
+        .def("reset", &cpm::StreamingFeatureExtractor::reset, "Discard buffered samples")
+        .def_property_readonly("window_size", &cpm::StreamingFeatureExtractor::window_size)
+        .def_property_readonly("hop_size", &cpm::StreamingFeatureExtractor::hop_size)
+        .def_property_readonly("samples_seen", &cpm::StreamingFeatureExtractor::samples_seen)
+        .def_property_readonly("uses_sliding_dft", &cpm::StreamingFeatureExtractor::uses_sliding_dft);
+
+    // Storage encodings of spectra in feature stores and encode_spectrum
+    py::enum_<cpm::SpectrumEncoding>(m, "SpectrumEncoding")
+        .value("FLOAT64", cpm::SpectrumEncoding::Float64)
+        .value("FLOAT16", cpm::SpectrumEncoding::Float16)
+        .value("LOG8", cpm::SpectrumEncoding::Log8)
+        .value("LOG16", cpm::SpectrumEncoding::Log16);
+
+    // Persistent feature cache shared by processes
+    py::class_<cpm::FeatureStore>(m, "FeatureStore")
+        .def(py::init([](const std::string& path, size_t num_bands, size_t num_faults, size_t num_bins,
+                         cpm::SpectrumEncoding encoding) {
+                 return cpm::FeatureStore::open(path, num_bands, num_faults, num_bins, encoding);
+             }),
+             py::arg("path"), py::arg("num_bands") = 5, py::arg("num_faults") = 0, py::arg("num_bins") = 0,
+             py::arg("spectrum_encoding") = cpm::SpectrumEncoding::Float16,
+             "Open or create a feature store for reading and appending; num_bins > 0 also keeps "
+             "encoded spectra of that length")
+        .def_static("open_readonly", &cpm::FeatureStore::open_readonly, py::arg("path"),
+                    "Open an existing feature store without appending misses")
+
+        .def("extract", [](cpm::FeatureStore& store, const cpm::FeatureExtractor& fe,
+                           TimedInputArray signal) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            cpm::Workspace workspace;
+            return cpm::SignalFeatures(store.extract(fe, view, workspace));
+        }, py::arg("extractor"), py::arg("signal"),
+           "Features of a signal from the store, extracted and stored on a miss (with a "
+           "spectrum only if the store keeps spectra)")
+        .def("extract", [](cpm::FeatureStore& store, const cpm::FeatureExtractor& fe, FloatArray signal) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            cpm::Workspace workspace;
+            return cpm::SignalFeatures(store.extract(fe, view, workspace));
+        }, py::arg("extractor"), py::arg("signal").noconvert())
+        .def("extract", [](cpm::FeatureStore& store, const cpm::FeatureExtractor& fe,
+                           CountArray signal, double scale) {
+            auto view = as_span(signal);
+            py::gil_scoped_release release;
+            cpm::Workspace workspace;
+            return cpm::SignalFeatures(store.extract(fe, view, scale, workspace));
+        }, py::arg("extractor"), py::arg("signal").noconvert(), py::arg("scale"))
+
+        .def("extract_batch", [](cpm::FeatureStore& store, const cpm::FeatureExtractor& fe,
+                                 TimedInputArray signals) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            py::gil_scoped_release release;
+            return store.extract_batch(fe, view, rows, cols);
+        }, py::arg("extractor"), py::arg("signals"),
+           "Batch features; only rows missing from the store are extracted")
+        .def("extract_batch", [](cpm::FeatureStore& store, const cpm::FeatureExtractor& fe,
+                                 FloatArray signals) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            py::gil_scoped_release release;
+            return store.extract_batch(fe, view, rows, cols);
+        }, py::arg("extractor"), py::arg("signals").noconvert())
+        .def("extract_batch", [](cpm::FeatureStore& store, const cpm::FeatureExtractor& fe,
+                                 CountArray signals, double scale) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            py::gil_scoped_release release;
+            return store.extract_batch(fe, view, scale, rows, cols);
+        }, py::arg("extractor"), py::arg("signals").noconvert(), py::arg("scale"))
+
+        .def("__len__", &cpm::FeatureStore::size)
+        .def_property_readonly("num_bands", &cpm::FeatureStore::num_bands)
+        .def_property_readonly("num_faults", &cpm::FeatureStore::num_faults)
+        .def_property_readonly("num_bins", &cpm::FeatureStore::num_bins)
+        .def_property_readonly("spectrum_encoding", &cpm::FeatureStore::spectrum_encoding)
+        .def_property_readonly("writable", &cpm::FeatureStore::writable)
+        .def_property_readonly("hits", &cpm::FeatureStore::hits)
+        .def_property_readonly("misses", &cpm::FeatureStore::misses);
+
+    // Spectrum thinning for display payloads
+    py::class_<cpm::SpectralPeak>(m, "SpectralPeak")
+        .def_readonly("bin", &cpm::SpectralPeak::bin)
+        .def_readonly("frequency", &cpm::SpectralPeak::frequency)
+        .def_readonly("magnitude", &cpm::SpectralPeak::magnitude)
+        .def("__repr__", [](const cpm::SpectralPeak& p) {
+            return "SpectralPeak(frequency=" + std::to_string(p.frequency) +
+                   ", magnitude=" + std::to_string(p.magnitude) + ")";
+        });
+
+    py::class_<cpm::ReducedSpectrum>(m, "ReducedSpectrum")
+        .def_property_readonly("frequencies", [](py::object self) {
+            return view_of(self.cast<const cpm::ReducedSpectrum&>().frequencies, self);
+        })
+        .def_property_readonly("magnitudes", [](py::object self) {
+            return view_of(self.cast<const cpm::ReducedSpectrum&>().magnitudes, self);
+        })
+        .def_readonly("peaks", &cpm::ReducedSpectrum::peaks)
+        .def_readonly("num_bins", &cpm::ReducedSpectrum::num_bins)
+        .def_readonly("dominant_frequency", &cpm::ReducedSpectrum::dominant_frequency)
+        .def_readonly("dominant_magnitude", &cpm::ReducedSpectrum::dominant_magnitude)
+        .def_readonly("total_power", &cpm::ReducedSpectrum::total_power);
+
+    auto reduction_config = [](size_t points, const std::string& method, bool log_frequency,
+                               double min_frequency, size_t num_peaks) {
+        cpm::SpectrumReductionConfig config;
+        config.points = points;
+        config.method = cpm::parse_decimation(method);
+        config.log_frequency = log_frequency;
+        config.min_frequency = min_frequency;
+        config.num_peaks = num_peaks;
+        return config;
+    };
+    m.def("reduce_spectrum", [reduction_config](InputArray frequencies, InputArray magnitudes, size_t points,
+                                                const std::string& method, bool log_frequency,
+                                                double min_frequency, size_t num_peaks) {
+        const auto config = reduction_config(points, method, log_frequency, min_frequency, num_peaks);
+        auto f = as_span(frequencies);
+        auto mag = as_span(magnitudes);
+        py::gil_scoped_release release;
+        return cpm::reduce_spectrum(f, mag, config);
+    }, py::arg("frequencies"), py::arg("magnitudes"), py::arg("points") = 256,
+       py::arg("method") = "minmax", py::arg("log_frequency") = false, py::arg("min_frequency") = 0.0,
+       py::arg("num_peaks") = 0,
+       "Thin a magnitude spectrum to at most points points (minmax or lttb, or log-frequency "
+       "resampling) and report its top peaks, dominant frequency and total power");
+    m.def("reduce_spectrum", [reduction_config](const cpm::SignalFeatures& features, size_t points,
+                                                const std::string& method, bool log_frequency,
+                                                double min_frequency, size_t num_peaks) {
+        const auto config = reduction_config(points, method, log_frequency, min_frequency, num_peaks);
+        py::gil_scoped_release release;
+        return cpm::reduce_spectrum(features, config);
+    }, py::arg("features"), py::arg("points") = 256, py::arg("method") = "minmax",
+       py::arg("log_frequency") = false, py::arg("min_frequency") = 0.0, py::arg("num_peaks") = 0);
+
+    // Compact encodings for storage and transport
+    m.def("encode_spectrum", [](InputArray magnitudes, const std::string& encoding, unsigned dynamic_range_db) {
+        const auto enc = cpm::parse_spectrum_encoding(encoding);
+        auto mag = as_span(magnitudes);
+        std::vector<unsigned char> block;
+        {
+            py::gil_scoped_release release;
+            block = cpm::encode_spectrum(mag, enc, dynamic_range_db);
+        }
+        return to_bytes(block);
+    }, py::arg("magnitudes"), py::arg("encoding") = "f16", py::arg("dynamic_range_db") = 0,
+       "Encode a magnitude spectrum as a self-describing block: f64, f16, log8 or log16");
+    m.def("decode_spectrum", [](const py::buffer& block) {
+        auto bytes = bytes_of(block);
+        std::vector<double> out(cpm::spectrum_length(bytes));
+        cpm::decode_spectrum(bytes, out);
+        return to_numpy(std::move(out));
+    }, py::arg("block"), "Decode a block from encode_spectrum");
+    m.def("encode_series", [](InputArray values, double resolution) {
+        auto v = as_span(values);
+        std::vector<unsigned char> encoded;
+        {
+            py::gil_scoped_release release;
+            encoded = cpm::encode_series(v, resolution);
+        }
+        return to_bytes(encoded);
+    }, py::arg("values"), py::arg("resolution"),
+       "Delta and bit-pack a feature series quantised to resolution; NaN gaps are kept");
+    m.def("decode_series", [](const py::buffer& encoded) {
+        auto bytes = bytes_of(encoded);
+        std::vector<double> out(cpm::series_length(bytes));
+        cpm::decode_series(bytes, out);
+        return to_numpy(std::move(out));
+    }, py::arg("encoded"), "Decode a series from encode_series");
+
+    // Asynchronous extraction for asyncio servers
+    py::class_<PyExtractionQueue>(m, "ExtractionQueue")
+        .def(py::init([](const cpm::FeatureExtractor& fe, size_t max_batch, double max_delay_us) {
+                 auto q = std::make_unique<PyExtractionQueue>();
+                 q->queue = std::make_unique<cpm::ExtractionQueue>(
+                     fe, max_batch, std::chrono::microseconds(static_cast<int64_t>(max_delay_us)));
+                 return q;
+             }),
+             py::arg("extractor"), py::arg("max_batch") = 64, py::arg("max_delay_us") = 0.0,
+             "Queue that coalesces concurrent submissions into micro-batches on the native pool")
+        .def("submit", [](PyExtractionQueue& q, TimedInputArray signal, bool include_spectrum) {
+            auto view = as_span(signal);
+            std::vector<double> samples(view.begin(), view.end());
+
+            // The callback owns a reference to the future and drops it under the GIL
+            py::object future = py::module_::import("concurrent.futures").attr("Future")();
+            PyObject* handle = future.inc_ref().ptr();
+            auto done = [handle](cpm::SignalFeatures&& features, std::exception_ptr error) {
+                py::gil_scoped_acquire acquire;
+                auto fut = py::reinterpret_steal<py::object>(handle);
+                try {
+                    if (!fut.attr("set_running_or_notify_cancel")().cast<bool>()) {
+                        return;  // Cancelled while queued
+                    }
+                    if (error) {
+                        fut.attr("set_exception")(python_error(error));
+                    } else {
+                        fut.attr("set_result")(py::cast(std::move(features)));
+                    }
+                } catch (py::error_already_set& e) {
+                    e.discard_as_unraisable("ExtractionQueue completion");
+                }
+            };
+            try {
+                py::gil_scoped_release release;
+                q.queue->submit(std::move(samples), include_spectrum, std::move(done));
+            } catch (...) {
+                py::reinterpret_steal<py::object>(handle);
+                throw;
+            }
+            return future;
+        }, py::arg("signal"), py::arg("include_spectrum") = true,
+           "Queue a signal; returns a concurrent.futures.Future of SignalFeatures "
+           "(await it with asyncio.wrap_future)")
+        .def("close", &PyExtractionQueue::close, "Stop accepting signals and finish queued ones")
+        .def_property_readonly("max_batch", [](const PyExtractionQueue& q) { return q.queue->max_batch(); })
+        .def_property_readonly("pending", [](const PyExtractionQueue& q) { return q.queue->pending(); })
+        .def_property_readonly("completed", [](const PyExtractionQueue& q) { return q.queue->completed(); })
+        .def_property_readonly("batches", [](const PyExtractionQueue& q) { return q.queue->batches(); });
+
+    // Per-asset append-only feature history
+    py::class_<cpm::RowRange>(m, "RowRange")
+        .def_readonly("begin", &cpm::RowRange::begin)
+        .def_readonly("end", &cpm::RowRange::end)
+        .def("__len__", &cpm::RowRange::size)
+        .def("__repr__", [](const cpm::RowRange& r) {
+            return "RowRange(" + std::to_string(r.begin) + ", " + std::to_string(r.end) + ")";
+        });
+
+    py::class_<cpm::FleetFeatureTable>(m, "FleetFeatureTable")
+        .def(py::init<cpm::FeatureStore*>(), py::arg("store") = nullptr, py::keep_alive<1, 2>(),
+             "Empty table; new rows are extracted through store when one is given")
+
+        .def("update", [](cpm::FleetFeatureTable& table, const std::string& asset,
+                          const cpm::FeatureExtractor& fe, TimedInputArray signals) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            py::gil_scoped_release release;
+            return table.update(asset, fe, view, rows, cols);
+        }, py::arg("asset"), py::arg("extractor"), py::arg("signals"),
+           "Extract the rows of a full waveform history that the table does not hold yet")
+        .def("update", [](cpm::FleetFeatureTable& table, const std::string& asset,
+                          const cpm::FeatureExtractor& fe, FloatArray signals) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            py::gil_scoped_release release;
+            return table.update(asset, fe, view, rows, cols);
+        }, py::arg("asset"), py::arg("extractor"), py::arg("signals").noconvert())
+        .def("update", [](cpm::FleetFeatureTable& table, const std::string& asset,
+                          const cpm::FeatureExtractor& fe, CountArray signals, double scale) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            py::gil_scoped_release release;
+            return table.update(asset, fe, view, scale, rows, cols);
+        }, py::arg("asset"), py::arg("extractor"), py::arg("signals").noconvert(), py::arg("scale"))
+
+        .def("append", [](cpm::FleetFeatureTable& table, const std::string& asset,
+                          const cpm::FeatureExtractor& fe, TimedInputArray signals) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            py::gil_scoped_release release;
+            return table.append(asset, fe, view, rows, cols);
+        }, py::arg("asset"), py::arg("extractor"), py::arg("signals"),
+           "Extract newly arrived waveforms and append them to an asset")
+        .def("append", [](cpm::FleetFeatureTable& table, const std::string& asset,
+                          const cpm::FeatureExtractor& fe, FloatArray signals) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            py::gil_scoped_release release;
+            return table.append(asset, fe, view, rows, cols);
+        }, py::arg("asset"), py::arg("extractor"), py::arg("signals").noconvert())
+        .def("append", [](cpm::FleetFeatureTable& table, const std::string& asset,
+                          const cpm::FeatureExtractor& fe, CountArray signals, double scale) {
+            size_t rows = 0, cols = 0;
+            auto view = as_matrix_span(signals, rows, cols);
+            py::gil_scoped_release release;
+            return table.append(asset, fe, view, scale, rows, cols);
+        }, py::arg("asset"), py::arg("extractor"), py::arg("signals").noconvert(), py::arg("scale"))
+
+        .def("column", [](const cpm::FleetFeatureTable& table, const std::string& asset,
+                          const std::string& name) {
+            const bool matrix = name == "bandpowers" || name == "fault_amplitudes";
+            return fleet_column_view(table.column(asset, name), matrix);
+        }, py::arg("asset"), py::arg("name"),
+           "Zero-copy view of an asset's feature column (2D for bandpowers and fault_amplitudes)")
+        .def("band_names", [](const cpm::FleetFeatureTable& table, const std::string& asset) {
+            return table.band_names(asset).vector();
+        }, py::arg("asset"))
+        .def("fault_names", [](const cpm::FleetFeatureTable& table, const std::string& asset) {
+            return table.fault_names(asset).vector();
+        }, py::arg("asset"))
+        .def("rows", &cpm::FleetFeatureTable::rows, py::arg("asset"))
+        .def("erase", &cpm::FleetFeatureTable::erase, py::arg("asset"))
+        .def_property_readonly("assets", &cpm::FleetFeatureTable::assets)
+        .def("__contains__", &cpm::FleetFeatureTable::contains)
+        .def("__len__", [](const cpm::FleetFeatureTable& table) { return table.assets().size(); })
+        .def_property_readonly_static("column_names", [](py::object) {
+            return cpm::FleetFeatureTable::column_names();
+        });
 
     // Convenience function
-    m.def("extract_features", [](py::array_t<double> signal, double sample_rate) {
+    m.def("extract_features", [](TimedInputArray signal, double sample_rate, const std::string& features) {
         cpm::FeatureExtractor fe(sample_rate);
-        py::buffer_info buf = signal.request();
-        if (buf.ndim != 1) {
-            throw std::runtime_error("Signal must be a 1D array");
+        fe.set_features(cpm::parse_features(features));
+        auto view = as_span(signal);
+        py::gil_scoped_release release;
+        return fe.extract_all(view);
+    }, py::arg("signal"), py::arg("sample_rate") = 5000.0, py::arg("features") = "all",
+       "Extract features from a signal (convenience function)");
+    m.def("extract_features", [](FloatArray signal, double sample_rate, const std::string& features) {
+        cpm::FeatureExtractor fe(sample_rate);
+        fe.set_features(cpm::parse_features(features));
+        auto view = as_span(signal);
+        py::gil_scoped_release release;
+        return fe.extract_all(view);
+    }, py::arg("signal").noconvert(), py::arg("sample_rate") = 5000.0, py::arg("features") = "all");
+
+    m.def("extract_features_batch", [](TimedInputArray signals, double sample_rate, size_t num_threads,
+                                       const std::string& features) {
+        cpm::FeatureExtractor fe(sample_rate, num_threads);
+        fe.set_features(cpm::parse_features(features));
+        size_t rows = 0, cols = 0;
+        auto view = as_matrix_span(signals, rows, cols);
+        py::gil_scoped_release release;
+        return fe.extract_batch(view, rows, cols);
+    }, py::arg("signals"), py::arg("sample_rate") = 5000.0, py::arg("num_threads") = 1,
+       py::arg("features") = "all",
+       "Extract features from each row of a 2D signal array (convenience function)");
+    m.def("extract_features_batch", [](FloatArray signals, double sample_rate, size_t num_threads,
+                                       const std::string& features) {
+        cpm::FeatureExtractor fe(sample_rate, num_threads);
+        fe.set_features(cpm::parse_features(features));
+        size_t rows = 0, cols = 0;
+        auto view = as_matrix_span(signals, rows, cols);
+        py::gil_scoped_release release;
+        return fe.extract_batch(view, rows, cols);
+    }, py::arg("signals").noconvert(), py::arg("sample_rate") = 5000.0, py::arg("num_threads") = 1,
+       py::arg("features") = "all");
+
+    m.def("write_feature_table", [](const std::string& path, const cpm::BatchFeatures& batch,
+                                    size_t row_length, double sample_rate) {
+        py::gil_scoped_release release;
+        cpm::write_feature_table(path, batch, row_length, sample_rate);
+    }, py::arg("path"), py::arg("batch"), py::arg("row_length"), py::arg("sample_rate"),
+       "Write batch features as a memory-mappable CPMF feature table");
+
+    // Stage counters (all zero unless built with -DENABLE_STATS=ON)
+    m.def("stats", [] {
+        const cpm::stats::Snapshot snapshot = cpm::stats::snapshot();
+        py::dict stages;
+        for (size_t s = 0; s < cpm::stats::NUM_STAGES; ++s) {
+            const auto& stage = snapshot.stages[s];
+            py::dict entry;
+            entry["calls"] = stage.calls;
+            entry["nanoseconds"] = stage.nanoseconds;
+            entry["cycles"] = stage.cycles;
+            entry["bytes"] = stage.bytes;
+            stages[cpm::stats::stage_name(static_cast<cpm::stats::Stage>(s))] = entry;
         }
-        std::vector<double> vec(static_cast<double*>(buf.ptr),
-                               static_cast<double*>(buf.ptr) + buf.shape[0]);
-        return fe.extract_all(vec);
-    }, py::arg("signal"), py::arg("sample_rate") = 5000.0,
-       "Extract all features from a signal (convenience function)");
+        py::dict plan_cache;
+        plan_cache["hits"] = snapshot.plan_cache_hits;
+        plan_cache["misses"] = snapshot.plan_cache_misses;
+        plan_cache["hit_rate"] = snapshot.plan_cache_hit_rate();
+
+        py::dict out;
+        out["enabled"] = cpm::stats::enabled();
+        out["stages"] = stages;
+        out["plan_cache"] = plan_cache;
+        return out;
+    }, "Per-stage calls, nanoseconds, cycles and bytes, and FFT plan cache hits, summed over all threads");
+
+    m.def("reset_stats", &cpm::stats::reset, "Start the stage counters from zero");
+
+    m.def("simd_isa", [] {
+        return std::string(cpm::simd::isa_name(cpm::simd::active().isa));
+    }, "Name of the SIMD kernel set selected for this CPU");
 
     // Version info
     m.attr("__version__") = "1.0.0";
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * Frequency band [low, high) in Hz
+ */
+struct FrequencyBand {
+    std::string name;
+    double low;
+    double high;
+};
+
+/**
+ * Immutable list of band names shared by every result computed with the
+ * same band set (copying only bumps a reference count)
+ */
+class BandNames {
+public:
+    BandNames() = default;
+    explicit BandNames(std::vector<std::string> names);
+
+    size_t size() const { return names_ ? names_->size() : 0; }
+    bool empty() const { return size() == 0; }
+    const std::string& operator[](size_t i) const { return (*names_)[i]; }
+
+    std::vector<std::string>::const_iterator begin() const { return vector().begin(); }
+    std::vector<std::string>::const_iterator end() const { return vector().end(); }
+
+    /**
+     * Names as a vector (empty if unset)
+     */
+    const std::vector<std::string>& vector() const;
+
+private:
+    std::shared_ptr<const std::vector<std::string>> names_;
+};
+
+/**
+ * Bearing defect frequencies as multiples of shaft speed (orders)
+ */
+struct BearingFaultOrders {
+    double bpfo;  // Ball pass frequency, outer race
+    double bpfi;  // Ball pass frequency, inner race
+    double bsf;   // Ball spin frequency
+    double ftf;   // Fundamental train (cage) frequency
+};
+
+/**
+ * Set of frequency bands used for bandpower features
+ */
+class BandSet {
+public:
+    explicit BandSet(std::vector<FrequencyBand> bands);
+
+    /**
+     * The five fixed bands: [0-100, 100-500, 500-1000, 1000-2000, 2000+] Hz
+     */
+    static BandSet defaults();
+
+    /**
+     * Shared instance of defaults(), so default extractors share one set
+     */
+    static std::shared_ptr<const BandSet> shared_defaults();
+
+    /**
+     * Base-2 octave bands (centres 1 kHz * 2^k) with centres in [f_low, f_high]
+     */
+    static BandSet octave(double f_low, double f_high);
+
+    /**
+     * Base-2 1/3-octave bands (centres 1 kHz * 2^(k/3)) with centres in [f_low, f_high]
+     */
+    static BandSet third_octave(double f_low, double f_high);
+
+    /**
+     * Bands of +/- half_width_hz around each bearing defect frequency and
+     * its harmonics, named e.g. "BPFO 2x"
+     * @param shaft_hz Shaft rotation frequency in Hz
+     * @param orders Defect frequencies as multiples of shaft speed
+     * @param harmonics Number of harmonics per defect (1 = fundamental only)
+     * @param half_width_hz Half-width of each band in Hz
+     */
+    static BandSet bearing_faults(double shaft_hz, const BearingFaultOrders& orders,
+                                  size_t harmonics = 3, double half_width_hz = 2.0);
+
+    size_t size() const { return bands_.size(); }
+    const FrequencyBand& operator[](size_t i) const { return bands_[i]; }
+    const std::vector<FrequencyBand>& bands() const { return bands_; }
+    const BandNames& names() const { return names_; }
+
+private:
+    std::vector<FrequencyBand> bands_;
+    BandNames names_;
+};
+
+/**
+ * Bands resolved to contiguous FFT bin ranges for one (sample rate, FFT size)
+ * frequency grid, where bin i sits at i * sample_rate / fft_size Hz.
+ * Bandpower is then a sum over each range with no per-bin band search.
+ */
+class BandLayout {
+public:
+    BandLayout(const BandSet& bands, double sample_rate, size_t fft_size, size_t num_bins);
+
+    /**
+     * Get a cached layout for the band set and frequency grid
+     * @param bands Band definitions (held by the cache)
+     * @param sample_rate Sample rate in Hz
+     * @param fft_size Transform size that sets the bin spacing
+     * @param num_bins Number of one-sided bins produced
+     */
+    static std::shared_ptr<const BandLayout> get(const std::shared_ptr<const BandSet>& bands,
+                                                 double sample_rate, size_t fft_size,
+                                                 size_t num_bins);
+
+    /**
+     * Bin ranges [begin, end) per band
+     */
+    const std::vector<std::pair<size_t, size_t>>& ranges() const { return ranges_; }
+
+    size_t size() const { return ranges_.size(); }
+
+    /**
+     * Add sum(magnitude^2) over each band's bins into out (size() values)
+     */
+    void accumulate(std::span<const double> magnitudes, std::span<double> out) const;
+
+private:
+    std::vector<std::pair<size_t, size_t>> ranges_;
+};
+
+} // namespace cpm
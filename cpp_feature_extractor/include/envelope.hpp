@@ -0,0 +1,82 @@
+#pragma once
+
+#include "band_layout.hpp"
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * Envelope analysis settings for bearing fault detection
+ */
+struct EnvelopeConfig {
+    double band_low = 0.0;           // Demodulation band (structural resonance) in Hz
+    double band_high = 0.0;          // Clamped to Nyquist
+    double shaft_hz = 0.0;           // Shaft rotation frequency in Hz
+    BearingFaultOrders orders{};     // Defect frequencies as multiples of shaft speed
+    size_t harmonics = 3;            // Harmonics per defect (1 = fundamental only)
+    double half_width_hz = 2.0;      // Search half-width around each defect line
+};
+
+/**
+ * Envelope (Hilbert) spectrum and bearing defect amplitudes.
+ *
+ * Works on the one-sided spectrum X of an n-point real FFT that the caller
+ * has already computed. Bins inside the demodulation band are shifted to
+ * baseband and inverse transformed at a reduced length M, which gives the
+ * analytic signal of the band-passed input decimated by n/M. Its magnitude
+ * is the envelope; the envelope's own spectrum keeps the input's bin
+ * spacing sample_rate / n. M is the smallest even 2^a 3^b 5^c length that
+ * holds the band and reaches the highest defect harmonic.
+ *
+ * Defect amplitudes are the largest envelope-spectrum magnitude within
+ * half_width_hz of each defect frequency and harmonic, ordered and named as
+ * BandSet::bearing_faults ("BPFO 1x", ...). Defects with a zero order are
+ * skipped.
+ */
+class EnvelopeAnalyzer {
+public:
+    explicit EnvelopeAnalyzer(const EnvelopeConfig& config);
+
+    const EnvelopeConfig& config() const { return config_; }
+
+    /**
+     * Names of the defect amplitudes, in output order
+     */
+    const BandNames& fault_names() const { return faults_->names(); }
+
+    size_t num_faults() const { return faults_->size(); }
+
+    /**
+     * Defect amplitudes from a one-sided spectrum
+     * @param spectrum Bins [0, n/2) of the unnormalised n-point FFT
+     * @param n Transform size
+     * @param sample_rate Sample rate in Hz
+     * @param amplitudes Destination for num_faults() values
+     */
+    void fault_amplitudes(std::span<const std::complex<double>> spectrum, size_t n,
+                          double sample_rate, std::span<double> amplitudes) const;
+
+    /**
+     * Envelope magnitude spectrum from a one-sided spectrum, scaled like
+     * FeatureExtractor::compute_fft (single-sided amplitude, envelope mean removed)
+     * @return Pair of (magnitudes, frequencies)
+     */
+    std::pair<std::vector<double>, std::vector<double>>
+    envelope_spectrum(std::span<const std::complex<double>> spectrum, size_t n,
+                      double sample_rate) const;
+
+private:
+    EnvelopeConfig config_;
+    std::shared_ptr<const BandSet> faults_;
+
+    // Compute the envelope spectrum into per-thread scratch; returns its
+    // magnitudes and the envelope transform length M
+    std::span<const double> compute(std::span<const std::complex<double>> spectrum, size_t n,
+                                    double sample_rate, size_t& envelope_size) const;
+};
+
+} // namespace cpm
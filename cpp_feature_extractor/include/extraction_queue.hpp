@@ -0,0 +1,137 @@
+#pragma once
+
+#include "feature_extractor.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * Asynchronous single-signal extraction with micro-batching.
+ *
+ * submit() queues a signal and returns immediately. A dispatcher thread
+ * takes everything queued (up to max_batch signals) as one micro-batch
+ * and spreads it over the shared work-stealing pool, one reusable
+ * Workspace per worker, so a burst of small requests runs at batch
+ * throughput instead of one signal at a time. While a batch runs, new
+ * requests collect for the next one; with max_delay > 0 the dispatcher
+ * also waits that long for a lone request to gain company.
+ *
+ * Completion callbacks run on a pool worker (or on the dispatcher when
+ * the extractor has one thread) and should return quickly; exceptions
+ * they throw are discarded. A callback may close or destroy the queue:
+ * from a pool worker or the dispatcher, close() only stops intake and
+ * the dispatcher drains the queue and exits on its own.
+ */
+class ExtractionQueue {
+public:
+    /**
+     * Called once per request with the features or, on failure, an error
+     * (features is then empty)
+     */
+    using Callback = std::function<void(SignalFeatures&& features, std::exception_ptr error)>;
+
+    /**
+     * @param extractor Settings to extract with (copied; later changes to
+     *        the original do not apply). Its thread count sizes the pool.
+     * @param max_batch Most signals per micro-batch
+     * @param max_delay How long a request may wait for others to join it
+     */
+    explicit ExtractionQueue(const FeatureExtractor& extractor, size_t max_batch = 64,
+                             std::chrono::microseconds max_delay = std::chrono::microseconds(0));
+
+    /**
+     * Finishes queued requests, then stops the dispatcher (detached when
+     * destroyed from a pool worker or the dispatcher)
+     */
+    ~ExtractionQueue();
+
+    ExtractionQueue(const ExtractionQueue&) = delete;
+    ExtractionQueue& operator=(const ExtractionQueue&) = delete;
+
+    /**
+     * Queue a signal for extraction
+     * @param signal Samples (the queue takes ownership)
+     * @param include_spectrum Whether the result keeps fft_magnitude / fft_frequencies
+     * @param done Completion callback
+     * @throws std::logic_error after close()
+     */
+    void submit(std::vector<double> signal, bool include_spectrum, Callback done);
+
+    /**
+     * Queue a signal and get a future for its features
+     */
+    std::future<SignalFeatures> submit(std::vector<double> signal, bool include_spectrum = true);
+
+    /**
+     * Stop accepting requests and wait for queued ones to finish. Called
+     * from a pool worker or the dispatcher it returns without waiting.
+     */
+    void close();
+
+    const FeatureExtractor& extractor() const { return state_->extractor; }
+    size_t max_batch() const { return state_->max_batch; }
+
+    /**
+     * Requests completed and micro-batches run since construction
+     */
+    uint64_t completed() const { return state_->completed.load(std::memory_order_relaxed); }
+    uint64_t batches() const { return state_->batches.load(std::memory_order_relaxed); }
+
+    /**
+     * Requests waiting for a batch
+     */
+    size_t pending() const;
+
+private:
+    struct Request {
+        std::vector<double> signal;
+        bool include_spectrum = true;
+        Callback done;
+    };
+
+    // Everything the dispatcher touches; shared with it so a detached
+    // dispatcher can finish draining after the queue object is gone
+    struct State {
+        State(const FeatureExtractor& extractor, size_t max_batch,
+              std::chrono::microseconds max_delay);
+
+        const FeatureExtractor extractor;
+        const size_t max_batch;
+        const std::chrono::microseconds max_delay;
+        std::shared_ptr<ThreadPool> pool;
+        std::vector<Workspace> workspaces;  // One per pool worker
+
+        mutable std::mutex mutex;
+        std::condition_variable wake;
+        std::vector<Request> queue;
+        bool closing = false;
+
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> batches{0};
+    };
+
+    std::shared_ptr<State> state_;
+    std::mutex join_mutex_;
+    std::thread dispatcher_;
+
+    // Whether the calling thread may block on the dispatcher
+    bool can_join() const;
+
+    static void dispatch_loop(State& state);
+    static void run_batch(State& state, std::vector<Request>& batch);
+    static void run_one(State& state, Request& request, Workspace& workspace);
+};
+
+} // namespace cpm
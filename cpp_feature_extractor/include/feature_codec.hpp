@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * Storage encodings of a magnitude spectrum
+ */
+enum class SpectrumEncoding : uint8_t {
+    Float64 = 0,  // Raw doubles (lossless)
+    Float16 = 1,  // IEEE half of value / scale: 11 significant bits, about 0.05% relative error
+    Log8 = 2,     // 8-bit logarithmic code over dynamic_range_db below scale
+    Log16 = 3,    // 16-bit logarithmic code over dynamic_range_db below scale
+};
+
+/**
+ * Parse an encoding name: f64, f16, log8 or log16 (throws std::invalid_argument)
+ */
+SpectrumEncoding parse_spectrum_encoding(const std::string& name);
+
+const char* spectrum_encoding_name(SpectrumEncoding encoding);
+
+/**
+ * Header of an encoded spectrum block (all values little-endian).
+ *
+ * The header is followed by num_values codes: 8-byte doubles, 2-byte
+ * halves, or 1- or 2-byte log codes, padded to a multiple of 8 bytes so
+ * blocks can be packed back to back and stay aligned. Log code q = 0 is
+ * zero, and q = 1 .. L (L = 255 or 65535) decodes to
+ *
+ *   scale * 10^(-dynamic_range_db / 20 * (L - q) / (L - 1))
+ *
+ * so the steps are equal in dB: 96 dB over 8 bits is 0.38 dB (4.4%) per
+ * step, 160 dB over 16 bits 0.0024 dB. Values more than dynamic_range_db
+ * below the largest are stored as zero. A block with num_values = 0
+ * marks an empty slot in a fixed-size file section.
+ */
+struct SpectrumBlockHeader {
+    uint8_t encoding = 0;
+    uint8_t reserved = 0;
+    uint16_t dynamic_range_db = 0;  // Log encodings only
+    uint32_t num_values = 0;
+    double scale = 1.0;             // Largest magnitude (Float16, log encodings)
+};
+
+static_assert(sizeof(SpectrumBlockHeader) == 16, "SpectrumBlockHeader must be packed to 16 bytes");
+
+/**
+ * Bytes of an encoded block of n values, header and padding included
+ */
+size_t encoded_spectrum_size(SpectrumEncoding encoding, size_t n);
+
+/**
+ * Encode magnitudes into a block
+ * @param out At least encoded_spectrum_size(encoding, magnitudes.size()) bytes
+ * @param dynamic_range_db Range of the log encodings; 0 picks 96 dB for Log8
+ *        and 160 dB for Log16; at most 600 dB
+ * @throws std::invalid_argument on a short buffer, or (except for Float64)
+ *         on non-finite values and on negative values for the log encodings
+ */
+void encode_spectrum(std::span<const double> magnitudes, SpectrumEncoding encoding,
+                     std::span<unsigned char> out, unsigned dynamic_range_db = 0);
+std::vector<unsigned char> encode_spectrum(std::span<const double> magnitudes, SpectrumEncoding encoding,
+                                           unsigned dynamic_range_db = 0);
+
+/**
+ * Number of values in an encoded block (throws std::invalid_argument if malformed)
+ */
+size_t spectrum_length(std::span<const unsigned char> block);
+
+/**
+ * Decode a block into spectrum_length(block) values
+ */
+void decode_spectrum(std::span<const unsigned char> block, std::span<double> out);
+std::vector<double> decode_spectrum(std::span<const unsigned char> block);
+
+/**
+ * Encode a feature time series (one column of successive records).
+ *
+ * Values are quantised to multiples of resolution, delta coded and
+ * zigzag mapped, then bit-packed in blocks of 128 deltas with one width
+ * byte per block. Slowly drifting features need only a few bits per value.
+ * NaN gaps are kept in a validity bitmap. Decoding returns each value
+ * within resolution / 2.
+ *
+ * @throws std::invalid_argument if resolution is not positive, a value is
+ *         infinite or a value exceeds 2^52 resolution steps
+ */
+std::vector<unsigned char> encode_series(std::span<const double> values, double resolution);
+
+/**
+ * Number of values in an encoded series (throws std::invalid_argument if malformed)
+ */
+size_t series_length(std::span<const unsigned char> encoded);
+
+void decode_series(std::span<const unsigned char> encoded, std::span<double> out);
+std::vector<double> decode_series(std::span<const unsigned char> encoded);
+
+} // namespace cpm
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
+#include <span>
 #include <vector>
 #include <complex>
 #include <cmath>
@@ -8,12 +11,70 @@
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include "band_layout.hpp"
+#include "envelope.hpp"
+#include "fft_plan.hpp"
+#include "kurtogram.hpp"
+#include "window.hpp"
+#include "moments.hpp"
+#include "order_tracking.hpp"
+#include "thread_pool.hpp"
 
 namespace cpm {
 
 // Constants
 constexpr double PI = 3.14159265358979323846;
 
+/**
+ * Feature selection flags. Features left out of a mask are not computed:
+ * scalars read NaN, bandpower and fault rows are NaN-filled and the
+ * spectrum is empty. The FFT is skipped entirely when no frequency-domain
+ * feature is selected.
+ */
+enum class Feature : uint32_t {
+    None             = 0,
+    Rms              = 1u << 0,
+    Peak             = 1u << 1,
+    CrestFactor      = 1u << 2,
+    Kurtosis         = 1u << 3,
+    Skewness         = 1u << 4,
+    SpectralCentroid = 1u << 5,
+    SpectralSpread   = 1u << 6,
+    Bandpowers       = 1u << 7,
+    Spectrum         = 1u << 8,   // fft_magnitude / fft_frequencies (extract_all only)
+    FaultAmplitudes  = 1u << 9,   // Needs set_envelope()
+
+    TimeDomain       = Rms | Peak | CrestFactor | Kurtosis | Skewness,
+    FrequencyDomain  = SpectralCentroid | SpectralSpread | Bandpowers | Spectrum | FaultAmplitudes,
+    All              = TimeDomain | FrequencyDomain
+};
+
+constexpr Feature operator|(Feature a, Feature b) {
+    return static_cast<Feature>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+}
+
+constexpr Feature operator&(Feature a, Feature b) {
+    return static_cast<Feature>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+}
+
+constexpr Feature operator~(Feature a) {
+    return static_cast<Feature>(~static_cast<uint32_t>(a) & static_cast<uint32_t>(Feature::All));
+}
+
+/**
+ * True if any flag of wanted is set in mask
+ */
+constexpr bool has_feature(Feature mask, Feature wanted) {
+    return (mask & wanted) != Feature::None;
+}
+
+/**
+ * Parse a comma-separated feature list: rms, peak, crest_factor, kurtosis,
+ * skewness, spectral_centroid, spectral_spread, bandpowers, spectrum,
+ * fault_amplitudes, or the groups time, frequency and all
+ */
+Feature parse_features(const std::string& list);
+
 /**
  * Struct to hold all extracted features from a vibration signal
  */
@@ -28,60 +89,253 @@ struct SignalFeatures {
     std::vector<double> fft_magnitude;   // FFT magnitude spectrum
     std::vector<double> fft_frequencies; // Corresponding frequencies
     std::vector<double> bandpowers;      // Power in frequency bands
-    std::vector<std::string> band_names; // Names of frequency bands
+    BandNames band_names;                // Names of frequency bands (shared)
+    std::vector<double> fault_amplitudes;  // Envelope amplitudes at bearing defect lines
+    BandNames fault_names;               // Names of defect lines (empty without envelope analysis)
+};
+
+/**
+ * Time-domain statistics computed together in one fused pass
+ */
+struct TimeStats {
+    double mean = 0.0;
+    double rms = 0.0;
+    double peak = 0.0;
+    double crest_factor = 0.0;
+    double variance = 0.0;
+    double skewness = 0.0;
+    double kurtosis = 0.0;
+};
+
+/**
+ * Struct-of-arrays features for a batch of equal-length signals.
+ * Each scalar feature is one contiguous array with one entry per row;
+ * bandpowers is a row-major num_rows x num_bands matrix.
+ */
+struct BatchFeatures {
+    size_t num_rows = 0;
+    size_t num_bands = 0;
+    std::vector<double> rms;
+    std::vector<double> peak;
+    std::vector<double> crest_factor;
+    std::vector<double> kurtosis;
+    std::vector<double> skewness;
+    std::vector<double> spectral_centroid;
+    std::vector<double> spectral_spread;
+    std::vector<double> bandpowers;      // num_rows x num_bands, row-major
+    BandNames band_names;                // Names of frequency bands (shared)
+    size_t num_faults = 0;
+    std::vector<double> fault_amplitudes;  // num_rows x num_faults, row-major
+    BandNames fault_names;               // Names of defect lines
+};
+
+/**
+ * Welch averaged spectrum settings
+ */
+struct WelchConfig {
+    size_t segment_length = 1024;                 // Samples per segment (clamped to the signal)
+    double overlap = 0.5;                         // Fraction of a segment shared with the next
+    WindowFunction window = WindowFunction::Hann;
+};
+
+/**
+ * Sample order of a multichannel buffer
+ */
+enum class ChannelLayout {
+    Planar,       // channels x samples: each channel contiguous
+    Interleaved   // samples x channels: one frame of all channels at a time
+};
+
+/**
+ * Features of a multichannel recording (e.g. a triaxial accelerometer).
+ *
+ * Cross-channel spectra are Welch averages over Hann-windowed segments with
+ * 50% overlap and the segment mean removed, scaled as one-sided densities
+ * (units^2/Hz), matching scipy.signal.csd and scipy.signal.coherence.
+ */
+struct MultichannelFeatures {
+    size_t num_channels = 0;
+    size_t num_samples = 0;              // Samples per channel
+    BatchFeatures channels;              // Per-channel features, one row per channel
+    double vector_rms = 0.0;             // RMS of the vector magnitude across channels (always computed)
+
+    // Cross-channel features, empty unless requested
+    size_t segment_length = 0;           // Welch segment length
+    size_t num_segments = 0;             // Segments averaged
+    std::vector<double> frequencies;     // num_bins frequencies
+    std::vector<double> psd;             // num_channels x num_bins auto-spectral densities
+    std::vector<std::pair<size_t, size_t>> channel_pairs;  // (i, j), i < j, in row order
+    std::vector<std::complex<double>> csd;  // num_pairs x num_bins, E[conj(X_i) X_j]
+    std::vector<double> coherence;       // num_pairs x num_bins magnitude-squared coherence
+};
+
+/**
+ * Caller-owned buffers for allocation-free extraction.
+ *
+ * Pass the same workspace to repeated extract_all() calls: buffers grow to
+ * the largest signal seen and are then reused, so steady-state calls on
+ * same-length signals do no heap allocation. A workspace must not be used
+ * by two threads at once.
+ */
+struct Workspace {
+    SignalFeatures features;                     // Result of the last call
+    std::vector<std::complex<double>> spectrum;  // Half-length complex FFT output
+    std::vector<double> magnitudes;              // Used when the spectrum is not kept
+    std::vector<double> segment;                 // Windowed Welch segment
+    std::vector<std::complex<double>> full_spectrum;  // Whole-signal spectrum for envelope analysis in Welch mode
+    std::vector<double> samples;                 // float32 / int16 input widened for the transform
+    std::vector<double> frequencies;             // Cached frequency grid
+    double grid_sample_rate = 0.0;               // Grid the frequencies were built for
+    size_t grid_fft_size = 0;
 };
 
 /**
  * Feature Extractor class for vibration signal analysis
+ *
+ * Reductions run on SIMD kernels selected at runtime (see simd_kernels.hpp).
+ * Signals may be double, float32 or int16 ADC counts with a scale to
+ * physical units. Narrow samples are read at their own width and widened
+ * to double block by block; moments, FFTs and all results stay in double.
  */
 class FeatureExtractor {
 public:
     /**
      * Constructor
      * @param sample_rate Sample rate in Hz (default 5000 Hz)
+     * @param num_threads Worker threads for batch extraction (0 = all cores)
      */
-    explicit FeatureExtractor(double sample_rate = 5000.0);
+    explicit FeatureExtractor(double sample_rate = 5000.0, size_t num_threads = 1);
 
     /**
      * Extract all features from a signal
      * @param signal Input signal samples
      * @return SignalFeatures struct with all computed features
      */
-    SignalFeatures extract_all(const std::vector<double>& signal) const;
+    SignalFeatures extract_all(std::span<const double> signal) const;
+    SignalFeatures extract_all(std::span<const float> signal) const;
+
+    /**
+     * Extract all features from int16 samples
+     * @param signal ADC counts
+     * @param scale Physical units per count
+     */
+    SignalFeatures extract_all(std::span<const int16_t> signal, double scale) const;
+
+    /**
+     * Extract all features into a reusable workspace
+     * @param signal Input signal samples
+     * @param workspace Buffers reused across calls
+     * @param include_spectrum If false, fft_magnitude and fft_frequencies are
+     *                         left empty (scalar features and bandpowers only)
+     * @return Reference to workspace.features, valid until the next call
+     */
+    const SignalFeatures& extract_all(std::span<const double> signal, Workspace& workspace,
+                                      bool include_spectrum = true) const;
+    const SignalFeatures& extract_all(std::span<const float> signal, Workspace& workspace,
+                                      bool include_spectrum = true) const;
+    const SignalFeatures& extract_all(std::span<const int16_t> signal, double scale,
+                                      Workspace& workspace, bool include_spectrum = true) const;
+
+    /**
+     * Select the features extract_all, extract_batch and extract_multichannel
+     * compute (default Feature::All). Unselected stages are skipped.
+     */
+    void set_features(Feature features);
+
+    /**
+     * Get the selected features
+     */
+    Feature get_features() const { return features_; }
+
+    /**
+     * Extract scalar features and bandpowers from a batch of signals
+     * sharing one FFT plan. Rows are split across the shared work-stealing
+     * pool when more than one thread is configured; each worker keeps its
+     * own FFT scratch buffers.
+     * @param data Row-major num_rows x row_length sample matrix
+     * @param num_rows Number of signals
+     * @param row_length Samples per signal
+     * @return BatchFeatures with one entry per row
+     */
+    BatchFeatures extract_batch(std::span<const double> data, size_t num_rows,
+                                size_t row_length) const;
+    BatchFeatures extract_batch(std::span<const float> data, size_t num_rows,
+                                size_t row_length) const;
+    BatchFeatures extract_batch(std::span<const int16_t> data, double scale, size_t num_rows,
+                                size_t row_length) const;
+
+    /**
+     * Extract per-channel features of a multichannel recording in one call.
+     * All channels share one FFT plan and band layout and are spread over
+     * the pool like batch rows; interleaved input is transposed once in
+     * cache-sized blocks.
+     * @param data num_channels x num_samples samples in the given layout
+     * @param num_channels Number of channels
+     * @param layout Planar or interleaved sample order
+     * @param cross_segment Welch segment length for cross-spectral density
+     *        and coherence (clamped to the signal length); 0 skips them
+     */
+    MultichannelFeatures extract_multichannel(std::span<const double> data, size_t num_channels,
+                                              ChannelLayout layout = ChannelLayout::Planar,
+                                              size_t cross_segment = 0) const;
+
+    /**
+     * Compute all time-domain statistics in a single pass over memory.
+     * The signal is processed in cache-resident blocks whose moments are
+     * merged with Pébay's formulas, so results stay accurate with a large
+     * DC offset.
+     */
+    TimeStats compute_time_stats(std::span<const double> signal) const;
+    TimeStats compute_time_stats(std::span<const float> signal) const;
+    TimeStats compute_time_stats(std::span<const int16_t> signal, double scale) const;
 
     /**
      * Compute Root Mean Square
      */
-    double compute_rms(const std::vector<double>& signal) const;
+    double compute_rms(std::span<const double> signal) const;
 
     /**
      * Compute peak (maximum absolute value)
      */
-    double compute_peak(const std::vector<double>& signal) const;
+    double compute_peak(std::span<const double> signal) const;
 
     /**
      * Compute Crest Factor (Peak / RMS)
      */
-    double compute_crest_factor(const std::vector<double>& signal) const;
+    double compute_crest_factor(std::span<const double> signal) const;
 
     /**
      * Compute Kurtosis (fourth moment / variance^2)
      * Fisher's definition: excess kurtosis (normal = 0)
      */
-    double compute_kurtosis(const std::vector<double>& signal) const;
+    double compute_kurtosis(std::span<const double> signal) const;
 
     /**
      * Compute Skewness (third moment / variance^1.5)
      */
-    double compute_skewness(const std::vector<double>& signal) const;
+    double compute_skewness(std::span<const double> signal) const;
 
     /**
      * Compute FFT and return magnitude spectrum
+     * The transform has the signal's exact length n (no zero padding), so
+     * the n/2 bins are spaced sample_rate / n apart, as with numpy's fft.
      * @param signal Input signal
      * @return Pair of (magnitudes, frequencies)
      */
     std::pair<std::vector<double>, std::vector<double>>
-    compute_fft(const std::vector<double>& signal) const;
+    compute_fft(std::span<const double> signal) const;
+
+    /**
+     * Compute a Welch averaged magnitude spectrum: windowed segments are
+     * transformed one at a time and their powers averaged. Magnitudes are
+     * power-scaled, so squared magnitudes sum to the same bandpower as the
+     * single periodogram of compute_fft. Uses the configured Welch settings,
+     * or the WelchConfig defaults when Welch mode is off.
+     * @param signal Input signal
+     * @return Pair of (magnitudes, frequencies) on a segment_length grid
+     */
+    std::pair<std::vector<double>, std::vector<double>>
+    compute_welch(std::span<const double> signal) const;
 
     /**
      * Compute Spectral Centroid (weighted mean frequency)
@@ -89,33 +343,142 @@ public:
      * @param frequencies Corresponding frequencies
      */
     double compute_spectral_centroid(
-        const std::vector<double>& magnitudes,
-        const std::vector<double>& frequencies) const;
+        std::span<const double> magnitudes,
+        std::span<const double> frequencies) const;
 
     /**
      * Compute Spectral Spread (standard deviation around centroid)
      */
     double compute_spectral_spread(
-        const std::vector<double>& magnitudes,
-        const std::vector<double>& frequencies,
+        std::span<const double> magnitudes,
+        std::span<const double> frequencies,
         double centroid) const;
 
     /**
-     * Compute bandpower in predefined frequency bands
-     * Bands: [0-100, 100-500, 500-1000, 1000-2000, 2000+] Hz
+     * Compute bandpower in the configured frequency bands
+     * (default: [0-100, 100-500, 500-1000, 1000-2000, 2000+] Hz)
      * @param magnitudes FFT magnitude spectrum
-     * @param frequencies Corresponding frequencies
+     * @param frequencies Corresponding frequencies (ascending, as from compute_fft)
      * @return Vector of powers for each band
      */
     std::vector<double> compute_bandpower(
-        const std::vector<double>& magnitudes,
-        const std::vector<double>& frequencies) const;
+        std::span<const double> magnitudes,
+        std::span<const double> frequencies) const;
 
     /**
      * Get frequency band names
      */
     std::vector<std::string> get_band_names() const;
 
+    /**
+     * Replace the frequency bands used for bandpower features
+     */
+    void set_bands(BandSet bands);
+
+    /**
+     * Get the configured frequency bands
+     */
+    const BandSet& get_bands() const;
+
+    /**
+     * Enable Welch mode: spectral centroid, spread and bandpowers (and the
+     * returned spectrum) then come from compute_welch instead of one
+     * full-length transform
+     */
+    void set_welch(const WelchConfig& config);
+
+    /**
+     * Return to one full-length periodogram per signal
+     */
+    void clear_welch();
+
+    /**
+     * Welch settings in use, or nullptr
+     */
+    const WelchConfig* get_welch() const { return welch_ ? &*welch_ : nullptr; }
+
+    /**
+     * Enable envelope analysis: extract_all and extract_batch then also
+     * report envelope-spectrum amplitudes at the configured bearing defect
+     * frequencies, computed from the spectrum they already take
+     */
+    void set_envelope(const EnvelopeConfig& config);
+
+    /**
+     * Disable envelope analysis
+     */
+    void clear_envelope();
+
+    /**
+     * Envelope analyzer in use, or nullptr
+     */
+    const EnvelopeAnalyzer* get_envelope() const { return envelope_.get(); }
+
+    /**
+     * Compute the envelope spectrum of a signal with the configured envelope
+     * settings (throws std::logic_error if envelope analysis is disabled)
+     * @return Pair of (magnitudes, frequencies)
+     */
+    std::pair<std::vector<double>, std::vector<double>>
+    compute_envelope_spectrum(std::span<const double> signal) const;
+
+    /**
+     * Fast kurtogram of a signal: spectral kurtosis over a 1/3-binary tree
+     * of bands, and the band where it peaks
+     */
+    Kurtogram compute_kurtogram(std::span<const double> signal, const KurtogramConfig& config = {}) const;
+
+    /**
+     * Kurtogram and the envelope spectrum of its best band, sharing one
+     * FFT of the signal. With set_envelope() the defect amplitudes are
+     * also reported, demodulating the best band instead of the configured one.
+     */
+    KurtogramEnvelope compute_kurtogram_envelope(std::span<const double> signal,
+                                                 const KurtogramConfig& config = {}) const;
+
+    /**
+     * Configure order tracking (angle-domain resampling to shaft orders)
+     */
+    void set_order_tracking(const OrderConfig& config);
+
+    /**
+     * Return to the OrderConfig defaults for order spectra
+     */
+    void clear_order_tracking();
+
+    /**
+     * Order tracker in use, or nullptr when running on the defaults
+     */
+    const OrderTracker* get_order_tracker() const { return orders_.get(); }
+
+    /**
+     * Compute the order spectrum and order-band powers of a signal at a
+     * constant shaft speed, with the configured order settings or the
+     * OrderConfig defaults
+     * @param rpm Shaft speed in revolutions per minute
+     */
+    OrderSpectrum compute_order_spectrum(std::span<const double> signal, double rpm) const;
+
+    /**
+     * Compute the order spectrum following an RPM trace spread evenly over
+     * the signal (e.g. a tachometer channel, or a coarser speed log)
+     */
+    OrderSpectrum compute_order_spectrum(std::span<const double> signal,
+                                         std::span<const double> rpm) const;
+
+    /**
+     * Order-band powers for a batch of equal-length signals, one shaft
+     * speed per row, spread over the worker threads like extract_batch
+     */
+    BatchOrderFeatures extract_order_batch(std::span<const double> data, std::span<const double> rpm,
+                                           size_t num_rows, size_t row_length) const;
+
+    /**
+     * Bin ranges of the configured bands on the grid of an fft_size transform
+     * producing num_bins bins (cached per band set and grid)
+     */
+    std::shared_ptr<const BandLayout> band_layout(size_t fft_size, size_t num_bins) const;
+
     /**
      * Set sample rate
      */
@@ -126,26 +489,112 @@ public:
      */
     double get_sample_rate() const;
 
+    /**
+     * Set worker thread count for batch extraction (0 = all cores)
+     */
+    void set_num_threads(size_t num_threads);
+
+    /**
+     * Get worker thread count for batch extraction
+     */
+    size_t get_num_threads() const;
+
 private:
     double sample_rate_;
+    size_t num_threads_;
+    std::shared_ptr<const BandSet> bands_;
+    std::shared_ptr<const EnvelopeAnalyzer> envelope_;
+    std::shared_ptr<const OrderTracker> orders_;
+    std::optional<WelchConfig> welch_;
+    Feature features_ = Feature::All;
+
+    // Pipeline stages needed for the selected features, resolved once per call
+    struct Stages {
+        bool time = false;       // rms, peak, crest factor
+        bool moments = false;    // kurtosis, skewness
+        bool spectrum = false;   // Any FFT at all
+        bool magnitudes = false; // Feature magnitude spectrum (not just the envelope's input)
+        bool centroid = false;   // Also needed for the spread
+        bool spread = false;
+        bool bandpowers = false;
+        bool faults = false;
+        bool keep_spectrum = false;
+    };
+
+    Stages stages(bool include_spectrum) const;
+
+    // Configured order tracker, or a shared default-configured one
+    const OrderTracker& order_tracker() const;
+
+    // Fused time-domain statistics of double, float or int16 (times scale)
+    // samples; with_moments = false skips the central-moment pass
+    template <typename T>
+    TimeStats sample_time_stats(std::span<const T> signal, double scale, bool with_moments) const;
+
+    // Time-domain features a stage set asks for
+    template <typename T>
+    TimeStats time_features(std::span<const T> signal, double scale, const Stages& stages) const;
+
+    // extract_all / extract_batch for any sample type
+    template <typename T>
+    const SignalFeatures& extract_samples(std::span<const T> signal, double scale,
+                                          Workspace& workspace, bool include_spectrum) const;
+
+    template <typename T>
+    BatchFeatures batch_samples(std::span<const T> data, double scale, size_t num_rows,
+                                size_t row_length) const;
+
+    // Frequency-domain features of a non-empty signal into workspace.features
+    void spectral_features(std::span<const double> signal, const Stages& stages,
+                           Workspace& workspace) const;
+
+    // Reusable per-worker buffers for the batch path
+    struct BatchScratch {
+        std::vector<std::complex<double>> spectrum;
+        std::vector<double> magnitudes;
+        std::vector<double> segment;
+        std::vector<std::complex<double>> full_spectrum;
+        std::vector<double> samples;     // Widened narrow row
+    };
+
+    // Transforms used for the spectral features of n-sample signals
+    struct SpectrumSetup {
+        std::shared_ptr<const FFTPlan> plan;        // Feature spectrum (segment length in Welch mode)
+        std::shared_ptr<const WindowTable> window;  // Welch window; null for one periodogram
+        size_t hop = 0;                             // Welch segment step
+        std::shared_ptr<const FFTPlan> full_plan;   // Whole signal, for envelope analysis in Welch mode
+    };
+
+    SpectrumSetup spectrum_setup(size_t n, bool faults) const;
+
+    // Averaged magnitudes of hop-spaced windowed segments
+    void welch_spectrum(const FFTPlan& plan, const WindowTable& window, size_t hop,
+                        std::span<const double> signal, std::vector<double>& segment,
+                        std::vector<std::complex<double>>& spectrum,
+                        std::span<double> magnitudes) const;
 
-    // FFT implementation (Cooley-Tukey radix-2)
-    void fft_recursive(std::vector<std::complex<double>>& x) const;
+    // Feature magnitudes of signal (setup.plan->num_bins() values, skipped
+    // unless want_magnitudes). Returns the whole-signal half spectrum when
+    // envelope analysis needs it.
+    std::span<const std::complex<double>> feature_spectrum(
+        const SpectrumSetup& setup, std::span<const double> signal,
+        std::vector<double>& segment, std::vector<std::complex<double>>& spectrum,
+        std::vector<std::complex<double>>& full_spectrum, std::span<double> magnitudes,
+        bool want_magnitudes = true) const;
 
-    // Bit-reversal for FFT
-    static size_t bit_reverse(size_t n, size_t bits);
+    // One-sided magnitude spectrum of signal using a prepared plan
+    void magnitude_spectrum(const FFTPlan& plan, std::span<const double> signal,
+                            std::span<std::complex<double>> spectrum,
+                            std::span<double> magnitudes) const;
 
-    // Next power of 2
-    static size_t next_power_of_2(size_t n);
+    // Compute the selected batch features for one row into out
+    void extract_row(std::span<const double> row, const Stages& stages,
+                     const SpectrumSetup* setup, std::span<const double> frequencies,
+                     const BandLayout* layout, BatchScratch& scratch, BatchFeatures& out,
+                     size_t index) const;
 
-    // Frequency bands [low, high) in Hz
-    static constexpr std::array<std::pair<double, double>, 5> FREQ_BANDS = {{
-        {0.0, 100.0},
-        {100.0, 500.0},
-        {500.0, 1000.0},
-        {1000.0, 2000.0},
-        {2000.0, 10000.0}  // Up to Nyquist for 5kHz
-    }};
+    // Samples per block in compute_time_stats (fits in L1 alongside scratch)
+    static constexpr size_t TIME_STATS_BLOCK = 512;
 };
 
 } // namespace cpm
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "feature_codec.hpp"
+#include "feature_extractor.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+namespace cpm {
+
+/**
+ * Header of a CPMS feature store file (all values little-endian).
+ *
+ * The 64-byte header is followed by num_records fixed-size records, each a
+ * FeatureRecord followed by num_bands bandpowers and num_faults fault
+ * amplitudes (float64). A store that keeps spectra (num_bins > 0) adds to
+ * every record the bin spacing in Hz (float64) and one encoded spectrum
+ * block of encoded_spectrum_size(encoding, num_bins) bytes. Records are
+ * only ever appended: a writer fills the next slot and then publishes it
+ * by storing the new num_records, so readers never see a partial record.
+ * A later record with the same key supersedes an earlier one; this is how
+ * a spectrum is added to a record first stored without one.
+ */
+struct FeatureStoreHeader {
+    char magic[4] = {'C', 'P', 'M', 'S'};
+    uint16_t version = 1;
+    uint16_t spectrum_encoding = 0; // SpectrumEncoding of stored spectra
+    uint32_t num_bands = 0;
+    uint32_t num_faults = 0;
+    uint32_t record_size = 0;       // Bytes per record, trailing values included
+    uint32_t num_bins = 0;          // Spectrum bins per record; 0 stores no spectra
+    uint64_t num_records = 0;       // Published records
+    uint64_t reserved3[4] = {};
+};
+
+static_assert(sizeof(FeatureStoreHeader) == 64, "FeatureStoreHeader must be packed to 64 bytes");
+
+/**
+ * Fixed part of one stored result. Features that were not selected are NaN,
+ * as in SignalFeatures.
+ */
+struct FeatureRecord {
+    uint64_t waveform_hash;  // waveform_hash() of the samples
+    uint64_t config_hash;    // feature_config_hash() of the extractor
+    uint64_t num_samples;
+    double sample_rate;
+    double rms;
+    double peak;
+    double crest_factor;
+    double kurtosis;
+    double skewness;
+    double spectral_centroid;
+    double spectral_spread;
+
+    /**
+     * Bandpowers, then fault amplitudes, stored right after the record
+     */
+    const double* values() const { return reinterpret_cast<const double*>(this + 1); }
+};
+
+static_assert(sizeof(FeatureRecord) == 88, "FeatureRecord must be packed to 88 bytes");
+
+/**
+ * XXH64 of the raw samples; the seed differs per sample type, so the same
+ * values stored as double and float32 get different keys
+ */
+uint64_t waveform_hash(std::span<const double> signal);
+uint64_t waveform_hash(std::span<const float> signal);
+uint64_t waveform_hash(std::span<const int16_t> signal);
+
+/**
+ * Hash of every extractor setting that changes results: sample rate, bands,
+ * feature mask, Welch and envelope settings, and the int16 scale (1 for
+ * other sample types). Thread counts are not included.
+ */
+uint64_t feature_config_hash(const FeatureExtractor& extractor, double scale = 1.0);
+
+/**
+ * Persistent feature cache in a memory-mapped, append-only file.
+ *
+ * Records are keyed by (waveform hash, config hash). Each process maps the
+ * file once and keeps an in-memory index that picks up records appended by
+ * other processes on the next lookup; lookups return pointers into the
+ * mapping without copying. Appends take an exclusive flock on the file, so
+ * any number of processes can share one store.
+ *
+ * The mapping reserves address space for the largest supported file up
+ * front and is never moved, so record pointers stay valid for the life of
+ * the store. All methods are thread-safe.
+ */
+class FeatureStore {
+public:
+    /**
+     * Open a store for reading and appending, creating it if missing
+     * @param path File path
+     * @param num_bands Bandpower values per record
+     * @param num_faults Fault amplitude values per record
+     * @param num_bins Spectrum bins kept per record (0 = no spectra); spectra
+     *        of any other length are not stored
+     * @param encoding Storage of the spectra; Float16 keeps a 2048-bin
+     *        spectrum in 4 KiB instead of 16
+     * @throws std::invalid_argument if an existing store has another layout
+     */
+    static FeatureStore open(const std::string& path, size_t num_bands, size_t num_faults = 0,
+                             size_t num_bins = 0, SpectrumEncoding encoding = SpectrumEncoding::Float16);
+
+    /**
+     * Open an existing store read-only; misses are computed but not stored
+     */
+    static FeatureStore open_readonly(const std::string& path);
+
+    FeatureStore(FeatureStore&& other) noexcept;
+    FeatureStore& operator=(FeatureStore&& other) noexcept;
+    FeatureStore(const FeatureStore&) = delete;
+    FeatureStore& operator=(const FeatureStore&) = delete;
+    ~FeatureStore();
+
+    size_t num_bands() const { return num_bands_; }
+    size_t num_faults() const { return num_faults_; }
+    size_t num_bins() const { return num_bins_; }
+    SpectrumEncoding spectrum_encoding() const { return encoding_; }
+    bool writable() const { return writable_; }
+
+    /**
+     * Published records, including those appended by other processes
+     */
+    size_t size() const;
+
+    /**
+     * Look up the newest record of a key (nullptr if absent)
+     */
+    const FeatureRecord* find(uint64_t waveform_hash, uint64_t config_hash) const;
+
+    /**
+     * Decode the spectrum of a stored record
+     * @return False (leaving the outputs empty) if the record has no spectrum
+     */
+    bool spectrum(const FeatureRecord& record, std::vector<double>& magnitudes,
+                  std::vector<double>& frequencies) const;
+
+    /**
+     * Append a result unless the key is already stored for num_samples
+     * samples. The spectrum is kept if the store has spectra and fft_magnitude
+     * holds num_bins() finite values; such a result supersedes a stored record
+     * that has no spectrum.
+     * @return The stored record (the existing one if it needs no update)
+     * @throws std::logic_error on a read-only store, std::invalid_argument if the
+     *         band or fault count does not match the store
+     */
+    const FeatureRecord* append(uint64_t waveform_hash, uint64_t config_hash,
+                                const SignalFeatures& features, size_t num_samples, double sample_rate);
+
+    /**
+     * Features of a signal, read from the store on a hit and extracted and
+     * appended on a miss. The spectrum is filled in only by stores that keep
+     * spectra, from the decoded record on a hit. A record stored without a
+     * spectrum (by extract_batch) counts as a miss once: it is extracted
+     * again and superseded by a record with the spectrum. Spectra the store
+     * cannot keep (not num_bins() values) are returned only on the miss.
+     */
+    const SignalFeatures& extract(const FeatureExtractor& extractor, std::span<const double> signal,
+                                  Workspace& workspace);
+    const SignalFeatures& extract(const FeatureExtractor& extractor, std::span<const float> signal,
+                                  Workspace& workspace);
+    const SignalFeatures& extract(const FeatureExtractor& extractor, std::span<const int16_t> signal,
+                                  double scale, Workspace& workspace);
+
+    /**
+     * Batch features of num_rows x row_length samples. Only rows missing
+     * from the store are extracted (in one extract_batch call) and appended,
+     * without spectra.
+     */
+    BatchFeatures extract_batch(const FeatureExtractor& extractor, std::span<const double> data,
+                                size_t num_rows, size_t row_length);
+    BatchFeatures extract_batch(const FeatureExtractor& extractor, std::span<const float> data,
+                                size_t num_rows, size_t row_length);
+    BatchFeatures extract_batch(const FeatureExtractor& extractor, std::span<const int16_t> data,
+                                double scale, size_t num_rows, size_t row_length);
+
+    /**
+     * Lookups by extract and extract_batch since the store was opened
+     */
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    FeatureStore() = default;
+
+    struct KeyHash {
+        size_t operator()(const std::pair<uint64_t, uint64_t>& key) const {
+            return static_cast<size_t>(key.first ^ (key.second * 0x9E3779B97F4A7C15ULL));
+        }
+    };
+    using Index = std::unordered_map<std::pair<uint64_t, uint64_t>, uint64_t, KeyHash>;
+
+    int fd_ = -1;
+    bool writable_ = false;
+    unsigned char* map_ = nullptr;
+    size_t map_size_ = 0;
+    size_t num_bands_ = 0;
+    size_t num_faults_ = 0;
+    size_t num_bins_ = 0;
+    SpectrumEncoding encoding_ = SpectrumEncoding::Float16;
+    size_t record_size_ = 0;
+
+    // Guards the index; records themselves are immutable once published
+    mutable std::mutex mutex_;
+    mutable Index index_;
+    mutable uint64_t indexed_ = 0;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+
+    static FeatureStore open_file(const std::string& path, bool writable, size_t num_bands,
+                                  size_t num_faults, size_t num_bins, SpectrumEncoding encoding);
+
+    void release();  // Unmap and close
+    uint64_t published() const;
+    const FeatureRecord* record(uint64_t index) const;
+    void check_layout(const FeatureExtractor& extractor) const;
+    void reserve(uint64_t extra) const;  // Grow the file for extra more records; flock held
+    void refresh() const;  // Index records published since the last call; mutex_ held
+    // Newest record of the key, or nullptr if absent or stored for another
+    // length (0 skips the length check); mutex_ held
+    const FeatureRecord* lookup(uint64_t waveform_hash, uint64_t config_hash,
+                                size_t num_samples = 0) const;
+    bool has_spectrum(const FeatureRecord& record) const;
+    bool spectrum_unstorable(const FeatureRecord& record) const;
+    const FeatureRecord* append_locked(uint64_t waveform_hash, uint64_t config_hash,
+                                       const double* scalars, std::span<const double> bandpowers,
+                                       std::span<const double> faults, std::span<const double> spectrum,
+                                       double bin_spacing, size_t num_samples, double sample_rate);
+
+    void fill(const FeatureRecord& record, const FeatureExtractor& extractor,
+              SignalFeatures& features) const;
+
+    template <typename T>
+    const SignalFeatures& extract_samples(const FeatureExtractor& extractor, std::span<const T> signal,
+                                          double scale, Workspace& workspace);
+
+    template <typename T>
+    BatchFeatures batch_samples(const FeatureExtractor& extractor, std::span<const T> data,
+                                double scale, size_t num_rows, size_t row_length);
+};
+
+} // namespace cpm
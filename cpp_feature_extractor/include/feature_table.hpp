@@ -0,0 +1,198 @@
+#pragma once
+
+#include "feature_codec.hpp"
+#include "feature_extractor.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * Header of the CPMF columnar feature file (all values little-endian).
+ *
+ * Layout, with every section starting on a 64-byte boundary:
+ *   - this 64-byte header
+ *   - names_size bytes of '\n'-terminated UTF-8: num_columns column names,
+ *     then optionally num_rows row labels (e.g. source file paths)
+ *   - num_columns float64 columns of num_rows values, column_stride bytes apart;
+ *     the last num_bands columns are bandpowers
+ *   - if num_bins > 0: num_bins frequencies followed by num_rows x num_bins
+ *     float64 spectrum magnitudes, row-major
+ *
+ * Version 2 files store the spectra encoded (reserved holds the
+ * SpectrumEncoding): after the frequencies come num_rows fixed-size
+ * blocks of encoded_spectrum_size(encoding, num_bins) bytes, one per row,
+ * each a SpectrumBlockHeader and its codes. Rows never set have an empty
+ * block. Float16 spectra take a quarter of the space, Log8 an eighth.
+ *
+ * Each column is a plain aligned float64 buffer, so it can be wrapped by
+ * numpy.frombuffer or used as an Arrow float64 data buffer without copying.
+ */
+struct FeatureTableHeader {
+    char magic[4] = {'C', 'P', 'M', 'F'};
+    uint16_t version = 1;
+    uint16_t reserved = 0;           // SpectrumEncoding of the spectrum block (version 2)
+    uint32_t num_columns = 0;
+    uint32_t num_bands = 0;
+    uint32_t num_bins = 0;
+    uint32_t reserved2 = 0;
+    uint64_t num_rows = 0;
+    uint64_t names_size = 0;
+    uint64_t columns_offset = 0;
+    uint64_t column_stride = 0;
+    uint64_t spectrum_offset = 0;    // 0 when there is no spectrum block
+};
+
+static_assert(sizeof(FeatureTableHeader) == 64, "FeatureTableHeader must be packed to 64 bytes");
+
+/**
+ * Scalar columns that precede the bandpower columns, in file order
+ */
+const std::vector<std::string>& feature_table_scalar_columns();
+
+/**
+ * Writes a CPMF file through a shared memory mapping.
+ *
+ * The file is sized up front for num_rows rows with every value NaN, and
+ * set_row() writes one row in place. Distinct rows may be written from
+ * different threads at once, so batch workers can store results directly
+ * without a reorder step.
+ */
+class FeatureTableWriter {
+public:
+    /**
+     * Create (or truncate) a feature file
+     * @param path Output path
+     * @param num_rows Number of rows
+     * @param band_names Names of the bandpower columns
+     * @param frequencies Spectrum frequency grid; empty for no spectrum block
+     * @param row_labels One label per row, or empty for none
+     * @param encoding Storage of the spectrum block; anything but Float64
+     *        writes a version 2 file
+     */
+    FeatureTableWriter(const std::string& path, size_t num_rows, const BandNames& band_names,
+                       std::span<const double> frequencies = {},
+                       const std::vector<std::string>& row_labels = {},
+                       SpectrumEncoding encoding = SpectrumEncoding::Float64);
+
+    FeatureTableWriter(const FeatureTableWriter&) = delete;
+    FeatureTableWriter& operator=(const FeatureTableWriter&) = delete;
+    ~FeatureTableWriter();
+
+    /**
+     * Store the features of one row
+     * @param row Row index
+     * @param features Extracted features; with a spectrum block, fft_magnitude
+     *        must hold num_bins() values on the same frequency grid
+     * @param num_samples Signal length
+     * @param sample_rate Sample rate in Hz
+     */
+    void set_row(size_t row, const SignalFeatures& features, size_t num_samples, double sample_rate);
+
+    /**
+     * Flush and unmap the file. Called by the destructor if not called earlier.
+     */
+    void close();
+
+    size_t num_rows() const { return header_.num_rows; }
+    size_t num_bins() const { return header_.num_bins; }
+    SpectrumEncoding spectrum_encoding() const { return static_cast<SpectrumEncoding>(header_.reserved); }
+
+private:
+    FeatureTableHeader header_;
+    unsigned char* map_ = nullptr;
+    size_t map_size_ = 0;
+    double bin_spacing_ = 0.0;
+
+    double* column(size_t index) const;
+    unsigned char* spectrum_row(size_t row) const;
+};
+
+/**
+ * Write a batch result as a CPMF file (no spectrum block)
+ * @param path Output path
+ * @param batch Result of FeatureExtractor::extract_batch
+ * @param row_length Samples per row
+ * @param sample_rate Sample rate in Hz
+ */
+void write_feature_table(const std::string& path, const BatchFeatures& batch,
+                         size_t row_length, double sample_rate);
+
+/**
+ * Read-only memory-mapped CPMF file. Columns are views into the mapping.
+ */
+class FeatureTable {
+public:
+    static FeatureTable open(const std::string& path);
+
+    FeatureTable(FeatureTable&& other) noexcept;
+    FeatureTable& operator=(FeatureTable&& other) noexcept;
+    FeatureTable(const FeatureTable&) = delete;
+    FeatureTable& operator=(const FeatureTable&) = delete;
+    ~FeatureTable();
+
+    size_t num_rows() const { return header_.num_rows; }
+    size_t num_bands() const { return header_.num_bands; }
+    size_t num_bins() const { return header_.num_bins; }
+    const std::vector<std::string>& column_names() const { return names_; }
+
+    /**
+     * Row labels, empty if the file has none
+     */
+    const std::vector<std::string>& row_labels() const { return labels_; }
+
+    /**
+     * Column by index or by name (throws std::out_of_range if missing)
+     */
+    std::span<const double> column(size_t index) const;
+    std::span<const double> column(const std::string& name) const;
+
+    /**
+     * Bandpower column of one band
+     */
+    std::span<const double> bandpower(size_t band) const;
+
+    /**
+     * Spectrum frequency grid (empty without a spectrum block)
+     */
+    std::span<const double> frequencies() const;
+
+    /**
+     * How the spectrum block is stored
+     */
+    SpectrumEncoding spectrum_encoding() const { return static_cast<SpectrumEncoding>(header_.reserved); }
+
+    /**
+     * Spectrum magnitudes of one row (empty without a spectrum block)
+     * @throws std::logic_error if the spectra are encoded; use decode_spectrum
+     */
+    std::span<const double> spectrum(size_t row) const;
+
+    /**
+     * Encoded spectrum block of one row (empty without a spectrum block)
+     * @throws std::logic_error if the spectra are stored as plain float64
+     */
+    std::span<const unsigned char> encoded_spectrum(size_t row) const;
+
+    /**
+     * Spectrum magnitudes of one row in any encoding; rows never written are NaN
+     * @param out num_bins() values
+     */
+    void decode_spectrum(size_t row, std::span<double> out) const;
+
+private:
+    FeatureTable() = default;
+
+    std::span<const unsigned char> spectrum_bytes(size_t row) const;
+
+    FeatureTableHeader header_;
+    std::vector<std::string> names_;
+    std::vector<std::string> labels_;
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+};
+
+} // namespace cpm
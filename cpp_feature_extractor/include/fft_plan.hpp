@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+namespace cpm {
+
+/**
+ * Precomputed plan for a real-input FFT of any fixed size n.
+ *
+ * For even n the real signal is packed into n/2 complex samples (even
+ * samples as real part, odd samples as imaginary part), transformed with
+ * an n/2-point complex FFT and unpacked into the first n/2 bins of the
+ * n-point spectrum. Odd n runs the n-point complex transform directly.
+ *
+ * The complex transform is chosen from its size:
+ *   - power of two: in-place radix-2 on bit-reversed input, with
+ *     compile-time specialised kernels for n = 1024, 2048, 4096 and 8192
+ *   - 2^a 3^b 5^c: mixed-radix Cooley-Tukey with radix-2/3/4/5 butterflies
+ *   - anything else: Bluestein's chirp-z over a power-of-two convolution
+ *
+ * Twiddle factors and permutations are computed once at construction.
+ * Plans are immutable after construction and safe to share between threads;
+ * non-power-of-two sizes use per-thread scratch buffers.
+ */
+class FFTPlan {
+public:
+    enum class Algorithm {
+        PowerOfTwo,
+        MixedRadix,
+        Bluestein
+    };
+
+    /**
+     * Build a plan
+     * @param n Transform size (must be positive)
+     * @param use_codelets Use the fixed-size kernel when one exists for n
+     */
+    explicit FFTPlan(size_t n, bool use_codelets = true);
+
+    /**
+     * Get a cached plan for the given size, creating it on first use
+     * @param n Transform size (must be positive)
+     */
+    static std::shared_ptr<const FFTPlan> get(size_t n);
+
+    /**
+     * Forward transform of real input
+     * @param input Input samples (at most size()); zero-padded up to size()
+     * @param output Destination for bins [0, size()/2); must hold num_bins() values
+     */
+    void forward_real(std::span<const double> input,
+                      std::span<std::complex<double>> output) const;
+
+    /**
+     * Forward complex DFT of complex_size() points, out of place with
+     * in-order input and output. A complex transform of m points is the
+     * forward_complex of a get(2 * m) plan.
+     * @param input complex_size() input values
+     * @param output Destination for complex_size() values
+     */
+    void forward_complex(std::span<const std::complex<double>> input,
+                         std::span<std::complex<double>> output) const;
+
+    /**
+     * Transform size
+     */
+    size_t size() const { return n_; }
+
+    /**
+     * Number of output bins written by forward_real (size() / 2, rounded down)
+     */
+    size_t num_bins() const { return n_ / 2; }
+
+    /**
+     * Size of the underlying complex transform (size() / 2 for even sizes,
+     * size() for odd)
+     */
+    size_t complex_size() const { return m_; }
+
+    /**
+     * Algorithm used for the complex transform
+     */
+    Algorithm algorithm() const { return algorithm_; }
+
+    /**
+     * True if a fixed-size kernel is used for this size
+     */
+    bool specialized() const { return codelet_ != nullptr; }
+
+private:
+    size_t n_;
+    size_t m_;  // Complex transform size: n/2 for even n, n for odd n
+    Algorithm algorithm_;
+
+    // W_n^k = exp(-2*pi*i*k/n) for k in [0, n/2) (even n)
+    std::vector<std::complex<double>> twiddles_;
+
+    // Power of two: bit-reversal permutation and optional fixed-size kernel
+    std::vector<size_t> bit_reversal_;
+    void (*codelet_)(std::complex<double>*) = nullptr;
+
+    // Mixed radix: factors of m in application order; level f combines
+    // sub-transforms with twiddles W_size^(q*k) stored contiguously per k
+    // from stage_offsets_[f]
+    std::vector<size_t> factors_;
+    std::vector<size_t> stage_offsets_;
+    std::vector<std::complex<double>> stage_twiddles_;
+
+    // Bluestein: chirp exp(-i*pi*k^2/m), spectrum of its conjugate scaled
+    // by 1/M, and the power-of-two plan for the length-M convolution
+    std::vector<std::complex<double>> chirp_;
+    std::vector<std::complex<double>> chirp_spectrum_;
+    std::shared_ptr<const FFTPlan> inner_;
+
+    // Out-of-place m-point complex DFT with in-order input and output
+    void complex_transform(const std::complex<double>* in, std::complex<double>* out) const;
+
+    // In-place complex FFT of size n/2 on bit-reversed input
+    void butterflies(std::complex<double>* x) const;
+
+    // One level of the mixed-radix recursion over a size-point sub-transform
+    void mixed_radix(const std::complex<double>* in, size_t stride, std::complex<double>* out,
+                     size_t factor, size_t size) const;
+
+    void bluestein(const std::complex<double>* in, std::complex<double>* out) const;
+
+    // Unpack the packed half-length spectrum in place (even n)
+    void unpack(std::complex<double>* x) const;
+};
+
+} // namespace cpm
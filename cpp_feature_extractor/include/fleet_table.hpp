@@ -0,0 +1,169 @@
+#pragma once
+
+#include "feature_extractor.hpp"
+#include "feature_store.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * Half-open range of rows [begin, end)
+ */
+struct RowRange {
+    size_t begin = 0;
+    size_t end = 0;
+
+    size_t size() const { return end - begin; }
+    bool empty() const { return begin == end; }
+};
+
+/**
+ * Read-only view of one column of an asset's feature history.
+ *
+ * The view shares ownership of its buffer, so it stays valid (and keeps
+ * showing the rows it was taken with) however many rows are appended
+ * afterwards.
+ */
+struct FleetColumn {
+    std::shared_ptr<const double[]> owner;
+    const double* data = nullptr;
+    size_t rows = 0;
+    size_t width = 1;  // Values per row: 1, num_bands or num_faults
+
+    std::span<const double> values() const { return {data, rows * width}; }
+};
+
+/**
+ * Per-asset, columnar, append-only feature history.
+ *
+ * Each asset has the CPMF scalar columns (feature_table_scalar_columns())
+ * plus "bandpowers" (rows x num_bands) and "fault_amplitudes"
+ * (rows x num_faults), all contiguous float64. Appending extracts only the
+ * new rows, in one extract_batch call, so an update costs O(new rows)
+ * regardless of history length; columns grow geometrically.
+ *
+ * An asset's rows must all come from extractors with the same settings
+ * (feature_config_hash). All methods are thread-safe; extraction runs
+ * outside the table lock.
+ */
+class FleetFeatureTable {
+public:
+    /**
+     * @param store Optional feature store that new rows are extracted
+     *        through, so rows another process already computed are read
+     *        from it; must outlive the table
+     */
+    explicit FleetFeatureTable(FeatureStore* store = nullptr) : store_(store) {}
+
+    /**
+     * Extract features of newly arrived waveforms and append them
+     * @param asset Asset id (created on first append)
+     * @param extractor Extractor; must match the settings of earlier rows
+     * @param data num_rows x row_length samples, row-major
+     * @return Rows that were added
+     * @throws std::invalid_argument if extractor settings differ from earlier rows
+     */
+    RowRange append(const std::string& asset, const FeatureExtractor& extractor,
+                    std::span<const double> data, size_t num_rows, size_t row_length);
+    RowRange append(const std::string& asset, const FeatureExtractor& extractor,
+                    std::span<const float> data, size_t num_rows, size_t row_length);
+    RowRange append(const std::string& asset, const FeatureExtractor& extractor,
+                    std::span<const int16_t> data, double scale, size_t num_rows, size_t row_length);
+
+    /**
+     * Bring an asset up to date with its full waveform history: only rows
+     * past the ones already held (the dirty window) are extracted.
+     * @param data num_rows x row_length samples, oldest row first
+     * @return Rows that were added (empty if the asset was current)
+     * @throws std::invalid_argument if the history is shorter than the table
+     */
+    RowRange update(const std::string& asset, const FeatureExtractor& extractor,
+                    std::span<const double> data, size_t num_rows, size_t row_length);
+    RowRange update(const std::string& asset, const FeatureExtractor& extractor,
+                    std::span<const float> data, size_t num_rows, size_t row_length);
+    RowRange update(const std::string& asset, const FeatureExtractor& extractor,
+                    std::span<const int16_t> data, double scale, size_t num_rows, size_t row_length);
+
+    /**
+     * Rows held for an asset (0 if unknown)
+     */
+    size_t rows(const std::string& asset) const;
+
+    bool contains(const std::string& asset) const;
+    std::vector<std::string> assets() const;
+
+    /**
+     * Drop an asset's history
+     * @return Whether the asset existed
+     */
+    bool erase(const std::string& asset);
+
+    /**
+     * Column of an asset by name: a scalar column, "bandpowers" or "fault_amplitudes"
+     * @throws std::out_of_range for an unknown asset or column
+     */
+    FleetColumn column(const std::string& asset, const std::string& name) const;
+
+    /**
+     * Band and fault names of an asset's rows
+     * @throws std::out_of_range for an unknown asset
+     */
+    BandNames band_names(const std::string& asset) const;
+    BandNames fault_names(const std::string& asset) const;
+
+    /**
+     * Names accepted by column(), in storage order
+     */
+    static const std::vector<std::string>& column_names();
+
+private:
+    // One growable column; a full buffer is replaced, never resized in
+    // place, so outstanding FleetColumn views keep the old one alive
+    struct Column {
+        std::shared_ptr<double[]> data;
+        size_t capacity = 0;  // Rows
+        size_t width = 1;
+
+        void reserve(size_t rows, size_t used);
+    };
+
+    struct History {
+        uint64_t config_hash = 0;
+        size_t num_rows = 0;
+        std::vector<Column> columns;  // Same order as column_names()
+        BandNames band_names;
+        BandNames fault_names;
+    };
+
+    FeatureStore* store_ = nullptr;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, History> assets_;
+
+    const History& find(const std::string& asset) const;  // mutex_ held
+
+    // Append rows [skip, batch.num_rows) of a result to an asset, creating
+    // it if needed; mutex_ held
+    RowRange store(const std::string& asset, uint64_t config_hash, const BatchFeatures& batch,
+                   size_t skip, size_t row_length, double sample_rate);
+
+    template <typename T>
+    BatchFeatures extract_rows(const FeatureExtractor& extractor, std::span<const T> data,
+                               double scale, size_t num_rows, size_t row_length);
+
+    template <typename T>
+    RowRange append_samples(const std::string& asset, const FeatureExtractor& extractor,
+                            std::span<const T> data, double scale, size_t num_rows, size_t row_length);
+
+    template <typename T>
+    RowRange update_samples(const std::string& asset, const FeatureExtractor& extractor,
+                            std::span<const T> data, double scale, size_t num_rows, size_t row_length);
+};
+
+} // namespace cpm
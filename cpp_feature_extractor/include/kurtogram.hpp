@@ -0,0 +1,92 @@
+#pragma once
+
+#include "band_layout.hpp"
+#include <complex>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * Fast kurtogram settings
+ */
+struct KurtogramConfig {
+    size_t max_level = 6;       // Finest level: 2^max_level bands across [0, Nyquist)
+    bool third_levels = true;   // Also levels k + 0.6 with 3 x 2^(k-1) bands (1/3-binary tree)
+    size_t min_band_bins = 8;   // Levels whose bands would hold fewer spectrum bins are skipped
+};
+
+/**
+ * Spectral kurtosis over a tree of frequency bands, and the band that
+ * maximises it. Level l splits [0, Nyquist) into equal bands: 2^l of them
+ * at integer levels and 3 x 2^(l-1) at the k.6 levels in between.
+ */
+struct Kurtogram {
+    std::vector<double> levels;       // Level of each row: 0, 1, 1.6, 2, 2.6, ...
+    std::vector<size_t> offsets;      // Row r is kurtosis[offsets[r], offsets[r + 1])
+    std::vector<double> kurtosis;     // Spectral kurtosis per band, low to high frequency
+    double best_level = 0.0;
+    size_t best_band = 0;             // Band index within the best level
+    double band_low = 0.0;            // Best band in Hz; the demodulation band for envelope analysis
+    double band_high = 0.0;
+    double best_kurtosis = 0.0;
+
+    size_t num_levels() const { return levels.size(); }
+
+    /**
+     * Spectral kurtosis of the bands of row r
+     */
+    std::span<const double> row(size_t r) const {
+        return std::span<const double>(kurtosis).subspan(offsets[r], offsets[r + 1] - offsets[r]);
+    }
+};
+
+/**
+ * Kurtogram and the envelope analysis of its best band, from one transform
+ */
+struct KurtogramEnvelope {
+    Kurtogram kurtogram;
+    std::vector<double> envelope_magnitudes;   // Envelope spectrum of the best band
+    std::vector<double> envelope_frequencies;
+    std::vector<double> fault_amplitudes;      // Defect amplitudes in the best band (with set_envelope())
+    BandNames fault_names;
+};
+
+/**
+ * Fast kurtogram of a one-sided spectrum (Antoni, 2007).
+ *
+ * Works on the same n-point FFT as EnvelopeAnalyzer, so one transform
+ * serves both. Each band is isolated by slicing its bins out of the
+ * spectrum, shifting them to baseband and inverse transforming at a
+ * power-of-two length M at least the band width: the result is the
+ * band's complex envelope c, decimated. Its spectral kurtosis is
+ *
+ *   SK = mean |c|^4 / (mean |c|^2)^2 - 2
+ *
+ * which is about 0 for Gaussian noise, -1 for a steady tone and large for
+ * repetitive impacts, the signature of a bearing defect. All bands of a
+ * level share one M and one inverse FFT plan. DC is excluded.
+ */
+class KurtogramAnalyzer {
+public:
+    /**
+     * @throws std::invalid_argument if min_band_bins is zero
+     */
+    explicit KurtogramAnalyzer(const KurtogramConfig& config = {});
+
+    const KurtogramConfig& config() const { return config_; }
+
+    /**
+     * Kurtogram from a one-sided spectrum
+     * @param spectrum Bins [0, n/2) of the unnormalised n-point FFT
+     * @param n Transform size
+     * @param sample_rate Sample rate in Hz
+     */
+    Kurtogram compute(std::span<const std::complex<double>> spectrum, size_t n, double sample_rate) const;
+
+private:
+    KurtogramConfig config_;
+};
+
+} // namespace cpm
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace cpm {
+
+/**
+ * Running central moments (count, mean and sums of 2nd-4th central powers).
+ *
+ * Samples are added one at a time with Welford's update or whole accumulators
+ * are merged with Pébay's pairwise formulas, so blocks can be reduced
+ * independently and combined without losing precision on signals with a
+ * large DC offset.
+ */
+struct MomentAccumulator {
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;  // Sum of (x - mean)^2
+    double m3 = 0.0;  // Sum of (x - mean)^3
+    double m4 = 0.0;  // Sum of (x - mean)^4
+
+    /**
+     * Add a single sample
+     */
+    void add(double x);
+
+    /**
+     * Merge another accumulator into this one
+     */
+    void merge(const MomentAccumulator& other);
+
+    /**
+     * Accumulate a block of samples with two passes over the block
+     * (block mean, then central powers); blocks should fit in L1
+     */
+    static MomentAccumulator from_block(std::span<const double> block);
+
+    /**
+     * Population variance (m2 / count)
+     */
+    double variance() const;
+
+    /**
+     * Skewness (third moment / variance^1.5), 0 if undefined
+     */
+    double skewness() const;
+
+    /**
+     * Fisher's excess kurtosis (normal = 0), 0 if undefined
+     */
+    double kurtosis() const;
+};
+
+} // namespace cpm
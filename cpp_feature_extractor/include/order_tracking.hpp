@@ -0,0 +1,164 @@
+#pragma once
+
+#include "band_layout.hpp"
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * Windowed-sinc fractional-delay filter bank for band-limited resampling.
+ *
+ * Row p holds the taps that evaluate a signal at p / phases samples past
+ * an integer position, with a low-pass cutoff at cutoff x Nyquist of the
+ * input. Lower cutoffs stretch the kernel: a filter built for cutoff c
+ * has about taps / c taps, so each output averages enough input samples
+ * to suppress what would alias at the lower output rate. Rows sum to one.
+ */
+class PolyphaseFilter {
+public:
+    /**
+     * @param taps Taps at unit cutoff (rounded up to even, at least 4)
+     * @param phases Fractional positions per input sample (at least 1)
+     * @param cutoff Pass band as a fraction of the input Nyquist, in (0, 1]
+     * @throws std::invalid_argument on a cutoff outside (0, 1]
+     */
+    PolyphaseFilter(size_t taps, size_t phases, double cutoff);
+
+    /**
+     * Get a cached filter; the cutoff is rounded down to a multiple of 1/256
+     */
+    static std::shared_ptr<const PolyphaseFilter> get(size_t taps, size_t phases, double cutoff);
+
+    size_t taps() const { return taps_; }
+    size_t phases() const { return phases_; }
+    double cutoff() const { return cutoff_; }
+
+    /**
+     * Taps for fractional position phase / phases (phase in [0, phases]),
+     * applied to input samples [i - taps()/2 + 1, i + taps()/2] around
+     * integer position i
+     */
+    const double* row(size_t phase) const { return coefficients_.data() + phase * taps_; }
+
+    /**
+     * Evaluate a signal at fractional sample positions, treating samples
+     * outside it as zero
+     * @param signal Input samples
+     * @param positions Ascending or not, in input sample units
+     * @param out Destination, same length as positions
+     */
+    void resample(std::span<const double> signal, std::span<const double> positions,
+                  std::span<double> out) const;
+
+private:
+    size_t taps_;
+    size_t phases_;
+    double cutoff_;
+    std::vector<double> coefficients_;  // (phases + 1) x taps, row-major
+};
+
+/**
+ * Order tracking settings
+ */
+struct OrderConfig {
+    size_t samples_per_rev = 64;          // Angular sample rate; orders up to samples_per_rev / 2
+    size_t taps = 16;                     // Interpolation taps at unit cutoff
+    size_t phases = 256;                  // Fractional-delay resolution per input sample
+    std::vector<FrequencyBand> bands;     // Order bands (low/high in orders); empty = OrderTracker::default_bands()
+};
+
+/**
+ * Order spectrum of one signal: magnitudes on a grid of shaft orders
+ * rather than Hz, so harmonics of the shaft stay in the same bins (and
+ * bands) at any speed
+ */
+struct OrderSpectrum {
+    std::vector<double> orders;        // Bin centres in multiples of shaft speed
+    std::vector<double> magnitudes;    // Single-sided amplitude, as compute_fft
+    std::vector<double> band_powers;   // Sum of squared magnitudes per order band
+    BandNames band_names;
+    size_t revolutions = 0;            // Whole shaft revolutions transformed
+    double mean_rpm = 0.0;
+};
+
+/**
+ * Order bands of a batch of equal-length signals, one speed per row
+ */
+struct BatchOrderFeatures {
+    size_t num_rows = 0;
+    size_t num_bands = 0;
+    std::vector<double> band_powers;   // num_rows x num_bands, row-major
+    BandNames band_names;
+    std::vector<size_t> revolutions;   // Whole revolutions per row
+};
+
+/**
+ * Angle-domain resampling and order spectra.
+ *
+ * The shaft angle is integrated from the speed (a constant RPM or an RPM
+ * trace) and the signal is resampled at samples_per_rev equal angle steps
+ * per revolution with a PolyphaseFilter whose cutoff follows the lowest
+ * speed, so nothing above order samples_per_rev / 2 aliases. Only whole
+ * revolutions are transformed: with R of them the order grid has spacing
+ * 1/R and every integer order falls exactly on a bin, so one transform of
+ * R x samples_per_rev points replaces zero-padded high-resolution FFTs for
+ * locating harmonics.
+ */
+class OrderTracker {
+public:
+    explicit OrderTracker(const OrderConfig& config = {});
+
+    /**
+     * Sub-synchronous (0.25-0.75x), 1x, 2x and 3x (each +/- 0.25 orders)
+     * and everything above 3.75x
+     */
+    static BandSet default_bands();
+
+    const OrderConfig& config() const { return config_; }
+    const BandSet& bands() const { return *bands_; }
+    size_t num_bands() const { return bands_->size(); }
+
+    /**
+     * Order spectrum at a constant speed
+     * @param signal Samples
+     * @param sample_rate Sample rate in Hz
+     * @param rpm Shaft speed in revolutions per minute
+     * @throws std::invalid_argument if rpm is not positive
+     */
+    OrderSpectrum compute(std::span<const double> signal, double sample_rate, double rpm) const;
+
+    /**
+     * Order spectrum following a speed trace. The trace is spread evenly
+     * over the signal duration and interpolated linearly, so it may be
+     * sampled with the signal or more coarsely (a single value is a
+     * constant speed).
+     * @throws std::invalid_argument if the trace is empty or not positive
+     */
+    OrderSpectrum compute(std::span<const double> signal, double sample_rate,
+                          std::span<const double> rpm) const;
+
+    /**
+     * Order band powers for one constant speed per row
+     * @param data num_rows x row_length samples, row-major
+     * @param rpm num_rows speeds
+     * @param num_threads Worker threads (0 = all cores)
+     */
+    BatchOrderFeatures compute_batch(std::span<const double> data, double sample_rate,
+                                     std::span<const double> rpm, size_t num_rows,
+                                     size_t row_length, size_t num_threads = 1) const;
+
+private:
+    OrderConfig config_;
+    std::shared_ptr<const BandSet> bands_;
+
+    // Resample into angle_samples (thread scratch) and transform it; returns
+    // the magnitudes and sets the revolution count and mean speed
+    std::span<const double> spectrum(std::span<const double> signal, double sample_rate,
+                                     std::span<const double> rpm, size_t& revolutions,
+                                     double& mean_rpm) const;
+};
+
+} // namespace cpm
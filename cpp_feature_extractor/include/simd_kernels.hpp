@@ -0,0 +1,100 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+namespace cpm {
+namespace simd {
+
+/**
+ * Instruction sets with a kernel implementation
+ */
+enum class Isa {
+    Scalar,
+    AVX2,
+    AVX512,
+    NEON
+};
+
+/**
+ * Table of reduction kernels used on the FeatureExtractor hot path.
+ * Every instruction set provides the same entries; results agree with the
+ * scalar reference up to floating-point reassociation.
+ */
+struct Kernels {
+    Isa isa;
+
+    // sum(x), sum(x^2), max(|x|)
+    void (*raw_sums)(const double* x, size_t n,
+                     double& sum, double& sum_sq, double& max_abs);
+
+    // sum((x - mean)^k) for k = 2, 3, 4
+    void (*central_moments)(const double* x, size_t n, double mean,
+                            double& m2, double& m3, double& m4);
+
+    // sum(x^2)
+    double (*sum_squares)(const double* x, size_t n);
+
+    // sum(a * b)
+    double (*dot)(const double* a, const double* b, size_t n);
+
+    // max(|x|)
+    double (*max_abs)(const double* x, size_t n);
+
+    // out[i] = |spectrum[i]| * scale
+    void (*magnitudes)(const std::complex<double>* spectrum, size_t n,
+                       double scale, double* out);
+
+    // total = sum(m^2), weighted = sum(f * m^2)
+    void (*power_moments)(const double* mags, const double* freqs, size_t n,
+                          double& total, double& weighted);
+
+    // total = sum(m^2), weighted_var = sum((f - centroid)^2 * m^2)
+    void (*power_spread)(const double* mags, const double* freqs, size_t n,
+                         double centroid, double& total, double& weighted_var);
+
+    // out[i] = x[i], float32 samples widened for the double pipeline
+    void (*widen_f32)(const float* x, size_t n, double* out);
+
+    // out[i] = x[i] * scale, int16 ADC counts to physical units
+    void (*widen_i16)(const int16_t* x, size_t n, double scale, double* out);
+
+    // out[i] = binary16 bits of float(x[i] * scale), rounded to nearest even
+    void (*narrow_f16)(const double* x, size_t n, double scale, uint16_t* out);
+
+    // out[i] = half(x[i]) * scale, binary16 codes back to double
+    void (*widen_f16)(const uint16_t* x, size_t n, double scale, double* out);
+};
+
+/**
+ * Kernels selected for this CPU. Chosen once at first use: the widest
+ * supported instruction set, unless overridden by the CPM_SIMD environment
+ * variable ("scalar", "avx2", "avx512", "neon") or set_active().
+ */
+const Kernels& active();
+
+/**
+ * Portable scalar reference kernels
+ */
+const Kernels& scalar();
+
+/**
+ * Kernels for a specific instruction set, or nullptr if it was not
+ * compiled in or the CPU does not support it
+ */
+const Kernels* kernels_for(Isa isa);
+
+/**
+ * Switch the active kernels (e.g. to the scalar path for testing)
+ * @return false if the instruction set is unavailable
+ */
+bool set_active(Isa isa);
+
+/**
+ * Instruction set name ("scalar", "avx2", "avx512", "neon")
+ */
+const char* isa_name(Isa isa);
+
+} // namespace simd
+} // namespace cpm
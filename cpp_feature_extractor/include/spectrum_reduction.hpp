@@ -0,0 +1,89 @@
+#pragma once
+
+#include "feature_extractor.hpp"
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * How a spectrum is thinned to a point budget
+ */
+enum class Decimation {
+    MinMax,  // Smallest and largest magnitude of each bucket, in bin order
+    LTTB     // Largest-Triangle-Three-Buckets: one point per bucket, shape preserving
+};
+
+/**
+ * Parse "minmax" or "lttb"
+ * @throws std::invalid_argument for other names
+ */
+Decimation parse_decimation(const std::string& name);
+
+/**
+ * Spectrum reduction settings
+ */
+struct SpectrumReductionConfig {
+    size_t points = 256;                     // Output points (0 = keep every bin)
+    Decimation method = Decimation::MinMax;
+    bool log_frequency = false;              // Resample onto log-spaced frequencies instead
+    double min_frequency = 0.0;              // Lowest log-grid frequency (0 = first bin above DC)
+    size_t num_peaks = 0;                    // Largest local maxima to report
+};
+
+/**
+ * A local maximum of the magnitude spectrum
+ */
+struct SpectralPeak {
+    size_t bin;
+    double frequency;
+    double magnitude;
+};
+
+/**
+ * Spectrum thinned for display plus summary values of the full spectrum
+ */
+struct ReducedSpectrum {
+    std::vector<double> frequencies;
+    std::vector<double> magnitudes;
+    std::vector<SpectralPeak> peaks;  // Descending magnitude, DC excluded
+    size_t num_bins = 0;              // Bins of the full spectrum
+    double dominant_frequency = 0.0;  // Frequency of the largest bin above DC
+    double dominant_magnitude = 0.0;
+    double total_power = 0.0;         // Sum of squared magnitudes, DC included
+};
+
+/**
+ * Reduce a magnitude spectrum to at most config.points points.
+ *
+ * Linear mode decimates the bins: MinMax keeps the extremes of each of
+ * points/2 buckets, so no peak is lost between rendered pixels (a budget
+ * of one point keeps the largest bin), and LTTB
+ * keeps the first and last bins and the point of each bucket that spans
+ * the largest triangle with its neighbours. Log mode resamples onto
+ * config.points log-spaced frequencies from min_frequency to the last bin,
+ * taking the largest magnitude among bins that fall in each log bucket and
+ * interpolating linearly where a bucket is narrower than the bin spacing.
+ *
+ * Peaks and the dominant frequency come from the full spectrum.
+ * @param frequencies Bin frequencies, ascending
+ * @param magnitudes Magnitudes, same length
+ * @throws std::invalid_argument on mismatched lengths
+ */
+ReducedSpectrum reduce_spectrum(std::span<const double> frequencies, std::span<const double> magnitudes,
+                                const SpectrumReductionConfig& config);
+
+/**
+ * Reduce the spectrum of an extraction result (fft_frequencies / fft_magnitude)
+ */
+ReducedSpectrum reduce_spectrum(const SignalFeatures& features, const SpectrumReductionConfig& config);
+
+/**
+ * The num_peaks largest local maxima above DC, descending by magnitude
+ */
+std::vector<SpectralPeak> find_peaks(std::span<const double> frequencies, std::span<const double> magnitudes,
+                                     size_t num_peaks);
+
+} // namespace cpm
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Built with -DENABLE_STATS=ON (CMake) to define CPM_ENABLE_STATS=1. When it
+// is off, the recording macros expand to nothing and snapshot() stays zero.
+#ifndef CPM_ENABLE_STATS
+#define CPM_ENABLE_STATS 0
+#endif
+
+namespace cpm::stats {
+
+/**
+ * Instrumented stages of the extraction pipeline.
+ *
+ * Extract and Batch cover whole calls and include the stages below them;
+ * the others do not nest, except that Envelope and Kurtogram include their
+ * own FFTs and Magnitudes includes the segment FFTs in Welch mode.
+ */
+enum class Stage : uint8_t {
+    Extract,        // One extract_all call
+    Batch,          // One extract_batch call
+    TimeStats,      // Fused time-domain pass (widening of narrow blocks included)
+    Widen,          // Full-signal float32/int16 to double conversion
+    FFT,            // FFTPlan::forward_real and forward_complex
+    Magnitudes,     // Magnitude or Welch-averaged spectrum from FFT bins
+    SpectralShape,  // Spectral centroid and spread
+    Bandpower,      // Band power accumulation
+    Envelope,       // Envelope spectrum and fault amplitudes
+    Resample,       // Angle-domain resampling for order tracking
+    Kurtogram,      // Spectral kurtosis band transforms
+    PythonInput,    // Copies made by the Python bindings to get float64 C arrays
+    Count
+};
+
+constexpr size_t NUM_STAGES = static_cast<size_t>(Stage::Count);
+
+/**
+ * Totals for one stage
+ */
+struct StageStats {
+    uint64_t calls = 0;
+    uint64_t nanoseconds = 0;
+    uint64_t cycles = 0;  // Time-stamp counter ticks on x86, 0 elsewhere
+    uint64_t bytes = 0;   // Input bytes processed
+};
+
+/**
+ * Counters summed over all threads, since start-up or the last reset()
+ */
+struct Snapshot {
+    std::array<StageStats, NUM_STAGES> stages{};
+    uint64_t plan_cache_hits = 0;
+    uint64_t plan_cache_misses = 0;
+
+    const StageStats& operator[](Stage stage) const {
+        return stages[static_cast<size_t>(stage)];
+    }
+
+    /**
+     * Fraction of FFTPlan::get lookups served from the cache (0 if none)
+     */
+    double plan_cache_hit_rate() const {
+        const uint64_t lookups = plan_cache_hits + plan_cache_misses;
+        return lookups ? static_cast<double>(plan_cache_hits) / static_cast<double>(lookups) : 0.0;
+    }
+};
+
+/**
+ * Whether the library was built with instrumentation
+ */
+constexpr bool enabled() { return CPM_ENABLE_STATS != 0; }
+
+/**
+ * Lower-case stage name ("extract", "time_stats", "fft", ...)
+ */
+const char* stage_name(Stage stage);
+
+/**
+ * Sum the counters of every thread. Writers never block; a snapshot taken
+ * while other threads record may miss their latest few updates.
+ */
+Snapshot snapshot();
+
+/**
+ * Start counting from zero again
+ */
+void reset();
+
+/**
+ * Current tick count: the time-stamp counter on x86, steady-clock
+ * nanoseconds elsewhere. snapshot() converts ticks to both units.
+ */
+uint64_t ticks();
+
+/**
+ * Add one call of a stage, started at start_ticks, to this thread's counters
+ */
+void record(Stage stage, uint64_t start_ticks, uint64_t bytes);
+
+/**
+ * Count one plan cache lookup on this thread
+ */
+void record_plan_lookup(bool hit);
+
+/**
+ * Times the enclosing scope as one call of a stage
+ */
+class ScopedStage {
+public:
+    ScopedStage(Stage stage, size_t bytes) : stage_(stage), bytes_(bytes), start_(ticks()) {}
+    ~ScopedStage() { record(stage_, start_, bytes_); }
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+private:
+    Stage stage_;
+    uint64_t bytes_;
+    uint64_t start_;
+};
+
+} // namespace cpm::stats
+
+#if CPM_ENABLE_STATS
+#define CPM_STATS_CONCAT_(a, b) a##b
+#define CPM_STATS_CONCAT(a, b) CPM_STATS_CONCAT_(a, b)
+#define CPM_STATS_STAGE(stage, bytes) \
+    ::cpm::stats::ScopedStage CPM_STATS_CONCAT(cpm_stats_stage_, __LINE__)(::cpm::stats::Stage::stage, (bytes))
+#define CPM_STATS_PLAN_LOOKUP(hit) ::cpm::stats::record_plan_lookup(hit)
+#else
+#define CPM_STATS_STAGE(stage, bytes) static_cast<void>(0)
+#define CPM_STATS_PLAN_LOOKUP(hit) static_cast<void>(0)
+#endif
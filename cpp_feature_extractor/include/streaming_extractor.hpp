@@ -0,0 +1,112 @@
+#pragma once
+
+#include "feature_extractor.hpp"
+#include <functional>
+
+namespace cpm {
+
+/**
+ * How the streaming extractor refreshes the spectrum on each hop
+ */
+enum class SpectrumUpdate {
+    Auto,       // Sliding DFT for very small hops, FFT otherwise
+    FFT,        // Full real FFT of the window on every hop
+    SlidingDFT  // Per-sample bin update, resynchronised once per window
+};
+
+/**
+ * Sliding-window feature extractor for continuous sample streams.
+ *
+ * Samples arrive in arbitrary chunks through push(). Once window_size
+ * samples have been seen, features are emitted every hop_size samples
+ * for the most recent window_size samples, and match extract_all() on
+ * that window.
+ *
+ * Samples are written once into a mirrored ring buffer so the window is
+ * always contiguous without re-copying. Time-domain moments are kept per
+ * hop-sized block and merged (Pébay), so each hop only scans the new
+ * samples. The spectrum is either recomputed with the cached FFT plan or
+ * updated per sample with a sliding DFT that is resynchronised once per
+ * window length.
+ */
+class StreamingFeatureExtractor {
+public:
+    using Callback = std::function<void(const SignalFeatures&)>;
+
+    /**
+     * Constructor
+     * @param sample_rate Sample rate in Hz
+     * @param window_size Samples per analysis window
+     * @param hop_size Samples between emitted windows (must divide window_size)
+     * @param update Spectrum update strategy
+     */
+    StreamingFeatureExtractor(double sample_rate, size_t window_size, size_t hop_size,
+                              SpectrumUpdate update = SpectrumUpdate::Auto);
+
+    /**
+     * Push a chunk of samples
+     * @param samples New samples in arrival order
+     * @param on_features Called for each completed window; the reference is
+     *                    only valid for the duration of the call
+     * @return Number of windows emitted
+     */
+    size_t push(std::span<const double> samples, const Callback& on_features);
+
+    /**
+     * Push a chunk of samples and collect the emitted features
+     */
+    std::vector<SignalFeatures> push(std::span<const double> samples);
+
+    /**
+     * Discard all buffered samples
+     */
+    void reset();
+
+    size_t window_size() const { return window_size_; }
+    size_t hop_size() const { return hop_size_; }
+    size_t samples_seen() const { return samples_seen_; }
+
+    /**
+     * True if the sliding DFT is used to update the spectrum
+     */
+    bool uses_sliding_dft() const { return sliding_dft_; }
+
+private:
+    struct BlockStats {
+        MomentAccumulator moments;
+        double sum_sq = 0.0;
+        double max_abs = 0.0;
+    };
+
+    FeatureExtractor extractor_;
+    size_t window_size_;
+    size_t hop_size_;
+    bool sliding_dft_;
+
+    // Mirrored ring: sample i is stored at i and i + window_size_, so the
+    // current window is always buffer_[write_pos_, write_pos_ + window_size_)
+    std::vector<double> buffer_;
+    size_t write_pos_ = 0;
+    size_t samples_seen_ = 0;
+    size_t samples_in_hop_ = 0;
+
+    // Per-hop statistics for the blocks making up the window
+    std::vector<BlockStats> blocks_;
+    size_t next_block_ = 0;
+
+    // Spectrum state
+    std::shared_ptr<const FFTPlan> plan_;
+    std::vector<std::complex<double>> bins_;
+    std::vector<std::complex<double>> rotations_;  // e^{+2 pi i k / N}
+    std::shared_ptr<const BandLayout> layout_;
+    size_t samples_since_resync_ = 0;
+
+    // Reused output record
+    SignalFeatures features_;
+
+    void push_sample(double x);
+    void close_block();
+    void emit();
+};
+
+} // namespace cpm
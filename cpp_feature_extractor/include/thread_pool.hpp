@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <cstddef>
+
+namespace cpm {
+
+/**
+ * Fixed-size work-stealing thread pool.
+ *
+ * Each worker owns a task deque. Workers pop their own tasks LIFO and,
+ * when empty, steal FIFO from the other workers. Tasks receive the index
+ * of the worker that runs them so callers can keep per-worker scratch
+ * buffers without locking.
+ *
+ * parallel_for must not be called from inside a pool task.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void(size_t worker)>;
+
+    /**
+     * Constructor
+     * @param num_threads Number of workers (0 = hardware concurrency)
+     */
+    explicit ThreadPool(size_t num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Get a process-wide pool with the given worker count, creating it on first use
+     * @param num_threads Number of workers (0 = hardware concurrency)
+     */
+    static std::shared_ptr<ThreadPool> shared(size_t num_threads);
+
+    /**
+     * Resolve a requested thread count (0 = hardware concurrency, at least 1)
+     */
+    static size_t resolve_threads(size_t num_threads);
+
+    /**
+     * Whether the calling thread is a worker of any ThreadPool
+     */
+    static bool on_worker_thread();
+
+    /**
+     * Run body(begin, end, worker) over [0, count) in chunks of at most
+     * grain items and block until all chunks have finished. The first
+     * exception thrown by a chunk is rethrown here.
+     */
+    void parallel_for(size_t count, size_t grain,
+                      const std::function<void(size_t begin, size_t end, size_t worker)>& body);
+
+    /**
+     * Number of worker threads
+     */
+    size_t size() const { return workers_.size(); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> next_queue_{0};
+    bool stopping_ = false;
+
+    void push(Task task);
+    bool try_pop(size_t worker, Task& task);
+    void worker_loop(size_t worker);
+};
+
+} // namespace cpm
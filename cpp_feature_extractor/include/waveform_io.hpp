@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * Sample encodings for binary waveform files (all little-endian)
+ */
+enum class SampleType : uint16_t {
+    Float32 = 1,
+    Float64 = 2,
+    Int16 = 3
+};
+
+/**
+ * Bytes per sample of a SampleType
+ */
+size_t sample_size(SampleType type);
+
+/**
+ * Parse a sample type name: "f32", "f64" or "i16"
+ */
+SampleType parse_sample_type(const std::string& name);
+
+/**
+ * Header of the CPMW binary waveform format. The file is this 40-byte
+ * header followed by num_frames * channels interleaved samples.
+ */
+struct WaveformHeader {
+    char magic[4] = {'C', 'P', 'M', 'W'};
+    uint16_t version = 1;
+    uint16_t sample_type = static_cast<uint16_t>(SampleType::Float64);
+    uint32_t channels = 1;
+    uint32_t reserved = 0;
+    double sample_rate = 0.0;
+    double scale = 1.0;        // Physical units per count (int16 only)
+    uint64_t num_frames = 0;
+};
+
+static_assert(sizeof(WaveformHeader) == 40, "WaveformHeader must be packed to 40 bytes");
+
+/**
+ * Read-only memory-mapped binary waveform.
+ *
+ * Raw files hold bare interleaved samples of one type; CPMW files carry a
+ * WaveformHeader with sample rate, channel count and type. Single-channel
+ * float64 data is exposed directly as a span over the mapped pages;
+ * other layouts are converted to double in one pass on request.
+ */
+class MappedWaveform {
+public:
+    /**
+     * Map a headerless file of little-endian samples
+     * @param path File path
+     * @param type Sample encoding
+     * @param channels Interleaved channel count
+     */
+    static MappedWaveform open_raw(const std::string& path, SampleType type, size_t channels = 1);
+
+    /**
+     * Map a CPMW file, validating its header
+     */
+    static MappedWaveform open(const std::string& path);
+
+    /**
+     * True if the file starts with the CPMW magic
+     */
+    static bool has_header(const std::string& path);
+
+    /**
+     * Write samples as a CPMW file
+     * @param path Output path
+     * @param samples Interleaved samples (num_frames * channels)
+     * @param channels Interleaved channel count
+     * @param sample_rate Sample rate in Hz
+     */
+    static void write(const std::string& path, std::span<const double> samples,
+                      size_t channels, double sample_rate);
+
+    MappedWaveform(MappedWaveform&& other) noexcept;
+    MappedWaveform& operator=(MappedWaveform&& other) noexcept;
+    MappedWaveform(const MappedWaveform&) = delete;
+    MappedWaveform& operator=(const MappedWaveform&) = delete;
+    ~MappedWaveform();
+
+    SampleType sample_type() const { return type_; }
+    size_t num_channels() const { return channels_; }
+    size_t num_frames() const { return frames_; }
+
+    /**
+     * Sample rate from the header (0 for raw files)
+     */
+    double sample_rate() const { return sample_rate_; }
+
+    /**
+     * True if channel() returns views into the mapping without conversion
+     */
+    bool zero_copy() const;
+
+    /**
+     * Samples of one channel as doubles
+     * @param index Channel index
+     * @param storage Used for converted samples when zero_copy() is false
+     * @return View over the mapping or over storage
+     */
+    std::span<const double> channel(size_t index, std::vector<double>& storage) const;
+
+    /**
+     * Samples of a single-channel float32 file as stored (empty otherwise)
+     */
+    std::span<const float> float_samples() const;
+
+    /**
+     * Samples of a single-channel int16 file as stored (empty otherwise);
+     * multiply by scale() for physical units
+     */
+    std::span<const int16_t> int16_samples() const;
+
+    /**
+     * Physical units per count of int16 samples (1 for raw files)
+     */
+    double scale() const { return scale_; }
+
+    /**
+     * Raw interleaved sample bytes
+     */
+    const unsigned char* data() const { return data_; }
+
+private:
+    MappedWaveform() = default;
+
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    const unsigned char* data_ = nullptr;
+    SampleType type_ = SampleType::Float64;
+    size_t channels_ = 1;
+    size_t frames_ = 0;
+    double sample_rate_ = 0.0;
+    double scale_ = 1.0;
+
+    void map_file(const std::string& path);
+};
+
+/**
+ * Append the numeric samples in CSV text to out. Values are separated by
+ * commas or newlines with surrounding whitespace ignored; tokens that are
+ * not numbers (headers, labels) are skipped.
+ */
+void parse_csv_samples(std::string_view text, std::vector<double>& out);
+
+/**
+ * Read every numeric sample from a CSV file in file order.
+ * The file is read in fixed-size chunks and parsed with std::from_chars.
+ * With more than one thread, large files are split at newline boundaries
+ * and the pieces are parsed in parallel on the shared pool.
+ * @param path File path
+ * @param num_threads Parser threads (0 = all cores)
+ */
+std::vector<double> read_csv_signal(const std::string& path, size_t num_threads = 1);
+
+} // namespace cpm
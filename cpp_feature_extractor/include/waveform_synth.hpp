@@ -0,0 +1,99 @@
+#pragma once
+
+#include "feature_extractor.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * Philox4x32-10 counter-based generator (Salmon et al., SC'11).
+ *
+ * The output is a pure function of a 128-bit counter and a 64-bit key,
+ * so any draw can be computed directly from its index: rows synthesised
+ * on different threads, or in different chunks, get the same numbers.
+ */
+struct Philox4x32 {
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    static Counter generate(Counter counter, Key key);
+};
+
+/**
+ * Vibration waveform model of the backend simulator
+ */
+struct SynthesisConfig {
+    double sample_rate = 5000.0;
+    size_t samples = 2048;               // Samples per waveform
+    uint64_t seed = 42;
+    size_t max_harmonic = 5;             // Harmonics 2..max_harmonic, wear-scaled
+    double bpfo_order = 3.5;             // Outer-race defect line, multiple of shaft speed
+    double defect_wear = 0.3;            // Wear fraction above which the defect line appears
+    double impact_probability = 0.05;    // Chance of one decaying impact per waveform
+    size_t impact_length = 50;           // Impact duration in samples
+    double impact_decay = 10.0;          // Samples per e-fold of the impact
+};
+
+/**
+ * Parallel synthesis of simulator waveforms.
+ *
+ * Row i of a timestep series with vibration level v, speed s (RPM) and wear
+ * w (percent) is, with amp = v / 10, f0 = s / 60 and wf = w / 100:
+ *
+ *   amp sin(2 pi f0 t)
+ *   + sum_h amp wf 0.5^h U(0.5, 1.5) sin(2 pi h f0 t + U(0, 2 pi))
+ *   + amp wf 0.3 sin(2 pi bpfo_order f0 t)          (if wf > defect_wear)
+ *   + N(0, (0.1 + 0.2 wf) amp)
+ *   + 2 amp exp(-k / impact_decay)                   (an occasional impact)
+ *
+ * Sines are evaluated in blocks: a table of the tone over one block and
+ * an exact phase at each block start, combined with the angle-addition
+ * identity in a loop the compiler vectorises. Noise uses Box-Muller on
+ * Philox draws keyed by (seed, row), so output does not depend on the
+ * thread count or on how rows are split into calls.
+ */
+class WaveformSynthesizer {
+public:
+    explicit WaveformSynthesizer(const SynthesisConfig& config = {});
+
+    const SynthesisConfig& config() const { return config_; }
+
+    /**
+     * Synthesise one row
+     * @param row Row index (selects the random stream)
+     * @param out Destination for config().samples values
+     */
+    void generate_row(size_t row, double vibration_level, double speed, double wear,
+                      std::span<double> out) const;
+
+    /**
+     * Synthesise a rows x samples matrix, row-major
+     * @param first_row Index of the first row, so a series can be produced in chunks
+     * @param num_threads Worker threads (0 = all cores)
+     * @throws std::invalid_argument on inputs of different lengths
+     */
+    std::vector<double> generate(std::span<const double> vibration_levels, std::span<const double> speeds,
+                                 std::span<const double> wear_levels, size_t first_row = 0,
+                                 size_t num_threads = 0) const;
+
+    /**
+     * Synthesise rows and extract their features without materialising the
+     * matrix: each extractor worker fills one row buffer and extracts it
+     * in place. Same result as extract_batch on generate() output.
+     */
+    BatchFeatures extract(const FeatureExtractor& extractor, std::span<const double> vibration_levels,
+                          std::span<const double> speeds, std::span<const double> wear_levels,
+                          size_t first_row = 0) const;
+
+private:
+    SynthesisConfig config_;
+
+    template <typename Body>
+    void for_rows(size_t num_rows, size_t num_threads, const Body& body) const;
+};
+
+} // namespace cpm
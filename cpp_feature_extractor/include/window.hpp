@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cpm {
+
+/**
+ * Spectral analysis windows (periodic form, as scipy.signal.get_window)
+ */
+enum class WindowFunction {
+    Rectangular,
+    Hann,
+    Hamming,
+    Blackman
+};
+
+/**
+ * Parse a window name: "rectangular" (or "boxcar"), "hann", "hamming", "blackman"
+ */
+WindowFunction parse_window(const std::string& name);
+
+/**
+ * Precomputed window coefficients for one length
+ */
+class WindowTable {
+public:
+    WindowTable(WindowFunction function, size_t length);
+
+    /**
+     * Get a cached table, creating it on first use
+     */
+    static std::shared_ptr<const WindowTable> get(WindowFunction function, size_t length);
+
+    WindowFunction function() const { return function_; }
+    size_t size() const { return values_.size(); }
+    std::span<const double> values() const { return values_; }
+
+    /**
+     * Sum of coefficients (coherent gain times length)
+     */
+    double sum() const { return sum_; }
+
+    /**
+     * Sum of squared coefficients (noise power gain times length)
+     */
+    double sum_squares() const { return sum_squares_; }
+
+private:
+    WindowFunction function_;
+    std::vector<double> values_;
+    double sum_ = 0.0;
+    double sum_squares_ = 0.0;
+};
+
+} // namespace cpm
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cpm {
+
+/**
+ * XXH64 hash of a byte buffer (Yann Collet's xxHash, 64-bit variant).
+ *
+ * Output matches the reference implementation for the same seed, so keys
+ * written by other tools (python-xxhash, xxhsum) compare equal.
+ */
+uint64_t xxh64(const void* data, size_t size, uint64_t seed = 0);
+
+} // namespace cpm
@@ -0,0 +1,194 @@
+#include "band_layout.hpp"
+#include "simd_kernels.hpp"
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace cpm {
+
+namespace {
+
+// Nominal label for a band centre, e.g. "63 Hz", "1.25 kHz"
+std::string centre_label(double centre) {
+    std::ostringstream ss;
+    ss.precision(3);
+    if (centre >= 1000.0) {
+        ss << centre / 1000.0 << " kHz";
+    } else {
+        ss << centre << " Hz";
+    }
+    return ss.str();
+}
+
+BandSet fractional_octave(double f_low, double f_high, int fraction) {
+    if (f_low <= 0 || f_high < f_low) {
+        throw std::invalid_argument("Octave band range must satisfy 0 < f_low <= f_high");
+    }
+
+    const double step = 1.0 / static_cast<double>(fraction);
+    const double half = std::pow(2.0, step / 2.0);
+
+    // Centre index k gives 1 kHz * 2^(k / fraction)
+    const int k_min = static_cast<int>(std::ceil(std::log2(f_low / 1000.0) * fraction - 1e-9));
+    const int k_max = static_cast<int>(std::floor(std::log2(f_high / 1000.0) * fraction + 1e-9));
+
+    std::vector<FrequencyBand> bands;
+    for (int k = k_min; k <= k_max; ++k) {
+        double centre = 1000.0 * std::pow(2.0, k * step);
+        bands.push_back({centre_label(centre), centre / half, centre * half});
+    }
+    return BandSet(std::move(bands));
+}
+
+} // namespace
+
+BandNames::BandNames(std::vector<std::string> names)
+    : names_(std::make_shared<const std::vector<std::string>>(std::move(names))) {}
+
+const std::vector<std::string>& BandNames::vector() const {
+    static const std::vector<std::string> empty;
+    return names_ ? *names_ : empty;
+}
+
+BandSet::BandSet(std::vector<FrequencyBand> bands) : bands_(std::move(bands)) {
+    std::vector<std::string> names;
+    names.reserve(bands_.size());
+    for (const auto& b : bands_) {
+        if (!(b.low < b.high)) {
+            throw std::invalid_argument("Band '" + b.name + "' must have low < high");
+        }
+        names.push_back(b.name);
+    }
+    names_ = BandNames(std::move(names));
+}
+
+BandSet BandSet::defaults() {
+    return BandSet({
+        {"0-100 Hz", 0.0, 100.0},
+        {"100-500 Hz", 100.0, 500.0},
+        {"500-1000 Hz", 500.0, 1000.0},
+        {"1000-2000 Hz", 1000.0, 2000.0},
+        {"2000+ Hz", 2000.0, 10000.0}  // Up to Nyquist for 5kHz
+    });
+}
+
+std::shared_ptr<const BandSet> BandSet::shared_defaults() {
+    static const std::shared_ptr<const BandSet> instance =
+        std::make_shared<const BandSet>(defaults());
+    return instance;
+}
+
+BandSet BandSet::octave(double f_low, double f_high) {
+    return fractional_octave(f_low, f_high, 1);
+}
+
+BandSet BandSet::third_octave(double f_low, double f_high) {
+    return fractional_octave(f_low, f_high, 3);
+}
+
+BandSet BandSet::bearing_faults(double shaft_hz, const BearingFaultOrders& orders,
+                                size_t harmonics, double half_width_hz) {
+    if (shaft_hz <= 0 || half_width_hz <= 0) {
+        throw std::invalid_argument("Shaft frequency and band half-width must be positive");
+    }
+
+    const std::pair<const char*, double> defects[] = {
+        {"BPFO", orders.bpfo},
+        {"BPFI", orders.bpfi},
+        {"BSF", orders.bsf},
+        {"FTF", orders.ftf},
+    };
+
+    std::vector<FrequencyBand> bands;
+    for (const auto& [label, order] : defects) {
+        if (order <= 0) {
+            continue;  // Defect not specified
+        }
+        for (size_t h = 1; h <= harmonics; ++h) {
+            double centre = shaft_hz * order * static_cast<double>(h);
+            bands.push_back({std::string(label) + " " + std::to_string(h) + "x",
+                             std::max(0.0, centre - half_width_hz), centre + half_width_hz});
+        }
+    }
+    return BandSet(std::move(bands));
+}
+
+BandLayout::BandLayout(const BandSet& bands, double sample_rate, size_t fft_size, size_t num_bins) {
+    // Same grid expression as FeatureExtractor::compute_fft, so range edges
+    // agree exactly with a per-bin comparison
+    const double freq_resolution = sample_rate / static_cast<double>(fft_size);
+    auto first_bin_at_least = [&](double f) {
+        size_t lo = 0, hi = num_bins;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (static_cast<double>(mid) * freq_resolution < f) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    };
+
+    ranges_.reserve(bands.size());
+    for (const auto& b : bands.bands()) {
+        size_t begin = first_bin_at_least(b.low);
+        size_t end = std::max(begin, first_bin_at_least(b.high));
+        ranges_.emplace_back(begin, end);
+    }
+}
+
+std::shared_ptr<const BandLayout> BandLayout::get(const std::shared_ptr<const BandSet>& bands,
+                                                  double sample_rate, size_t fft_size,
+                                                  size_t num_bins) {
+    using Key = std::tuple<const BandSet*, double, size_t, size_t>;
+    struct Entry {
+        std::shared_ptr<const BandSet> bands;  // Keeps the key pointer unique
+        std::shared_ptr<const BandLayout> layout;
+    };
+
+    const Key key{bands.get(), sample_rate, fft_size, num_bins};
+
+    thread_local Key last_key{nullptr, 0.0, 0, 0};
+    thread_local Entry last;
+    if (last.layout && last_key == key) {
+        return last.layout;
+    }
+
+    // Band sets built per waveform (e.g. speed-dependent bearing bands)
+    // would grow the cache without bound, so cap it
+    constexpr size_t MAX_ENTRIES = 256;
+
+    static std::mutex mutex;
+    static std::map<Key, Entry> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        if (cache.size() >= MAX_ENTRIES) {
+            cache.clear();
+        }
+        Entry entry{bands, std::make_shared<const BandLayout>(*bands, sample_rate, fft_size, num_bins)};
+        it = cache.emplace(key, std::move(entry)).first;
+    }
+
+    last_key = key;
+    last = it->second;
+    return last.layout;
+}
+
+void BandLayout::accumulate(std::span<const double> magnitudes, std::span<double> out) const {
+    // Each disjoint band touches its bins once, so vectorised range sums do
+    // the same work as prefix-sum differences without the serial scan
+    const auto& k = simd::active();
+    for (size_t b = 0; b < ranges_.size(); ++b) {
+        size_t begin = std::min(ranges_[b].first, magnitudes.size());
+        size_t end = std::min(ranges_[b].second, magnitudes.size());
+        out[b] += k.sum_squares(magnitudes.data() + begin, end - begin);
+    }
+}
+
+} // namespace cpm
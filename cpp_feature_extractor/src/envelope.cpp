@@ -0,0 +1,156 @@
+#include "envelope.hpp"
+#include "fft_plan.hpp"
+#include "simd_kernels.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace cpm {
+
+namespace {
+
+// Smallest even 2^a 3^b 5^c length >= n
+size_t next_even_smooth(size_t n) {
+    for (size_t m = std::max<size_t>(2, n + (n & 1));; m += 2) {
+        size_t r = m;
+        for (size_t p : {2, 3, 5}) {
+            while (r % p == 0) r /= p;
+        }
+        if (r == 1) return m;
+    }
+}
+
+// Per-thread buffers, kept for the last envelope length used
+struct EnvelopeScratch {
+    size_t size = 0;
+    std::shared_ptr<const FFTPlan> inverse;   // Complex M-point transform
+    std::shared_ptr<const FFTPlan> forward;   // Real M-point transform
+    std::vector<std::complex<double>> band;
+    std::vector<std::complex<double>> analytic;
+    std::vector<double> envelope;
+    std::vector<std::complex<double>> envelope_spectrum;
+    std::vector<double> magnitudes;
+};
+
+EnvelopeScratch& scratch_for(size_t size) {
+    thread_local EnvelopeScratch scratch;
+    if (scratch.size != size) {
+        scratch.size = size;
+        scratch.inverse = FFTPlan::get(2 * size);
+        scratch.forward = FFTPlan::get(size);
+        scratch.band.resize(size);
+        scratch.analytic.resize(size);
+        scratch.envelope.resize(size);
+        scratch.envelope_spectrum.resize(size / 2);
+        scratch.magnitudes.resize(size / 2);
+    }
+    return scratch;
+}
+
+} // namespace
+
+EnvelopeAnalyzer::EnvelopeAnalyzer(const EnvelopeConfig& config)
+    : config_(config),
+      faults_(std::make_shared<const BandSet>(
+          BandSet::bearing_faults(config.shaft_hz, config.orders, config.harmonics,
+                                  config.half_width_hz))) {
+    if (config.band_low < 0 || config.band_high <= config.band_low) {
+        throw std::invalid_argument("Envelope band must satisfy 0 <= low < high");
+    }
+}
+
+std::span<const double> EnvelopeAnalyzer::compute(
+    std::span<const std::complex<double>> spectrum, size_t n, double sample_rate,
+    size_t& envelope_size) const {
+
+    CPM_STATS_STAGE(Envelope, spectrum.size_bytes());
+    const double df = sample_rate / static_cast<double>(n);
+    const size_t bins = std::min(spectrum.size(), n / 2);
+    const size_t lo = std::min(bins, static_cast<size_t>(std::ceil(config_.band_low / df)));
+    const size_t hi = std::min(bins, static_cast<size_t>(std::ceil(config_.band_high / df)));
+    const size_t width = hi - lo;
+
+    // The envelope spectrum must reach the highest defect harmonic
+    double top_hz = 0.0;
+    for (const auto& band : faults_->bands()) {
+        top_hz = std::max(top_hz, band.high);
+    }
+    const size_t top_bin = static_cast<size_t>(std::ceil(top_hz / df)) + 1;
+    const size_t size = next_even_smooth(std::max(width, 2 * top_bin));
+    envelope_size = size;
+
+    EnvelopeScratch& s = scratch_for(size);
+
+    // Inverse DFT via the forward transform: ifft(Y) = conj(fft(conj(Y))) / M.
+    // The 1/M cancels against the decimation, leaving the 2/n analytic-signal
+    // scale; only the magnitude is needed, so the outer conj is dropped.
+    std::fill(s.band.begin(), s.band.end(), std::complex<double>(0.0, 0.0));
+    for (size_t j = 0; j < width; ++j) {
+        s.band[j] = std::conj(spectrum[lo + j]);
+    }
+    s.inverse->forward_complex(s.band, s.analytic);
+
+    const double scale = 2.0 / static_cast<double>(n);
+    double mean = 0.0;
+    for (size_t t = 0; t < size; ++t) {
+        s.envelope[t] = std::abs(s.analytic[t]) * scale;
+        mean += s.envelope[t];
+    }
+    mean /= static_cast<double>(size);
+    for (double& e : s.envelope) {
+        e -= mean;
+    }
+
+    s.forward->forward_real(s.envelope, s.envelope_spectrum);
+    simd::active().magnitudes(s.envelope_spectrum.data(), size / 2,
+                              2.0 / static_cast<double>(size), s.magnitudes.data());
+    s.magnitudes[0] /= 2.0;
+
+    return s.magnitudes;
+}
+
+void EnvelopeAnalyzer::fault_amplitudes(std::span<const std::complex<double>> spectrum, size_t n,
+                                        double sample_rate, std::span<double> amplitudes) const {
+    if (amplitudes.size() < num_faults()) {
+        throw std::invalid_argument("Fault amplitude buffer too small");
+    }
+    std::fill(amplitudes.begin(), amplitudes.begin() + num_faults(), 0.0);
+    if (n < 2 || spectrum.empty()) {
+        return;
+    }
+
+    size_t size = 0;
+    auto magnitudes = compute(spectrum, n, sample_rate, size);
+
+    // Envelope spectrum bins keep the input spacing: an M-point grid at sample_rate * M / n
+    auto layout = BandLayout::get(faults_, sample_rate * static_cast<double>(size) / static_cast<double>(n),
+                                  size, size / 2);
+    const auto& ranges = layout->ranges();
+    for (size_t f = 0; f < ranges.size(); ++f) {
+        const auto [begin, end] = ranges[f];
+        if (begin < end) {
+            amplitudes[f] = *std::max_element(magnitudes.begin() + begin, magnitudes.begin() + end);
+        }
+    }
+}
+
+std::pair<std::vector<double>, std::vector<double>>
+EnvelopeAnalyzer::envelope_spectrum(std::span<const std::complex<double>> spectrum, size_t n,
+                                    double sample_rate) const {
+    if (n < 2 || spectrum.empty()) {
+        return {{}, {}};
+    }
+
+    size_t size = 0;
+    auto magnitudes = compute(spectrum, n, sample_rate, size);
+
+    std::vector<double> frequencies(magnitudes.size());
+    const double df = sample_rate / static_cast<double>(n);
+    for (size_t k = 0; k < frequencies.size(); ++k) {
+        frequencies[k] = static_cast<double>(k) * df;
+    }
+    return {std::vector<double>(magnitudes.begin(), magnitudes.end()), frequencies};
+}
+
+} // namespace cpm
@@ -0,0 +1,158 @@
+#include "extraction_queue.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace cpm {
+
+ExtractionQueue::State::State(const FeatureExtractor& settings, size_t batch_limit,
+                              std::chrono::microseconds delay)
+    : extractor(settings),
+      max_batch(std::max<size_t>(1, batch_limit)),
+      max_delay(delay) {
+    // A single thread runs batches inline on the dispatcher, like extract_batch
+    const size_t threads = ThreadPool::resolve_threads(extractor.get_num_threads());
+    if (threads > 1) {
+        pool = ThreadPool::shared(extractor.get_num_threads());
+    }
+    workspaces.resize(pool ? pool->size() : 1);
+    queue.reserve(max_batch);
+}
+
+ExtractionQueue::ExtractionQueue(const FeatureExtractor& extractor, size_t max_batch,
+                                 std::chrono::microseconds max_delay)
+    : state_(std::make_shared<State>(extractor, max_batch, max_delay)) {
+    dispatcher_ = std::thread([state = state_] { dispatch_loop(*state); });
+}
+
+ExtractionQueue::~ExtractionQueue() {
+    close();
+    // Destroyed from a callback: the dispatcher holds its own reference to
+    // the state and exits once the queue is drained
+    if (dispatcher_.joinable()) {
+        dispatcher_.detach();
+    }
+}
+
+void ExtractionQueue::submit(std::vector<double> signal, bool include_spectrum, Callback done) {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (state_->closing) {
+            throw std::logic_error("Extraction queue is closed");
+        }
+        state_->queue.push_back({std::move(signal), include_spectrum, std::move(done)});
+    }
+    state_->wake.notify_one();
+}
+
+std::future<SignalFeatures> ExtractionQueue::submit(std::vector<double> signal, bool include_spectrum) {
+    auto promise = std::make_shared<std::promise<SignalFeatures>>();
+    std::future<SignalFeatures> result = promise->get_future();
+    submit(std::move(signal), include_spectrum,
+           [promise](SignalFeatures&& features, std::exception_ptr error) {
+               if (error) {
+                   promise->set_exception(error);
+               } else {
+                   promise->set_value(std::move(features));
+               }
+           });
+    return result;
+}
+
+bool ExtractionQueue::can_join() const {
+    // The dispatcher may be waiting in parallel_for on the calling worker,
+    // or be the calling thread itself
+    return !ThreadPool::on_worker_thread() && dispatcher_.get_id() != std::this_thread::get_id();
+}
+
+void ExtractionQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->closing = true;
+    }
+    state_->wake.notify_one();
+    // A callback's close() must not wait on join_mutex_ either: another
+    // thread may hold it while joining the dispatcher it runs under
+    if (!can_join()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(join_mutex_);
+    if (dispatcher_.joinable()) {
+        dispatcher_.join();
+    }
+}
+
+size_t ExtractionQueue::pending() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->queue.size();
+}
+
+void ExtractionQueue::dispatch_loop(State& state) {
+    std::vector<Request> batch;
+    batch.reserve(state.max_batch);
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.wake.wait(lock, [&state] { return state.closing || !state.queue.empty(); });
+            if (state.queue.empty()) {
+                return;  // Closing and drained
+            }
+            if (state.max_delay.count() > 0 && state.queue.size() < state.max_batch &&
+                !state.closing) {
+                state.wake.wait_for(lock, state.max_delay, [&state] {
+                    return state.closing || state.queue.size() >= state.max_batch;
+                });
+            }
+            // Oldest requests first; the rest wait for the next batch
+            const size_t take = std::min(state.queue.size(), state.max_batch);
+            std::move(state.queue.begin(), state.queue.begin() + static_cast<std::ptrdiff_t>(take),
+                      std::back_inserter(batch));
+            state.queue.erase(state.queue.begin(),
+                              state.queue.begin() + static_cast<std::ptrdiff_t>(take));
+        }
+        run_batch(state, batch);
+        state.batches.fetch_add(1, std::memory_order_relaxed);
+        batch.clear();
+    }
+}
+
+void ExtractionQueue::run_batch(State& state, std::vector<Request>& batch) {
+    if (!state.pool || batch.size() == 1) {
+        for (Request& request : batch) {
+            run_one(state, request, state.workspaces[0]);
+        }
+        return;
+    }
+    // Signals differ in cost (length, spectrum or not), so one per chunk
+    // lets idle workers steal the stragglers
+    state.pool->parallel_for(batch.size(), 1, [&](size_t begin, size_t end, size_t worker) {
+        for (size_t i = begin; i < end; ++i) {
+            run_one(state, batch[i], state.workspaces[worker]);
+        }
+    });
+}
+
+void ExtractionQueue::run_one(State& state, Request& request, Workspace& workspace) {
+    SignalFeatures features;
+    std::exception_ptr error;
+    try {
+        state.extractor.extract_all(request.signal, workspace, request.include_spectrum);
+        // The result leaves with the request; the workspace regrows its
+        // spectrum buffer on the next call
+        features = std::move(workspace.features);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    request.signal = {};
+    state.completed.fetch_add(1, std::memory_order_relaxed);
+    if (request.done) {
+        try {
+            request.done(std::move(features), error);
+        } catch (...) {
+            // Nothing is waiting on the callback; keep the batch going
+        }
+        request.done = nullptr;
+    }
+}
+
+} // namespace cpm
@@ -0,0 +1,439 @@
+#include "feature_codec.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace cpm {
+
+namespace {
+
+constexpr unsigned LOG8_RANGE_DB = 96;
+constexpr unsigned LOG16_RANGE_DB = 160;
+constexpr unsigned MAX_RANGE_DB = 600;  // Keeps the floor above the subnormals
+
+constexpr size_t SERIES_BLOCK = 128;     // Deltas sharing one bit width
+constexpr size_t SERIES_PADDING = 8;     // Zero tail so unpacking can read whole words
+constexpr unsigned MAX_DELTA_BITS = 55;  // Zigzag of a difference of two 2^52 codes
+constexpr uint32_t SERIES_HAS_GAPS = 1;
+
+// Header of an encoded series, followed by the validity bitmap (with
+// SERIES_HAS_GAPS), the packed blocks and SERIES_PADDING zero bytes
+struct SeriesHeader {
+    uint32_t num_values = 0;
+    uint32_t flags = 0;
+    double resolution = 1.0;
+};
+
+static_assert(sizeof(SeriesHeader) == 16, "SeriesHeader must be packed to 16 bytes");
+
+size_t code_bytes(SpectrumEncoding encoding) {
+    switch (encoding) {
+        case SpectrumEncoding::Float64: return 8;
+        case SpectrumEncoding::Float16: return 2;
+        case SpectrumEncoding::Log8: return 1;
+        case SpectrumEncoding::Log16: return 2;
+    }
+    throw std::invalid_argument("Unknown spectrum encoding " + std::to_string(static_cast<int>(encoding)));
+}
+
+uint32_t log_levels(SpectrumEncoding encoding) {
+    return encoding == SpectrumEncoding::Log8 ? 255u : 65535u;
+}
+
+// Payload codes as T; copied out when the block does not keep them aligned
+template <typename T>
+const T* aligned_codes(const unsigned char* payload, size_t n, std::vector<T>& copy) {
+    if (reinterpret_cast<uintptr_t>(payload) % alignof(T) == 0) {
+        return reinterpret_cast<const T*>(payload);
+    }
+    copy.resize(n);
+    std::memcpy(copy.data(), payload, n * sizeof(T));
+    return copy.data();
+}
+
+// Destination for codes: the payload itself when aligned, else scratch
+// that finish_codes copies in
+template <typename T>
+T* code_buffer(unsigned char* payload, size_t n, std::vector<T>& scratch) {
+    if (reinterpret_cast<uintptr_t>(payload) % alignof(T) == 0) {
+        return reinterpret_cast<T*>(payload);
+    }
+    scratch.resize(n);
+    return scratch.data();
+}
+
+template <typename T>
+void finish_codes(const std::vector<T>& scratch, unsigned char* payload) {
+    if (scratch.empty()) {
+        return;  // Codes were written in place
+    }
+    std::memcpy(payload, scratch.data(), scratch.size() * sizeof(T));
+}
+
+// log2 without libm calls so the encode loops vectorise: the exponent
+// from the bits, the mantissa reduced to [sqrt(1/2), sqrt(2)) and
+// log2(m) = 2 / ln 2 * atanh((m - 1) / (m + 1)) as an odd series. The
+// error is below 1e-9, far under a Log16 step; zero gives -1023.
+double log2_approx(double x) {
+    constexpr uint64_t MANTISSA = (uint64_t{1} << 52) - 1;
+    constexpr uint64_t ONE = uint64_t{1023} << 52;
+    constexpr uint64_t TWO_52 = uint64_t{0x433} << 52;  // 2^52: e + 2^52 read back exactly
+    const uint64_t bits = std::bit_cast<uint64_t>(x);
+    double exponent = std::bit_cast<double>((bits >> 52) | TWO_52) - (4503599627370496.0 + 1023.0);
+    double m = std::bit_cast<double>((bits & MANTISSA) | ONE);
+    const bool high = m > 1.4142135623730951;
+    m = high ? 0.5 * m : m;
+    exponent = high ? exponent + 1.0 : exponent;
+    const double s = (m - 1.0) / (m + 1.0);
+    const double s2 = s * s;
+    const double series = 1.0 + s2 * (1.0 / 3.0 + s2 * (1.0 / 5.0 + s2 * (1.0 / 7.0 + s2 * (1.0 / 9.0))));
+    return exponent + 2.8853900817779268 * s * series;  // 2 / ln 2
+}
+
+// Decoded value of every log code, built by multiplicative recurrence
+// from the top code down (error stays far below one quantisation step)
+void log_table(double top, double ratio, size_t count, double* table) {
+    double value = top;
+    for (size_t q = count; q-- > 0;) {
+        table[q] = value;
+        value /= ratio;
+    }
+}
+
+uint64_t load_word(const unsigned char* p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+} // namespace
+
+SpectrumEncoding parse_spectrum_encoding(const std::string& name) {
+    if (name == "f64" || name == "float64") return SpectrumEncoding::Float64;
+    if (name == "f16" || name == "float16") return SpectrumEncoding::Float16;
+    if (name == "log8") return SpectrumEncoding::Log8;
+    if (name == "log16") return SpectrumEncoding::Log16;
+    throw std::invalid_argument("Unknown spectrum encoding: " + name + " (expected f64, f16, log8 or log16)");
+}
+
+const char* spectrum_encoding_name(SpectrumEncoding encoding) {
+    switch (encoding) {
+        case SpectrumEncoding::Float64: return "f64";
+        case SpectrumEncoding::Float16: return "f16";
+        case SpectrumEncoding::Log8: return "log8";
+        case SpectrumEncoding::Log16: return "log16";
+    }
+    return "unknown";
+}
+
+size_t encoded_spectrum_size(SpectrumEncoding encoding, size_t n) {
+    const size_t payload = n * code_bytes(encoding);
+    return sizeof(SpectrumBlockHeader) + (payload + 7) / 8 * 8;
+}
+
+void encode_spectrum(std::span<const double> magnitudes, SpectrumEncoding encoding,
+                     std::span<unsigned char> out, unsigned dynamic_range_db) {
+    const size_t n = magnitudes.size();
+    const size_t size = encoded_spectrum_size(encoding, n);
+    if (out.size() < size) {
+        throw std::invalid_argument("Spectrum block needs " + std::to_string(size) + " bytes, got " +
+                                    std::to_string(out.size()));
+    }
+    if (n > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("Spectrum is too long to encode");
+    }
+
+    SpectrumBlockHeader header;
+    header.encoding = static_cast<uint8_t>(encoding);
+    header.num_values = static_cast<uint32_t>(n);
+    unsigned char* payload = out.data() + sizeof(SpectrumBlockHeader);
+    std::fill(payload, out.data() + size, 0);
+
+    if (encoding == SpectrumEncoding::Float64) {
+        if (n > 0) {
+            std::memcpy(payload, magnitudes.data(), n * sizeof(double));
+        }
+        std::memcpy(out.data(), &header, sizeof(header));
+        return;
+    }
+
+    const bool log = encoding != SpectrumEncoding::Float16;
+    double largest = 0.0;
+    for (double x : magnitudes) {
+        if (!std::isfinite(x) || (log && x < 0.0)) {
+            throw std::invalid_argument(std::string("Cannot encode ") + (log ? "negative or " : "") +
+                                        "non-finite magnitudes as " + spectrum_encoding_name(encoding));
+        }
+        largest = std::max(largest, std::abs(x));
+    }
+    header.scale = largest > 0.0 ? largest : 1.0;
+    const double inv_scale = 1.0 / header.scale;
+
+    if (encoding == SpectrumEncoding::Float16) {
+        std::vector<uint16_t> scratch;
+        simd::active().narrow_f16(magnitudes.data(), n, inv_scale, code_buffer(payload, n, scratch));
+        finish_codes(scratch, payload);
+    } else {
+        if (dynamic_range_db == 0) {
+            dynamic_range_db = encoding == SpectrumEncoding::Log8 ? LOG8_RANGE_DB : LOG16_RANGE_DB;
+        }
+        if (dynamic_range_db > MAX_RANGE_DB) {
+            throw std::invalid_argument("Dynamic range must be at most " + std::to_string(MAX_RANGE_DB) + " dB");
+        }
+        header.dynamic_range_db = static_cast<uint16_t>(dynamic_range_db);
+
+        // q = L + (L - 1) * 20 log10(x / scale) / range, rounded; values below
+        // the range, zero included, give t < 0.5 and q = 0
+        const uint32_t levels = log_levels(encoding);
+        const double top = static_cast<double>(levels);
+        const double per_octave = (top - 1.0) * 20.0 * std::log10(2.0) / dynamic_range_db;
+        auto code = [&](double x) {
+            const double t = top + per_octave * log2_approx(x * inv_scale);
+            return t < 0.5 ? 0.0 : std::min(t + 0.5, top);
+        };
+        if (encoding == SpectrumEncoding::Log8) {
+            for (size_t i = 0; i < n; ++i) {
+                payload[i] = static_cast<uint8_t>(static_cast<int32_t>(code(magnitudes[i])));
+            }
+        } else {
+            std::vector<uint16_t> scratch;
+            uint16_t* codes = code_buffer(payload, n, scratch);
+            for (size_t i = 0; i < n; ++i) {
+                codes[i] = static_cast<uint16_t>(static_cast<int32_t>(code(magnitudes[i])));
+            }
+            finish_codes(scratch, payload);
+        }
+    }
+    std::memcpy(out.data(), &header, sizeof(header));
+}
+
+std::vector<unsigned char> encode_spectrum(std::span<const double> magnitudes, SpectrumEncoding encoding,
+                                           unsigned dynamic_range_db) {
+    std::vector<unsigned char> out(encoded_spectrum_size(encoding, magnitudes.size()));
+    encode_spectrum(magnitudes, encoding, out, dynamic_range_db);
+    return out;
+}
+
+size_t spectrum_length(std::span<const unsigned char> block) {
+    SpectrumBlockHeader header;
+    if (block.size() < sizeof(header)) {
+        throw std::invalid_argument("Spectrum block is shorter than its header");
+    }
+    std::memcpy(&header, block.data(), sizeof(header));
+    const auto encoding = static_cast<SpectrumEncoding>(header.encoding);
+    if (header.encoding > static_cast<uint8_t>(SpectrumEncoding::Log16)) {
+        throw std::invalid_argument("Unknown spectrum encoding " + std::to_string(header.encoding));
+    }
+    if (block.size() < encoded_spectrum_size(encoding, header.num_values)) {
+        throw std::invalid_argument("Truncated spectrum block");
+    }
+    const bool log = encoding == SpectrumEncoding::Log8 || encoding == SpectrumEncoding::Log16;
+    if (header.num_values > 0 && log && header.dynamic_range_db == 0) {
+        throw std::invalid_argument("Log spectrum block has no dynamic range");
+    }
+    return header.num_values;
+}
+
+void decode_spectrum(std::span<const unsigned char> block, std::span<double> out) {
+    const size_t n = spectrum_length(block);
+    if (out.size() < n) {
+        throw std::invalid_argument("Spectrum block holds " + std::to_string(n) + " values, output has room for " +
+                                    std::to_string(out.size()));
+    }
+    SpectrumBlockHeader header;
+    std::memcpy(&header, block.data(), sizeof(header));
+    const unsigned char* payload = block.data() + sizeof(SpectrumBlockHeader);
+
+    switch (static_cast<SpectrumEncoding>(header.encoding)) {
+        case SpectrumEncoding::Float64:
+            if (n > 0) {
+                std::memcpy(out.data(), payload, n * sizeof(double));
+            }
+            break;
+        case SpectrumEncoding::Float16: {
+            std::vector<uint16_t> copy;
+            simd::active().widen_f16(aligned_codes(payload, n, copy), n, header.scale, out.data());
+            break;
+        }
+        case SpectrumEncoding::Log8: {
+            // One table lookup per code
+            const double ratio = std::pow(10.0, header.dynamic_range_db / 20.0 / 254.0);
+            double table[256];
+            log_table(header.scale, ratio, 255, table + 1);
+            table[0] = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = table[payload[i]];
+            }
+            break;
+        }
+        case SpectrumEncoding::Log16: {
+            // q - 1 = 256 h + l splits r^(q - L) into hi[h] * lo[l], two 2 KiB tables
+            const double ratio = std::pow(10.0, header.dynamic_range_db / 20.0 / 65534.0);
+            double hi[256];
+            double lo[256];
+            log_table(std::pow(ratio, 255.0), ratio, 256, lo);
+            log_table(header.scale * std::pow(ratio, -254.0), std::pow(ratio, 256.0), 256, hi);
+            std::vector<uint16_t> copy;
+            const uint16_t* codes = aligned_codes(payload, n, copy);
+            for (size_t i = 0; i < n; ++i) {
+                const uint32_t q = codes[i];
+                const uint32_t k = q - 1;
+                out[i] = q == 0 ? 0.0 : hi[(k >> 8) & 0xFF] * lo[k & 0xFF];
+            }
+            break;
+        }
+    }
+}
+
+std::vector<double> decode_spectrum(std::span<const unsigned char> block) {
+    std::vector<double> out(spectrum_length(block));
+    decode_spectrum(block, out);
+    return out;
+}
+
+std::vector<unsigned char> encode_series(std::span<const double> values, double resolution) {
+    if (!(resolution > 0.0) || !std::isfinite(resolution)) {
+        throw std::invalid_argument("Series resolution must be positive and finite");
+    }
+    const size_t n = values.size();
+    if (n > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("Series is too long to encode");
+    }
+
+    SeriesHeader header;
+    header.num_values = static_cast<uint32_t>(n);
+    header.resolution = resolution;
+
+    // Quantise; a gap repeats the previous code so its delta costs no bits
+    constexpr double LIMIT = 4503599627370496.0;  // 2^52
+    std::vector<int64_t> codes(n);
+    std::vector<unsigned char> valid((n + 7) / 8, 0);
+    int64_t previous = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const double v = values[i];
+        if (std::isnan(v)) {
+            header.flags |= SERIES_HAS_GAPS;
+            codes[i] = previous;
+            continue;
+        }
+        const double steps = v / resolution;
+        if (!(std::abs(steps) <= LIMIT)) {
+            throw std::invalid_argument("Series value " + std::to_string(v) +
+                                        " is infinite or too large for the resolution");
+        }
+        codes[i] = previous = std::llround(steps);
+        valid[i / 8] |= static_cast<unsigned char>(1u << (i % 8));
+    }
+
+    const size_t bitmap = (header.flags & SERIES_HAS_GAPS) ? valid.size() : 0;
+    std::vector<unsigned char> out(sizeof(header) + bitmap);
+    std::memcpy(out.data(), &header, sizeof(header));
+    std::copy_n(valid.begin(), bitmap, out.begin() + sizeof(header));
+
+    uint64_t zigzag[SERIES_BLOCK];
+    previous = 0;
+    for (size_t start = 0; start < n; start += SERIES_BLOCK) {
+        const size_t count = std::min(SERIES_BLOCK, n - start);
+        uint64_t bits = 0;
+        for (size_t j = 0; j < count; ++j) {
+            const int64_t delta = codes[start + j] - previous;
+            previous = codes[start + j];
+            zigzag[j] = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+            bits |= zigzag[j];
+        }
+        const unsigned width = static_cast<unsigned>(std::bit_width(bits));
+        out.push_back(static_cast<unsigned char>(width));
+
+        // At most 7 pending bits plus a 55-bit code fit the accumulator
+        uint64_t acc = 0;
+        unsigned pending = 0;
+        for (size_t j = 0; j < count && width > 0; ++j) {
+            acc |= zigzag[j] << pending;
+            pending += width;
+            while (pending >= 8) {
+                out.push_back(static_cast<unsigned char>(acc));
+                acc >>= 8;
+                pending -= 8;
+            }
+        }
+        if (pending > 0) {
+            out.push_back(static_cast<unsigned char>(acc));
+        }
+    }
+    out.insert(out.end(), SERIES_PADDING, 0);
+    return out;
+}
+
+size_t series_length(std::span<const unsigned char> encoded) {
+    SeriesHeader header;
+    if (encoded.size() < sizeof(header) + SERIES_PADDING) {
+        throw std::invalid_argument("Encoded series is shorter than its header");
+    }
+    std::memcpy(&header, encoded.data(), sizeof(header));
+    if (!(header.resolution > 0.0) || (header.flags & ~SERIES_HAS_GAPS) != 0) {
+        throw std::invalid_argument("Malformed series header");
+    }
+    return header.num_values;
+}
+
+void decode_series(std::span<const unsigned char> encoded, std::span<double> out) {
+    const size_t n = series_length(encoded);
+    if (out.size() < n) {
+        throw std::invalid_argument("Encoded series holds " + std::to_string(n) + " values, output has room for " +
+                                    std::to_string(out.size()));
+    }
+    SeriesHeader header;
+    std::memcpy(&header, encoded.data(), sizeof(header));
+
+    // Every read below stays clear of the zero padding, so whole-word loads are safe
+    const size_t end = encoded.size() - SERIES_PADDING;
+    size_t pos = sizeof(header);
+    const unsigned char* valid = nullptr;
+    if (header.flags & SERIES_HAS_GAPS) {
+        valid = encoded.data() + pos;
+        pos += (n + 7) / 8;
+    }
+
+    int64_t code = 0;
+    for (size_t start = 0; start < n; start += SERIES_BLOCK) {
+        const size_t count = std::min(SERIES_BLOCK, n - start);
+        if (pos >= end) {
+            throw std::invalid_argument("Truncated series block");
+        }
+        const unsigned width = encoded[pos++];
+        const size_t bytes = (count * width + 7) / 8;
+        if (width > MAX_DELTA_BITS || pos + bytes > end) {
+            throw std::invalid_argument("Malformed series block");
+        }
+        const unsigned char* packed = encoded.data() + pos;
+        const uint64_t mask = (uint64_t{1} << width) - 1;
+        for (size_t j = 0; j < count; ++j) {
+            const size_t bit = j * width;
+            const uint64_t z = (load_word(packed + bit / 8) >> (bit % 8)) & mask;
+            code += static_cast<int64_t>((z >> 1) ^ (~(z & 1) + 1));
+            out[start + j] = static_cast<double>(code) * header.resolution;
+        }
+        pos += bytes;
+    }
+
+    if (valid) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        for (size_t i = 0; i < n; ++i) {
+            if (!(valid[i / 8] & (1u << (i % 8)))) {
+                out[i] = nan;
+            }
+        }
+    }
+}
+
+std::vector<double> decode_series(std::span<const unsigned char> encoded) {
+    std::vector<double> out(series_length(encoded));
+    decode_series(encoded, out);
+    return out;
+}
+
+} // namespace cpm
@@ -1,11 +1,209 @@
 #include "feature_extractor.hpp"
+#include "simd_kernels.hpp"
+#include "stats.hpp"
+#include "window.hpp"
 #include <cmath>
 #include <algorithm>
+#include <limits>
+#include <type_traits>
 
 namespace cpm {
 
-FeatureExtractor::FeatureExtractor(double sample_rate)
-    : sample_rate_(sample_rate) {
+namespace {
+
+// Interleaved frames transposed per block; keeps all channel streams in L1
+constexpr size_t DEINTERLEAVE_BLOCK = 256;
+
+void deinterleave(std::span<const double> data, size_t channels, size_t length,
+                  std::vector<double>& planar) {
+    planar.resize(channels * length);
+    for (size_t start = 0; start < length; start += DEINTERLEAVE_BLOCK) {
+        const size_t end = std::min(length, start + DEINTERLEAVE_BLOCK);
+        for (size_t c = 0; c < channels; ++c) {
+            const double* src = data.data() + c;
+            double* dst = planar.data() + c * length;
+            for (size_t t = start; t < end; ++t) {
+                dst[t] = src[t * channels];
+            }
+        }
+    }
+}
+
+// Welch auto- and cross-spectral densities of planar channels
+void cross_spectra(std::span<const double> planar, size_t channels, size_t length,
+                   size_t segment, double sample_rate, MultichannelFeatures& out) {
+    const size_t seg = std::min(segment, length);
+    if (seg < 2) {
+        return;
+    }
+    const size_t hop = seg / 2;
+    const size_t segments = (length - seg) / hop + 1;
+
+    auto plan = FFTPlan::get(seg);
+    const size_t bins = plan->num_bins();
+
+    // Periodic Hann window, as scipy's default
+    auto hann = WindowTable::get(WindowFunction::Hann, seg);
+    const double* window = hann->values().data();
+    const double window_power = hann->sum_squares();
+
+    out.segment_length = seg;
+    out.num_segments = segments;
+    out.frequencies.resize(bins);
+    for (size_t k = 0; k < bins; ++k) {
+        out.frequencies[k] = static_cast<double>(k) * sample_rate / static_cast<double>(seg);
+    }
+    out.channel_pairs.clear();
+    for (size_t i = 0; i < channels; ++i) {
+        for (size_t j = i + 1; j < channels; ++j) {
+            out.channel_pairs.emplace_back(i, j);
+        }
+    }
+    const size_t pairs = out.channel_pairs.size();
+    out.psd.assign(channels * bins, 0.0);
+    out.csd.assign(pairs * bins, {0.0, 0.0});
+    out.coherence.assign(pairs * bins, 0.0);
+
+    // Spectra of every channel for the current segment
+    std::vector<double> buffer(seg);
+    std::vector<std::complex<double>> spectra(channels * bins);
+
+    for (size_t s = 0; s < segments; ++s) {
+        for (size_t c = 0; c < channels; ++c) {
+            const double* x = planar.data() + c * length + s * hop;
+            double mean = std::accumulate(x, x + seg, 0.0) / static_cast<double>(seg);
+            for (size_t i = 0; i < seg; ++i) {
+                buffer[i] = (x[i] - mean) * window[i];
+            }
+            std::complex<double>* X = spectra.data() + c * bins;
+            plan->forward_real(buffer, std::span<std::complex<double>>(X, bins));
+
+            double* psd = out.psd.data() + c * bins;
+            for (size_t k = 0; k < bins; ++k) {
+                psd[k] += std::norm(X[k]);
+            }
+        }
+        for (size_t p = 0; p < pairs; ++p) {
+            const auto [i, j] = out.channel_pairs[p];
+            const std::complex<double>* Xi = spectra.data() + i * bins;
+            const std::complex<double>* Xj = spectra.data() + j * bins;
+            std::complex<double>* csd = out.csd.data() + p * bins;
+            for (size_t k = 0; k < bins; ++k) {
+                csd[k] += std::conj(Xi[k]) * Xj[k];
+            }
+        }
+    }
+
+    // One-sided density: every bin but DC also carries its negative frequency
+    const double scale = 1.0 / (sample_rate * window_power * static_cast<double>(segments));
+    auto density = [&](size_t k) { return k == 0 ? scale : 2.0 * scale; };
+    for (size_t c = 0; c < channels; ++c) {
+        for (size_t k = 0; k < bins; ++k) {
+            out.psd[c * bins + k] *= density(k);
+        }
+    }
+    for (size_t p = 0; p < pairs; ++p) {
+        const auto [i, j] = out.channel_pairs[p];
+        for (size_t k = 0; k < bins; ++k) {
+            std::complex<double>& csd = out.csd[p * bins + k];
+            csd *= density(k);
+            double denom = out.psd[i * bins + k] * out.psd[j * bins + k];
+            out.coherence[p * bins + k] = denom > 0.0 ? std::norm(csd) / denom : 0.0;
+        }
+    }
+}
+
+// Narrow samples to double (int16 counts times scale)
+void widen(const simd::Kernels& k, const float* x, size_t n, double, double* out) {
+    k.widen_f32(x, n, out);
+}
+
+void widen(const simd::Kernels& k, const int16_t* x, size_t n, double scale, double* out) {
+    k.widen_i16(x, n, scale, out);
+}
+
+void store_time_stats(const TimeStats& stats, BatchFeatures& out, size_t index) {
+    out.rms[index] = stats.rms;
+    out.peak[index] = stats.peak;
+    out.crest_factor[index] = stats.crest_factor;
+    out.kurtosis[index] = stats.kurtosis;
+    out.skewness[index] = stats.skewness;
+}
+
+constexpr double NOT_COMPUTED = std::numeric_limits<double>::quiet_NaN();
+
+// NaN out the features a mask leaves unselected
+void mask_features(Feature mask, SignalFeatures& f) {
+    auto clear = [mask](Feature flag, double& value) {
+        if (!has_feature(mask, flag)) value = NOT_COMPUTED;
+    };
+    clear(Feature::Rms, f.rms);
+    clear(Feature::Peak, f.peak);
+    clear(Feature::CrestFactor, f.crest_factor);
+    clear(Feature::Kurtosis, f.kurtosis);
+    clear(Feature::Skewness, f.skewness);
+    clear(Feature::SpectralCentroid, f.spectral_centroid);
+    clear(Feature::SpectralSpread, f.spectral_spread);
+    if (!has_feature(mask, Feature::Bandpowers)) {
+        std::fill(f.bandpowers.begin(), f.bandpowers.end(), NOT_COMPUTED);
+    }
+    if (!has_feature(mask, Feature::FaultAmplitudes)) {
+        std::fill(f.fault_amplitudes.begin(), f.fault_amplitudes.end(), NOT_COMPUTED);
+    }
+}
+
+void mask_features(Feature mask, BatchFeatures& f) {
+    auto clear = [mask](Feature flag, std::vector<double>& column) {
+        if (!has_feature(mask, flag)) std::fill(column.begin(), column.end(), NOT_COMPUTED);
+    };
+    clear(Feature::Rms, f.rms);
+    clear(Feature::Peak, f.peak);
+    clear(Feature::CrestFactor, f.crest_factor);
+    clear(Feature::Kurtosis, f.kurtosis);
+    clear(Feature::Skewness, f.skewness);
+    clear(Feature::SpectralCentroid, f.spectral_centroid);
+    clear(Feature::SpectralSpread, f.spectral_spread);
+    clear(Feature::Bandpowers, f.bandpowers);
+    clear(Feature::FaultAmplitudes, f.fault_amplitudes);
+}
+
+} // namespace
+
+Feature parse_features(const std::string& list) {
+    static const std::pair<const char*, Feature> names[] = {
+        {"rms", Feature::Rms},
+        {"peak", Feature::Peak},
+        {"crest_factor", Feature::CrestFactor},
+        {"kurtosis", Feature::Kurtosis},
+        {"skewness", Feature::Skewness},
+        {"spectral_centroid", Feature::SpectralCentroid},
+        {"spectral_spread", Feature::SpectralSpread},
+        {"bandpowers", Feature::Bandpowers},
+        {"spectrum", Feature::Spectrum},
+        {"fault_amplitudes", Feature::FaultAmplitudes},
+        {"time", Feature::TimeDomain},
+        {"frequency", Feature::FrequencyDomain},
+        {"all", Feature::All},
+    };
+
+    Feature mask = Feature::None;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = std::min(list.find(',', start), list.size());
+        const std::string name = list.substr(start, end - start);
+        auto it = std::find_if(std::begin(names), std::end(names),
+                               [&](const auto& entry) { return name == entry.first; });
+        if (it == std::end(names)) {
+            throw std::invalid_argument("Unknown feature: " + name);
+        }
+        mask = mask | it->second;
+        start = end + 1;
+    }
+    return mask;
+}
+
+FeatureExtractor::FeatureExtractor(double sample_rate, size_t num_threads)
+    : sample_rate_(sample_rate), num_threads_(num_threads), bands_(BandSet::shared_defaults()) {
     if (sample_rate <= 0) {
         throw std::invalid_argument("Sample rate must be positive");
     }
@@ -22,216 +220,442 @@ double FeatureExtractor::get_sample_rate() const {
     return sample_rate_;
 }
 
-double FeatureExtractor::compute_rms(const std::vector<double>& signal) const {
+void FeatureExtractor::set_num_threads(size_t num_threads) {
+    num_threads_ = num_threads;
+}
+
+size_t FeatureExtractor::get_num_threads() const {
+    return num_threads_;
+}
+
+void FeatureExtractor::set_bands(BandSet bands) {
+    bands_ = std::make_shared<const BandSet>(std::move(bands));
+}
+
+const BandSet& FeatureExtractor::get_bands() const {
+    return *bands_;
+}
+
+void FeatureExtractor::set_envelope(const EnvelopeConfig& config) {
+    envelope_ = std::make_shared<const EnvelopeAnalyzer>(config);
+}
+
+void FeatureExtractor::clear_envelope() {
+    envelope_.reset();
+}
+
+std::pair<std::vector<double>, std::vector<double>>
+FeatureExtractor::compute_envelope_spectrum(std::span<const double> signal) const {
+    if (!envelope_) {
+        throw std::logic_error("Envelope analysis is not configured");
+    }
     if (signal.empty()) {
-        return 0.0;
+        return {{}, {}};
     }
+    auto plan = FFTPlan::get(signal.size());
+    std::vector<std::complex<double>> spectrum(plan->num_bins());
+    plan->forward_real(signal, spectrum);
+    return envelope_->envelope_spectrum(spectrum, signal.size(), sample_rate_);
+}
 
-    double sum_sq = 0.0;
-    for (const auto& s : signal) {
-        sum_sq += s * s;
+Kurtogram FeatureExtractor::compute_kurtogram(std::span<const double> signal,
+                                              const KurtogramConfig& config) const {
+    if (signal.empty()) {
+        return KurtogramAnalyzer(config).compute({}, 0, sample_rate_);
     }
-    return std::sqrt(sum_sq / static_cast<double>(signal.size()));
+    auto plan = FFTPlan::get(signal.size());
+    std::vector<std::complex<double>> spectrum(plan->num_bins());
+    plan->forward_real(signal, spectrum);
+    return KurtogramAnalyzer(config).compute(spectrum, signal.size(), sample_rate_);
 }
 
-double FeatureExtractor::compute_peak(const std::vector<double>& signal) const {
+KurtogramEnvelope FeatureExtractor::compute_kurtogram_envelope(std::span<const double> signal,
+                                                               const KurtogramConfig& config) const {
+    KurtogramEnvelope out;
     if (signal.empty()) {
-        return 0.0;
+        out.kurtogram = KurtogramAnalyzer(config).compute({}, 0, sample_rate_);
+        return out;
+    }
+    const size_t n = signal.size();
+    auto plan = FFTPlan::get(n);
+    std::vector<std::complex<double>> spectrum(plan->num_bins());
+    plan->forward_real(signal, spectrum);
+    out.kurtogram = KurtogramAnalyzer(config).compute(spectrum, n, sample_rate_);
+    if (!(out.kurtogram.band_high > out.kurtogram.band_low)) {
+        return out;
     }
 
-    double max_abs = 0.0;
-    for (const auto& s : signal) {
-        max_abs = std::max(max_abs, std::abs(s));
+    // Demodulate the best band, with the configured defect lines if any
+    // (otherwise a nominal shaft speed and no defect orders)
+    EnvelopeConfig envelope_config;
+    if (envelope_) {
+        envelope_config = envelope_->config();
+    } else {
+        envelope_config.shaft_hz = 1.0;
     }
-    return max_abs;
+    envelope_config.band_low = out.kurtogram.band_low;
+    envelope_config.band_high = out.kurtogram.band_high;
+    const EnvelopeAnalyzer envelope(envelope_config);
+    auto [magnitudes, frequencies] = envelope.envelope_spectrum(spectrum, n, sample_rate_);
+    out.envelope_magnitudes = std::move(magnitudes);
+    out.envelope_frequencies = std::move(frequencies);
+    if (envelope_) {
+        out.fault_names = envelope.fault_names();
+        out.fault_amplitudes.assign(envelope.num_faults(), 0.0);
+        envelope.fault_amplitudes(spectrum, n, sample_rate_, out.fault_amplitudes);
+    }
+    return out;
 }
 
-double FeatureExtractor::compute_crest_factor(const std::vector<double>& signal) const {
-    double rms = compute_rms(signal);
-    if (rms < 1e-10) {
-        return 0.0;
-    }
-    return compute_peak(signal) / rms;
+void FeatureExtractor::set_order_tracking(const OrderConfig& config) {
+    orders_ = std::make_shared<const OrderTracker>(config);
 }
 
-double FeatureExtractor::compute_kurtosis(const std::vector<double>& signal) const {
-    if (signal.size() < 4) {
-        return 0.0;
-    }
+void FeatureExtractor::clear_order_tracking() {
+    orders_.reset();
+}
 
-    const size_t n = signal.size();
+const OrderTracker& FeatureExtractor::order_tracker() const {
+    static const OrderTracker defaults;
+    return orders_ ? *orders_ : defaults;
+}
 
-    // Compute mean
-    double mean = 0.0;
-    for (const auto& s : signal) {
-        mean += s;
-    }
-    mean /= static_cast<double>(n);
+OrderSpectrum FeatureExtractor::compute_order_spectrum(std::span<const double> signal, double rpm) const {
+    return order_tracker().compute(signal, sample_rate_, rpm);
+}
 
-    // Compute variance and fourth moment
-    double m2 = 0.0;  // Second central moment
-    double m4 = 0.0;  // Fourth central moment
+OrderSpectrum FeatureExtractor::compute_order_spectrum(std::span<const double> signal,
+                                                       std::span<const double> rpm) const {
+    return order_tracker().compute(signal, sample_rate_, rpm);
+}
 
-    for (const auto& s : signal) {
-        double diff = s - mean;
-        double diff2 = diff * diff;
-        m2 += diff2;
-        m4 += diff2 * diff2;
-    }
+BatchOrderFeatures FeatureExtractor::extract_order_batch(std::span<const double> data,
+                                                         std::span<const double> rpm,
+                                                         size_t num_rows, size_t row_length) const {
+    return order_tracker().compute_batch(data, sample_rate_, rpm, num_rows, row_length, num_threads_);
+}
 
-    m2 /= static_cast<double>(n);
-    m4 /= static_cast<double>(n);
+std::shared_ptr<const BandLayout> FeatureExtractor::band_layout(size_t fft_size, size_t num_bins) const {
+    return BandLayout::get(bands_, sample_rate_, fft_size, num_bins);
+}
 
-    if (m2 < 1e-10) {
+double FeatureExtractor::compute_rms(std::span<const double> signal) const {
+    if (signal.empty()) {
         return 0.0;
     }
 
-    // Fisher's excess kurtosis (normal distribution = 0)
-    return (m4 / (m2 * m2)) - 3.0;
+    double sum_sq = simd::active().sum_squares(signal.data(), signal.size());
+    return std::sqrt(sum_sq / static_cast<double>(signal.size()));
 }
 
-double FeatureExtractor::compute_skewness(const std::vector<double>& signal) const {
-    if (signal.size() < 3) {
+double FeatureExtractor::compute_peak(std::span<const double> signal) const {
+    if (signal.empty()) {
         return 0.0;
     }
 
-    const size_t n = signal.size();
+    return simd::active().max_abs(signal.data(), signal.size());
+}
 
-    // Compute mean
-    double mean = 0.0;
-    for (const auto& s : signal) {
-        mean += s;
+double FeatureExtractor::compute_crest_factor(std::span<const double> signal) const {
+    double rms = compute_rms(signal);
+    if (rms < 1e-10) {
+        return 0.0;
     }
-    mean /= static_cast<double>(n);
+    return compute_peak(signal) / rms;
+}
 
-    // Compute variance and third moment
-    double m2 = 0.0;
-    double m3 = 0.0;
+double FeatureExtractor::compute_kurtosis(std::span<const double> signal) const {
+    return compute_time_stats(signal).kurtosis;
+}
 
-    for (const auto& s : signal) {
-        double diff = s - mean;
-        double diff2 = diff * diff;
-        m2 += diff2;
-        m3 += diff2 * diff;
+double FeatureExtractor::compute_skewness(std::span<const double> signal) const {
+    return compute_time_stats(signal).skewness;
+}
+
+template <typename T>
+TimeStats FeatureExtractor::sample_time_stats(std::span<const T> signal, double scale,
+                                              bool with_moments) const {
+    TimeStats stats;
+    if (signal.empty()) {
+        return stats;
     }
+    CPM_STATS_STAGE(TimeStats, signal.size_bytes());
 
-    m2 /= static_cast<double>(n);
-    m3 /= static_cast<double>(n);
+    const auto& k = simd::active();
 
-    double std_dev = std::sqrt(m2);
-    if (std_dev < 1e-10) {
-        return 0.0;
+    MomentAccumulator moments;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    double max_abs = 0.0;
+
+    // Narrow samples are widened one L1-sized block at a time, so they are
+    // read from memory at their own width and never copied in full
+    [[maybe_unused]] double widened[TIME_STATS_BLOCK];
+
+    for (size_t start = 0; start < signal.size(); start += TIME_STATS_BLOCK) {
+        const size_t count = std::min(TIME_STATS_BLOCK, signal.size() - start);
+        const double* block = nullptr;
+        if constexpr (std::is_same_v<T, double>) {
+            block = signal.data() + start;
+        } else {
+            widen(k, signal.data() + start, count, scale, widened);
+            block = widened;
+        }
+
+        // Raw sums stream the block in from memory; the central moments
+        // then re-read it from cache
+        double block_sum = 0.0, block_sq = 0.0, block_max = 0.0;
+        k.raw_sums(block, count, block_sum, block_sq, block_max);
+        sum += block_sum;
+        sum_sq += block_sq;
+        max_abs = std::max(max_abs, block_max);
+
+        if (with_moments) {
+            MomentAccumulator acc;
+            acc.count = count;
+            acc.mean = block_sum / static_cast<double>(count);
+            k.central_moments(block, count, acc.mean, acc.m2, acc.m3, acc.m4);
+            moments.merge(acc);
+        }
+    }
+
+    stats.mean = with_moments ? moments.mean : sum / static_cast<double>(signal.size());
+    stats.rms = std::sqrt(sum_sq / static_cast<double>(signal.size()));
+    stats.peak = max_abs;
+    stats.crest_factor = stats.rms < 1e-10 ? 0.0 : max_abs / stats.rms;
+    if (with_moments) {
+        stats.variance = moments.variance();
+        stats.skewness = moments.skewness();
+        stats.kurtosis = moments.kurtosis();
     }
 
-    return m3 / (std_dev * std_dev * std_dev);
+    return stats;
+}
+
+TimeStats FeatureExtractor::compute_time_stats(std::span<const double> signal) const {
+    return sample_time_stats(signal, 1.0, true);
+}
+
+TimeStats FeatureExtractor::compute_time_stats(std::span<const float> signal) const {
+    return sample_time_stats(signal, 1.0, true);
 }
 
-size_t FeatureExtractor::next_power_of_2(size_t n) {
-    size_t p = 1;
-    while (p < n) {
-        p <<= 1;
+TimeStats FeatureExtractor::compute_time_stats(std::span<const int16_t> signal, double scale) const {
+    return sample_time_stats(signal, scale, true);
+}
+
+template <typename T>
+TimeStats FeatureExtractor::time_features(std::span<const T> signal, double scale,
+                                          const Stages& stages) const {
+    if (stages.time || stages.moments) {
+        return sample_time_stats(signal, scale, stages.moments);
     }
-    return p;
+    return {};
+}
+
+void FeatureExtractor::set_features(Feature features) {
+    features_ = features & Feature::All;
 }
 
-size_t FeatureExtractor::bit_reverse(size_t n, size_t bits) {
-    size_t result = 0;
-    for (size_t i = 0; i < bits; ++i) {
-        result = (result << 1) | (n & 1);
-        n >>= 1;
+FeatureExtractor::Stages FeatureExtractor::stages(bool include_spectrum) const {
+    const Feature f = features_;
+    Stages s;
+    s.time = has_feature(f, Feature::Rms | Feature::Peak | Feature::CrestFactor);
+    s.moments = has_feature(f, Feature::Kurtosis | Feature::Skewness);
+    s.centroid = has_feature(f, Feature::SpectralCentroid | Feature::SpectralSpread);
+    s.spread = has_feature(f, Feature::SpectralSpread);
+    s.bandpowers = has_feature(f, Feature::Bandpowers);
+    s.faults = envelope_ && has_feature(f, Feature::FaultAmplitudes);
+    s.keep_spectrum = include_spectrum && has_feature(f, Feature::Spectrum);
+    s.magnitudes = s.centroid || s.bandpowers || s.keep_spectrum;
+    s.spectrum = s.magnitudes || s.faults;
+    return s;
+}
+
+void FeatureExtractor::magnitude_spectrum(
+    const FFTPlan& plan, std::span<const double> signal,
+    std::span<std::complex<double>> spectrum,
+    std::span<double> magnitudes) const {
+
+    plan.forward_real(signal, spectrum);
+
+    // Extract magnitude spectrum (positive frequencies only)
+    CPM_STATS_STAGE(Magnitudes, signal.size_bytes());
+    const size_t half_n = plan.num_bins();
+    const double scale = 2.0 / static_cast<double>(plan.size());
+    simd::active().magnitudes(spectrum.data(), half_n, scale, magnitudes.data());
+
+    // DC component doesn't need doubling
+    if (half_n > 0) {
+        magnitudes[0] /= 2.0;
     }
-    return result;
 }
 
-void FeatureExtractor::fft_recursive(std::vector<std::complex<double>>& x) const {
-    const size_t n = x.size();
-    if (n <= 1) return;
+FeatureExtractor::SpectrumSetup FeatureExtractor::spectrum_setup(size_t n, bool faults) const {
+    SpectrumSetup setup;
+    if (!welch_) {
+        setup.plan = FFTPlan::get(n);
+        return setup;
+    }
 
-    // Bit-reversal permutation
-    size_t bits = 0;
-    for (size_t temp = n; temp > 1; temp >>= 1) {
-        ++bits;
+    const size_t length = std::min(welch_->segment_length, n);
+    const auto overlap = static_cast<size_t>(std::llround(static_cast<double>(length) * welch_->overlap));
+    setup.plan = FFTPlan::get(length);
+    setup.window = WindowTable::get(welch_->window, length);
+    setup.hop = std::max<size_t>(1, length - std::min(overlap, length));
+    if (faults) {
+        setup.full_plan = FFTPlan::get(n);
     }
+    return setup;
+}
 
-    for (size_t i = 0; i < n; ++i) {
-        size_t j = bit_reverse(i, bits);
-        if (i < j) {
-            std::swap(x[i], x[j]);
+void FeatureExtractor::welch_spectrum(
+    const FFTPlan& plan, const WindowTable& window, size_t hop, std::span<const double> signal,
+    std::vector<double>& segment, std::vector<std::complex<double>>& spectrum,
+    std::span<double> magnitudes) const {
+
+    CPM_STATS_STAGE(Magnitudes, signal.size_bytes());
+    const size_t length = plan.size();
+    const size_t bins = plan.num_bins();
+    segment.resize(length);
+    spectrum.resize(bins);
+    std::fill(magnitudes.begin(), magnitudes.begin() + bins, 0.0);
+
+    // One windowed segment at a time, so the working set stays in cache;
+    // trailing samples that do not fill a segment are dropped, as in scipy
+    const double* w = window.values().data();
+    size_t segments = 0;
+    for (size_t start = 0; start + length <= signal.size(); start += hop) {
+        const double* x = signal.data() + start;
+        for (size_t i = 0; i < length; ++i) {
+            segment[i] = x[i] * w[i];
+        }
+        plan.forward_real(segment, spectrum);
+        for (size_t k = 0; k < bins; ++k) {
+            magnitudes[k] += std::norm(spectrum[k]);
         }
+        ++segments;
     }
 
-    // Cooley-Tukey iterative FFT
-    for (size_t len = 2; len <= n; len <<= 1) {
-        double angle = -2.0 * PI / static_cast<double>(len);
-        std::complex<double> wlen(std::cos(angle), std::sin(angle));
+    // Power scaling: summed squared magnitudes equal those of the
+    // rectangular periodogram for stationary input, whatever the window
+    const double scale = 4.0 / (static_cast<double>(length) * window.sum_squares() *
+                                static_cast<double>(segments));
+    for (size_t k = 0; k < bins; ++k) {
+        magnitudes[k] = std::sqrt(magnitudes[k] * scale);
+    }
+    if (bins > 0) {
+        magnitudes[0] /= 2.0;
+    }
+}
 
-        for (size_t i = 0; i < n; i += len) {
-            std::complex<double> w(1.0, 0.0);
-            for (size_t j = 0; j < len / 2; ++j) {
-                std::complex<double> u = x[i + j];
-                std::complex<double> t = w * x[i + j + len / 2];
-                x[i + j] = u + t;
-                x[i + j + len / 2] = u - t;
-                w *= wlen;
-            }
+std::span<const std::complex<double>> FeatureExtractor::feature_spectrum(
+    const SpectrumSetup& setup, std::span<const double> signal,
+    std::vector<double>& segment, std::vector<std::complex<double>>& spectrum,
+    std::vector<std::complex<double>>& full_spectrum, std::span<double> magnitudes,
+    bool want_magnitudes) const {
+
+    if (!setup.window) {
+        spectrum.resize(setup.plan->num_bins());
+        if (want_magnitudes) {
+            magnitude_spectrum(*setup.plan, signal, spectrum, magnitudes);
+        } else {
+            setup.plan->forward_real(signal, spectrum);
         }
+        return spectrum;
+    }
+
+    if (want_magnitudes) {
+        welch_spectrum(*setup.plan, *setup.window, setup.hop, signal, segment, spectrum, magnitudes);
+    }
+    if (!setup.full_plan) {
+        return {};
     }
+    full_spectrum.resize(setup.full_plan->num_bins());
+    setup.full_plan->forward_real(signal, full_spectrum);
+    return full_spectrum;
 }
 
 std::pair<std::vector<double>, std::vector<double>>
-FeatureExtractor::compute_fft(const std::vector<double>& signal) const {
+FeatureExtractor::compute_welch(std::span<const double> signal) const {
     if (signal.empty()) {
         return {{}, {}};
     }
 
-    // Pad to next power of 2
-    size_t n = next_power_of_2(signal.size());
-    std::vector<std::complex<double>> x(n, {0.0, 0.0});
+    // Configured settings, or the defaults when Welch mode is off
+    const WelchConfig config = welch_.value_or(WelchConfig{});
+    const size_t length = std::min(config.segment_length, signal.size());
+    const auto overlap = static_cast<size_t>(std::llround(static_cast<double>(length) * config.overlap));
+    auto plan = FFTPlan::get(length);
+    auto window = WindowTable::get(config.window, length);
+
+    std::vector<double> segment;
+    std::vector<std::complex<double>> spectrum;
+    std::vector<double> magnitudes(plan->num_bins());
+    welch_spectrum(*plan, *window, std::max<size_t>(1, length - std::min(overlap, length)),
+                   signal, segment, spectrum, magnitudes);
+
+    std::vector<double> frequencies(plan->num_bins());
+    double freq_resolution = sample_rate_ / static_cast<double>(length);
+    for (size_t i = 0; i < frequencies.size(); ++i) {
+        frequencies[i] = static_cast<double>(i) * freq_resolution;
+    }
+    return {magnitudes, frequencies};
+}
 
-    // Copy signal to complex array
-    for (size_t i = 0; i < signal.size(); ++i) {
-        x[i] = std::complex<double>(signal[i], 0.0);
+void FeatureExtractor::set_welch(const WelchConfig& config) {
+    if (config.segment_length < 2) {
+        throw std::invalid_argument("Welch segment length must be at least 2");
     }
+    if (!(config.overlap >= 0.0 && config.overlap < 1.0)) {
+        throw std::invalid_argument("Welch overlap must be in [0, 1)");
+    }
+    welch_ = config;
+}
 
-    // Compute FFT
-    fft_recursive(x);
+void FeatureExtractor::clear_welch() {
+    welch_.reset();
+}
 
-    // Extract magnitude spectrum (positive frequencies only)
-    size_t half_n = n / 2;
+std::pair<std::vector<double>, std::vector<double>>
+FeatureExtractor::compute_fft(std::span<const double> signal) const {
+    if (signal.empty()) {
+        return {{}, {}};
+    }
+
+    // Exact-length transform, so the grid matches numpy's fftfreq(n)
+    size_t n = signal.size();
+    auto plan = FFTPlan::get(n);
+
+    size_t half_n = plan->num_bins();
+    std::vector<std::complex<double>> x(half_n);
     std::vector<double> magnitudes(half_n);
     std::vector<double> frequencies(half_n);
 
-    double freq_resolution = sample_rate_ / static_cast<double>(n);
+    magnitude_spectrum(*plan, signal, x, magnitudes);
 
+    double freq_resolution = sample_rate_ / static_cast<double>(n);
     for (size_t i = 0; i < half_n; ++i) {
-        magnitudes[i] = std::abs(x[i]) * 2.0 / static_cast<double>(n);
         frequencies[i] = static_cast<double>(i) * freq_resolution;
     }
 
-    // DC component doesn't need doubling
-    if (!magnitudes.empty()) {
-        magnitudes[0] /= 2.0;
-    }
-
     return {magnitudes, frequencies};
 }
 
 double FeatureExtractor::compute_spectral_centroid(
-    const std::vector<double>& magnitudes,
-    const std::vector<double>& frequencies) const {
+    std::span<const double> magnitudes,
+    std::span<const double> frequencies) const {
 
     if (magnitudes.empty() || frequencies.empty()) {
         return 0.0;
     }
+    CPM_STATS_STAGE(SpectralShape, magnitudes.size_bytes());
 
     double weighted_sum = 0.0;
     double total_power = 0.0;
-
-    for (size_t i = 0; i < magnitudes.size() && i < frequencies.size(); ++i) {
-        double power = magnitudes[i] * magnitudes[i];
-        weighted_sum += frequencies[i] * power;
-        total_power += power;
-    }
+    simd::active().power_moments(magnitudes.data(), frequencies.data(),
+                                 std::min(magnitudes.size(), frequencies.size()),
+                                 total_power, weighted_sum);
 
     if (total_power < 1e-10) {
         return 0.0;
@@ -241,23 +665,20 @@ double FeatureExtractor::compute_spectral_centroid(
 }
 
 double FeatureExtractor::compute_spectral_spread(
-    const std::vector<double>& magnitudes,
-    const std::vector<double>& frequencies,
+    std::span<const double> magnitudes,
+    std::span<const double> frequencies,
     double centroid) const {
 
     if (magnitudes.empty() || frequencies.empty()) {
         return 0.0;
     }
+    CPM_STATS_STAGE(SpectralShape, magnitudes.size_bytes());
 
     double weighted_var = 0.0;
     double total_power = 0.0;
-
-    for (size_t i = 0; i < magnitudes.size() && i < frequencies.size(); ++i) {
-        double power = magnitudes[i] * magnitudes[i];
-        double diff = frequencies[i] - centroid;
-        weighted_var += diff * diff * power;
-        total_power += power;
-    }
+    simd::active().power_spread(magnitudes.data(), frequencies.data(),
+                                std::min(magnitudes.size(), frequencies.size()),
+                                centroid, total_power, weighted_var);
 
     if (total_power < 1e-10) {
         return 0.0;
@@ -267,61 +688,378 @@ double FeatureExtractor::compute_spectral_spread(
 }
 
 std::vector<double> FeatureExtractor::compute_bandpower(
-    const std::vector<double>& magnitudes,
-    const std::vector<double>& frequencies) const {
+    std::span<const double> magnitudes,
+    std::span<const double> frequencies) const {
+
+    // Arbitrary grid: frequencies ascend, so each band is a contiguous run
+    // of bins found by binary search
+    const size_t n = std::min(magnitudes.size(), frequencies.size());
+    const auto freqs = frequencies.first(n);
+    const auto& k = simd::active();
+    CPM_STATS_STAGE(Bandpower, n * sizeof(double));
+
+    std::vector<double> bandpowers(bands_->size(), 0.0);
+    for (size_t b = 0; b < bands_->size(); ++b) {
+        auto lo = std::lower_bound(freqs.begin(), freqs.end(), (*bands_)[b].low);
+        auto hi = std::lower_bound(lo, freqs.end(), (*bands_)[b].high);
+        const size_t begin = static_cast<size_t>(lo - freqs.begin());
+        const size_t end = static_cast<size_t>(hi - freqs.begin());
+        bandpowers[b] = k.sum_squares(magnitudes.data() + begin, end - begin);
+    }
+    return bandpowers;
+}
+
+std::vector<std::string> FeatureExtractor::get_band_names() const {
+    return bands_->names().vector();
+}
 
-    std::vector<double> bandpowers(FREQ_BANDS.size(), 0.0);
+SignalFeatures FeatureExtractor::extract_all(std::span<const double> signal) const {
+    Workspace workspace;
+    extract_all(signal, workspace);
+    return std::move(workspace.features);
+}
 
-    if (magnitudes.empty() || frequencies.empty()) {
-        return bandpowers;
+SignalFeatures FeatureExtractor::extract_all(std::span<const float> signal) const {
+    Workspace workspace;
+    extract_all(signal, workspace);
+    return std::move(workspace.features);
+}
+
+SignalFeatures FeatureExtractor::extract_all(std::span<const int16_t> signal, double scale) const {
+    Workspace workspace;
+    extract_all(signal, scale, workspace);
+    return std::move(workspace.features);
+}
+
+const SignalFeatures& FeatureExtractor::extract_all(
+    std::span<const double> signal, Workspace& workspace, bool include_spectrum) const {
+    CPM_STATS_STAGE(Extract, signal.size_bytes());
+    return extract_samples(signal, 1.0, workspace, include_spectrum);
+}
+
+const SignalFeatures& FeatureExtractor::extract_all(
+    std::span<const float> signal, Workspace& workspace, bool include_spectrum) const {
+    CPM_STATS_STAGE(Extract, signal.size_bytes());
+    return extract_samples(signal, 1.0, workspace, include_spectrum);
+}
+
+const SignalFeatures& FeatureExtractor::extract_all(
+    std::span<const int16_t> signal, double scale, Workspace& workspace,
+    bool include_spectrum) const {
+    CPM_STATS_STAGE(Extract, signal.size_bytes());
+    return extract_samples(signal, scale, workspace, include_spectrum);
+}
+
+void FeatureExtractor::spectral_features(std::span<const double> signal, const Stages& stages,
+                                         Workspace& workspace) const {
+    // resize() keeps capacity, so nothing is allocated once the buffers
+    // have seen this length
+    SignalFeatures& features = workspace.features;
+    const size_t n = signal.size();
+    const SpectrumSetup setup = spectrum_setup(n, stages.faults);
+    const size_t fft_size = setup.plan->size();
+    const size_t half_n = setup.plan->num_bins();
+
+    if (workspace.grid_fft_size != fft_size || workspace.grid_sample_rate != sample_rate_) {
+        workspace.frequencies.resize(half_n);
+        double freq_resolution = sample_rate_ / static_cast<double>(fft_size);
+        for (size_t i = 0; i < half_n; ++i) {
+            workspace.frequencies[i] = static_cast<double>(i) * freq_resolution;
+        }
+        workspace.grid_fft_size = fft_size;
+        workspace.grid_sample_rate = sample_rate_;
+    }
+
+    std::vector<double>& magnitudes = stages.keep_spectrum ? features.fft_magnitude : workspace.magnitudes;
+    magnitudes.resize(half_n);
+    auto full_spectrum = feature_spectrum(setup, signal, workspace.segment, workspace.spectrum,
+                                          workspace.full_spectrum, magnitudes, stages.magnitudes);
+
+    if (stages.keep_spectrum) {
+        features.fft_frequencies.assign(workspace.frequencies.begin(), workspace.frequencies.end());
+    }
+
+    if (stages.centroid) {
+        features.spectral_centroid = compute_spectral_centroid(magnitudes, workspace.frequencies);
+    }
+    if (stages.spread) {
+        features.spectral_spread = compute_spectral_spread(magnitudes, workspace.frequencies,
+                                                           features.spectral_centroid);
+    }
+    if (stages.bandpowers) {
+        CPM_STATS_STAGE(Bandpower, half_n * sizeof(double));
+        band_layout(fft_size, half_n)->accumulate(magnitudes, features.bandpowers);
+    }
+    if (stages.faults) {
+        envelope_->fault_amplitudes(full_spectrum, n, sample_rate_, features.fault_amplitudes);
     }
+}
+
+template <typename T>
+const SignalFeatures& FeatureExtractor::extract_samples(
+    std::span<const T> signal, double scale, Workspace& workspace, bool include_spectrum) const {
 
-    for (size_t i = 0; i < magnitudes.size() && i < frequencies.size(); ++i) {
-        double freq = frequencies[i];
-        double power = magnitudes[i] * magnitudes[i];
+    const Stages stages = this->stages(include_spectrum);
 
-        for (size_t b = 0; b < FREQ_BANDS.size(); ++b) {
-            if (freq >= FREQ_BANDS[b].first && freq < FREQ_BANDS[b].second) {
-                bandpowers[b] += power;
-                break;
+    // Transforms run in double: widen once and take every feature from that,
+    // unless only time-domain features are selected
+    if constexpr (!std::is_same_v<T, double>) {
+        if (stages.spectrum && !signal.empty()) {
+            workspace.samples.resize(signal.size());
+            {
+                CPM_STATS_STAGE(Widen, signal.size_bytes());
+                widen(simd::active(), signal.data(), signal.size(), scale, workspace.samples.data());
             }
+            return extract_samples(std::span<const double>(workspace.samples), 1.0, workspace,
+                                   include_spectrum);
         }
     }
 
-    return bandpowers;
-}
+    SignalFeatures& features = workspace.features;
 
-std::vector<std::string> FeatureExtractor::get_band_names() const {
-    return {
-        "0-100 Hz",
-        "100-500 Hz",
-        "500-1000 Hz",
-        "1000-2000 Hz",
-        "2000+ Hz"
-    };
+    // Time-domain features
+    TimeStats stats = time_features(signal, scale, stages);
+    features.rms = stats.rms;
+    features.peak = stats.peak;
+    features.crest_factor = stats.crest_factor;
+    features.kurtosis = stats.kurtosis;
+    features.skewness = stats.skewness;
+
+    features.bandpowers.assign(bands_->size(), 0.0);
+    features.band_names = bands_->names();
+    if (envelope_) {
+        features.fault_amplitudes.assign(envelope_->num_faults(), 0.0);
+        features.fault_names = envelope_->fault_names();
+    } else {
+        features.fault_amplitudes.clear();
+        features.fault_names = BandNames();
+    }
+    features.spectral_centroid = 0.0;
+    features.spectral_spread = 0.0;
+
+    if (!stages.keep_spectrum || signal.empty()) {
+        features.fft_magnitude.clear();
+        features.fft_frequencies.clear();
+    }
+
+    // Narrow input only reaches here when no transform is needed
+    if constexpr (std::is_same_v<T, double>) {
+        if (stages.spectrum && !signal.empty()) {
+            spectral_features(signal, stages, workspace);
+        }
+    }
+
+    mask_features(features_, features);
+    return features;
 }
 
-SignalFeatures FeatureExtractor::extract_all(const std::vector<double>& signal) const {
-    SignalFeatures features;
+void FeatureExtractor::extract_row(
+    std::span<const double> row, const Stages& stages, const SpectrumSetup* setup,
+    std::span<const double> frequencies, const BandLayout* layout,
+    BatchScratch& scratch, BatchFeatures& out, size_t index) const {
 
     // Time-domain features
-    features.rms = compute_rms(signal);
-    features.peak = compute_peak(signal);
-    features.crest_factor = compute_crest_factor(signal);
-    features.kurtosis = compute_kurtosis(signal);
-    features.skewness = compute_skewness(signal);
+    if (stages.time || stages.moments) {
+        store_time_stats(time_features(row, 1.0, stages), out, index);
+    }
+
+    if (!stages.spectrum) {
+        return;
+    }
 
     // Frequency-domain features
-    auto [magnitudes, frequencies] = compute_fft(signal);
-    features.fft_magnitude = magnitudes;
-    features.fft_frequencies = frequencies;
+    auto full_spectrum = feature_spectrum(*setup, row, scratch.segment, scratch.spectrum,
+                                          scratch.full_spectrum, scratch.magnitudes,
+                                          stages.magnitudes);
+
+    if (stages.centroid) {
+        double centroid = compute_spectral_centroid(scratch.magnitudes, frequencies);
+        out.spectral_centroid[index] = centroid;
+        if (stages.spread) {
+            out.spectral_spread[index] = compute_spectral_spread(
+                scratch.magnitudes, frequencies, centroid);
+        }
+    }
+    if (stages.bandpowers) {
+        CPM_STATS_STAGE(Bandpower, scratch.magnitudes.size() * sizeof(double));
+        layout->accumulate(scratch.magnitudes,
+                           std::span<double>(out.bandpowers).subspan(index * out.num_bands, out.num_bands));
+    }
+    if (stages.faults) {
+        envelope_->fault_amplitudes(
+            full_spectrum, row.size(), sample_rate_,
+            std::span<double>(out.fault_amplitudes).subspan(index * out.num_faults, out.num_faults));
+    }
+}
+
+BatchFeatures FeatureExtractor::extract_batch(
+    std::span<const double> data, size_t num_rows, size_t row_length) const {
+    return batch_samples(data, 1.0, num_rows, row_length);
+}
 
-    features.spectral_centroid = compute_spectral_centroid(magnitudes, frequencies);
-    features.spectral_spread = compute_spectral_spread(magnitudes, frequencies, features.spectral_centroid);
-    features.bandpowers = compute_bandpower(magnitudes, frequencies);
-    features.band_names = get_band_names();
+BatchFeatures FeatureExtractor::extract_batch(
+    std::span<const float> data, size_t num_rows, size_t row_length) const {
+    return batch_samples(data, 1.0, num_rows, row_length);
+}
 
-    return features;
+BatchFeatures FeatureExtractor::extract_batch(
+    std::span<const int16_t> data, double scale, size_t num_rows, size_t row_length) const {
+    return batch_samples(data, scale, num_rows, row_length);
+}
+
+template <typename T>
+BatchFeatures FeatureExtractor::batch_samples(
+    std::span<const T> data, double scale, size_t num_rows, size_t row_length) const {
+
+    CPM_STATS_STAGE(Batch, data.size_bytes());
+    BatchFeatures out;
+    out.num_rows = num_rows;
+    out.num_bands = bands_->size();
+    out.band_names = bands_->names();
+
+    out.rms.assign(num_rows, 0.0);
+    out.peak.assign(num_rows, 0.0);
+    out.crest_factor.assign(num_rows, 0.0);
+    out.kurtosis.assign(num_rows, 0.0);
+    out.skewness.assign(num_rows, 0.0);
+    out.spectral_centroid.assign(num_rows, 0.0);
+    out.spectral_spread.assign(num_rows, 0.0);
+    out.bandpowers.assign(num_rows * out.num_bands, 0.0);
+    if (envelope_) {
+        out.num_faults = envelope_->num_faults();
+        out.fault_names = envelope_->fault_names();
+        out.fault_amplitudes.assign(num_rows * out.num_faults, 0.0);
+    }
+
+    if (data.size() != num_rows * row_length) {
+        throw std::invalid_argument("Batch data size does not match num_rows x row_length");
+    }
+    if (num_rows == 0 || row_length == 0) {
+        mask_features(features_, out);
+        return out;
+    }
+
+    // One plan, frequency grid and band layout for every row, unless no
+    // frequency-domain feature is selected
+    const Stages stages = this->stages(false);
+    SpectrumSetup setup;
+    std::shared_ptr<const BandLayout> layout;
+    std::vector<double> frequencies;
+    size_t half_n = 0;
+    if (stages.spectrum) {
+        setup = spectrum_setup(row_length, stages.faults);
+        const size_t n = setup.plan->size();
+        half_n = setup.plan->num_bins();
+        layout = band_layout(n, half_n);
+
+        frequencies.resize(half_n);
+        double freq_resolution = sample_rate_ / static_cast<double>(n);
+        for (size_t i = 0; i < half_n; ++i) {
+            frequencies[i] = static_cast<double>(i) * freq_resolution;
+        }
+    }
+
+    // Narrow rows needing a transform are widened into per-worker scratch
+    constexpr bool widened = !std::is_same_v<T, double>;
+    auto make_scratch = [&] {
+        BatchScratch scratch;
+        scratch.spectrum.resize(half_n);
+        scratch.magnitudes.resize(half_n);
+        if (widened && stages.spectrum) {
+            scratch.samples.resize(row_length);
+        }
+        return scratch;
+    };
+
+    auto run_row = [&](size_t r, BatchScratch& scratch) {
+        auto row = data.subspan(r * row_length, row_length);
+        if constexpr (widened) {
+            if (!stages.spectrum) {
+                store_time_stats(time_features(row, scale, stages), out, r);
+                return;
+            }
+            {
+                CPM_STATS_STAGE(Widen, row.size_bytes());
+                widen(simd::active(), row.data(), row_length, scale, scratch.samples.data());
+            }
+            extract_row(scratch.samples, stages, &setup, frequencies, layout.get(), scratch, out, r);
+        } else {
+            extract_row(row, stages, &setup, frequencies, layout.get(), scratch, out, r);
+        }
+    };
+
+    const size_t threads = std::min(ThreadPool::resolve_threads(num_threads_), num_rows);
+    if (threads <= 1) {
+        BatchScratch scratch = make_scratch();
+        for (size_t r = 0; r < num_rows; ++r) {
+            run_row(r, scratch);
+        }
+        mask_features(features_, out);
+        return out;
+    }
+
+    // Rows write disjoint output slots, so only scratch needs to be per worker.
+    // Several chunks per worker lets stealing even out uneven progress.
+    auto pool = ThreadPool::shared(num_threads_);
+    std::vector<BatchScratch> scratch(pool->size());
+    for (auto& s : scratch) {
+        s = make_scratch();
+    }
+
+    const size_t grain = std::max<size_t>(1, num_rows / (pool->size() * 8));
+    pool->parallel_for(num_rows, grain, [&](size_t begin, size_t end, size_t worker) {
+        for (size_t r = begin; r < end; ++r) {
+            run_row(r, scratch[worker]);
+        }
+    });
+
+    mask_features(features_, out);
+    return out;
+}
+
+MultichannelFeatures FeatureExtractor::extract_multichannel(
+    std::span<const double> data, size_t num_channels, ChannelLayout layout,
+    size_t cross_segment) const {
+
+    if (num_channels == 0) {
+        throw std::invalid_argument("Number of channels must be positive");
+    }
+    if (data.size() % num_channels != 0) {
+        throw std::invalid_argument("Multichannel data size is not a multiple of the channel count");
+    }
+
+    MultichannelFeatures out;
+    out.num_channels = num_channels;
+    out.num_samples = data.size() / num_channels;
+
+    // Channels become rows of a planar matrix; planar input is used in place
+    std::vector<double> transposed;
+    std::span<const double> planar = data;
+    if (layout == ChannelLayout::Interleaved && num_channels > 1) {
+        deinterleave(data, num_channels, out.num_samples, transposed);
+        planar = transposed;
+    }
+
+    out.channels = extract_batch(planar, num_channels, out.num_samples);
+
+    // mean(sum_c x_c^2) is the sum of the per-channel mean squares; the
+    // channel RMS is reused when selected, otherwise one pass over the samples
+    if (has_feature(features_, Feature::Rms)) {
+        double sum_sq = 0.0;
+        for (double rms : out.channels.rms) {
+            sum_sq += rms * rms;
+        }
+        out.vector_rms = std::sqrt(sum_sq);
+    } else if (out.num_samples > 0) {
+        double sum_sq = simd::active().sum_squares(planar.data(), planar.size());
+        out.vector_rms = std::sqrt(sum_sq / static_cast<double>(out.num_samples));
+    }
+
+    if (cross_segment > 0) {
+        cross_spectra(planar, num_channels, out.num_samples, cross_segment, sample_rate_, out);
+    }
+
+    return out;
 }
 
 } // namespace cpm
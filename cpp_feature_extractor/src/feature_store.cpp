@@ -0,0 +1,638 @@
+#include "feature_store.hpp"
+#include "xxhash.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cpm {
+
+namespace {
+
+// Address space reserved for the mapping; the file itself grows on demand
+constexpr size_t MAX_STORE_BYTES = size_t{1} << 36;
+
+// Files grow in steps, so appends rarely need an ftruncate
+constexpr size_t GROWTH = size_t{1} << 20;
+
+constexpr size_t NUM_SCALARS = 7;  // rms ... spectral_spread in FeatureRecord
+
+// Exclusive (or shared) flock held for one scope
+class FileLock {
+public:
+    FileLock(int fd, int operation) : fd_(fd) {
+        if (::flock(fd_, operation) != 0) {
+            throw std::runtime_error("Cannot lock feature store");
+        }
+    }
+    ~FileLock() { ::flock(fd_, LOCK_UN); }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+private:
+    int fd_;
+};
+
+// Flat byte image of the settings that feed feature_config_hash
+struct ConfigBytes {
+    std::string bytes;
+
+    template <typename T>
+    void add(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void add(const std::string& s) {
+        add(static_cast<uint64_t>(s.size()));
+        bytes += s;
+    }
+};
+
+template <typename T>
+uint64_t hash_samples(std::span<const T> signal) {
+    // Seeded with the sample width so equal bytes of different types differ
+    return xxh64(signal.data(), signal.size_bytes(), sizeof(T));
+}
+
+void copy_scalars(const SignalFeatures& f, double* out) {
+    const double values[NUM_SCALARS] = {f.rms, f.peak, f.crest_factor, f.kurtosis, f.skewness,
+                                        f.spectral_centroid, f.spectral_spread};
+    std::copy(values, values + NUM_SCALARS, out);
+}
+
+// Bin spacing and encoded spectrum block at the end of each record
+size_t spectrum_slot_size(SpectrumEncoding encoding, size_t num_bins) {
+    return num_bins > 0 ? sizeof(double) + encoded_spectrum_size(encoding, num_bins) : 0;
+}
+
+size_t num_faults_of(const FeatureExtractor& extractor) {
+    const EnvelopeAnalyzer* envelope = extractor.get_envelope();
+    return envelope ? envelope->num_faults() : 0;
+}
+
+} // namespace
+
+uint64_t waveform_hash(std::span<const double> signal) {
+    return hash_samples(signal);
+}
+
+uint64_t waveform_hash(std::span<const float> signal) {
+    return hash_samples(signal);
+}
+
+uint64_t waveform_hash(std::span<const int16_t> signal) {
+    return hash_samples(signal);
+}
+
+uint64_t feature_config_hash(const FeatureExtractor& extractor, double scale) {
+    ConfigBytes c;
+    c.add(uint32_t{1});  // Record format version
+    c.add(extractor.get_sample_rate());
+    c.add(static_cast<uint32_t>(extractor.get_features()));
+    c.add(scale);
+
+    const BandSet& bands = extractor.get_bands();
+    c.add(static_cast<uint64_t>(bands.size()));
+    for (const auto& band : bands.bands()) {
+        c.add(band.low);
+        c.add(band.high);
+        c.add(band.name);
+    }
+
+    const WelchConfig* welch = extractor.get_welch();
+    c.add(welch != nullptr);
+    if (welch) {
+        c.add(static_cast<uint64_t>(welch->segment_length));
+        c.add(welch->overlap);
+        c.add(static_cast<uint32_t>(welch->window));
+    }
+
+    const EnvelopeAnalyzer* envelope = extractor.get_envelope();
+    c.add(envelope != nullptr);
+    if (envelope) {
+        const EnvelopeConfig& e = envelope->config();
+        for (double v : {e.band_low, e.band_high, e.shaft_hz, e.orders.bpfo, e.orders.bpfi,
+                         e.orders.bsf, e.orders.ftf, e.half_width_hz}) {
+            c.add(v);
+        }
+        c.add(static_cast<uint64_t>(e.harmonics));
+    }
+
+    return xxh64(c.bytes.data(), c.bytes.size());
+}
+
+FeatureStore FeatureStore::open(const std::string& path, size_t num_bands, size_t num_faults,
+                                size_t num_bins, SpectrumEncoding encoding) {
+    return open_file(path, true, num_bands, num_faults, num_bins, encoding);
+}
+
+FeatureStore FeatureStore::open_readonly(const std::string& path) {
+    return open_file(path, false, 0, 0, 0, SpectrumEncoding::Float16);
+}
+
+FeatureStore FeatureStore::open_file(const std::string& path, bool writable, size_t num_bands,
+                                     size_t num_faults, size_t num_bins, SpectrumEncoding encoding) {
+    if constexpr (std::endian::native != std::endian::little) {
+        throw std::runtime_error("CPMS files are only supported on little-endian hosts");
+    }
+
+    FeatureStore store;
+    store.writable_ = writable;
+    store.fd_ = ::open(path.c_str(), (writable ? O_RDWR | O_CREAT : O_RDONLY) | O_CLOEXEC, 0644);
+    if (store.fd_ < 0) {
+        throw std::runtime_error("Cannot open feature store: " + path);
+    }
+
+    FeatureStoreHeader header;
+    {
+        // Creation holds the exclusive lock, so nobody reads a half-written header
+        FileLock lock(store.fd_, writable ? LOCK_EX : LOCK_SH);
+        struct stat st;
+        if (::fstat(store.fd_, &st) != 0) {
+            throw std::runtime_error("Cannot stat feature store: " + path);
+        }
+
+        if (st.st_size == 0 && writable) {
+            header.num_bands = static_cast<uint32_t>(num_bands);
+            header.num_faults = static_cast<uint32_t>(num_faults);
+            header.num_bins = static_cast<uint32_t>(num_bins);
+            header.spectrum_encoding = static_cast<uint16_t>(encoding);
+            header.record_size = static_cast<uint32_t>(
+                sizeof(FeatureRecord) + (num_bands + num_faults) * sizeof(double) +
+                spectrum_slot_size(encoding, num_bins));
+            if (::pwrite(store.fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+                throw std::runtime_error("Cannot write feature store header: " + path);
+            }
+        } else {
+            if (::pread(store.fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+                std::memcmp(header.magic, "CPMS", 4) != 0) {
+                throw std::runtime_error("Not a CPMS feature store: " + path);
+            }
+            if (header.version != 1) {
+                throw std::runtime_error("Unsupported CPMS version " + std::to_string(header.version));
+            }
+            if (writable && (header.num_bands != num_bands || header.num_faults != num_faults)) {
+                throw std::invalid_argument(
+                    "Feature store " + path + " holds " + std::to_string(header.num_bands) +
+                    " bands and " + std::to_string(header.num_faults) + " fault amplitudes per record");
+            }
+            if (writable && (header.num_bins != num_bins ||
+                             (num_bins > 0 && header.spectrum_encoding != static_cast<uint16_t>(encoding)))) {
+                throw std::invalid_argument(
+                    "Feature store " + path + " holds " + std::to_string(header.num_bins) + " " +
+                    spectrum_encoding_name(static_cast<SpectrumEncoding>(header.spectrum_encoding)) +
+                    " spectrum bins per record");
+            }
+            if (header.record_size !=
+                sizeof(FeatureRecord) + (header.num_bands + header.num_faults) * sizeof(double) +
+                    spectrum_slot_size(static_cast<SpectrumEncoding>(header.spectrum_encoding), header.num_bins)) {
+                throw std::runtime_error("Corrupt CPMS header: " + path);
+            }
+        }
+    }
+
+    store.num_bands_ = header.num_bands;
+    store.num_faults_ = header.num_faults;
+    store.num_bins_ = header.num_bins;
+    store.encoding_ = static_cast<SpectrumEncoding>(header.spectrum_encoding);
+    store.record_size_ = header.record_size;
+
+    // Mapping past the end of the file is allowed; only published records,
+    // which always lie inside it, are ever touched
+    void* map = ::mmap(nullptr, MAX_STORE_BYTES, PROT_READ | (writable ? PROT_WRITE : 0),
+                       MAP_SHARED, store.fd_, 0);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error("Cannot map feature store: " + path);
+    }
+    store.map_ = static_cast<unsigned char*>(map);
+    store.map_size_ = MAX_STORE_BYTES;
+    return store;
+}
+
+FeatureStore::FeatureStore(FeatureStore&& other) noexcept {
+    *this = std::move(other);
+}
+
+FeatureStore& FeatureStore::operator=(FeatureStore&& other) noexcept {
+    if (this != &other) {
+        release();
+        fd_ = std::exchange(other.fd_, -1);
+        writable_ = other.writable_;
+        map_ = std::exchange(other.map_, nullptr);
+        map_size_ = std::exchange(other.map_size_, 0);
+        num_bands_ = other.num_bands_;
+        num_faults_ = other.num_faults_;
+        num_bins_ = other.num_bins_;
+        encoding_ = other.encoding_;
+        record_size_ = other.record_size_;
+        index_ = std::move(other.index_);
+        indexed_ = std::exchange(other.indexed_, 0);
+        hits_.store(other.hits_.load());
+        misses_.store(other.misses_.load());
+    }
+    return *this;
+}
+
+FeatureStore::~FeatureStore() {
+    release();
+}
+
+void FeatureStore::release() {
+    if (map_) {
+        ::munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+uint64_t FeatureStore::published() const {
+    auto* header = reinterpret_cast<FeatureStoreHeader*>(map_);
+    return std::atomic_ref<uint64_t>(header->num_records).load(std::memory_order_acquire);
+}
+
+size_t FeatureStore::size() const {
+    return static_cast<size_t>(published());
+}
+
+const FeatureRecord* FeatureStore::record(uint64_t index) const {
+    return reinterpret_cast<const FeatureRecord*>(map_ + sizeof(FeatureStoreHeader) + index * record_size_);
+}
+
+void FeatureStore::refresh() const {
+    const uint64_t count = published();
+    for (; indexed_ < count; ++indexed_) {
+        const FeatureRecord* r = record(indexed_);
+        // Later records supersede earlier ones with the same key
+        index_.insert_or_assign({r->waveform_hash, r->config_hash}, indexed_);
+    }
+}
+
+const FeatureRecord* FeatureStore::lookup(uint64_t waveform_hash, uint64_t config_hash,
+                                          size_t num_samples) const {
+    auto it = index_.find({waveform_hash, config_hash});
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    const FeatureRecord* r = record(it->second);
+    return num_samples == 0 || r->num_samples == num_samples ? r : nullptr;
+}
+
+bool FeatureStore::has_spectrum(const FeatureRecord& record) const {
+    if (num_bins_ == 0) {
+        return false;
+    }
+    const auto* slot = reinterpret_cast<const unsigned char*>(record.values() + num_bands_ + num_faults_);
+    SpectrumBlockHeader block;
+    std::memcpy(&block, slot + sizeof(double), sizeof(block));
+    return block.num_values == num_bins_;
+}
+
+bool FeatureStore::spectrum_unstorable(const FeatureRecord& record) const {
+    // extract stores the bin spacing of every spectrum it computed, while
+    // extract_batch computes none and leaves it 0
+    if (num_bins_ == 0 || has_spectrum(record)) {
+        return false;
+    }
+    double bin_spacing;
+    std::memcpy(&bin_spacing, record.values() + num_bands_ + num_faults_, sizeof(double));
+    return bin_spacing > 0.0;
+}
+
+const FeatureRecord* FeatureStore::find(uint64_t waveform_hash, uint64_t config_hash) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    return lookup(waveform_hash, config_hash);
+}
+
+void FeatureStore::check_layout(const FeatureExtractor& extractor) const {
+    if (extractor.get_bands().size() != num_bands_ || num_faults_of(extractor) != num_faults_) {
+        throw std::invalid_argument("Extractor bands and fault lines do not match the feature store layout");
+    }
+}
+
+void FeatureStore::reserve(uint64_t extra) const {
+    const size_t needed = sizeof(FeatureStoreHeader) + (published() + extra) * record_size_;
+    if (needed > map_size_) {
+        throw std::runtime_error("Feature store is full");
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        throw std::runtime_error("Cannot stat feature store");
+    }
+    if (static_cast<size_t>(st.st_size) < needed) {
+        const size_t size = std::min(map_size_, (needed + GROWTH - 1) / GROWTH * GROWTH);
+        if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+            throw std::runtime_error("Cannot grow feature store");
+        }
+    }
+}
+
+const FeatureRecord* FeatureStore::append_locked(
+    uint64_t waveform_hash, uint64_t config_hash, const double* scalars,
+    std::span<const double> bandpowers, std::span<const double> faults,
+    std::span<const double> spectrum, double bin_spacing, size_t num_samples, double sample_rate) {
+
+    const bool storable = num_bins_ > 0 && spectrum.size() == num_bins_ &&
+        std::all_of(spectrum.begin(), spectrum.end(), [](double x) { return std::isfinite(x); });
+
+    // Another process may have stored the same key since the last lookup;
+    // only a record that adds a missing spectrum is worth another slot
+    refresh();
+    if (const FeatureRecord* existing = lookup(waveform_hash, config_hash, num_samples)) {
+        if (!storable || has_spectrum(*existing)) {
+            return existing;
+        }
+    }
+
+    const uint64_t index = published();
+    auto* r = reinterpret_cast<FeatureRecord*>(map_ + sizeof(FeatureStoreHeader) + index * record_size_);
+    r->waveform_hash = waveform_hash;
+    r->config_hash = config_hash;
+    r->num_samples = num_samples;
+    r->sample_rate = sample_rate;
+    std::copy(scalars, scalars + NUM_SCALARS, &r->rms);
+    auto* values = const_cast<double*>(r->values());
+    std::copy(bandpowers.begin(), bandpowers.end(), values);
+    std::copy(faults.begin(), faults.end(), values + num_bands_);
+    if (num_bins_ > 0) {
+        // Spectra of another length, or with NaN bins, leave an empty block
+        auto* slot = reinterpret_cast<unsigned char*>(values + num_bands_ + num_faults_);
+        const size_t block = encoded_spectrum_size(encoding_, num_bins_);
+        std::memcpy(slot, &bin_spacing, sizeof(double));
+        if (storable) {
+            encode_spectrum(spectrum, encoding_, {slot + sizeof(double), block});
+        } else {
+            std::memset(slot + sizeof(double), 0, sizeof(SpectrumBlockHeader));
+        }
+    }
+
+    // Publish: readers that see the new count also see the record
+    auto* header = reinterpret_cast<FeatureStoreHeader*>(map_);
+    std::atomic_ref<uint64_t>(header->num_records).store(index + 1, std::memory_order_release);
+    index_.insert_or_assign({waveform_hash, config_hash}, index);
+    indexed_ = index + 1;
+    return r;
+}
+
+const FeatureRecord* FeatureStore::append(uint64_t waveform_hash, uint64_t config_hash,
+                                          const SignalFeatures& features, size_t num_samples,
+                                          double sample_rate) {
+    if (!writable_) {
+        throw std::logic_error("Feature store is read-only");
+    }
+    if (features.bandpowers.size() != num_bands_ || features.fault_amplitudes.size() != num_faults_) {
+        throw std::invalid_argument("Feature bands and fault lines do not match the feature store layout");
+    }
+
+    double scalars[NUM_SCALARS];
+    copy_scalars(features, scalars);
+    const auto& freqs = features.fft_frequencies;
+    const double bin_spacing = freqs.size() > 1 ? freqs[1] - freqs[0] : 0.0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    FileLock file_lock(fd_, LOCK_EX);
+    reserve(1);
+    return append_locked(waveform_hash, config_hash, scalars, features.bandpowers,
+                         features.fault_amplitudes, features.fft_magnitude, bin_spacing,
+                         num_samples, sample_rate);
+}
+
+bool FeatureStore::spectrum(const FeatureRecord& record, std::vector<double>& magnitudes,
+                            std::vector<double>& frequencies) const {
+    magnitudes.clear();
+    frequencies.clear();
+    if (num_bins_ == 0) {
+        return false;
+    }
+    const auto* slot = reinterpret_cast<const unsigned char*>(record.values() + num_bands_ + num_faults_);
+    const std::span<const unsigned char> block(slot + sizeof(double), encoded_spectrum_size(encoding_, num_bins_));
+    if (spectrum_length(block) != num_bins_) {
+        return false;
+    }
+    double bin_spacing;
+    std::memcpy(&bin_spacing, slot, sizeof(double));
+
+    magnitudes.resize(num_bins_);
+    decode_spectrum(block, magnitudes);
+    frequencies.resize(num_bins_);
+    for (size_t k = 0; k < num_bins_; ++k) {
+        frequencies[k] = static_cast<double>(k) * bin_spacing;
+    }
+    return true;
+}
+
+void FeatureStore::fill(const FeatureRecord& record, const FeatureExtractor& extractor,
+                        SignalFeatures& features) const {
+    features.rms = record.rms;
+    features.peak = record.peak;
+    features.crest_factor = record.crest_factor;
+    features.kurtosis = record.kurtosis;
+    features.skewness = record.skewness;
+    features.spectral_centroid = record.spectral_centroid;
+    features.spectral_spread = record.spectral_spread;
+    spectrum(record, features.fft_magnitude, features.fft_frequencies);
+
+    const double* values = record.values();
+    features.bandpowers.assign(values, values + num_bands_);
+    features.band_names = extractor.get_bands().names();
+    if (const EnvelopeAnalyzer* envelope = extractor.get_envelope()) {
+        features.fault_amplitudes.assign(values + num_bands_, values + num_bands_ + num_faults_);
+        features.fault_names = envelope->fault_names();
+    } else {
+        features.fault_amplitudes.clear();
+        features.fault_names = BandNames();
+    }
+}
+
+template <typename T>
+const SignalFeatures& FeatureStore::extract_samples(
+    const FeatureExtractor& extractor, std::span<const T> signal, double scale, Workspace& workspace) {
+
+    check_layout(extractor);
+    const uint64_t key = waveform_hash(signal);
+    const uint64_t config = feature_config_hash(extractor, scale);
+
+    // Records written by extract_batch carry no spectrum, so a caller that
+    // wants one gets a fresh extraction, stored below as a superseding record
+    const bool wants_spectrum = num_bins_ > 0 && has_feature(extractor.get_features(), Feature::Spectrum);
+    const FeatureRecord* r = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh();
+        r = lookup(key, config, signal.size());
+    }
+    if (r && (!wants_spectrum || has_spectrum(*r) || spectrum_unstorable(*r))) {
+        fill(*r, extractor, workspace.features);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return workspace.features;
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+
+    const SignalFeatures* features = nullptr;
+    if constexpr (std::is_same_v<T, int16_t>) {
+        features = &extractor.extract_all(signal, scale, workspace, num_bins_ > 0);
+    } else {
+        features = &extractor.extract_all(signal, workspace, num_bins_ > 0);
+    }
+    if (writable_) {
+        append(key, config, *features, signal.size(), extractor.get_sample_rate());
+    }
+    return *features;
+}
+
+const SignalFeatures& FeatureStore::extract(const FeatureExtractor& extractor,
+                                            std::span<const double> signal, Workspace& workspace) {
+    return extract_samples(extractor, signal, 1.0, workspace);
+}
+
+const SignalFeatures& FeatureStore::extract(const FeatureExtractor& extractor,
+                                            std::span<const float> signal, Workspace& workspace) {
+    return extract_samples(extractor, signal, 1.0, workspace);
+}
+
+const SignalFeatures& FeatureStore::extract(const FeatureExtractor& extractor,
+                                            std::span<const int16_t> signal, double scale,
+                                            Workspace& workspace) {
+    return extract_samples(extractor, signal, scale, workspace);
+}
+
+template <typename T>
+BatchFeatures FeatureStore::batch_samples(const FeatureExtractor& extractor, std::span<const T> data,
+                                          double scale, size_t num_rows, size_t row_length) {
+    if (data.size() != num_rows * row_length) {
+        throw std::invalid_argument("Batch data size does not match num_rows x row_length");
+    }
+    check_layout(extractor);
+    const uint64_t config = feature_config_hash(extractor, scale);
+
+    std::vector<uint64_t> keys(num_rows);
+    for (size_t r = 0; r < num_rows; ++r) {
+        keys[r] = waveform_hash(data.subspan(r * row_length, row_length));
+    }
+
+    std::vector<const FeatureRecord*> found(num_rows, nullptr);
+    std::vector<size_t> missing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh();
+        for (size_t r = 0; r < num_rows; ++r) {
+            found[r] = lookup(keys[r], config, row_length);
+            if (!found[r]) {
+                missing.push_back(r);
+            }
+        }
+    }
+    hits_.fetch_add(num_rows - missing.size(), std::memory_order_relaxed);
+    misses_.fetch_add(missing.size(), std::memory_order_relaxed);
+
+    // Missing rows are gathered and extracted together, so they still fan
+    // out over the extractor's worker threads
+    auto extract_rows = [&](std::span<const T> rows, size_t count) {
+        if constexpr (std::is_same_v<T, int16_t>) {
+            return extractor.extract_batch(rows, scale, count, row_length);
+        } else {
+            return extractor.extract_batch(rows, count, row_length);
+        }
+    };
+    BatchFeatures computed;
+    if (missing.size() == num_rows) {
+        computed = extract_rows(data, num_rows);
+    } else if (!missing.empty()) {
+        std::vector<T> rows(missing.size() * row_length);
+        for (size_t j = 0; j < missing.size(); ++j) {
+            auto row = data.subspan(missing[j] * row_length, row_length);
+            std::copy(row.begin(), row.end(), rows.begin() + j * row_length);
+        }
+        computed = extract_rows(rows, missing.size());
+    }
+
+    BatchFeatures out;
+    out.num_rows = num_rows;
+    out.num_bands = num_bands_;
+    out.band_names = extractor.get_bands().names();
+    out.num_faults = num_faults_;
+    if (const EnvelopeAnalyzer* envelope = extractor.get_envelope()) {
+        out.fault_names = envelope->fault_names();
+    }
+    std::vector<double>* columns[NUM_SCALARS] = {
+        &out.rms, &out.peak, &out.crest_factor, &out.kurtosis, &out.skewness,
+        &out.spectral_centroid, &out.spectral_spread};
+    for (auto* column : columns) {
+        column->resize(num_rows);
+    }
+    out.bandpowers.resize(num_rows * num_bands_);
+    out.fault_amplitudes.resize(num_rows * num_faults_);
+
+    for (size_t r = 0; r < num_rows; ++r) {
+        if (const FeatureRecord* rec = found[r]) {
+            const double* scalars = &rec->rms;
+            for (size_t c = 0; c < NUM_SCALARS; ++c) {
+                (*columns[c])[r] = scalars[c];
+            }
+            std::copy(rec->values(), rec->values() + num_bands_, out.bandpowers.begin() + r * num_bands_);
+            std::copy(rec->values() + num_bands_, rec->values() + num_bands_ + num_faults_,
+                      out.fault_amplitudes.begin() + r * num_faults_);
+        }
+    }
+
+    const std::vector<double>* computed_columns[NUM_SCALARS] = {
+        &computed.rms, &computed.peak, &computed.crest_factor, &computed.kurtosis, &computed.skewness,
+        &computed.spectral_centroid, &computed.spectral_spread};
+    for (size_t j = 0; j < missing.size(); ++j) {
+        const size_t r = missing[j];
+        for (size_t c = 0; c < NUM_SCALARS; ++c) {
+            (*columns[c])[r] = (*computed_columns[c])[j];
+        }
+        std::copy_n(computed.bandpowers.begin() + j * num_bands_, num_bands_,
+                    out.bandpowers.begin() + r * num_bands_);
+        std::copy_n(computed.fault_amplitudes.begin() + j * num_faults_, num_faults_,
+                    out.fault_amplitudes.begin() + r * num_faults_);
+    }
+
+    if (writable_ && !missing.empty()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        FileLock file_lock(fd_, LOCK_EX);
+        reserve(missing.size());
+        double scalars[NUM_SCALARS];
+        for (size_t j = 0; j < missing.size(); ++j) {
+            for (size_t c = 0; c < NUM_SCALARS; ++c) {
+                scalars[c] = (*computed_columns[c])[j];
+            }
+            append_locked(keys[missing[j]], config, scalars,
+                          std::span<const double>(computed.bandpowers).subspan(j * num_bands_, num_bands_),
+                          std::span<const double>(computed.fault_amplitudes).subspan(j * num_faults_, num_faults_),
+                          {}, 0.0, row_length, extractor.get_sample_rate());
+        }
+    }
+    return out;
+}
+
+BatchFeatures FeatureStore::extract_batch(const FeatureExtractor& extractor, std::span<const double> data,
+                                          size_t num_rows, size_t row_length) {
+    return batch_samples(extractor, data, 1.0, num_rows, row_length);
+}
+
+BatchFeatures FeatureStore::extract_batch(const FeatureExtractor& extractor, std::span<const float> data,
+                                          size_t num_rows, size_t row_length) {
+    return batch_samples(extractor, data, 1.0, num_rows, row_length);
+}
+
+BatchFeatures FeatureStore::extract_batch(const FeatureExtractor& extractor, std::span<const int16_t> data,
+                                          double scale, size_t num_rows, size_t row_length) {
+    return batch_samples(extractor, data, scale, num_rows, row_length);
+}
+
+} // namespace cpm
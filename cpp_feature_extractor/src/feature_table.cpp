@@ -0,0 +1,400 @@
+#include "feature_table.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cpm {
+
+namespace {
+
+constexpr size_t SECTION_ALIGN = 64;
+
+size_t align_up(size_t n) {
+    return (n + SECTION_ALIGN - 1) / SECTION_ALIGN * SECTION_ALIGN;
+}
+
+// Bytes per row of the spectrum block
+size_t spectrum_row_size(const FeatureTableHeader& header) {
+    if (header.version == 1) {
+        return header.num_bins * sizeof(double);
+    }
+    return encoded_spectrum_size(static_cast<SpectrumEncoding>(header.reserved), header.num_bins);
+}
+
+void require_little_endian() {
+    if constexpr (std::endian::native != std::endian::little) {
+        throw std::runtime_error("CPMF files are only supported on little-endian hosts");
+    }
+}
+
+} // namespace
+
+const std::vector<std::string>& feature_table_scalar_columns() {
+    static const std::vector<std::string> columns = {
+        "num_samples", "sample_rate", "rms", "peak", "crest_factor",
+        "kurtosis", "skewness", "spectral_centroid", "spectral_spread"
+    };
+    return columns;
+}
+
+FeatureTableWriter::FeatureTableWriter(const std::string& path, size_t num_rows,
+                                       const BandNames& band_names,
+                                       std::span<const double> frequencies,
+                                       const std::vector<std::string>& row_labels,
+                                       SpectrumEncoding encoding) {
+    require_little_endian();
+
+    if (!row_labels.empty() && row_labels.size() != num_rows) {
+        throw std::invalid_argument("Row label count does not match the number of rows");
+    }
+
+    std::string names;
+    for (const auto& name : feature_table_scalar_columns()) {
+        names += name;
+        names += '\n';
+    }
+    for (const auto& name : band_names) {
+        if (name.find('\n') != std::string::npos) {
+            throw std::invalid_argument("Band names must not contain newlines");
+        }
+        names += name;
+        names += '\n';
+    }
+    for (const auto& label : row_labels) {
+        if (label.find('\n') != std::string::npos) {
+            throw std::invalid_argument("Row labels must not contain newlines");
+        }
+        names += label;
+        names += '\n';
+    }
+
+    encoded_spectrum_size(encoding, 0);  // Rejects unknown encodings
+    const bool encoded = encoding != SpectrumEncoding::Float64 && !frequencies.empty();
+    header_.version = encoded ? 2 : 1;
+    header_.reserved = encoded ? static_cast<uint16_t>(encoding) : 0;
+    header_.num_columns = static_cast<uint32_t>(feature_table_scalar_columns().size() + band_names.size());
+    header_.num_bands = static_cast<uint32_t>(band_names.size());
+    header_.num_bins = static_cast<uint32_t>(frequencies.size());
+    header_.num_rows = num_rows;
+    header_.names_size = names.size();
+    header_.columns_offset = align_up(sizeof(FeatureTableHeader) + names.size());
+    header_.column_stride = align_up(num_rows * sizeof(double));
+
+    size_t end = header_.columns_offset + header_.num_columns * header_.column_stride;
+    if (header_.num_bins > 0) {
+        header_.spectrum_offset = end;
+        end += align_up(frequencies.size() * sizeof(double)) +
+               num_rows * spectrum_row_size(header_);
+        if (frequencies.size() > 1) {
+            bin_spacing_ = frequencies[1] - frequencies[0];
+        }
+    }
+    map_size_ = end;
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create file: " + path);
+    }
+    if (ftruncate(fd, static_cast<off_t>(map_size_)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot size file: " + path);
+    }
+    void* map = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    map_ = static_cast<unsigned char*>(map);
+
+    std::memcpy(map_, &header_, sizeof(header_));
+    std::memcpy(map_ + sizeof(header_), names.data(), names.size());
+
+    // Rows that are never set read back as missing
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (size_t c = 0; c < header_.num_columns; ++c) {
+        std::fill_n(column(c), num_rows, nan);
+    }
+    if (header_.num_bins > 0) {
+        auto* freqs = reinterpret_cast<double*>(map_ + header_.spectrum_offset);
+        std::copy(frequencies.begin(), frequencies.end(), freqs);
+        // Encoded rows start as empty blocks: the file is zero-filled
+        if (!encoded) {
+            std::fill_n(reinterpret_cast<double*>(spectrum_row(0)), num_rows * header_.num_bins, nan);
+        }
+    }
+}
+
+FeatureTableWriter::~FeatureTableWriter() {
+    close();
+}
+
+double* FeatureTableWriter::column(size_t index) const {
+    return reinterpret_cast<double*>(map_ + header_.columns_offset + index * header_.column_stride);
+}
+
+unsigned char* FeatureTableWriter::spectrum_row(size_t row) const {
+    return map_ + header_.spectrum_offset + align_up(header_.num_bins * sizeof(double)) +
+           row * spectrum_row_size(header_);
+}
+
+void FeatureTableWriter::set_row(size_t row, const SignalFeatures& features,
+                                 size_t num_samples, double sample_rate) {
+    if (!map_) {
+        throw std::runtime_error("Feature table is closed");
+    }
+    if (row >= header_.num_rows) {
+        throw std::out_of_range("Row index out of range");
+    }
+    if (features.bandpowers.size() != header_.num_bands) {
+        throw std::invalid_argument("Bandpower count does not match the table");
+    }
+
+    // Validate the spectrum before writing anything so a rejected row stays NaN
+    const size_t bins = header_.num_bins;
+    if (bins > 0) {
+        if (features.fft_magnitude.size() != bins) {
+            throw std::invalid_argument("Spectrum has " + std::to_string(features.fft_magnitude.size()) +
+                                        " bins, table expects " + std::to_string(bins));
+        }
+        if (bins > 1 && features.fft_frequencies.size() == bins) {
+            double spacing = features.fft_frequencies[1] - features.fft_frequencies[0];
+            if (std::abs(spacing - bin_spacing_) > 1e-9 * std::abs(bin_spacing_)) {
+                throw std::invalid_argument("Spectrum frequency grid does not match the table");
+            }
+        }
+    }
+
+    const double scalars[] = {
+        static_cast<double>(num_samples), sample_rate,
+        features.rms, features.peak, features.crest_factor,
+        features.kurtosis, features.skewness,
+        features.spectral_centroid, features.spectral_spread
+    };
+    size_t c = 0;
+    for (double v : scalars) {
+        column(c++)[row] = v;
+    }
+    for (double bp : features.bandpowers) {
+        column(c++)[row] = bp;
+    }
+
+    if (bins > 0) {
+        if (header_.version == 1) {
+            std::copy(features.fft_magnitude.begin(), features.fft_magnitude.end(),
+                      reinterpret_cast<double*>(spectrum_row(row)));
+        } else {
+            encode_spectrum(features.fft_magnitude, spectrum_encoding(),
+                            {spectrum_row(row), spectrum_row_size(header_)});
+        }
+    }
+}
+
+void FeatureTableWriter::close() {
+    if (map_) {
+        msync(map_, map_size_, MS_SYNC);
+        munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+}
+
+void write_feature_table(const std::string& path, const BatchFeatures& batch,
+                         size_t row_length, double sample_rate) {
+    FeatureTableWriter writer(path, batch.num_rows, batch.band_names);
+
+    const double* scalars[] = {
+        batch.rms.data(), batch.peak.data(), batch.crest_factor.data(),
+        batch.kurtosis.data(), batch.skewness.data(),
+        batch.spectral_centroid.data(), batch.spectral_spread.data()
+    };
+
+    SignalFeatures row;
+    row.bandpowers.resize(batch.num_bands);
+    for (size_t r = 0; r < batch.num_rows; ++r) {
+        row.rms = scalars[0][r];
+        row.peak = scalars[1][r];
+        row.crest_factor = scalars[2][r];
+        row.kurtosis = scalars[3][r];
+        row.skewness = scalars[4][r];
+        row.spectral_centroid = scalars[5][r];
+        row.spectral_spread = scalars[6][r];
+        std::copy_n(batch.bandpowers.begin() + r * batch.num_bands, batch.num_bands, row.bandpowers.begin());
+        writer.set_row(r, row, row_length, sample_rate);
+    }
+}
+
+FeatureTable FeatureTable::open(const std::string& path) {
+    require_little_endian();
+
+    FeatureTable table;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FeatureTableHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Not a CPMF file: " + path);
+    }
+    table.map_size_ = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, table.map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    table.map_ = map;
+
+    const auto* bytes = static_cast<const unsigned char*>(map);
+    std::memcpy(&table.header_, bytes, sizeof(FeatureTableHeader));
+    const FeatureTableHeader& h = table.header_;
+    if (std::memcmp(h.magic, "CPMF", 4) != 0) {
+        throw std::runtime_error("Not a CPMF file: " + path);
+    }
+    if (h.version != 1 && h.version != 2) {
+        throw std::runtime_error("Unsupported CPMF version " + std::to_string(h.version));
+    }
+    if (h.version == 2 && (h.reserved == 0 || h.reserved > static_cast<uint16_t>(SpectrumEncoding::Log16))) {
+        throw std::runtime_error("Unknown CPMF spectrum encoding " + std::to_string(h.reserved));
+    }
+    if (h.version == 1) {
+        table.header_.reserved = 0;
+    }
+
+    size_t expected = h.columns_offset + h.num_columns * h.column_stride;
+    if (h.num_bins > 0) {
+        expected = h.spectrum_offset + align_up(h.num_bins * sizeof(double)) +
+                   h.num_rows * spectrum_row_size(h);
+    }
+    if (h.columns_offset < sizeof(FeatureTableHeader) + h.names_size ||
+        h.column_stride < h.num_rows * sizeof(double) || h.num_bands > h.num_columns ||
+        expected > table.map_size_) {
+        throw std::runtime_error("Truncated or corrupt CPMF file: " + path);
+    }
+
+    std::string_view names(reinterpret_cast<const char*>(bytes + sizeof(FeatureTableHeader)), h.names_size);
+    size_t start = 0;
+    while (start < names.size()) {
+        size_t end = names.find('\n', start);
+        if (end == std::string_view::npos) end = names.size();
+        auto& dest = table.names_.size() < h.num_columns ? table.names_ : table.labels_;
+        dest.emplace_back(names.substr(start, end - start));
+        start = end + 1;
+    }
+    if (table.names_.size() != h.num_columns ||
+        (!table.labels_.empty() && table.labels_.size() != h.num_rows)) {
+        throw std::runtime_error("Column names do not match column count in " + path);
+    }
+
+    return table;
+}
+
+FeatureTable::FeatureTable(FeatureTable&& other) noexcept
+    : header_(other.header_), names_(std::move(other.names_)), labels_(std::move(other.labels_)),
+      map_(other.map_), map_size_(other.map_size_) {
+    other.map_ = nullptr;
+    other.map_size_ = 0;
+}
+
+FeatureTable& FeatureTable::operator=(FeatureTable&& other) noexcept {
+    if (this != &other) {
+        if (map_) munmap(map_, map_size_);
+        header_ = other.header_;
+        names_ = std::move(other.names_);
+        labels_ = std::move(other.labels_);
+        map_ = other.map_;
+        map_size_ = other.map_size_;
+        other.map_ = nullptr;
+        other.map_size_ = 0;
+    }
+    return *this;
+}
+
+FeatureTable::~FeatureTable() {
+    if (map_) munmap(map_, map_size_);
+}
+
+std::span<const double> FeatureTable::column(size_t index) const {
+    if (index >= header_.num_columns) {
+        throw std::out_of_range("Column index out of range");
+    }
+    const auto* bytes = static_cast<const unsigned char*>(map_);
+    return {reinterpret_cast<const double*>(bytes + header_.columns_offset + index * header_.column_stride),
+            header_.num_rows};
+}
+
+std::span<const double> FeatureTable::column(const std::string& name) const {
+    for (size_t i = 0; i < names_.size(); ++i) {
+        if (names_[i] == name) return column(i);
+    }
+    throw std::out_of_range("No column named " + name);
+}
+
+std::span<const double> FeatureTable::bandpower(size_t band) const {
+    if (band >= header_.num_bands) {
+        throw std::out_of_range("Band index out of range");
+    }
+    return column(header_.num_columns - header_.num_bands + band);
+}
+
+std::span<const double> FeatureTable::frequencies() const {
+    if (header_.num_bins == 0) return {};
+    const auto* bytes = static_cast<const unsigned char*>(map_);
+    return {reinterpret_cast<const double*>(bytes + header_.spectrum_offset), header_.num_bins};
+}
+
+std::span<const unsigned char> FeatureTable::spectrum_bytes(size_t row) const {
+    if (row >= header_.num_rows) {
+        throw std::out_of_range("Row index out of range");
+    }
+    const size_t size = spectrum_row_size(header_);
+    const auto* bytes = static_cast<const unsigned char*>(map_);
+    return {bytes + header_.spectrum_offset + align_up(header_.num_bins * sizeof(double)) + row * size, size};
+}
+
+std::span<const double> FeatureTable::spectrum(size_t row) const {
+    if (header_.num_bins == 0) return {};
+    if (header_.version != 1) {
+        throw std::logic_error(std::string("Spectra are stored as ") +
+                               spectrum_encoding_name(spectrum_encoding()) + "; use decode_spectrum");
+    }
+    return {reinterpret_cast<const double*>(spectrum_bytes(row).data()), header_.num_bins};
+}
+
+std::span<const unsigned char> FeatureTable::encoded_spectrum(size_t row) const {
+    if (header_.num_bins == 0) return {};
+    if (header_.version == 1) {
+        throw std::logic_error("Spectra are stored as plain float64; use spectrum");
+    }
+    return spectrum_bytes(row);
+}
+
+void FeatureTable::decode_spectrum(size_t row, std::span<double> out) const {
+    if (out.size() != header_.num_bins) {
+        throw std::invalid_argument("Output must hold num_bins values");
+    }
+    if (header_.num_bins == 0) return;
+    if (header_.version == 1) {
+        const auto mags = spectrum(row);
+        std::copy(mags.begin(), mags.end(), out.begin());
+        return;
+    }
+    const auto block = spectrum_bytes(row);
+    const size_t n = spectrum_length(block);
+    if (n == 0) {
+        std::fill(out.begin(), out.end(), std::numeric_limits<double>::quiet_NaN());
+    } else if (n != header_.num_bins) {
+        throw std::runtime_error("Spectrum block of row " + std::to_string(row) + " holds " +
+                                 std::to_string(n) + " values");
+    } else {
+        cpm::decode_spectrum(block, out);
+    }
+}
+
+} // namespace cpm
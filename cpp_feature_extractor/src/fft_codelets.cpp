@@ -0,0 +1,226 @@
+#include "fft_codelets.hpp"
+#include "feature_extractor.hpp"
+#include <array>
+
+namespace cpm {
+namespace fft {
+
+namespace {
+
+struct Root {
+    double re;
+    double im;
+};
+
+// cos/sin by Taylor series; accurate to an ulp or two for |x| <= pi/4
+constexpr Root taylor_cos_sin(double x) {
+    const double x2 = x * x;
+    double c = 1.0, s = x;
+    double tc = 1.0, ts = x;
+    for (int i = 1; i <= 12; ++i) {
+        tc *= -x2 / static_cast<double>((2 * i - 1) * (2 * i));
+        ts *= -x2 / static_cast<double>((2 * i) * (2 * i + 1));
+        c += tc;
+        s += ts;
+    }
+    return {c, s};
+}
+
+// W_n^k = exp(-2*pi*i*k/n), reduced to the first octant with exact integer
+// arithmetic so the series only sees small angles
+constexpr Root unit_root(size_t k, size_t n) {
+    k %= n;
+    const size_t quadrant = (4 * k) / n;
+    const size_t rem = 4 * k - quadrant * n;  // angle = pi/2 * (quadrant + rem / n)
+
+    double c, s;
+    if (2 * rem <= n) {
+        Root r = taylor_cos_sin(PI / 2.0 * static_cast<double>(rem) / static_cast<double>(n));
+        c = r.re;
+        s = r.im;
+    } else {
+        Root r = taylor_cos_sin(PI / 2.0 * static_cast<double>(n - rem) / static_cast<double>(n));
+        c = r.im;
+        s = r.re;
+    }
+
+    // Rotate e^{+i phi} by quadrant * pi/2
+    for (size_t q = 0; q < quadrant; ++q) {
+        double t = c;
+        c = -s;
+        s = t;
+    }
+    return {c, -s};
+}
+
+constexpr size_t log2_exact(size_t m) {
+    size_t bits = 0;
+    while (m > 1) {
+        m >>= 1;
+        ++bits;
+    }
+    return bits;
+}
+
+// Pass structure for an M-point transform: one radix-8 pass over blocks of
+// eight, radix-4 passes combining sub-transforms of length q = 8, 32, ...,
+// and a final radix-2 pass when log2(M) - 3 is odd.
+// Radix-4 passes store (W_2q^j, W_4q^j, W_4q^3j) per j; radix-2 stores W_2q^j.
+template <size_t M>
+constexpr size_t twiddle_count() {
+    size_t count = 0;
+    size_t q = 8;
+    for (; 4 * q <= M; q *= 4) {
+        count += 3 * q;
+    }
+    if (2 * q == M) {
+        count += q;
+    }
+    return count;
+}
+
+template <size_t M>
+constexpr std::array<Root, twiddle_count<M>()> make_twiddles() {
+    constexpr size_t N = 2 * M;  // Real transform size; roots are W_N^k
+    std::array<Root, twiddle_count<M>()> table{};
+
+    size_t pos = 0;
+    size_t q = 8;
+    for (; 4 * q <= M; q *= 4) {
+        for (size_t j = 0; j < q; ++j) {
+            table[pos++] = unit_root(j * (N / (2 * q)), N);
+            table[pos++] = unit_root(j * (N / (4 * q)), N);
+            table[pos++] = unit_root(3 * j * (N / (4 * q)), N);
+        }
+    }
+    if (2 * q == M) {
+        for (size_t j = 0; j < q; ++j) {
+            table[pos++] = unit_root(j * (N / (2 * q)), N);
+        }
+    }
+    return table;
+}
+
+template <size_t M>
+struct Twiddles {
+    static constexpr auto table = make_twiddles<M>();
+};
+
+// Plain complex products: std::complex multiplication carries NaN/inf
+// recovery branches the butterflies never need
+inline std::complex<double> mul(std::complex<double> a, Root w) {
+    return {a.real() * w.re - a.imag() * w.im, a.real() * w.im + a.imag() * w.re};
+}
+
+inline std::complex<double> mul_neg_i(std::complex<double> a) {
+    return {a.imag(), -a.real()};
+}
+
+// Stages of length 2, 4 and 8 fused; W_8^k are constants
+template <size_t M>
+inline void radix8_pass(std::complex<double>* x) {
+    constexpr double r = 0.70710678118654752440;  // 1/sqrt(2)
+
+    for (size_t i = 0; i < M; i += 8) {
+        std::complex<double>* v = x + i;
+
+        // Length 2
+        std::complex<double> a0 = v[0] + v[1], a1 = v[0] - v[1];
+        std::complex<double> a2 = v[2] + v[3], a3 = v[2] - v[3];
+        std::complex<double> a4 = v[4] + v[5], a5 = v[4] - v[5];
+        std::complex<double> a6 = v[6] + v[7], a7 = v[6] - v[7];
+
+        // Length 4: twiddles 1, -i
+        std::complex<double> b0 = a0 + a2, b2 = a0 - a2;
+        std::complex<double> t1 = mul_neg_i(a3);
+        std::complex<double> b1 = a1 + t1, b3 = a1 - t1;
+        std::complex<double> b4 = a4 + a6, b6 = a4 - a6;
+        std::complex<double> t5 = mul_neg_i(a7);
+        std::complex<double> b5 = a5 + t5, b7 = a5 - t5;
+
+        // Length 8: twiddles 1, (1-i)/sqrt2, -i, (-1-i)/sqrt2
+        std::complex<double> c5(r * (b5.real() + b5.imag()), r * (b5.imag() - b5.real()));
+        std::complex<double> c6 = mul_neg_i(b6);
+        std::complex<double> c7(r * (b7.imag() - b7.real()), -r * (b7.real() + b7.imag()));
+
+        v[0] = b0 + b4;
+        v[4] = b0 - b4;
+        v[1] = b1 + c5;
+        v[5] = b1 - c5;
+        v[2] = b2 + c6;
+        v[6] = b2 - c6;
+        v[3] = b3 + c7;
+        v[7] = b3 - c7;
+    }
+}
+
+// Combine four sub-transforms of length Q into one of length 4Q
+template <size_t M, size_t Q>
+inline void radix4_pass(std::complex<double>* x, const Root* tw) {
+    for (size_t i = 0; i < M; i += 4 * Q) {
+        std::complex<double>* v = x + i;
+        for (size_t j = 0; j < Q; ++j) {
+            const std::complex<double> a0 = v[j];
+            const std::complex<double> c1 = mul(v[j + Q], tw[3 * j]);
+            const std::complex<double> c2 = mul(v[j + 2 * Q], tw[3 * j + 1]);
+            const std::complex<double> c3 = mul(v[j + 3 * Q], tw[3 * j + 2]);
+
+            const std::complex<double> b0 = a0 + c1;
+            const std::complex<double> b1 = a0 - c1;
+            const std::complex<double> s = c2 + c3;
+            const std::complex<double> d = mul_neg_i(c2 - c3);
+
+            v[j] = b0 + s;
+            v[j + 2 * Q] = b0 - s;
+            v[j + Q] = b1 + d;
+            v[j + 3 * Q] = b1 - d;
+        }
+    }
+}
+
+// Combine two sub-transforms of length M/2
+template <size_t M>
+inline void radix2_pass(std::complex<double>* x, const Root* tw) {
+    constexpr size_t Q = M / 2;
+    for (size_t j = 0; j < Q; ++j) {
+        const std::complex<double> u = x[j];
+        const std::complex<double> t = mul(x[j + Q], tw[j]);
+        x[j] = u + t;
+        x[j + Q] = u - t;
+    }
+}
+
+template <size_t M, size_t Q>
+inline void remaining_passes(std::complex<double>* x, const Root* tw) {
+    if constexpr (4 * Q <= M) {
+        radix4_pass<M, Q>(x, tw);
+        remaining_passes<M, 4 * Q>(x, tw + 3 * Q);
+    } else if constexpr (2 * Q == M) {
+        radix2_pass<M>(x, tw);
+    }
+}
+
+template <size_t M>
+void transform(std::complex<double>* x) {
+    static_assert(M >= 8 && (M & (M - 1)) == 0, "Codelet size must be a power of two >= 8");
+    static_assert(log2_exact(M) >= 3);
+
+    radix8_pass<M>(x);
+    remaining_passes<M, 8>(x, Twiddles<M>::table.data());
+}
+
+} // namespace
+
+Codelet codelet_for(size_t m) {
+    // Complex sizes for real windows of 1024, 2048, 4096 and 8192 samples
+    switch (m) {
+        case 512: return &transform<512>;
+        case 1024: return &transform<1024>;
+        case 2048: return &transform<2048>;
+        case 4096: return &transform<4096>;
+        default: return nullptr;
+    }
+}
+
+} // namespace fft
+} // namespace cpm
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+
+// Fixed-size complex FFT kernels used by FFTPlan for the common window
+// lengths. Sizes are template parameters, so every pass has constant trip
+// counts and its twiddles come from a table built at compile time.
+
+namespace cpm {
+namespace fft {
+
+// In-place complex FFT of a fixed size on bit-reversed input
+using Codelet = void (*)(std::complex<double>* x);
+
+/**
+ * Get the codelet for an m-point complex transform
+ * @return nullptr if m has no specialised kernel
+ */
+Codelet codelet_for(size_t m);
+
+} // namespace fft
+} // namespace cpm
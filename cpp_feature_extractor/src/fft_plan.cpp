@@ -0,0 +1,396 @@
+#include "fft_plan.hpp"
+#include "feature_extractor.hpp"
+#include "fft_codelets.hpp"
+#include "stats.hpp"
+#include <mutex>
+#include <unordered_map>
+
+namespace cpm {
+
+namespace {
+
+bool is_power_of_2(size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+std::complex<double> unit_root(size_t k, size_t n) {
+    double angle = -2.0 * PI * static_cast<double>(k) / static_cast<double>(n);
+    return {std::cos(angle), std::sin(angle)};
+}
+
+// Per-thread work buffers for the non-power-of-two paths; they only grow,
+// so repeated transforms of one size do not allocate
+enum ScratchSlot { PACKED, COMPLEX_OUT, CHIRP_A, CHIRP_B, NUM_SLOTS };
+
+// Plain complex product: std::complex multiplication carries NaN/inf
+// recovery branches the butterflies never need
+inline std::complex<double> mul(std::complex<double> a, std::complex<double> b) {
+    return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+}
+
+inline std::complex<double> mul_neg_i(std::complex<double> a) {
+    return {a.imag(), -a.real()};
+}
+
+// Radix-P combine of P consecutive length-sub blocks of out; tw holds
+// W_size^(q*k) for q in [1, P) at tw[k * (P - 1) + q - 1]
+template <size_t P>
+void combine(std::complex<double>* out, size_t sub, const std::complex<double>* tw) {
+    for (size_t k = 0; k < sub; ++k) {
+        std::complex<double> t[P];
+        t[0] = out[k];
+        for (size_t q = 1; q < P; ++q) {
+            t[q] = mul(out[q * sub + k], tw[k * (P - 1) + q - 1]);
+        }
+
+        if constexpr (P == 2) {
+            out[k] = t[0] + t[1];
+            out[k + sub] = t[0] - t[1];
+        } else if constexpr (P == 3) {
+            constexpr double c = -0.5;
+            constexpr double s = 0.86602540378443864676;  // sin(2 pi / 3)
+            std::complex<double> a = t[1] + t[2];
+            std::complex<double> b = mul_neg_i(s * (t[1] - t[2]));
+            std::complex<double> base = t[0] + c * a;
+            out[k] = t[0] + a;
+            out[k + sub] = base + b;
+            out[k + 2 * sub] = base - b;
+        } else if constexpr (P == 4) {
+            std::complex<double> a0 = t[0] + t[2], a1 = t[0] - t[2];
+            std::complex<double> b0 = t[1] + t[3], b1 = mul_neg_i(t[1] - t[3]);
+            out[k] = a0 + b0;
+            out[k + sub] = a1 + b1;
+            out[k + 2 * sub] = a0 - b0;
+            out[k + 3 * sub] = a1 - b1;
+        } else {
+            static_assert(P == 5, "Unsupported radix");
+            constexpr double c1 = 0.30901699437494742410;   // cos(2 pi / 5)
+            constexpr double c2 = -0.80901699437494742410;  // cos(4 pi / 5)
+            constexpr double s1 = 0.95105651629515357212;   // sin(2 pi / 5)
+            constexpr double s2 = 0.58778525229247312917;   // sin(4 pi / 5)
+            std::complex<double> a1 = t[1] + t[4], b1 = t[1] - t[4];
+            std::complex<double> a2 = t[2] + t[3], b2 = t[2] - t[3];
+            std::complex<double> r1 = t[0] + c1 * a1 + c2 * a2;
+            std::complex<double> r2 = t[0] + c2 * a1 + c1 * a2;
+            std::complex<double> i1 = mul_neg_i(s1 * b1 + s2 * b2);
+            std::complex<double> i2 = mul_neg_i(s2 * b1 - s1 * b2);
+            out[k] = t[0] + a1 + a2;
+            out[k + sub] = r1 + i1;
+            out[k + 4 * sub] = r1 - i1;
+            out[k + 2 * sub] = r2 + i2;
+            out[k + 3 * sub] = r2 - i2;
+        }
+    }
+}
+
+std::complex<double>* scratch(ScratchSlot slot, size_t size) {
+    thread_local std::vector<std::complex<double>> buffers[NUM_SLOTS];
+    auto& buf = buffers[slot];
+    if (buf.size() < size) {
+        buf.resize(size);
+    }
+    return buf.data();
+}
+
+} // namespace
+
+FFTPlan::FFTPlan(size_t n, bool use_codelets) : n_(n) {
+    if (n == 0) {
+        throw std::invalid_argument("FFT size must be positive");
+    }
+
+    m_ = n % 2 == 0 ? n / 2 : n;
+
+    if (n % 2 == 0) {
+        twiddles_.resize(n / 2);
+        for (size_t k = 0; k < n / 2; ++k) {
+            twiddles_[k] = unit_root(k, n);
+        }
+    }
+
+    // Split m into radix-4/2/3/5 factors; a leftover means m is not 5-smooth
+    size_t rest = m_;
+    for (size_t p : {4, 2, 3, 5}) {
+        while (rest % p == 0 && rest > 1) {
+            factors_.push_back(p);
+            rest /= p;
+        }
+    }
+
+    // A single point has no factors; treat it as the trivial power of two
+    // so the transform is the identity copy rather than an empty recursion
+    if (is_power_of_2(m_) && (n % 2 == 0 || n == 1)) {
+        algorithm_ = Algorithm::PowerOfTwo;
+        factors_.clear();
+
+        size_t bits = 0;
+        for (size_t temp = m_; temp > 1; temp >>= 1) {
+            ++bits;
+        }
+
+        bit_reversal_.resize(m_);
+        for (size_t i = 0; i < m_; ++i) {
+            size_t r = 0;
+            size_t v = i;
+            for (size_t b = 0; b < bits; ++b) {
+                r = (r << 1) | (v & 1);
+                v >>= 1;
+            }
+            bit_reversal_[i] = r;
+        }
+
+        if (use_codelets) {
+            codelet_ = fft::codelet_for(m_);
+        }
+    } else if (rest == 1) {
+        algorithm_ = Algorithm::MixedRadix;
+
+        size_t size = m_;
+        for (size_t p : factors_) {
+            const size_t sub = size / p;
+            stage_offsets_.push_back(stage_twiddles_.size());
+            for (size_t k = 0; k < sub; ++k) {
+                for (size_t q = 1; q < p; ++q) {
+                    stage_twiddles_.push_back(unit_root(q * k, size));
+                }
+            }
+            size = sub;
+        }
+    } else {
+        // Bluestein: X_k = w_k * sum_j (x_j w_j) conj(w_{k-j}), w_t = exp(-i*pi*t^2/m),
+        // evaluated as a circular convolution of power-of-two length M >= 2m - 1
+        algorithm_ = Algorithm::Bluestein;
+        factors_.clear();
+
+        size_t conv = 1;
+        while (conv < 2 * m_ - 1) {
+            conv <<= 1;
+        }
+
+        // Reduce k^2 mod 2m exactly so the chirp angle stays small
+        chirp_.resize(m_);
+        for (size_t k = 0; k < m_; ++k) {
+            size_t k2 = (k * k) % (2 * m_);
+            double angle = -PI * static_cast<double>(k2) / static_cast<double>(m_);
+            chirp_[k] = std::complex<double>(std::cos(angle), std::sin(angle));
+        }
+
+        // Complex size conv is the packed size of a real 2 * conv plan. Built
+        // directly rather than through get(), which holds the cache lock.
+        inner_ = std::make_shared<const FFTPlan>(2 * conv, use_codelets);
+
+        std::vector<std::complex<double>> b(conv, {0.0, 0.0});
+        b[0] = std::conj(chirp_[0]);
+        for (size_t k = 1; k < m_; ++k) {
+            b[k] = std::conj(chirp_[k]);
+            b[conv - k] = std::conj(chirp_[k]);
+        }
+
+        chirp_spectrum_.resize(conv);
+        inner_->complex_transform(b.data(), chirp_spectrum_.data());
+        const double inv = 1.0 / static_cast<double>(conv);
+        for (auto& c : chirp_spectrum_) {
+            c *= inv;
+        }
+    }
+}
+
+std::shared_ptr<const FFTPlan> FFTPlan::get(size_t n) {
+    // Most callers use a single size, so check the last plan this thread saw
+    // before taking the lock.
+    thread_local std::shared_ptr<const FFTPlan> last;
+    if (last && last->size() == n) {
+        CPM_STATS_PLAN_LOOKUP(true);
+        return last;
+    }
+
+    // Lengths that vary per call (Welch segments, order-tracking resamples,
+    // trimmed records) would grow the cache without bound, so cap it
+    constexpr size_t MAX_ENTRIES = 256;
+
+    static std::mutex mutex;
+    static std::unordered_map<size_t, std::shared_ptr<const FFTPlan>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(n);
+    CPM_STATS_PLAN_LOOKUP(it != cache.end());
+    if (it == cache.end()) {
+        if (cache.size() >= MAX_ENTRIES) {
+            cache.clear();
+        }
+        it = cache.emplace(n, std::make_shared<const FFTPlan>(n)).first;
+    }
+    last = it->second;
+    return it->second;
+}
+
+void FFTPlan::butterflies(std::complex<double>* x) const {
+    const size_t m = m_;
+
+    // Stage of length len uses W_len^j = W_n^(j * n / len)
+    for (size_t len = 2; len <= m; len <<= 1) {
+        const size_t half_len = len / 2;
+        const size_t stride = n_ / len;
+
+        for (size_t i = 0; i < m; i += len) {
+            for (size_t j = 0; j < half_len; ++j) {
+                std::complex<double> u = x[i + j];
+                std::complex<double> t = twiddles_[j * stride] * x[i + j + half_len];
+                x[i + j] = u + t;
+                x[i + j + half_len] = u - t;
+            }
+        }
+    }
+}
+
+void FFTPlan::mixed_radix(const std::complex<double>* in, size_t stride,
+                          std::complex<double>* out, size_t factor, size_t size) const {
+    // Decimation in time: transform the p interleaved subsequences into
+    // consecutive blocks of out, then combine them with radix-p butterflies
+    const size_t p = factors_[factor];
+    const size_t sub = size / p;
+
+    if (sub == 1) {
+        for (size_t q = 0; q < p; ++q) {
+            out[q] = in[q * stride];
+        }
+    } else {
+        for (size_t q = 0; q < p; ++q) {
+            mixed_radix(in + q * stride, stride * p, out + q * sub, factor + 1, sub);
+        }
+    }
+
+    const std::complex<double>* tw = stage_twiddles_.data() + stage_offsets_[factor];
+    switch (p) {
+        case 2: combine<2>(out, sub, tw); break;
+        case 3: combine<3>(out, sub, tw); break;
+        case 4: combine<4>(out, sub, tw); break;
+        case 5: combine<5>(out, sub, tw); break;
+    }
+}
+
+void FFTPlan::bluestein(const std::complex<double>* in, std::complex<double>* out) const {
+    const size_t conv = chirp_spectrum_.size();
+    std::complex<double>* a = scratch(CHIRP_A, conv);
+    std::complex<double>* b = scratch(CHIRP_B, conv);
+
+    for (size_t k = 0; k < m_; ++k) {
+        a[k] = in[k] * chirp_[k];
+    }
+    std::fill(a + m_, a + conv, std::complex<double>(0.0, 0.0));
+
+    // Circular convolution; the inverse transform is conj(FFT(conj(.)))
+    inner_->complex_transform(a, b);
+    for (size_t j = 0; j < conv; ++j) {
+        a[j] = std::conj(b[j] * chirp_spectrum_[j]);
+    }
+    inner_->complex_transform(a, b);
+
+    for (size_t k = 0; k < m_; ++k) {
+        out[k] = std::conj(b[k]) * chirp_[k];
+    }
+}
+
+void FFTPlan::forward_complex(std::span<const std::complex<double>> input,
+                              std::span<std::complex<double>> output) const {
+    if (input.size() != m_ || output.size() < m_) {
+        throw std::invalid_argument("Complex FFT buffers must hold complex_size() values");
+    }
+    CPM_STATS_STAGE(FFT, input.size_bytes());
+    complex_transform(input.data(), output.data());
+}
+
+void FFTPlan::complex_transform(const std::complex<double>* in, std::complex<double>* out) const {
+    switch (algorithm_) {
+        case Algorithm::PowerOfTwo:
+            for (size_t k = 0; k < m_; ++k) {
+                out[bit_reversal_[k]] = in[k];
+            }
+            if (codelet_) {
+                codelet_(out);
+            } else {
+                butterflies(out);
+            }
+            break;
+        case Algorithm::MixedRadix:
+            mixed_radix(in, 1, out, 0, m_);
+            break;
+        case Algorithm::Bluestein:
+            bluestein(in, out);
+            break;
+    }
+}
+
+void FFTPlan::unpack(std::complex<double>* x) const {
+    // Unpack the n/2-point complex spectrum Z into the real spectrum X:
+    //   X[k]     = E[k] + W^k O[k]
+    //   X[m - k] = conj(E[k] - W^k O[k])
+    // with E[k] = (Z[k] + conj(Z[m-k])) / 2, O[k] = (Z[k] - conj(Z[m-k])) / 2i
+    const size_t m = m_;
+    const std::complex<double> z0 = x[0];
+    x[0] = std::complex<double>(z0.real() + z0.imag(), 0.0);
+
+    for (size_t k = 1; k <= m / 2; ++k) {
+        const std::complex<double> zk = x[k];
+        const std::complex<double> zmk = std::conj(x[m - k]);
+
+        const std::complex<double> even = 0.5 * (zk + zmk);
+        const std::complex<double> odd = std::complex<double>(0.0, -0.5) * (zk - zmk);
+        const std::complex<double> t = twiddles_[k] * odd;
+
+        x[k] = even + t;
+        x[m - k] = std::conj(even - t);
+    }
+}
+
+void FFTPlan::forward_real(std::span<const double> input,
+                           std::span<std::complex<double>> output) const {
+    const size_t len = input.size();
+    if (len > n_) {
+        throw std::invalid_argument("Input longer than FFT size");
+    }
+    if (output.size() < num_bins()) {
+        throw std::invalid_argument("FFT output buffer too small");
+    }
+    if (num_bins() == 0) {
+        return;
+    }
+    CPM_STATS_STAGE(FFT, input.size_bytes());
+
+    auto sample = [&](size_t i) { return i < len ? input[i] : 0.0; };
+
+    if (n_ % 2 != 0) {
+        // Odd length: plain complex transform of the real signal
+        std::complex<double>* x = scratch(PACKED, n_);
+        std::complex<double>* y = scratch(COMPLEX_OUT, n_);
+        for (size_t i = 0; i < n_; ++i) {
+            x[i] = std::complex<double>(sample(i), 0.0);
+        }
+        complex_transform(x, y);
+        std::copy(y, y + num_bins(), output.begin());
+        return;
+    }
+
+    // Pack pairs of real samples into complex values
+    if (algorithm_ == Algorithm::PowerOfTwo) {
+        // Scatter directly into bit-reversed order and transform in place
+        for (size_t k = 0; k < m_; ++k) {
+            output[bit_reversal_[k]] = std::complex<double>(sample(2 * k), sample(2 * k + 1));
+        }
+        if (codelet_) {
+            codelet_(output.data());
+        } else {
+            butterflies(output.data());
+        }
+    } else {
+        std::complex<double>* packed = scratch(PACKED, m_);
+        for (size_t k = 0; k < m_; ++k) {
+            packed[k] = std::complex<double>(sample(2 * k), sample(2 * k + 1));
+        }
+        complex_transform(packed, output.data());
+    }
+
+    unpack(output.data());
+}
+
+} // namespace cpm
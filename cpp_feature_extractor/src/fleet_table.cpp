@@ -0,0 +1,272 @@
+#include "fleet_table.hpp"
+#include "feature_table.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+namespace cpm {
+
+namespace {
+
+// feature_table_scalar_columns() starts with num_samples and sample_rate,
+// which come from the call rather than from the extracted features
+constexpr size_t NUM_SAMPLES_COLUMN = 0;
+constexpr size_t SAMPLE_RATE_COLUMN = 1;
+constexpr size_t NUM_SHAPE_COLUMNS = 2;
+
+constexpr size_t MIN_CAPACITY = 64;  // Rows allocated for a new asset
+
+} // namespace
+
+const std::vector<std::string>& FleetFeatureTable::column_names() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> n = feature_table_scalar_columns();
+        n.push_back("bandpowers");
+        n.push_back("fault_amplitudes");
+        return n;
+    }();
+    return names;
+}
+
+void FleetFeatureTable::Column::reserve(size_t rows, size_t used) {
+    if (rows <= capacity) {
+        return;
+    }
+    const size_t grown = std::max({rows, capacity * 2, MIN_CAPACITY});
+    std::shared_ptr<double[]> replacement(new double[grown * width]);
+    if (used > 0) {
+        std::copy_n(data.get(), used * width, replacement.get());
+    }
+    data = std::move(replacement);
+    capacity = grown;
+}
+
+const FleetFeatureTable::History& FleetFeatureTable::find(const std::string& asset) const {
+    auto it = assets_.find(asset);
+    if (it == assets_.end()) {
+        throw std::out_of_range("Unknown asset: " + asset);
+    }
+    return it->second;
+}
+
+RowRange FleetFeatureTable::store(const std::string& asset, uint64_t config_hash, const BatchFeatures& batch,
+                                  size_t skip, size_t row_length, double sample_rate) {
+    auto [it, created] = assets_.try_emplace(asset);
+    History& h = it->second;
+    if (created) {
+        h.config_hash = config_hash;
+        h.band_names = batch.band_names;
+        h.fault_names = batch.fault_names;
+        h.columns.resize(column_names().size());
+        h.columns[h.columns.size() - 2].width = batch.num_bands;
+        h.columns.back().width = batch.num_faults;
+    } else if (h.config_hash != config_hash) {
+        throw std::invalid_argument("Extractor settings differ from earlier rows of asset " + asset);
+    }
+
+    const size_t first = h.num_rows;
+    const size_t count = batch.num_rows - std::min(skip, batch.num_rows);
+    if (count == 0) {
+        return {first, first};
+    }
+    const size_t total = first + count;
+    for (Column& column : h.columns) {
+        if (column.width > 0) {
+            column.reserve(total, first);
+        }
+    }
+
+    std::fill_n(h.columns[NUM_SAMPLES_COLUMN].data.get() + first, count, static_cast<double>(row_length));
+    std::fill_n(h.columns[SAMPLE_RATE_COLUMN].data.get() + first, count, sample_rate);
+
+    const std::vector<double>* scalars[] = {
+        &batch.rms, &batch.peak, &batch.crest_factor, &batch.kurtosis, &batch.skewness,
+        &batch.spectral_centroid, &batch.spectral_spread};
+    for (size_t c = 0; c < std::size(scalars); ++c) {
+        std::copy_n(scalars[c]->begin() + skip, count, h.columns[NUM_SHAPE_COLUMNS + c].data.get() + first);
+    }
+
+    Column& bands = h.columns[h.columns.size() - 2];
+    if (bands.width > 0) {
+        std::copy_n(batch.bandpowers.begin() + skip * bands.width, count * bands.width,
+                    bands.data.get() + first * bands.width);
+    }
+    Column& faults = h.columns.back();
+    if (faults.width > 0) {
+        std::copy_n(batch.fault_amplitudes.begin() + skip * faults.width, count * faults.width,
+                    faults.data.get() + first * faults.width);
+    }
+
+    // Published last: readers only look at rows below num_rows
+    h.num_rows = total;
+    return {first, total};
+}
+
+template <typename T>
+BatchFeatures FleetFeatureTable::extract_rows(const FeatureExtractor& extractor, std::span<const T> data,
+                                             double scale, size_t num_rows, size_t row_length) {
+    if constexpr (std::is_same_v<T, int16_t>) {
+        return store_ ? store_->extract_batch(extractor, data, scale, num_rows, row_length)
+                      : extractor.extract_batch(data, scale, num_rows, row_length);
+    } else {
+        return store_ ? store_->extract_batch(extractor, data, num_rows, row_length)
+                      : extractor.extract_batch(data, num_rows, row_length);
+    }
+}
+
+template <typename T>
+RowRange FleetFeatureTable::append_samples(const std::string& asset, const FeatureExtractor& extractor,
+                                           std::span<const T> data, double scale, size_t num_rows,
+                                           size_t row_length) {
+    if (data.size() < num_rows * row_length) {
+        throw std::invalid_argument("Data is smaller than num_rows x row_length");
+    }
+    const uint64_t config = feature_config_hash(extractor, scale);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = assets_.find(asset);
+        if (it != assets_.end() && it->second.config_hash != config) {
+            throw std::invalid_argument("Extractor settings differ from earlier rows of asset " + asset);
+        }
+        if (num_rows == 0) {
+            return it != assets_.end() ? RowRange{it->second.num_rows, it->second.num_rows} : RowRange{};
+        }
+    }
+
+    const BatchFeatures batch = extract_rows(extractor, data.first(num_rows * row_length), scale,
+                                             num_rows, row_length);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return store(asset, config, batch, 0, row_length, extractor.get_sample_rate());
+}
+
+template <typename T>
+RowRange FleetFeatureTable::update_samples(const std::string& asset, const FeatureExtractor& extractor,
+                                           std::span<const T> data, double scale, size_t num_rows,
+                                           size_t row_length) {
+    if (data.size() < num_rows * row_length) {
+        throw std::invalid_argument("Data is smaller than num_rows x row_length");
+    }
+    const uint64_t config = feature_config_hash(extractor, scale);
+    size_t held = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = assets_.find(asset);
+        if (it != assets_.end()) {
+            if (it->second.config_hash != config) {
+                throw std::invalid_argument("Extractor settings differ from earlier rows of asset " + asset);
+            }
+            held = it->second.num_rows;
+        }
+    }
+    if (num_rows < held) {
+        throw std::invalid_argument("Waveform history of asset " + asset + " is shorter than its feature table");
+    }
+    if (num_rows == held) {
+        return {held, held};
+    }
+
+    // The dirty window is contiguous, so it is extracted in place
+    const size_t fresh = num_rows - held;
+    auto window = data.subspan(held * row_length, fresh * row_length);
+    const BatchFeatures batch = extract_rows(extractor, window, scale, fresh, row_length);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = assets_.find(asset);
+    const size_t now = it != assets_.end() ? it->second.num_rows : 0;
+    if (now < held) {
+        // Erased while extracting; the result no longer lines up with the table
+        return {now, now};
+    }
+    // A concurrent update may already have stored part of the window
+    return store(asset, config, batch, now - held, row_length, extractor.get_sample_rate());
+}
+
+RowRange FleetFeatureTable::append(const std::string& asset, const FeatureExtractor& extractor,
+                                   std::span<const double> data, size_t num_rows, size_t row_length) {
+    return append_samples(asset, extractor, data, 1.0, num_rows, row_length);
+}
+
+RowRange FleetFeatureTable::append(const std::string& asset, const FeatureExtractor& extractor,
+                                   std::span<const float> data, size_t num_rows, size_t row_length) {
+    return append_samples(asset, extractor, data, 1.0, num_rows, row_length);
+}
+
+RowRange FleetFeatureTable::append(const std::string& asset, const FeatureExtractor& extractor,
+                                   std::span<const int16_t> data, double scale, size_t num_rows,
+                                   size_t row_length) {
+    return append_samples(asset, extractor, data, scale, num_rows, row_length);
+}
+
+RowRange FleetFeatureTable::update(const std::string& asset, const FeatureExtractor& extractor,
+                                   std::span<const double> data, size_t num_rows, size_t row_length) {
+    return update_samples(asset, extractor, data, 1.0, num_rows, row_length);
+}
+
+RowRange FleetFeatureTable::update(const std::string& asset, const FeatureExtractor& extractor,
+                                   std::span<const float> data, size_t num_rows, size_t row_length) {
+    return update_samples(asset, extractor, data, 1.0, num_rows, row_length);
+}
+
+RowRange FleetFeatureTable::update(const std::string& asset, const FeatureExtractor& extractor,
+                                   std::span<const int16_t> data, double scale, size_t num_rows,
+                                   size_t row_length) {
+    return update_samples(asset, extractor, data, scale, num_rows, row_length);
+}
+
+size_t FleetFeatureTable::rows(const std::string& asset) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = assets_.find(asset);
+    return it != assets_.end() ? it->second.num_rows : 0;
+}
+
+bool FleetFeatureTable::contains(const std::string& asset) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return assets_.count(asset) > 0;
+}
+
+std::vector<std::string> FleetFeatureTable::assets() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> out;
+    out.reserve(assets_.size());
+    for (const auto& [name, history] : assets_) {
+        out.push_back(name);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+bool FleetFeatureTable::erase(const std::string& asset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return assets_.erase(asset) > 0;
+}
+
+FleetColumn FleetFeatureTable::column(const std::string& asset, const std::string& name) const {
+    const auto& names = column_names();
+    auto pos = std::find(names.begin(), names.end(), name);
+    if (pos == names.end()) {
+        throw std::out_of_range("Unknown feature column: " + name);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const History& h = find(asset);
+    const Column& c = h.columns[static_cast<size_t>(pos - names.begin())];
+    FleetColumn out;
+    out.owner = c.data;
+    out.data = c.data.get();
+    out.rows = h.num_rows;
+    out.width = c.width;
+    return out;
+}
+
+BandNames FleetFeatureTable::band_names(const std::string& asset) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return find(asset).band_names;
+}
+
+BandNames FleetFeatureTable::fault_names(const std::string& asset) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return find(asset).fault_names;
+}
+
+} // namespace cpm
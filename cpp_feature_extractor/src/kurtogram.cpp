@@ -0,0 +1,114 @@
+#include "kurtogram.hpp"
+#include "fft_plan.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace cpm {
+
+namespace {
+
+// Per-thread buffers, kept for the last band transform length used
+struct KurtogramScratch {
+    size_t size = 0;
+    std::shared_ptr<const FFTPlan> inverse;   // Complex M-point transform
+    std::vector<std::complex<double>> band;
+    std::vector<std::complex<double>> analytic;
+};
+
+KurtogramScratch& scratch_for(size_t size) {
+    thread_local KurtogramScratch scratch;
+    if (scratch.size != size) {
+        scratch.size = size;
+        scratch.inverse = FFTPlan::get(2 * size);
+        scratch.band.resize(size);
+        scratch.analytic.resize(size);
+    }
+    return scratch;
+}
+
+} // namespace
+
+KurtogramAnalyzer::KurtogramAnalyzer(const KurtogramConfig& config) : config_(config) {
+    if (config.min_band_bins == 0) {
+        throw std::invalid_argument("Kurtogram bands need at least one bin");
+    }
+}
+
+Kurtogram KurtogramAnalyzer::compute(std::span<const std::complex<double>> spectrum, size_t n,
+                                     double sample_rate) const {
+    Kurtogram out;
+    out.offsets.push_back(0);
+    const size_t bins = std::min(spectrum.size(), n / 2);
+    if (n < 2 || bins < 2) {
+        return out;
+    }
+    CPM_STATS_STAGE(Kurtogram, spectrum.size_bytes());
+
+    // (level, bands) rows of the 1/3-binary tree, coarse to fine
+    std::vector<std::pair<double, size_t>> rows = {{0.0, 1}};
+    for (size_t k = 1, bands = 2; k <= config_.max_level; ++k, bands *= 2) {
+        const size_t thirds = 3 * bands / 4;
+        if (config_.third_levels && k > 1 && bins / thirds >= config_.min_band_bins) {
+            rows.emplace_back(static_cast<double>(k - 1) + 0.6, thirds);
+        }
+        if (bins / bands < config_.min_band_bins) {
+            break;
+        }
+        rows.emplace_back(static_cast<double>(k), bands);
+    }
+
+    const double nyquist = 0.5 * sample_rate;
+    double best = -std::numeric_limits<double>::infinity();
+    for (const auto& [level, bands] : rows) {
+        const size_t size = std::bit_ceil((bins + bands - 1) / bands);
+        KurtogramScratch& s = scratch_for(size);
+        // Slicing the spectrum filters circularly: the jump between the
+        // signal's ends rings at both ends of every band envelope and would
+        // read as an impact, so those samples are left out of the moments
+        const size_t guard = size / 16;
+
+        for (size_t b = 0; b < bands; ++b) {
+            const size_t lo = std::max<size_t>(1, b * bins / bands);
+            const size_t hi = (b + 1) * bins / bands;
+
+            // Inverse DFT of the baseband-shifted bins via the forward
+            // transform; only |c| is used, so the outer conj is dropped
+            std::fill(s.band.begin(), s.band.end(), std::complex<double>(0.0, 0.0));
+            for (size_t j = lo; j < hi; ++j) {
+                s.band[j - lo] = std::conj(spectrum[j]);
+            }
+            s.inverse->forward_complex(s.band, s.analytic);
+
+            double m2 = 0.0;
+            double m4 = 0.0;
+            for (size_t t = guard; t < size - guard; ++t) {
+                const double p = std::norm(s.analytic[t]);
+                m2 += p;
+                m4 += p * p;
+            }
+            // Scale-free: mean |c|^4 / (mean |c|^2)^2 = count * m4 / m2^2
+            const double count = static_cast<double>(size - 2 * guard);
+            const double sk = m2 > 0.0 ? count * m4 / (m2 * m2) - 2.0 : 0.0;
+            out.kurtosis.push_back(sk);
+
+            if (sk > best) {
+                best = sk;
+                out.best_level = level;
+                out.best_band = b;
+                out.band_low = nyquist * static_cast<double>(b) / static_cast<double>(bands);
+                out.band_high = nyquist * static_cast<double>(b + 1) / static_cast<double>(bands);
+                out.best_kurtosis = sk;
+            }
+        }
+        out.levels.push_back(level);
+        out.offsets.push_back(out.kurtosis.size());
+    }
+    return out;
+}
+
+} // namespace cpm
@@ -1,58 +1,216 @@
 #include "feature_extractor.hpp"
+#include "feature_table.hpp"
+#include "stats.hpp"
+#include "thread_pool.hpp"
+#include "waveform_io.hpp"
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <iomanip>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <glob.h>
+
+// How input files are read
+struct InputOptions {
+    std::string format = "auto";
+    double sample_rate = 5000.0;
+    bool rate_given = false;
+    size_t channel = 0;
+    size_t raw_channels = 1;
+    size_t num_threads = 1;
+};
+
+// How features are computed
+struct AnalysisOptions {
+    std::optional<cpm::WelchConfig> welch;
+    cpm::Feature features = cpm::Feature::All;
+
+    cpm::FeatureExtractor make_extractor(double sample_rate) const {
+        cpm::FeatureExtractor extractor(sample_rate);
+        if (welch) {
+            extractor.set_welch(*welch);
+        }
+        extractor.set_features(features);
+        return extractor;
+    }
+};
+
+// A loaded signal. Binary input stays mapped while this is alive and
+// samples is a view over it (or over storage after type conversion).
+// Single-channel float32 and int16 files are viewed in their own type
+// instead and handed to the extractor without conversion.
+struct LoadedSignal {
+    std::optional<cpm::MappedWaveform> mapped;
+    std::vector<double> storage;
+    std::span<const double> samples;
+    std::span<const float> float_samples;
+    std::span<const int16_t> int16_samples;
+    double scale = 1.0;
+    double sample_rate = 0.0;
+
+    size_t size() const {
+        return samples.size() + float_samples.size() + int16_samples.size();
+    }
+
+    const cpm::SignalFeatures& extract(const cpm::FeatureExtractor& extractor,
+                                       cpm::Workspace& workspace, bool include_spectrum) const {
+        if (!float_samples.empty()) {
+            return extractor.extract_all(float_samples, workspace, include_spectrum);
+        }
+        if (!int16_samples.empty()) {
+            return extractor.extract_all(int16_samples, scale, workspace, include_spectrum);
+        }
+        return extractor.extract_all(samples, workspace, include_spectrum);
+    }
+};
 
 void print_usage(const char* program) {
     std::cerr << "Usage: " << program << " [OPTIONS] <input_file>\n"
+              << "       " << program << " [OPTIONS] --batch <dir|glob|manifest>\n"
               << "\n"
-              << "Extract vibration signal features from a CSV file.\n"
+              << "Extract vibration signal features from a CSV or binary waveform file.\n"
               << "\n"
               << "Options:\n"
-              << "  -r, --rate <Hz>     Sample rate in Hz (default: 5000)\n"
-              << "  -o, --output <file> Output file (default: stdout)\n"
-              << "  -j, --json          Output in JSON format\n"
-              << "  -h, --help          Show this help message\n"
+              << "  -r, --rate <Hz>       Sample rate in Hz (default: 5000, or from a CPMW header)\n"
+              << "  -o, --output <file>   Output file (default: stdout)\n"
+              << "  -j, --json            Output in JSON format (for reading; slow on large spectra)\n"
+              << "      --output-format <fmt>\n"
+              << "                        text (default), json or columnar. columnar writes a\n"
+              << "                        memory-mappable CPMF feature table and needs -o\n"
+              << "      --spectrum-encoding <enc>\n"
+              << "                        Spectrum storage in columnar output: f64 (default),\n"
+              << "                        f16, log8 or log16 (quantised, 4-8x smaller)\n"
+              << "  -f, --format <fmt>    Input format: csv, f32, f64, i16, cpmw (default: auto)\n"
+              << "  -c, --channel <n>     Channel to analyse in multichannel input (default: 0)\n"
+              << "      --channels <n>    Interleaved channel count of raw binary input (default: 1)\n"
+              << "  -t, --threads <n>     Threads for parsing CSV input (default: 1, 0 = all cores)\n"
+              << "  -w, --welch <n>       Welch averaged spectrum with n-sample segments\n"
+              << "      --overlap <f>     Welch segment overlap fraction (default: 0.5)\n"
+              << "      --window <name>   Welch window: hann (default), hamming, blackman, rectangular\n"
+              << "      --features <list> Compute only these features, comma-separated: rms, peak,\n"
+              << "                        crest_factor, kurtosis, skewness, spectral_centroid,\n"
+              << "                        spectral_spread, bandpowers, spectrum, or time, frequency,\n"
+              << "                        all (default). Others are reported as null; the FFT is\n"
+              << "                        skipped when no frequency-domain feature is listed\n"
+              << "      --stats           Print per-stage timings and plan-cache hits to stderr\n"
+              << "                        (needs a build with -DENABLE_STATS=ON)\n"
+              << "  -h, --help            Show this help message\n"
+              << "\n"
+              << "Batch mode:\n"
+              << "  -b, --batch <spec>    Process many files in one run. spec is a directory\n"
+              << "                        (all files in it), a glob pattern such as 'data/*.f32',\n"
+              << "                        or a manifest file listing one path per line\n"
+              << "      --jobs <n>        Worker threads (default: 0 = all cores)\n"
+              << "      --output-format <fmt>\n"
+              << "                        jsonl (one JSON object per file, default), csv (one\n"
+              << "                        row per file with a header) or columnar (CPMF table\n"
+              << "                        with one row per file, needs -o)\n"
+              << "      --with-spectrum   Store spectra in columnar output (files must share\n"
+              << "                        length and sample rate)\n"
+              << "      --unordered       Write results as files finish instead of in input order\n"
               << "\n"
-              << "Input format: CSV with one sample per line, or comma-separated values.\n"
+              << "Input formats:\n"
+              << "  csv   One sample per line, or comma-separated values\n"
+              << "  f32, f64, i16\n"
+              << "        Raw little-endian samples (auto-detected from .f32/.f64/.i16)\n"
+              << "  cpmw  Binary file with a header giving sample rate, channels and\n"
+              << "        sample type (auto-detected from its magic bytes)\n"
+              << "Binary input is memory-mapped; single-channel f64 is analysed in place.\n"
               << "\n"
               << "Example:\n"
-              << "  " << program << " -r 5000 --json vibration_data.csv\n";
+              << "  " << program << " -r 5000 --json vibration_data.csv\n"
+              << "  " << program << " --format i16 -r 25600 recording.bin\n"
+              << "  " << program << " --batch 'recordings/*.cpmw' --jobs 8 -o features.jsonl\n";
+}
+
+// Resolve "auto" to a concrete input format
+std::string detect_format(const std::string& filename) {
+    if (cpm::MappedWaveform::has_header(filename)) {
+        return "cpmw";
+    }
+    for (const char* ext : {".f32", ".f64", ".i16"}) {
+        const std::string suffix(ext);
+        if (filename.size() > suffix.size() &&
+            filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            return suffix.substr(1);
+        }
+    }
+    return "csv";
 }
 
-std::vector<double> read_signal(const std::string& filename) {
-    std::vector<double> signal;
-    std::ifstream file(filename);
+void load_signal(const std::string& path, const InputOptions& options, LoadedSignal& signal) {
+    std::string format = options.format == "auto" ? detect_format(path) : options.format;
+    signal.mapped.reset();
+    signal.samples = {};
+    signal.float_samples = {};
+    signal.int16_samples = {};
+    signal.sample_rate = options.sample_rate;
 
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + filename);
+    if (format == "csv") {
+        signal.storage = cpm::read_csv_signal(path, options.num_threads);
+        signal.samples = signal.storage;
+        return;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string value;
+    if (format == "cpmw") {
+        signal.mapped = cpm::MappedWaveform::open(path);
+        if (!options.rate_given && signal.mapped->sample_rate() > 0) {
+            signal.sample_rate = signal.mapped->sample_rate();
+        }
+    } else {
+        signal.mapped = cpm::MappedWaveform::open_raw(
+            path, cpm::parse_sample_type(format), options.raw_channels);
+    }
+    if (options.channel == 0) {
+        signal.float_samples = signal.mapped->float_samples();
+        signal.int16_samples = signal.mapped->int16_samples();
+        signal.scale = signal.mapped->scale();
+        if (!signal.float_samples.empty() || !signal.int16_samples.empty()) {
+            return;
+        }
+    }
+    signal.samples = signal.mapped->channel(options.channel, signal.storage);
+}
 
-        while (std::getline(ss, value, ',')) {
-            // Trim whitespace
-            size_t start = value.find_first_not_of(" \t\r\n");
-            size_t end = value.find_last_not_of(" \t\r\n");
+// Shortest round-trip representation for machine-readable output, or a
+// fixed number of decimals when digits >= 0
+void write_number(std::ostream& out, double value, int digits = -1) {
+    if (!std::isfinite(value)) {
+        out << "null";
+        return;
+    }
+    char buf[352];  // Fits any double in fixed notation
+    auto result = digits < 0
+        ? std::to_chars(buf, buf + sizeof(buf), value)
+        : std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, digits);
+    out.write(buf, result.ptr - buf);
+}
 
-            if (start != std::string::npos && end != std::string::npos) {
-                std::string trimmed = value.substr(start, end - start + 1);
-                if (!trimmed.empty()) {
-                    try {
-                        signal.push_back(std::stod(trimmed));
-                    } catch (...) {
-                        // Skip non-numeric values (headers, etc.)
-                    }
+void write_json_string(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c : s) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            case '\r': out << "\\r"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char esc[8];
+                    std::snprintf(esc, sizeof(esc), "\\u%04x", static_cast<unsigned>(c));
+                    out << esc;
+                } else {
+                    out << c;
                 }
-            }
         }
     }
-
-    return signal;
+    out << '"';
 }
 
 void output_text(const cpm::SignalFeatures& features, std::ostream& out) {
@@ -79,92 +237,439 @@ void output_text(const cpm::SignalFeatures& features, std::ostream& out) {
         << "FFT Spectrum: " << features.fft_magnitude.size() << " frequency bins\n";
 }
 
+// JSON is for reading by eye; use columnar output for anything large
 void output_json(const cpm::SignalFeatures& features, std::ostream& out) {
-    out << std::fixed << std::setprecision(6);
+    const std::pair<const char*, double> scalars[] = {
+        {"rms", features.rms},
+        {"peak", features.peak},
+        {"crest_factor", features.crest_factor},
+        {"kurtosis", features.kurtosis},
+        {"skewness", features.skewness},
+        {"spectral_centroid", features.spectral_centroid},
+        {"spectral_spread", features.spectral_spread},
+    };
 
-    out << "{\n"
-        << "  \"rms\": " << features.rms << ",\n"
-        << "  \"peak\": " << features.peak << ",\n"
-        << "  \"crest_factor\": " << features.crest_factor << ",\n"
-        << "  \"kurtosis\": " << features.kurtosis << ",\n"
-        << "  \"skewness\": " << features.skewness << ",\n"
-        << "  \"spectral_centroid\": " << features.spectral_centroid << ",\n"
-        << "  \"spectral_spread\": " << features.spectral_spread << ",\n"
-        << "  \"bandpowers\": {\n";
+    out << "{\n";
+    for (const auto& [name, value] : scalars) {
+        out << "  \"" << name << "\": ";
+        write_number(out, value, 6);
+        out << ",\n";
+    }
 
+    out << "  \"bandpowers\": {\n";
     for (size_t i = 0; i < features.bandpowers.size(); ++i) {
-        out << "    \"" << features.band_names[i] << "\": " << features.bandpowers[i];
+        out << "    ";
+        write_json_string(out, features.band_names[i]);
+        out << ": ";
+        write_number(out, features.bandpowers[i], 6);
         if (i < features.bandpowers.size() - 1) out << ",";
         out << "\n";
     }
+    out << "  },\n";
 
-    out << "  },\n"
-        << "  \"fft_magnitude\": [";
+    auto write_array = [&](const char* name, const std::vector<double>& values) {
+        out << "  \"" << name << "\": [";
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) out << ", ";
+            write_number(out, values[i], 6);
+        }
+        out << "]";
+    };
+    write_array("fft_magnitude", features.fft_magnitude);
+    out << ",\n";
+    write_array("fft_frequencies", features.fft_frequencies);
+    out << "\n}\n";
+}
 
-    for (size_t i = 0; i < features.fft_magnitude.size(); ++i) {
-        if (i > 0) out << ", ";
-        out << features.fft_magnitude[i];
+// Per-stage counters for --stats; stages that never ran are left out
+void output_stats(std::ostream& out) {
+    if (!cpm::stats::enabled()) {
+        out << "Stage statistics are not available: rebuild with -DENABLE_STATS=ON\n";
+        return;
     }
+    const cpm::stats::Snapshot snapshot = cpm::stats::snapshot();
 
-    out << "],\n"
-        << "  \"fft_frequencies\": [";
+    out << "=== Stage Statistics ===\n"
+        << std::left << std::setw(16) << "stage" << std::right
+        << std::setw(10) << "calls" << std::setw(12) << "total ms"
+        << std::setw(12) << "us/call" << std::setw(14) << "cycles/call"
+        << std::setw(10) << "MB/s" << "\n";
+    for (size_t s = 0; s < cpm::stats::NUM_STAGES; ++s) {
+        const auto& stage = snapshot.stages[s];
+        if (stage.calls == 0) {
+            continue;
+        }
+        const double calls = static_cast<double>(stage.calls);
+        const double ns = static_cast<double>(stage.nanoseconds);
+        out << std::left << std::setw(16) << cpm::stats::stage_name(static_cast<cpm::stats::Stage>(s))
+            << std::right << std::fixed
+            << std::setw(10) << stage.calls
+            << std::setw(12) << std::setprecision(3) << ns / 1e6
+            << std::setw(12) << std::setprecision(2) << ns / 1e3 / calls
+            << std::setw(14) << std::setprecision(0) << static_cast<double>(stage.cycles) / calls
+            << std::setw(10) << std::setprecision(1)
+            << (ns > 0 ? static_cast<double>(stage.bytes) * 1e3 / ns : 0.0) << "\n";
+    }
+    out << "Plan cache: " << snapshot.plan_cache_hits << " hits, " << snapshot.plan_cache_misses
+        << " misses (" << std::setprecision(1) << 100.0 * snapshot.plan_cache_hit_rate() << "% hit rate)\n";
+}
 
-    for (size_t i = 0; i < features.fft_frequencies.size(); ++i) {
-        if (i > 0) out << ", ";
-        out << features.fft_frequencies[i];
+void write_csv_field(std::ostream& out, const std::string& s) {
+    if (s.find_first_of(",\"\n") == std::string::npos) {
+        out << s;
+        return;
     }
+    out << '"';
+    for (char c : s) {
+        if (c == '"') out << '"';
+        out << c;
+    }
+    out << '"';
+}
 
-    out << "]\n"
-        << "}\n";
+// Files named by a batch spec: a directory, a glob pattern or a manifest
+std::vector<std::string> list_batch_inputs(const std::string& spec) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+
+    if (fs::is_directory(spec)) {
+        for (const auto& entry : fs::directory_iterator(spec)) {
+            const std::string name = entry.path().filename().string();
+            if (entry.is_regular_file() && !name.empty() && name[0] != '.') {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+    } else if (spec.find_first_of("*?[") != std::string::npos) {
+        glob_t matches;
+        int rc = glob(spec.c_str(), 0, nullptr, &matches);
+        if (rc != 0 && rc != GLOB_NOMATCH) {
+            throw std::runtime_error("Cannot expand pattern: " + spec);
+        }
+        for (size_t i = 0; i < matches.gl_pathc; ++i) {
+            if (fs::is_regular_file(matches.gl_pathv[i])) {
+                files.push_back(matches.gl_pathv[i]);
+            }
+        }
+        globfree(&matches);
+    } else {
+        std::ifstream manifest(spec);
+        if (!manifest.is_open()) {
+            throw std::runtime_error("Cannot open manifest: " + spec);
+        }
+        std::string line;
+        while (std::getline(manifest, line)) {
+            size_t start = line.find_first_not_of(" \t\r");
+            size_t end = line.find_last_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#') {
+                continue;
+            }
+            files.push_back(line.substr(start, end - start + 1));
+        }
+    }
+
+    return files;
+}
+
+struct BatchOptions {
+    size_t jobs = 0;
+    std::string output_format = "jsonl";
+    bool ordered = true;
+    bool with_spectrum = false;
+};
+
+// Format one batch result record (one line)
+std::string format_batch_record(const std::string& path, const LoadedSignal* signal,
+                                const cpm::SignalFeatures* features, const std::string& error,
+                                const std::string& output_format) {
+    std::ostringstream out;
+
+    if (output_format == "csv") {
+        write_csv_field(out, path);
+        if (features) {
+            out << ',' << signal->size() << ',';
+            write_number(out, signal->sample_rate);
+            for (double v : {features->rms, features->peak, features->crest_factor,
+                             features->kurtosis, features->skewness,
+                             features->spectral_centroid, features->spectral_spread}) {
+                out << ',';
+                write_number(out, v);
+            }
+            for (double bp : features->bandpowers) {
+                out << ',';
+                write_number(out, bp);
+            }
+        }
+        out << '\n';
+        return out.str();
+    }
+
+    out << "{\"file\":";
+    write_json_string(out, path);
+    if (!features) {
+        out << ",\"error\":";
+        write_json_string(out, error);
+        out << "}\n";
+        return out.str();
+    }
+
+    out << ",\"samples\":" << signal->size() << ",\"sample_rate\":";
+    write_number(out, signal->sample_rate);
+
+    const std::pair<const char*, double> scalars[] = {
+        {"rms", features->rms},
+        {"peak", features->peak},
+        {"crest_factor", features->crest_factor},
+        {"kurtosis", features->kurtosis},
+        {"skewness", features->skewness},
+        {"spectral_centroid", features->spectral_centroid},
+        {"spectral_spread", features->spectral_spread},
+    };
+    for (const auto& [name, value] : scalars) {
+        out << ",\"" << name << "\":";
+        write_number(out, value);
+    }
+
+    out << ",\"bandpowers\":{";
+    for (size_t i = 0; i < features->bandpowers.size(); ++i) {
+        if (i > 0) out << ',';
+        write_json_string(out, features->band_names[i]);
+        out << ':';
+        write_number(out, features->bandpowers[i]);
+    }
+    out << "}}\n";
+    return out.str();
+}
+
+// Process every file on the shared pool; returns the number of failures.
+// With a table, rows are stored in it at their input index and out is unused.
+size_t run_batch(const std::vector<std::string>& files, const InputOptions& input,
+                 const AnalysisOptions& analysis, const BatchOptions& batch, std::ostream& out,
+                 cpm::FeatureTableWriter* table) {
+    if (batch.output_format == "csv") {
+        out << "file,samples,sample_rate,rms,peak,crest_factor,kurtosis,skewness,"
+               "spectral_centroid,spectral_spread";
+        for (const auto& name : cpm::FeatureExtractor().get_band_names()) {
+            out << ',';
+            write_csv_field(out, name);
+        }
+        out << '\n';
+    }
+
+    // Files are parsed on their worker; CSV parsing must not fan out again
+    InputOptions per_file = input;
+    per_file.num_threads = 1;
+
+    auto pool = cpm::ThreadPool::shared(batch.jobs);
+    std::vector<LoadedSignal> signals(pool->size());
+    std::vector<cpm::Workspace> workspaces(pool->size());
+
+    // Ordered output holds finished records until all earlier ones are written
+    std::mutex out_mutex;
+    std::map<size_t, std::string> pending;
+    size_t next_to_write = 0;
+    size_t failures = 0;
+
+    auto emit = [&](size_t index, std::string record, bool failed) {
+        std::lock_guard<std::mutex> lock(out_mutex);
+        failures += failed ? 1 : 0;
+        if (!batch.ordered) {
+            out << record;
+            return;
+        }
+        pending.emplace(index, std::move(record));
+        while (!pending.empty() && pending.begin()->first == next_to_write) {
+            out << pending.begin()->second;
+            pending.erase(pending.begin());
+            ++next_to_write;
+        }
+    };
+
+    pool->parallel_for(files.size(), 1, [&](size_t begin, size_t end, size_t worker) {
+        for (size_t i = begin; i < end; ++i) {
+            const std::string& path = files[i];
+            LoadedSignal& signal = signals[worker];
+            try {
+                load_signal(path, per_file, signal);
+                if (signal.size() == 0) {
+                    throw std::runtime_error("No valid samples found");
+                }
+                // Plans and band layouts are cached process-wide, so this is cheap
+                cpm::FeatureExtractor extractor = analysis.make_extractor(signal.sample_rate);
+                bool spectrum = table && table->num_bins() > 0;
+                const auto& features = signal.extract(extractor, workspaces[worker], spectrum);
+                if (table) {
+                    table->set_row(i, features, signal.size(), signal.sample_rate);
+                    emit(i, {}, false);
+                } else {
+                    emit(i, format_batch_record(path, &signal, &features, {}, batch.output_format), false);
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << path << ": " << e.what() << "\n";
+                emit(i, batch.output_format != "jsonl"
+                            ? std::string()
+                            : format_batch_record(path, nullptr, nullptr, e.what(), batch.output_format),
+                     true);
+            }
+            signal.mapped.reset();
+        }
+    });
+
+    return failures;
 }
 
 int main(int argc, char* argv[]) {
-    double sample_rate = 5000.0;
+    InputOptions input;
+    AnalysisOptions analysis;
+    BatchOptions batch;
     std::string input_file;
+    std::string batch_spec;
     std::string output_file;
-    bool json_output = false;
+    std::string output_format;
+    cpm::SpectrumEncoding spectrum_encoding = cpm::SpectrumEncoding::Float64;
+    bool show_stats = false;
 
     // Parse arguments
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
 
-        if (arg == "-h" || arg == "--help") {
-            print_usage(argv[0]);
-            return 0;
-        } else if (arg == "-r" || arg == "--rate") {
+        auto value = [&](const char* what) -> const char* {
             if (i + 1 >= argc) {
-                std::cerr << "Error: --rate requires a value\n";
-                return 1;
+                throw std::invalid_argument(arg + " requires " + what);
             }
-            sample_rate = std::stod(argv[++i]);
-        } else if (arg == "-o" || arg == "--output") {
-            if (i + 1 >= argc) {
-                std::cerr << "Error: --output requires a filename\n";
+            return argv[++i];
+        };
+
+        try {
+            if (arg == "-h" || arg == "--help") {
+                print_usage(argv[0]);
+                return 0;
+            } else if (arg == "-r" || arg == "--rate") {
+                input.sample_rate = std::stod(value("a value"));
+                input.rate_given = true;
+            } else if (arg == "-o" || arg == "--output") {
+                output_file = value("a filename");
+            } else if (arg == "-j" || arg == "--json") {
+                output_format = "json";
+            } else if (arg == "-f" || arg == "--format") {
+                input.format = value("a value");
+            } else if (arg == "-c" || arg == "--channel") {
+                input.channel = std::stoul(value("a value"));
+            } else if (arg == "-t" || arg == "--threads") {
+                input.num_threads = std::stoul(value("a value"));
+            } else if (arg == "--channels") {
+                input.raw_channels = std::stoul(value("a value"));
+            } else if (arg == "-w" || arg == "--welch") {
+                if (!analysis.welch) analysis.welch.emplace();
+                analysis.welch->segment_length = std::stoul(value("a segment length"));
+            } else if (arg == "--overlap") {
+                if (!analysis.welch) analysis.welch.emplace();
+                analysis.welch->overlap = std::stod(value("a fraction"));
+            } else if (arg == "--window") {
+                if (!analysis.welch) analysis.welch.emplace();
+                analysis.welch->window = cpm::parse_window(value("a window name"));
+            } else if (arg == "--features") {
+                analysis.features = cpm::parse_features(value("a feature list"));
+            } else if (arg == "-b" || arg == "--batch") {
+                batch_spec = value("a directory, glob or manifest");
+            } else if (arg == "--jobs") {
+                batch.jobs = std::stoul(value("a value"));
+            } else if (arg == "--output-format") {
+                output_format = value("a value");
+            } else if (arg == "--unordered") {
+                batch.ordered = false;
+            } else if (arg == "--with-spectrum") {
+                batch.with_spectrum = true;
+            } else if (arg == "--spectrum-encoding") {
+                spectrum_encoding = cpm::parse_spectrum_encoding(value("an encoding"));
+            } else if (arg == "--stats") {
+                show_stats = true;
+            } else if (arg[0] == '-') {
+                std::cerr << "Unknown option: " << arg << "\n";
+                print_usage(argv[0]);
                 return 1;
+            } else {
+                input_file = arg;
             }
-            output_file = argv[++i];
-        } else if (arg == "-j" || arg == "--json") {
-            json_output = true;
-        } else if (arg[0] == '-') {
-            std::cerr << "Unknown option: " << arg << "\n";
-            print_usage(argv[0]);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
             return 1;
-        } else {
-            input_file = arg;
         }
     }
 
-    if (input_file.empty()) {
+    if (input_file.empty() && batch_spec.empty()) {
         std::cerr << "Error: No input file specified\n";
         print_usage(argv[0]);
         return 1;
     }
 
+    const bool batch_mode = !batch_spec.empty();
+    if (output_format.empty()) {
+        output_format = batch_mode ? "jsonl" : "text";
+    }
+    const bool valid_format = batch_mode
+        ? (output_format == "jsonl" || output_format == "csv" || output_format == "columnar")
+        : (output_format == "text" || output_format == "json" || output_format == "columnar");
+    if (!valid_format) {
+        std::cerr << "Error: Output format " << output_format << " is not available "
+                  << (batch_mode ? "in batch mode (use jsonl, csv or columnar)\n"
+                                 : "for a single file (use text, json or columnar)\n");
+        return 1;
+    }
+    const bool columnar = output_format == "columnar";
+    if (columnar && output_file.empty()) {
+        std::cerr << "Error: Columnar output needs an output file (-o)\n";
+        return 1;
+    }
+    batch.output_format = output_format;
+
     try {
-        // Read signal
-        std::vector<double> signal = read_signal(input_file);
+        // The feature table writer creates its own file
+        std::ofstream file_out;
+        if (!output_file.empty() && !columnar) {
+            file_out.open(output_file);
+            if (!file_out.is_open()) {
+                std::cerr << "Error: Cannot open output file: " << output_file << "\n";
+                return 1;
+            }
+        }
+        std::ostream& out = output_file.empty() ? std::cout : file_out;
 
-        if (signal.empty()) {
+        if (!batch_spec.empty()) {
+            std::vector<std::string> files = list_batch_inputs(batch_spec);
+            if (files.empty()) {
+                std::cerr << "Error: No input files match " << batch_spec << "\n";
+                return 1;
+            }
+
+            std::optional<cpm::FeatureTableWriter> table;
+            if (columnar) {
+                // The spectrum block has one frequency grid, taken from the first file
+                std::vector<double> frequencies;
+                if (batch.with_spectrum) {
+                    LoadedSignal first;
+                    load_signal(files.front(), input, first);
+                    cpm::Workspace workspace;
+                    frequencies = first.extract(analysis.make_extractor(first.sample_rate), workspace, true)
+                                      .fft_frequencies;
+                }
+                table.emplace(output_file, files.size(), cpm::FeatureExtractor().get_bands().names(),
+                              frequencies, files, spectrum_encoding);
+            }
+
+            size_t failures = run_batch(files, input, analysis, batch, out, table ? &*table : nullptr);
+            std::cerr << "Processed " << files.size() - failures << " of " << files.size()
+                      << " files\n";
+            if (show_stats) {
+                output_stats(std::cerr);
+            }
+            return failures == 0 ? 0 : 1;
+        }
+
+        LoadedSignal signal;
+        load_signal(input_file, input, signal);
+
+        if (signal.size() == 0) {
             std::cerr << "Error: No valid samples found in input file\n";
             return 1;
         }
@@ -172,27 +677,22 @@ int main(int argc, char* argv[]) {
         std::cerr << "Read " << signal.size() << " samples\n";
 
         // Extract features
-        cpm::FeatureExtractor extractor(sample_rate);
-        cpm::SignalFeatures features = extractor.extract_all(signal);
+        cpm::FeatureExtractor extractor = analysis.make_extractor(signal.sample_rate);
+        cpm::Workspace workspace;
+        const cpm::SignalFeatures& features = signal.extract(extractor, workspace, true);
 
         // Output
-        if (output_file.empty()) {
-            if (json_output) {
-                output_json(features, std::cout);
-            } else {
-                output_text(features, std::cout);
-            }
+        if (columnar) {
+            cpm::FeatureTableWriter table(output_file, 1, features.band_names,
+                                          features.fft_frequencies, {input_file}, spectrum_encoding);
+            table.set_row(0, features, signal.size(), signal.sample_rate);
+        } else if (output_format == "json") {
+            output_json(features, out);
         } else {
-            std::ofstream out(output_file);
-            if (!out.is_open()) {
-                std::cerr << "Error: Cannot open output file: " << output_file << "\n";
-                return 1;
-            }
-            if (json_output) {
-                output_json(features, out);
-            } else {
-                output_text(features, out);
-            }
+            output_text(features, out);
+        }
+        if (show_stats) {
+            output_stats(std::cerr);
         }
 
         return 0;
@@ -0,0 +1,113 @@
+#include "moments.hpp"
+#include "simd_kernels.hpp"
+#include <cmath>
+
+namespace cpm {
+
+void MomentAccumulator::add(double x) {
+    const double n1 = static_cast<double>(count);
+    ++count;
+    const double n = static_cast<double>(count);
+
+    const double delta = x - mean;
+    const double delta_n = delta / n;
+    const double delta_n2 = delta_n * delta_n;
+    const double term1 = delta * delta_n * n1;
+
+    mean += delta_n;
+    m4 += term1 * delta_n2 * (n * n - 3.0 * n + 3.0) + 6.0 * delta_n2 * m2 - 4.0 * delta_n * m3;
+    m3 += term1 * delta_n * (n - 2.0) - 3.0 * delta_n * m2;
+    m2 += term1;
+}
+
+void MomentAccumulator::merge(const MomentAccumulator& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+
+    const double na = static_cast<double>(count);
+    const double nb = static_cast<double>(other.count);
+    const double n = na + nb;
+
+    const double delta = other.mean - mean;
+    const double delta2 = delta * delta;
+    const double delta3 = delta2 * delta;
+    const double delta4 = delta2 * delta2;
+
+    const double new_m4 = m4 + other.m4
+        + delta4 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+        + 6.0 * delta2 * (na * na * other.m2 + nb * nb * m2) / (n * n)
+        + 4.0 * delta * (na * other.m3 - nb * m3) / n;
+
+    const double new_m3 = m3 + other.m3
+        + delta3 * na * nb * (na - nb) / (n * n)
+        + 3.0 * delta * (na * other.m2 - nb * m2) / n;
+
+    const double new_m2 = m2 + other.m2 + delta2 * na * nb / n;
+
+    mean += delta * nb / n;
+    m2 = new_m2;
+    m3 = new_m3;
+    m4 = new_m4;
+    count += other.count;
+}
+
+MomentAccumulator MomentAccumulator::from_block(std::span<const double> block) {
+    MomentAccumulator acc;
+    if (block.empty()) {
+        return acc;
+    }
+
+    const auto& k = simd::active();
+
+    double sum = 0.0, sum_sq = 0.0, max_abs = 0.0;
+    k.raw_sums(block.data(), block.size(), sum, sum_sq, max_abs);
+
+    acc.count = block.size();
+    acc.mean = sum / static_cast<double>(acc.count);
+    k.central_moments(block.data(), block.size(), acc.mean, acc.m2, acc.m3, acc.m4);
+
+    return acc;
+}
+
+double MomentAccumulator::variance() const {
+    if (count == 0) {
+        return 0.0;
+    }
+    return m2 / static_cast<double>(count);
+}
+
+double MomentAccumulator::skewness() const {
+    if (count < 3) {
+        return 0.0;
+    }
+
+    const double n = static_cast<double>(count);
+    double std_dev = std::sqrt(m2 / n);
+    if (std_dev < 1e-10) {
+        return 0.0;
+    }
+
+    return (m3 / n) / (std_dev * std_dev * std_dev);
+}
+
+double MomentAccumulator::kurtosis() const {
+    if (count < 4) {
+        return 0.0;
+    }
+
+    const double n = static_cast<double>(count);
+    double var = m2 / n;
+    if (var < 1e-10) {
+        return 0.0;
+    }
+
+    // Fisher's excess kurtosis (normal distribution = 0)
+    return ((m4 / n) / (var * var)) - 3.0;
+}
+
+} // namespace cpm
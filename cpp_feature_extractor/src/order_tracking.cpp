@@ -0,0 +1,331 @@
+#include "order_tracking.hpp"
+#include "fft_plan.hpp"
+#include "simd_kernels.hpp"
+#include "stats.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+namespace cpm {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double CUTOFF_STEPS = 256.0;  // Cache granularity of PolyphaseFilter::get
+
+// Blackman window on u in [-1, 1]
+double blackman(double u) {
+    if (std::abs(u) >= 1.0) {
+        return 0.0;
+    }
+    return 0.42 + 0.5 * std::cos(PI * u) + 0.08 * std::cos(2.0 * PI * u);
+}
+
+double sinc(double x) {
+    return x == 0.0 ? 1.0 : std::sin(PI * x) / (PI * x);
+}
+
+// Per-thread buffers for one order spectrum
+struct OrderScratch {
+    std::vector<double> padded;      // Signal with taps zeros on each side
+    std::vector<double> angle;       // Cumulative revolutions at each input sample
+    std::vector<double> positions;   // Input position of each angle sample
+    std::vector<double> resampled;
+    std::vector<std::complex<double>> spectrum;
+    std::vector<double> magnitudes;
+};
+
+OrderScratch& order_scratch() {
+    thread_local OrderScratch scratch;
+    return scratch;
+}
+
+// Linear interpolation of an RPM trace spread over n samples
+double rpm_at(std::span<const double> rpm, size_t i, size_t n) {
+    if (rpm.size() == 1 || n < 2) {
+        return rpm[0];
+    }
+    const double u = static_cast<double>(i) * static_cast<double>(rpm.size() - 1) /
+                     static_cast<double>(n - 1);
+    const size_t j = std::min(static_cast<size_t>(u), rpm.size() - 2);
+    const double t = u - static_cast<double>(j);
+    return rpm[j] + t * (rpm[j + 1] - rpm[j]);
+}
+
+} // namespace
+
+PolyphaseFilter::PolyphaseFilter(size_t taps, size_t phases, double cutoff)
+    : phases_(std::max<size_t>(1, phases)), cutoff_(cutoff) {
+    if (!(cutoff > 0.0 && cutoff <= 1.0)) {
+        throw std::invalid_argument("Resampling cutoff must be in (0, 1]");
+    }
+    const size_t base = std::max<size_t>(4, taps + (taps & 1));
+    taps_ = static_cast<size_t>(std::ceil(static_cast<double>(base) / cutoff));
+    taps_ += taps_ & 1;
+
+    // Tap k of row p weights input sample i - half + 1 + k for the output at
+    // i + p / phases, so its distance from the output is k - half + 1 - p / phases
+    const double half = static_cast<double>(taps_ / 2);
+    coefficients_.resize((phases_ + 1) * taps_);
+    for (size_t p = 0; p <= phases_; ++p) {
+        double* row = coefficients_.data() + p * taps_;
+        const double frac = static_cast<double>(p) / static_cast<double>(phases_);
+        double sum = 0.0;
+        for (size_t k = 0; k < taps_; ++k) {
+            const double t = static_cast<double>(k) - half + 1.0 - frac;
+            row[k] = cutoff * sinc(cutoff * t) * blackman(t / half);
+            sum += row[k];
+        }
+        for (size_t k = 0; k < taps_; ++k) {
+            row[k] /= sum;
+        }
+    }
+}
+
+std::shared_ptr<const PolyphaseFilter> PolyphaseFilter::get(size_t taps, size_t phases, double cutoff) {
+    // Speed-dependent cutoffs would otherwise give every waveform its own filter
+    const double steps = std::clamp(std::floor(cutoff * CUTOFF_STEPS), 1.0, CUTOFF_STEPS);
+    using Key = std::tuple<size_t, size_t, double>;
+    const Key key{taps, phases, steps};
+
+    static std::mutex mutex;
+    static std::map<Key, std::shared_ptr<const PolyphaseFilter>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.emplace(key, std::make_shared<const PolyphaseFilter>(taps, phases, steps / CUTOFF_STEPS)).first;
+    }
+    return it->second;
+}
+
+void PolyphaseFilter::resample(std::span<const double> signal, std::span<const double> positions,
+                               std::span<double> out) const {
+    if (out.size() < positions.size()) {
+        throw std::invalid_argument("Resampling output buffer too small");
+    }
+    // Padding keeps every tap window inside the buffer, so each output is
+    // one contiguous dot product
+    const size_t n = signal.size();
+    const size_t pad = taps_;
+    OrderScratch& s = order_scratch();
+    s.padded.assign(n + 2 * pad, 0.0);
+    std::copy(signal.begin(), signal.end(), s.padded.begin() + static_cast<std::ptrdiff_t>(pad));
+
+    const auto& k = simd::active();
+    const double lowest = -static_cast<double>(pad / 2);
+    const double highest = static_cast<double>(n + pad / 2) - 1.0;
+    const double phases = static_cast<double>(phases_);
+    for (size_t j = 0; j < positions.size(); ++j) {
+        const double x = positions[j];
+        if (!(x >= lowest && x <= highest)) {
+            out[j] = 0.0;
+            continue;
+        }
+        const double whole = std::floor(x);
+        const size_t phase = static_cast<size_t>(std::lround((x - whole) * phases));
+        const auto first = static_cast<std::ptrdiff_t>(whole) + static_cast<std::ptrdiff_t>(pad) -
+                           static_cast<std::ptrdiff_t>(taps_ / 2) + 1;
+        out[j] = k.dot(s.padded.data() + first, row(phase), taps_);
+    }
+}
+
+BandSet OrderTracker::default_bands() {
+    return BandSet({
+        {"0.5x", 0.25, 0.75},
+        {"1x", 0.75, 1.25},
+        {"2x", 1.75, 2.25},
+        {"3x", 2.75, 3.25},
+        {"4x+", 3.75, std::numeric_limits<double>::infinity()}
+    });
+}
+
+OrderTracker::OrderTracker(const OrderConfig& config)
+    : config_(config),
+      bands_(std::make_shared<const BandSet>(config.bands.empty() ? default_bands()
+                                                                  : BandSet(config.bands))) {
+    if (config.samples_per_rev < 2) {
+        throw std::invalid_argument("Order tracking needs at least 2 samples per revolution");
+    }
+}
+
+std::span<const double> OrderTracker::spectrum(std::span<const double> signal, double sample_rate,
+                                               std::span<const double> rpm, size_t& revolutions,
+                                               double& mean_rpm) const {
+    if (rpm.empty()) {
+        throw std::invalid_argument("Speed trace is empty");
+    }
+    if (!(sample_rate > 0.0)) {
+        throw std::invalid_argument("Sample rate must be positive");
+    }
+    revolutions = 0;
+    mean_rpm = 0.0;
+    const size_t n = signal.size();
+    const size_t spr = config_.samples_per_rev;
+
+    // Shaft angle in revolutions at each input sample (trapezoidal integral)
+    double slowest = std::numeric_limits<double>::infinity();
+    for (double r : rpm) {
+        if (!(r > 0.0) || !std::isfinite(r)) {
+            throw std::invalid_argument("Shaft speed must be positive");
+        }
+        slowest = std::min(slowest, r);
+    }
+    if (n < 2) {
+        mean_rpm = rpm_at(rpm, 0, n);
+        return {};
+    }
+
+    OrderScratch& s = order_scratch();
+    const double revs_per_sample = 1.0 / (60.0 * sample_rate);
+    const bool constant = rpm.size() == 1;
+    double total = 0.0;
+    if (constant) {
+        total = rpm[0] * revs_per_sample * static_cast<double>(n - 1);
+    } else {
+        s.angle.resize(n);
+        s.angle[0] = 0.0;
+        double previous = rpm_at(rpm, 0, n);
+        for (size_t i = 1; i < n; ++i) {
+            const double current = rpm_at(rpm, i, n);
+            s.angle[i] = s.angle[i - 1] + 0.5 * (previous + current) * revs_per_sample;
+            previous = current;
+        }
+        total = s.angle[n - 1];
+    }
+    mean_rpm = total / (revs_per_sample * static_cast<double>(n - 1));
+    revolutions = static_cast<size_t>(std::floor(total + 1e-9));
+    if (revolutions == 0) {
+        return {};
+    }
+
+    // Input position of each of the revolutions x spr equal angle steps
+    const size_t m = revolutions * spr;
+    s.positions.resize(m);
+    if (constant) {
+        const double step = 1.0 / (static_cast<double>(spr) * rpm[0] * revs_per_sample);
+        for (size_t j = 0; j < m; ++j) {
+            s.positions[j] = static_cast<double>(j) * step;
+        }
+    } else {
+        size_t i = 0;
+        for (size_t j = 0; j < m; ++j) {
+            const double target = static_cast<double>(j) / static_cast<double>(spr);
+            while (i + 2 < n && s.angle[i + 1] < target) {
+                ++i;
+            }
+            const double width = s.angle[i + 1] - s.angle[i];
+            s.positions[j] = static_cast<double>(i) + (target - s.angle[i]) / width;
+        }
+    }
+
+    // Input samples per angle sample peak at the lowest speed; the
+    // anti-alias cutoff follows it so no order above spr / 2 folds back
+    const double max_step = 1.0 / (static_cast<double>(spr) * slowest * revs_per_sample);
+    auto filter = PolyphaseFilter::get(config_.taps, config_.phases, std::min(1.0, 1.0 / max_step));
+    s.resampled.resize(m);
+    {
+        CPM_STATS_STAGE(Resample, signal.size_bytes());
+        filter->resample(signal, s.positions, s.resampled);
+    }
+
+    auto plan = FFTPlan::get(m);
+    const size_t bins = plan->num_bins();
+    s.spectrum.resize(bins);
+    s.magnitudes.resize(bins);
+    plan->forward_real(s.resampled, s.spectrum);
+    {
+        CPM_STATS_STAGE(Magnitudes, s.resampled.size() * sizeof(double));
+        simd::active().magnitudes(s.spectrum.data(), bins, 2.0 / static_cast<double>(m),
+                                  s.magnitudes.data());
+        if (bins > 0) {
+            s.magnitudes[0] /= 2.0;
+        }
+    }
+    return s.magnitudes;
+}
+
+OrderSpectrum OrderTracker::compute(std::span<const double> signal, double sample_rate, double rpm) const {
+    return compute(signal, sample_rate, std::span<const double>(&rpm, 1));
+}
+
+OrderSpectrum OrderTracker::compute(std::span<const double> signal, double sample_rate,
+                                    std::span<const double> rpm) const {
+    OrderSpectrum out;
+    out.band_names = bands_->names();
+    out.band_powers.assign(bands_->size(), 0.0);
+
+    auto magnitudes = spectrum(signal, sample_rate, rpm, out.revolutions, out.mean_rpm);
+    if (magnitudes.empty()) {
+        return out;
+    }
+    out.magnitudes.assign(magnitudes.begin(), magnitudes.end());
+    out.orders.resize(magnitudes.size());
+    const double spacing = 1.0 / static_cast<double>(out.revolutions);
+    for (size_t k = 0; k < out.orders.size(); ++k) {
+        out.orders[k] = static_cast<double>(k) * spacing;
+    }
+
+    CPM_STATS_STAGE(Bandpower, magnitudes.size_bytes());
+    const size_t m = out.revolutions * config_.samples_per_rev;
+    BandLayout::get(bands_, static_cast<double>(config_.samples_per_rev), m, magnitudes.size())
+        ->accumulate(magnitudes, out.band_powers);
+    return out;
+}
+
+BatchOrderFeatures OrderTracker::compute_batch(std::span<const double> data, double sample_rate,
+                                               std::span<const double> rpm, size_t num_rows,
+                                               size_t row_length, size_t num_threads) const {
+    if (data.size() != num_rows * row_length) {
+        throw std::invalid_argument("Batch data size does not match num_rows x row_length");
+    }
+    if (rpm.size() != num_rows) {
+        throw std::invalid_argument("Need one shaft speed per row");
+    }
+
+    BatchOrderFeatures out;
+    out.num_rows = num_rows;
+    out.num_bands = bands_->size();
+    out.band_names = bands_->names();
+    out.band_powers.assign(num_rows * out.num_bands, 0.0);
+    out.revolutions.assign(num_rows, 0);
+
+    // Rows write disjoint slots and resample into thread-local scratch
+    auto run_row = [&](size_t r) {
+        double mean_rpm = 0.0;
+        auto magnitudes = spectrum(data.subspan(r * row_length, row_length), sample_rate,
+                                   rpm.subspan(r, 1), out.revolutions[r], mean_rpm);
+        if (magnitudes.empty()) {
+            return;
+        }
+        CPM_STATS_STAGE(Bandpower, magnitudes.size_bytes());
+        const size_t m = out.revolutions[r] * config_.samples_per_rev;
+        BandLayout::get(bands_, static_cast<double>(config_.samples_per_rev), m, magnitudes.size())
+            ->accumulate(magnitudes, std::span<double>(out.band_powers).subspan(r * out.num_bands,
+                                                                                 out.num_bands));
+    };
+
+    const size_t threads = std::min(ThreadPool::resolve_threads(num_threads), num_rows);
+    if (threads <= 1) {
+        for (size_t r = 0; r < num_rows; ++r) {
+            run_row(r);
+        }
+        return out;
+    }
+
+    auto pool = ThreadPool::shared(num_threads);
+    const size_t grain = std::max<size_t>(1, num_rows / (pool->size() * 8));
+    pool->parallel_for(num_rows, grain, [&](size_t begin, size_t end, size_t) {
+        for (size_t r = begin; r < end; ++r) {
+            run_row(r);
+        }
+    });
+    return out;
+}
+
+} // namespace cpm
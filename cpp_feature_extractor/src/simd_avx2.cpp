@@ -0,0 +1,293 @@
+// Compiled with -mavx2 -mfma; only called after a runtime CPU check.
+#include "simd_internal.hpp"
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+
+namespace cpm {
+namespace simd {
+
+namespace {
+
+inline double hsum(__m256d v) {
+    __m128d lo = _mm256_castpd256_pd128(v);
+    __m128d hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_add_pd(lo, hi);
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+inline double hmax(__m256d v) {
+    __m128d lo = _mm256_castpd256_pd128(v);
+    __m128d hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_max_pd(lo, hi);
+    return _mm_cvtsd_f64(_mm_max_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+inline __m256d abs_pd(__m256d v) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+}
+
+void avx2_raw_sums(const double* x, size_t n,
+                   double& sum, double& sum_sq, double& max_abs) {
+    __m256d vs = _mm256_setzero_pd();
+    __m256d vsq = _mm256_setzero_pd();
+    __m256d vmx = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(x + i);
+        vs = _mm256_add_pd(vs, v);
+        vsq = _mm256_fmadd_pd(v, v, vsq);
+        vmx = _mm256_max_pd(vmx, abs_pd(v));
+    }
+
+    double s = hsum(vs), sq = hsum(vsq), mx = hmax(vmx);
+    for (; i < n; ++i) {
+        s += x[i];
+        sq += x[i] * x[i];
+        mx = std::max(mx, std::abs(x[i]));
+    }
+    sum = s;
+    sum_sq = sq;
+    max_abs = mx;
+}
+
+void avx2_central_moments(const double* x, size_t n, double mean,
+                          double& m2, double& m3, double& m4) {
+    const __m256d vmean = _mm256_set1_pd(mean);
+    __m256d v2 = _mm256_setzero_pd();
+    __m256d v3 = _mm256_setzero_pd();
+    __m256d v4 = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d d = _mm256_sub_pd(_mm256_loadu_pd(x + i), vmean);
+        __m256d d2 = _mm256_mul_pd(d, d);
+        v2 = _mm256_add_pd(v2, d2);
+        v3 = _mm256_fmadd_pd(d2, d, v3);
+        v4 = _mm256_fmadd_pd(d2, d2, v4);
+    }
+
+    double s2 = hsum(v2), s3 = hsum(v3), s4 = hsum(v4);
+    for (; i < n; ++i) {
+        double diff = x[i] - mean;
+        double diff2 = diff * diff;
+        s2 += diff2;
+        s3 += diff2 * diff;
+        s4 += diff2 * diff2;
+    }
+    m2 = s2;
+    m3 = s3;
+    m4 = s4;
+}
+
+double avx2_sum_squares(const double* x, size_t n) {
+    __m256d a = _mm256_setzero_pd();
+    __m256d b = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d v0 = _mm256_loadu_pd(x + i);
+        __m256d v1 = _mm256_loadu_pd(x + i + 4);
+        a = _mm256_fmadd_pd(v0, v0, a);
+        b = _mm256_fmadd_pd(v1, v1, b);
+    }
+
+    double sq = hsum(_mm256_add_pd(a, b));
+    for (; i < n; ++i) {
+        sq += x[i] * x[i];
+    }
+    return sq;
+}
+
+double avx2_dot(const double* x, const double* y, size_t n) {
+    __m256d a = _mm256_setzero_pd();
+    __m256d b = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        a = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), a);
+        b = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), b);
+    }
+    if (i + 4 <= n) {
+        a = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), a);
+        i += 4;
+    }
+
+    double sum = hsum(_mm256_add_pd(a, b));
+    for (; i < n; ++i) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+double avx2_max_abs(const double* x, size_t n) {
+    __m256d vmx = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vmx = _mm256_max_pd(vmx, abs_pd(_mm256_loadu_pd(x + i)));
+    }
+
+    double mx = hmax(vmx);
+    for (; i < n; ++i) {
+        mx = std::max(mx, std::abs(x[i]));
+    }
+    return mx;
+}
+
+void avx2_magnitudes(const std::complex<double>* spectrum, size_t n,
+                     double scale, double* out) {
+    const double* x = reinterpret_cast<const double*>(spectrum);
+    const __m256d vscale = _mm256_set1_pd(scale);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // a = [r0 i0 r1 i1], b = [r2 i2 r3 i3]
+        __m256d a = _mm256_loadu_pd(x + 2 * i);
+        __m256d b = _mm256_loadu_pd(x + 2 * i + 4);
+        // hadd gives [|0|^2 |2|^2 |1|^2 |3|^2]; restore bin order
+        __m256d p = _mm256_hadd_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b));
+        p = _mm256_permute4x64_pd(p, 0xD8);
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_sqrt_pd(p), vscale));
+    }
+
+    for (; i < n; ++i) {
+        double re = spectrum[i].real();
+        double im = spectrum[i].imag();
+        out[i] = std::sqrt(re * re + im * im) * scale;
+    }
+}
+
+void avx2_power_moments(const double* mags, const double* freqs, size_t n,
+                        double& total, double& weighted) {
+    __m256d vt = _mm256_setzero_pd();
+    __m256d vw = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d m = _mm256_loadu_pd(mags + i);
+        __m256d p = _mm256_mul_pd(m, m);
+        vt = _mm256_add_pd(vt, p);
+        vw = _mm256_fmadd_pd(_mm256_loadu_pd(freqs + i), p, vw);
+    }
+
+    double t = hsum(vt), w = hsum(vw);
+    for (; i < n; ++i) {
+        double power = mags[i] * mags[i];
+        t += power;
+        w += freqs[i] * power;
+    }
+    total = t;
+    weighted = w;
+}
+
+void avx2_power_spread(const double* mags, const double* freqs, size_t n,
+                       double centroid, double& total, double& weighted_var) {
+    const __m256d vc = _mm256_set1_pd(centroid);
+    __m256d vt = _mm256_setzero_pd();
+    __m256d vv = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d m = _mm256_loadu_pd(mags + i);
+        __m256d p = _mm256_mul_pd(m, m);
+        __m256d d = _mm256_sub_pd(_mm256_loadu_pd(freqs + i), vc);
+        vt = _mm256_add_pd(vt, p);
+        vv = _mm256_fmadd_pd(_mm256_mul_pd(d, d), p, vv);
+    }
+
+    double t = hsum(vt), v = hsum(vv);
+    for (; i < n; ++i) {
+        double power = mags[i] * mags[i];
+        double diff = freqs[i] - centroid;
+        t += power;
+        v += diff * diff * power;
+    }
+    total = t;
+    weighted_var = v;
+}
+
+void avx2_widen_f32(const float* x, size_t n, double* out) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        _mm256_storeu_pd(out + i, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        _mm256_storeu_pd(out + i + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+    }
+    for (; i < n; ++i) {
+        out[i] = static_cast<double>(x[i]);
+    }
+}
+
+void avx2_widen_i16(const int16_t* x, size_t n, double scale, double* out) {
+    const __m256d vscale = _mm256_set1_pd(scale);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // Sign-extend 8 counts to int32, then convert 4 at a time
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+        __m256d lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(v));
+        __m256d hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1));
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(lo, vscale));
+        _mm256_storeu_pd(out + i + 4, _mm256_mul_pd(hi, vscale));
+    }
+    for (; i < n; ++i) {
+        out[i] = static_cast<double>(x[i]) * scale;
+    }
+}
+
+void avx2_narrow_f16(const double* x, size_t n, double scale, uint16_t* out) {
+    const __m256d vscale = _mm256_set1_pd(scale);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 lo = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_loadu_pd(x + i), vscale));
+        __m128 hi = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_loadu_pd(x + i + 4), vscale));
+        __m256 v = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+    for (; i < n; ++i) {
+        out[i] = half_from_float(static_cast<float>(x[i] * scale));
+    }
+}
+
+void avx2_widen_f16(const uint16_t* x, size_t n, double scale, double* out) {
+    const __m256d vscale = _mm256_set1_pd(scale);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(v)), vscale));
+        _mm256_storeu_pd(out + i + 4, _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)), vscale));
+    }
+    for (; i < n; ++i) {
+        out[i] = static_cast<double>(float_from_half(x[i])) * scale;
+    }
+}
+
+const Kernels AVX2_KERNELS = {
+    Isa::AVX2,
+    avx2_raw_sums,
+    avx2_central_moments,
+    avx2_sum_squares,
+    avx2_dot,
+    avx2_max_abs,
+    avx2_magnitudes,
+    avx2_power_moments,
+    avx2_power_spread,
+    avx2_widen_f32,
+    avx2_widen_i16,
+    avx2_narrow_f16,
+    avx2_widen_f16,
+};
+
+} // namespace
+
+const Kernels& avx2_kernels() {
+    return AVX2_KERNELS;
+}
+
+} // namespace simd
+} // namespace cpm
@@ -0,0 +1,286 @@
+// Compiled with -mavx512f; only called after a runtime CPU check.
+#include "simd_internal.hpp"
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+
+namespace cpm {
+namespace simd {
+
+namespace {
+
+// Mask covering the remaining n - i (< 8) lanes
+inline __mmask8 tail_mask(size_t remaining) {
+    return static_cast<__mmask8>((1u << remaining) - 1u);
+}
+
+void avx512_raw_sums(const double* x, size_t n,
+                     double& sum, double& sum_sq, double& max_abs) {
+    __m512d vs = _mm512_setzero_pd();
+    __m512d vsq = _mm512_setzero_pd();
+    __m512d vmx = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d v = _mm512_loadu_pd(x + i);
+        vs = _mm512_add_pd(vs, v);
+        vsq = _mm512_fmadd_pd(v, v, vsq);
+        vmx = _mm512_max_pd(vmx, _mm512_abs_pd(v));
+    }
+    if (i < n) {
+        // Masked-off lanes load as zero, which is neutral for all three
+        __m512d v = _mm512_maskz_loadu_pd(tail_mask(n - i), x + i);
+        vs = _mm512_add_pd(vs, v);
+        vsq = _mm512_fmadd_pd(v, v, vsq);
+        vmx = _mm512_max_pd(vmx, _mm512_abs_pd(v));
+    }
+
+    sum = _mm512_reduce_add_pd(vs);
+    sum_sq = _mm512_reduce_add_pd(vsq);
+    max_abs = _mm512_reduce_max_pd(vmx);
+}
+
+void avx512_central_moments(const double* x, size_t n, double mean,
+                            double& m2, double& m3, double& m4) {
+    const __m512d vmean = _mm512_set1_pd(mean);
+    __m512d v2 = _mm512_setzero_pd();
+    __m512d v3 = _mm512_setzero_pd();
+    __m512d v4 = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d d = _mm512_sub_pd(_mm512_loadu_pd(x + i), vmean);
+        __m512d d2 = _mm512_mul_pd(d, d);
+        v2 = _mm512_add_pd(v2, d2);
+        v3 = _mm512_fmadd_pd(d2, d, v3);
+        v4 = _mm512_fmadd_pd(d2, d2, v4);
+    }
+    if (i < n) {
+        // Zero the deviation in masked-off lanes
+        const __mmask8 mask = tail_mask(n - i);
+        __m512d d = _mm512_maskz_sub_pd(mask, _mm512_maskz_loadu_pd(mask, x + i), vmean);
+        __m512d d2 = _mm512_mul_pd(d, d);
+        v2 = _mm512_add_pd(v2, d2);
+        v3 = _mm512_fmadd_pd(d2, d, v3);
+        v4 = _mm512_fmadd_pd(d2, d2, v4);
+    }
+
+    m2 = _mm512_reduce_add_pd(v2);
+    m3 = _mm512_reduce_add_pd(v3);
+    m4 = _mm512_reduce_add_pd(v4);
+}
+
+double avx512_sum_squares(const double* x, size_t n) {
+    __m512d a = _mm512_setzero_pd();
+    __m512d b = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512d v0 = _mm512_loadu_pd(x + i);
+        __m512d v1 = _mm512_loadu_pd(x + i + 8);
+        a = _mm512_fmadd_pd(v0, v0, a);
+        b = _mm512_fmadd_pd(v1, v1, b);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m512d v = _mm512_loadu_pd(x + i);
+        a = _mm512_fmadd_pd(v, v, a);
+    }
+    if (i < n) {
+        __m512d v = _mm512_maskz_loadu_pd(tail_mask(n - i), x + i);
+        b = _mm512_fmadd_pd(v, v, b);
+    }
+
+    return _mm512_reduce_add_pd(_mm512_add_pd(a, b));
+}
+
+double avx512_dot(const double* x, const double* y, size_t n) {
+    __m512d a = _mm512_setzero_pd();
+    __m512d b = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        a = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), a);
+        b = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), b);
+    }
+    for (; i + 8 <= n; i += 8) {
+        a = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), a);
+    }
+    if (i < n) {
+        const __mmask8 mask = tail_mask(n - i);
+        b = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i), b);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(a, b));
+}
+
+double avx512_max_abs(const double* x, size_t n) {
+    __m512d vmx = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        vmx = _mm512_max_pd(vmx, _mm512_abs_pd(_mm512_loadu_pd(x + i)));
+    }
+    if (i < n) {
+        __m512d v = _mm512_maskz_loadu_pd(tail_mask(n - i), x + i);
+        vmx = _mm512_max_pd(vmx, _mm512_abs_pd(v));
+    }
+
+    return _mm512_reduce_max_pd(vmx);
+}
+
+void avx512_magnitudes(const std::complex<double>* spectrum, size_t n,
+                       double scale, double* out) {
+    const double* x = reinterpret_cast<const double*>(spectrum);
+    const __m512d vscale = _mm512_set1_pd(scale);
+    const __m512i re_idx = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+    const __m512i im_idx = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // Deinterleave 8 complex values into real and imaginary vectors
+        __m512d a = _mm512_loadu_pd(x + 2 * i);
+        __m512d b = _mm512_loadu_pd(x + 2 * i + 8);
+        __m512d re = _mm512_permutex2var_pd(a, re_idx, b);
+        __m512d im = _mm512_permutex2var_pd(a, im_idx, b);
+        __m512d p = _mm512_fmadd_pd(re, re, _mm512_mul_pd(im, im));
+        _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_sqrt_pd(p), vscale));
+    }
+
+    for (; i < n; ++i) {
+        double re = spectrum[i].real();
+        double im = spectrum[i].imag();
+        out[i] = std::sqrt(re * re + im * im) * scale;
+    }
+}
+
+void avx512_power_moments(const double* mags, const double* freqs, size_t n,
+                          double& total, double& weighted) {
+    __m512d vt = _mm512_setzero_pd();
+    __m512d vw = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d m = _mm512_loadu_pd(mags + i);
+        __m512d p = _mm512_mul_pd(m, m);
+        vt = _mm512_add_pd(vt, p);
+        vw = _mm512_fmadd_pd(_mm512_loadu_pd(freqs + i), p, vw);
+    }
+    if (i < n) {
+        const __mmask8 mask = tail_mask(n - i);
+        __m512d m = _mm512_maskz_loadu_pd(mask, mags + i);
+        __m512d p = _mm512_mul_pd(m, m);
+        vt = _mm512_add_pd(vt, p);
+        vw = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, freqs + i), p, vw);
+    }
+
+    total = _mm512_reduce_add_pd(vt);
+    weighted = _mm512_reduce_add_pd(vw);
+}
+
+void avx512_power_spread(const double* mags, const double* freqs, size_t n,
+                         double centroid, double& total, double& weighted_var) {
+    const __m512d vc = _mm512_set1_pd(centroid);
+    __m512d vt = _mm512_setzero_pd();
+    __m512d vv = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d m = _mm512_loadu_pd(mags + i);
+        __m512d p = _mm512_mul_pd(m, m);
+        __m512d d = _mm512_sub_pd(_mm512_loadu_pd(freqs + i), vc);
+        vt = _mm512_add_pd(vt, p);
+        vv = _mm512_fmadd_pd(_mm512_mul_pd(d, d), p, vv);
+    }
+    if (i < n) {
+        // Masked-off magnitudes are zero, so their power contributes nothing
+        const __mmask8 mask = tail_mask(n - i);
+        __m512d m = _mm512_maskz_loadu_pd(mask, mags + i);
+        __m512d p = _mm512_mul_pd(m, m);
+        __m512d d = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, freqs + i), vc);
+        vt = _mm512_add_pd(vt, p);
+        vv = _mm512_fmadd_pd(_mm512_mul_pd(d, d), p, vv);
+    }
+
+    total = _mm512_reduce_add_pd(vt);
+    weighted_var = _mm512_reduce_add_pd(vv);
+}
+
+void avx512_widen_f32(const float* x, size_t n, double* out) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_cvtps_pd(_mm256_loadu_ps(x + i)));
+    }
+    for (; i < n; ++i) {
+        out[i] = static_cast<double>(x[i]);
+    }
+}
+
+void avx512_widen_i16(const int16_t* x, size_t n, double scale, double* out) {
+    const __m512d vscale = _mm512_set1_pd(scale);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // Sign-extend 8 counts to int32, then convert
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+        _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_cvtepi32_pd(v), vscale));
+    }
+    for (; i < n; ++i) {
+        out[i] = static_cast<double>(x[i]) * scale;
+    }
+}
+
+void avx512_narrow_f16(const double* x, size_t n, double scale, uint16_t* out) {
+    const __m512d vscale = _mm512_set1_pd(scale);
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 lo = _mm512_cvtpd_ps(_mm512_mul_pd(_mm512_loadu_pd(x + i), vscale));
+        __m256 hi = _mm512_cvtpd_ps(_mm512_mul_pd(_mm512_loadu_pd(x + i + 8), vscale));
+        __m512 v = _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(lo)),
+                                                       _mm256_castps_pd(hi), 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                            _mm512_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+    for (; i < n; ++i) {
+        out[i] = half_from_float(static_cast<float>(x[i] * scale));
+    }
+}
+
+void avx512_widen_f16(const uint16_t* x, size_t n, double scale, double* out) {
+    const __m512d vscale = _mm512_set1_pd(scale);
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)));
+        _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(v)), vscale));
+        _mm512_storeu_pd(out + i + 8, _mm512_mul_pd(
+            _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1))), vscale));
+    }
+    for (; i < n; ++i) {
+        out[i] = static_cast<double>(float_from_half(x[i])) * scale;
+    }
+}
+
+const Kernels AVX512_KERNELS = {
+    Isa::AVX512,
+    avx512_raw_sums,
+    avx512_central_moments,
+    avx512_sum_squares,
+    avx512_dot,
+    avx512_max_abs,
+    avx512_magnitudes,
+    avx512_power_moments,
+    avx512_power_spread,
+    avx512_widen_f32,
+    avx512_widen_i16,
+    avx512_narrow_f16,
+    avx512_widen_f16,
+};
+
+} // namespace
+
+const Kernels& avx512_kernels() {
+    return AVX512_KERNELS;
+}
+
+} // namespace simd
+} // namespace cpm
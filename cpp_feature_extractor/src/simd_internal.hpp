@@ -0,0 +1,64 @@
+#pragma once
+
+#include "simd_kernels.hpp"
+#include <bit>
+#include <cstdint>
+
+// Per-ISA kernel tables. Each lives in its own translation unit compiled
+// with the matching target flags and is only referenced when CMake enabled it.
+
+namespace cpm {
+namespace simd {
+
+// float to IEEE binary16 bits, round to nearest even; the same result as
+// F16C and NEON conversions for finite values, used for vector tails
+inline uint16_t half_from_float(float value) {
+    constexpr uint32_t F16_OVERFLOW = (127 + 16) << 23;                 // 65536.0f
+    constexpr uint32_t SUBNORMAL_MAGIC = ((127 - 15) + (23 - 10) + 1) << 23;
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+    uint32_t half;
+    if (bits >= F16_OVERFLOW) {
+        half = bits > 0x7F800000u ? 0x7E00u : 0x7C00u;  // NaN or infinity
+    } else if (bits < (113u << 23)) {
+        // Below 2^-14: the addition aligns the value so float rounding does the work
+        const float aligned = std::bit_cast<float>(bits) + std::bit_cast<float>(SUBNORMAL_MAGIC);
+        half = std::bit_cast<uint32_t>(aligned) - SUBNORMAL_MAGIC;
+    } else {
+        const uint32_t odd = (bits >> 13) & 1u;
+        bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFFu + odd;
+        half = bits >> 13;
+    }
+    return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+// IEEE binary16 bits to float (exact)
+inline float float_from_half(uint16_t half) {
+    constexpr uint32_t EXPONENT = 0x7C00u << 13;
+    uint32_t bits = static_cast<uint32_t>(half & 0x7FFFu) << 13;
+    const uint32_t exponent = bits & EXPONENT;
+    bits += (127 - 15) << 23;
+    if (exponent == EXPONENT) {
+        bits += (128 - 16) << 23;  // Infinity or NaN
+    } else if (exponent == 0) {
+        bits += 1u << 23;  // Subnormal: renormalise
+        bits = std::bit_cast<uint32_t>(std::bit_cast<float>(bits) - std::bit_cast<float>(113u << 23));
+    }
+    return std::bit_cast<float>(bits | (static_cast<uint32_t>(half & 0x8000u) << 16));
+}
+
+#if defined(CPM_HAVE_AVX2)
+const Kernels& avx2_kernels();
+#endif
+
+#if defined(CPM_HAVE_AVX512)
+const Kernels& avx512_kernels();
+#endif
+
+#if defined(CPM_HAVE_NEON)
+const Kernels& neon_kernels();
+#endif
+
+} // namespace simd
+} // namespace cpm
@@ -0,0 +1,241 @@
+#include "simd_kernels.hpp"
+#include "simd_internal.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace cpm {
+namespace simd {
+
+namespace {
+
+void scalar_raw_sums(const double* x, size_t n,
+                     double& sum, double& sum_sq, double& max_abs) {
+    double s = 0.0, sq = 0.0, mx = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        s += x[i];
+        sq += x[i] * x[i];
+        mx = std::max(mx, std::abs(x[i]));
+    }
+    sum = s;
+    sum_sq = sq;
+    max_abs = mx;
+}
+
+void scalar_central_moments(const double* x, size_t n, double mean,
+                            double& m2, double& m3, double& m4) {
+    double s2 = 0.0, s3 = 0.0, s4 = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double diff = x[i] - mean;
+        double diff2 = diff * diff;
+        s2 += diff2;
+        s3 += diff2 * diff;
+        s4 += diff2 * diff2;
+    }
+    m2 = s2;
+    m3 = s3;
+    m4 = s4;
+}
+
+double scalar_sum_squares(const double* x, size_t n) {
+    double sq = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sq += x[i] * x[i];
+    }
+    return sq;
+}
+
+double scalar_dot(const double* a, const double* b, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+double scalar_max_abs(const double* x, size_t n) {
+    double mx = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        mx = std::max(mx, std::abs(x[i]));
+    }
+    return mx;
+}
+
+void scalar_magnitudes(const std::complex<double>* spectrum, size_t n,
+                       double scale, double* out) {
+    for (size_t i = 0; i < n; ++i) {
+        double re = spectrum[i].real();
+        double im = spectrum[i].imag();
+        out[i] = std::sqrt(re * re + im * im) * scale;
+    }
+}
+
+void scalar_power_moments(const double* mags, const double* freqs, size_t n,
+                          double& total, double& weighted) {
+    double t = 0.0, w = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double power = mags[i] * mags[i];
+        t += power;
+        w += freqs[i] * power;
+    }
+    total = t;
+    weighted = w;
+}
+
+void scalar_power_spread(const double* mags, const double* freqs, size_t n,
+                         double centroid, double& total, double& weighted_var) {
+    double t = 0.0, v = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double power = mags[i] * mags[i];
+        double diff = freqs[i] - centroid;
+        t += power;
+        v += diff * diff * power;
+    }
+    total = t;
+    weighted_var = v;
+}
+
+void scalar_widen_f32(const float* x, size_t n, double* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<double>(x[i]);
+    }
+}
+
+void scalar_widen_i16(const int16_t* x, size_t n, double scale, double* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<double>(x[i]) * scale;
+    }
+}
+
+void scalar_narrow_f16(const double* x, size_t n, double scale, uint16_t* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = half_from_float(static_cast<float>(x[i] * scale));
+    }
+}
+
+void scalar_widen_f16(const uint16_t* x, size_t n, double scale, double* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<double>(float_from_half(x[i])) * scale;
+    }
+}
+
+const Kernels SCALAR_KERNELS = {
+    Isa::Scalar,
+    scalar_raw_sums,
+    scalar_central_moments,
+    scalar_sum_squares,
+    scalar_dot,
+    scalar_max_abs,
+    scalar_magnitudes,
+    scalar_power_moments,
+    scalar_power_spread,
+    scalar_widen_f32,
+    scalar_widen_i16,
+    scalar_narrow_f16,
+    scalar_widen_f16,
+};
+
+bool cpu_supports(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+#if defined(CPM_HAVE_AVX2)
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+                   __builtin_cpu_supports("f16c");
+#endif
+#if defined(CPM_HAVE_AVX512)
+        case Isa::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+#if defined(CPM_HAVE_NEON)
+        case Isa::NEON:
+            return true;  // Baseline on AArch64
+#endif
+        default:
+            return false;
+    }
+}
+
+const Kernels* detect() {
+    if (const char* env = std::getenv("CPM_SIMD")) {
+        for (Isa isa : {Isa::Scalar, Isa::AVX2, Isa::AVX512, Isa::NEON}) {
+            if (std::strcmp(env, isa_name(isa)) == 0) {
+                if (const Kernels* k = kernels_for(isa)) {
+                    return k;
+                }
+            }
+        }
+    }
+
+    for (Isa isa : {Isa::AVX512, Isa::AVX2, Isa::NEON}) {
+        if (const Kernels* k = kernels_for(isa)) {
+            return k;
+        }
+    }
+    return &SCALAR_KERNELS;
+}
+
+std::atomic<const Kernels*>& active_ptr() {
+    static std::atomic<const Kernels*> ptr{detect()};
+    return ptr;
+}
+
+} // namespace
+
+const Kernels& scalar() {
+    return SCALAR_KERNELS;
+}
+
+const Kernels* kernels_for(Isa isa) {
+    if (!cpu_supports(isa)) {
+        return nullptr;
+    }
+
+    switch (isa) {
+        case Isa::Scalar:
+            return &SCALAR_KERNELS;
+#if defined(CPM_HAVE_AVX2)
+        case Isa::AVX2:
+            return &avx2_kernels();
+#endif
+#if defined(CPM_HAVE_AVX512)
+        case Isa::AVX512:
+            return &avx512_kernels();
+#endif
+#if defined(CPM_HAVE_NEON)
+        case Isa::NEON:
+            return &neon_kernels();
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+const Kernels& active() {
+    return *active_ptr().load(std::memory_order_relaxed);
+}
+
+bool set_active(Isa isa) {
+    const Kernels* k = kernels_for(isa);
+    if (!k) {
+        return false;
+    }
+    active_ptr().store(k, std::memory_order_relaxed);
+    return true;
+}
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::AVX2: return "avx2";
+        case Isa::AVX512: return "avx512";
+        case Isa::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+} // namespace simd
+} // namespace cpm
@@ -0,0 +1,266 @@
+// AArch64 Advanced SIMD kernels (NEON is part of the baseline ISA).
+#include "simd_internal.hpp"
+#include <arm_neon.h>
+#include <algorithm>
+#include <cmath>
+
+namespace cpm {
+namespace simd {
+
+namespace {
+
+void neon_raw_sums(const double* x, size_t n,
+                   double& sum, double& sum_sq, double& max_abs) {
+    float64x2_t vs = vdupq_n_f64(0.0);
+    float64x2_t vsq = vdupq_n_f64(0.0);
+    float64x2_t vmx = vdupq_n_f64(0.0);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t v = vld1q_f64(x + i);
+        vs = vaddq_f64(vs, v);
+        vsq = vfmaq_f64(vsq, v, v);
+        vmx = vmaxq_f64(vmx, vabsq_f64(v));
+    }
+
+    double s = vaddvq_f64(vs), sq = vaddvq_f64(vsq), mx = vmaxvq_f64(vmx);
+    for (; i < n; ++i) {
+        s += x[i];
+        sq += x[i] * x[i];
+        mx = std::max(mx, std::abs(x[i]));
+    }
+    sum = s;
+    sum_sq = sq;
+    max_abs = mx;
+}
+
+void neon_central_moments(const double* x, size_t n, double mean,
+                          double& m2, double& m3, double& m4) {
+    const float64x2_t vmean = vdupq_n_f64(mean);
+    float64x2_t v2 = vdupq_n_f64(0.0);
+    float64x2_t v3 = vdupq_n_f64(0.0);
+    float64x2_t v4 = vdupq_n_f64(0.0);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t d = vsubq_f64(vld1q_f64(x + i), vmean);
+        float64x2_t d2 = vmulq_f64(d, d);
+        v2 = vaddq_f64(v2, d2);
+        v3 = vfmaq_f64(v3, d2, d);
+        v4 = vfmaq_f64(v4, d2, d2);
+    }
+
+    double s2 = vaddvq_f64(v2), s3 = vaddvq_f64(v3), s4 = vaddvq_f64(v4);
+    for (; i < n; ++i) {
+        double diff = x[i] - mean;
+        double diff2 = diff * diff;
+        s2 += diff2;
+        s3 += diff2 * diff;
+        s4 += diff2 * diff2;
+    }
+    m2 = s2;
+    m3 = s3;
+    m4 = s4;
+}
+
+double neon_sum_squares(const double* x, size_t n) {
+    float64x2_t a = vdupq_n_f64(0.0);
+    float64x2_t b = vdupq_n_f64(0.0);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float64x2_t v0 = vld1q_f64(x + i);
+        float64x2_t v1 = vld1q_f64(x + i + 2);
+        a = vfmaq_f64(a, v0, v0);
+        b = vfmaq_f64(b, v1, v1);
+    }
+
+    double sq = vaddvq_f64(vaddq_f64(a, b));
+    for (; i < n; ++i) {
+        sq += x[i] * x[i];
+    }
+    return sq;
+}
+
+double neon_dot(const double* x, const double* y, size_t n) {
+    float64x2_t a = vdupq_n_f64(0.0);
+    float64x2_t b = vdupq_n_f64(0.0);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        a = vfmaq_f64(a, vld1q_f64(x + i), vld1q_f64(y + i));
+        b = vfmaq_f64(b, vld1q_f64(x + i + 2), vld1q_f64(y + i + 2));
+    }
+
+    double sum = vaddvq_f64(vaddq_f64(a, b));
+    for (; i < n; ++i) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+double neon_max_abs(const double* x, size_t n) {
+    float64x2_t vmx = vdupq_n_f64(0.0);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        vmx = vmaxq_f64(vmx, vabsq_f64(vld1q_f64(x + i)));
+    }
+
+    double mx = vmaxvq_f64(vmx);
+    for (; i < n; ++i) {
+        mx = std::max(mx, std::abs(x[i]));
+    }
+    return mx;
+}
+
+void neon_magnitudes(const std::complex<double>* spectrum, size_t n,
+                     double scale, double* out) {
+    const double* x = reinterpret_cast<const double*>(spectrum);
+    const float64x2_t vscale = vdupq_n_f64(scale);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        // vld2 deinterleaves two complex values into re and im lanes
+        float64x2x2_t c = vld2q_f64(x + 2 * i);
+        float64x2_t p = vfmaq_f64(vmulq_f64(c.val[1], c.val[1]), c.val[0], c.val[0]);
+        vst1q_f64(out + i, vmulq_f64(vsqrtq_f64(p), vscale));
+    }
+
+    for (; i < n; ++i) {
+        double re = spectrum[i].real();
+        double im = spectrum[i].imag();
+        out[i] = std::sqrt(re * re + im * im) * scale;
+    }
+}
+
+void neon_power_moments(const double* mags, const double* freqs, size_t n,
+                        double& total, double& weighted) {
+    float64x2_t vt = vdupq_n_f64(0.0);
+    float64x2_t vw = vdupq_n_f64(0.0);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t m = vld1q_f64(mags + i);
+        float64x2_t p = vmulq_f64(m, m);
+        vt = vaddq_f64(vt, p);
+        vw = vfmaq_f64(vw, vld1q_f64(freqs + i), p);
+    }
+
+    double t = vaddvq_f64(vt), w = vaddvq_f64(vw);
+    for (; i < n; ++i) {
+        double power = mags[i] * mags[i];
+        t += power;
+        w += freqs[i] * power;
+    }
+    total = t;
+    weighted = w;
+}
+
+void neon_power_spread(const double* mags, const double* freqs, size_t n,
+                       double centroid, double& total, double& weighted_var) {
+    const float64x2_t vc = vdupq_n_f64(centroid);
+    float64x2_t vt = vdupq_n_f64(0.0);
+    float64x2_t vv = vdupq_n_f64(0.0);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t m = vld1q_f64(mags + i);
+        float64x2_t p = vmulq_f64(m, m);
+        float64x2_t d = vsubq_f64(vld1q_f64(freqs + i), vc);
+        vt = vaddq_f64(vt, p);
+        vv = vfmaq_f64(vv, vmulq_f64(d, d), p);
+    }
+
+    double t = vaddvq_f64(vt), v = vaddvq_f64(vv);
+    for (; i < n; ++i) {
+        double power = mags[i] * mags[i];
+        double diff = freqs[i] - centroid;
+        t += power;
+        v += diff * diff * power;
+    }
+    total = t;
+    weighted_var = v;
+}
+
+void neon_widen_f32(const float* x, size_t n, double* out) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(x + i);
+        vst1q_f64(out + i, vcvt_f64_f32(vget_low_f32(v)));
+        vst1q_f64(out + i + 2, vcvt_high_f64_f32(v));
+    }
+    for (; i < n; ++i) {
+        out[i] = static_cast<double>(x[i]);
+    }
+}
+
+void neon_widen_i16(const int16_t* x, size_t n, double scale, double* out) {
+    const float64x2_t vscale = vdupq_n_f64(scale);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // int16 -> int32 -> int64 -> double; every count is exact in double
+        int32x4_t v = vmovl_s16(vld1_s16(x + i));
+        float64x2_t lo = vcvtq_f64_s64(vmovl_s32(vget_low_s32(v)));
+        float64x2_t hi = vcvtq_f64_s64(vmovl_high_s32(v));
+        vst1q_f64(out + i, vmulq_f64(lo, vscale));
+        vst1q_f64(out + i + 2, vmulq_f64(hi, vscale));
+    }
+    for (; i < n; ++i) {
+        out[i] = static_cast<double>(x[i]) * scale;
+    }
+}
+
+void neon_narrow_f16(const double* x, size_t n, double scale, uint16_t* out) {
+    const float64x2_t vscale = vdupq_n_f64(scale);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x2_t lo = vcvt_f32_f64(vmulq_f64(vld1q_f64(x + i), vscale));
+        float32x4_t v = vcvt_high_f32_f64(lo, vmulq_f64(vld1q_f64(x + i + 2), vscale));
+        vst1_u16(out + i, vreinterpret_u16_f16(vcvt_f16_f32(v)));
+    }
+    for (; i < n; ++i) {
+        out[i] = half_from_float(static_cast<float>(x[i] * scale));
+    }
+}
+
+void neon_widen_f16(const uint16_t* x, size_t n, double scale, double* out) {
+    const float64x2_t vscale = vdupq_n_f64(scale);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(x + i)));
+        vst1q_f64(out + i, vmulq_f64(vcvt_f64_f32(vget_low_f32(v)), vscale));
+        vst1q_f64(out + i + 2, vmulq_f64(vcvt_high_f64_f32(v), vscale));
+    }
+    for (; i < n; ++i) {
+        out[i] = static_cast<double>(float_from_half(x[i])) * scale;
+    }
+}
+
+const Kernels NEON_KERNELS = {
+    Isa::NEON,
+    neon_raw_sums,
+    neon_central_moments,
+    neon_sum_squares,
+    neon_dot,
+    neon_max_abs,
+    neon_magnitudes,
+    neon_power_moments,
+    neon_power_spread,
+    neon_widen_f32,
+    neon_widen_i16,
+    neon_narrow_f16,
+    neon_widen_f16,
+};
+
+} // namespace
+
+const Kernels& neon_kernels() {
+    return NEON_KERNELS;
+}
+
+} // namespace simd
+} // namespace cpm
@@ -0,0 +1,214 @@
+#include "spectrum_reduction.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace cpm {
+
+namespace {
+
+void keep_all(std::span<const double> f, std::span<const double> m, ReducedSpectrum& out) {
+    out.frequencies.assign(f.begin(), f.end());
+    out.magnitudes.assign(m.begin(), m.end());
+}
+
+void min_max(std::span<const double> f, std::span<const double> m, size_t points, ReducedSpectrum& out) {
+    const size_t n = m.size();
+    if (points == 1) {
+        // No room for a pair: keep the largest bin
+        const size_t top = static_cast<size_t>(std::max_element(m.begin(), m.end()) - m.begin());
+        out.frequencies.push_back(f[top]);
+        out.magnitudes.push_back(m[top]);
+        return;
+    }
+    const size_t buckets = std::max<size_t>(1, points / 2);
+    out.frequencies.reserve(2 * buckets);
+    out.magnitudes.reserve(2 * buckets);
+    for (size_t b = 0; b < buckets; ++b) {
+        const size_t begin = b * n / buckets;
+        const size_t end = (b + 1) * n / buckets;
+        if (begin == end) {
+            continue;
+        }
+        auto [lo, hi] = std::minmax_element(m.begin() + static_cast<std::ptrdiff_t>(begin),
+                                            m.begin() + static_cast<std::ptrdiff_t>(end));
+        size_t first = static_cast<size_t>(lo - m.begin());
+        size_t second = static_cast<size_t>(hi - m.begin());
+        if (first > second) {
+            std::swap(first, second);
+        }
+        out.frequencies.push_back(f[first]);
+        out.magnitudes.push_back(m[first]);
+        if (second != first) {
+            out.frequencies.push_back(f[second]);
+            out.magnitudes.push_back(m[second]);
+        }
+    }
+}
+
+void lttb(std::span<const double> f, std::span<const double> m, size_t points, ReducedSpectrum& out) {
+    const size_t n = m.size();
+    out.frequencies.reserve(points);
+    out.magnitudes.reserve(points);
+    auto emit = [&](size_t i) {
+        out.frequencies.push_back(f[i]);
+        out.magnitudes.push_back(m[i]);
+    };
+
+    // Interior bins [1, n - 1) split into points - 2 buckets
+    const double bucket = static_cast<double>(n - 2) / static_cast<double>(points - 2);
+    auto edge = [&](size_t b) {
+        return std::min(n - 1, static_cast<size_t>(static_cast<double>(b) * bucket) + 1);
+    };
+
+    size_t anchor = 0;
+    emit(anchor);
+    for (size_t b = 0; b + 2 < points; ++b) {
+        const size_t begin = edge(b);
+        const size_t end = std::max(begin + 1, edge(b + 1));
+
+        // Third vertex: mean of the next bucket, or the last bin
+        double next_f = f[n - 1];
+        double next_m = m[n - 1];
+        const size_t next_begin = end;
+        const size_t next_end = b + 3 < points ? std::max(next_begin + 1, edge(b + 2)) : n;
+        if (b + 3 < points && next_begin < n - 1) {
+            next_f = 0.0;
+            next_m = 0.0;
+            const size_t stop = std::min(next_end, n - 1);
+            for (size_t i = next_begin; i < stop; ++i) {
+                next_f += f[i];
+                next_m += m[i];
+            }
+            next_f /= static_cast<double>(stop - next_begin);
+            next_m /= static_cast<double>(stop - next_begin);
+        }
+
+        const double af = f[anchor];
+        const double am = m[anchor];
+        size_t best = begin;
+        double best_area = -1.0;
+        for (size_t i = begin; i < std::min(end, n - 1); ++i) {
+            const double area = std::abs((af - next_f) * (m[i] - am) - (af - f[i]) * (next_m - am));
+            if (area > best_area) {
+                best_area = area;
+                best = i;
+            }
+        }
+        emit(best);
+        anchor = best;
+    }
+    emit(n - 1);
+}
+
+void log_resample(std::span<const double> f, std::span<const double> m, const SpectrumReductionConfig& config,
+                  ReducedSpectrum& out) {
+    const size_t n = m.size();
+    const double f_lo = config.min_frequency > 0.0 ? config.min_frequency : f[1];
+    const double f_hi = f[n - 1];
+    if (!(f_lo > 0.0) || f_lo >= f_hi) {
+        keep_all(f, m, out);
+        return;
+    }
+
+    const size_t points = config.points;
+    const double ratio = std::log(f_hi / f_lo) / static_cast<double>(points);
+    out.frequencies.resize(points);
+    out.magnitudes.resize(points);
+
+    // Bins and buckets both ascend, so one pass assigns every bin
+    size_t i = static_cast<size_t>(std::lower_bound(f.begin(), f.end(), f_lo) - f.begin());
+    for (size_t k = 0; k < points; ++k) {
+        const double lo = f_lo * std::exp(ratio * static_cast<double>(k));
+        const double hi = k + 1 == points ? f_hi : f_lo * std::exp(ratio * static_cast<double>(k + 1));
+        const double center = std::sqrt(lo * hi);
+        out.frequencies[k] = center;
+
+        double peak = -1.0;
+        for (; i < n && (f[i] < hi || (k + 1 == points && f[i] <= hi)); ++i) {
+            peak = std::max(peak, m[i]);
+        }
+        if (peak >= 0.0) {
+            out.magnitudes[k] = peak;
+            continue;
+        }
+        // Bucket narrower than the bin spacing: interpolate at its center
+        const size_t right = std::min(n - 1, static_cast<size_t>(
+            std::upper_bound(f.begin(), f.end(), center) - f.begin()));
+        const size_t left = right > 0 ? right - 1 : 0;
+        const double span = f[right] - f[left];
+        const double t = span > 0.0 ? (center - f[left]) / span : 0.0;
+        out.magnitudes[k] = m[left] + t * (m[right] - m[left]);
+    }
+}
+
+} // namespace
+
+Decimation parse_decimation(const std::string& name) {
+    if (name == "minmax") {
+        return Decimation::MinMax;
+    }
+    if (name == "lttb") {
+        return Decimation::LTTB;
+    }
+    throw std::invalid_argument("Unknown decimation method: " + name + " (expected minmax or lttb)");
+}
+
+std::vector<SpectralPeak> find_peaks(std::span<const double> frequencies, std::span<const double> magnitudes,
+                                     size_t num_peaks) {
+    std::vector<SpectralPeak> peaks;
+    if (num_peaks == 0 || magnitudes.size() < 3) {
+        return peaks;
+    }
+    for (size_t i = 1; i + 1 < magnitudes.size(); ++i) {
+        if (magnitudes[i] > magnitudes[i - 1] && magnitudes[i] >= magnitudes[i + 1]) {
+            peaks.push_back({i, frequencies[i], magnitudes[i]});
+        }
+    }
+    const size_t keep = std::min(num_peaks, peaks.size());
+    std::partial_sort(peaks.begin(), peaks.begin() + static_cast<std::ptrdiff_t>(keep), peaks.end(),
+                      [](const SpectralPeak& a, const SpectralPeak& b) { return a.magnitude > b.magnitude; });
+    peaks.resize(keep);
+    return peaks;
+}
+
+ReducedSpectrum reduce_spectrum(std::span<const double> frequencies, std::span<const double> magnitudes,
+                                const SpectrumReductionConfig& config) {
+    if (frequencies.size() != magnitudes.size()) {
+        throw std::invalid_argument("Frequencies and magnitudes must have the same length");
+    }
+    ReducedSpectrum out;
+    const size_t n = magnitudes.size();
+    out.num_bins = n;
+    if (n == 0) {
+        return out;
+    }
+
+    out.total_power = simd::active().sum_squares(magnitudes.data(), n);
+    if (n > 1) {
+        // First largest bin above DC, as numpy's argmax
+        const auto top = std::max_element(magnitudes.begin() + 1, magnitudes.end());
+        const size_t bin = static_cast<size_t>(top - magnitudes.begin());
+        out.dominant_frequency = frequencies[bin];
+        out.dominant_magnitude = *top;
+    }
+    out.peaks = find_peaks(frequencies, magnitudes, config.num_peaks);
+
+    if (config.points == 0 || (n <= config.points && !config.log_frequency) || n < 3) {
+        keep_all(frequencies, magnitudes, out);
+    } else if (config.log_frequency) {
+        log_resample(frequencies, magnitudes, config, out);
+    } else if (config.method == Decimation::LTTB && config.points >= 3) {
+        lttb(frequencies, magnitudes, config.points, out);
+    } else {
+        min_max(frequencies, magnitudes, config.points, out);
+    }
+    return out;
+}
+
+ReducedSpectrum reduce_spectrum(const SignalFeatures& features, const SpectrumReductionConfig& config) {
+    return reduce_spectrum(features.fft_frequencies, features.fft_magnitude, config);
+}
+
+} // namespace cpm
@@ -0,0 +1,197 @@
+#include "stats.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#define CPM_STATS_TSC 1
+#else
+#define CPM_STATS_TSC 0
+#endif
+
+namespace cpm::stats {
+
+namespace {
+
+constexpr size_t FIELDS = 3;  // calls, ticks, bytes
+
+// Plain totals, used for retired threads and the reset baseline
+struct Totals {
+    std::array<std::array<uint64_t, FIELDS>, NUM_STAGES> stages{};
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+// Counters of one thread. Only the owning thread writes them, so updates
+// are a relaxed load and store rather than a read-modify-write; other
+// threads only read. Cache-line aligned so neighbours do not false-share.
+struct alignas(64) ThreadCounters {
+    std::array<std::array<std::atomic<uint64_t>, FIELDS>, NUM_STAGES> stages{};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+
+    void add_to(Totals& totals) const {
+        for (size_t s = 0; s < NUM_STAGES; ++s) {
+            for (size_t f = 0; f < FIELDS; ++f) {
+                totals.stages[s][f] += stages[s][f].load(std::memory_order_relaxed);
+            }
+        }
+        totals.hits += hits.load(std::memory_order_relaxed);
+        totals.misses += misses.load(std::memory_order_relaxed);
+    }
+};
+
+void bump(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// The lock is only taken when a thread starts or stops recording and by
+// snapshot()/reset(), never on the recording path itself
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadCounters*> live;
+    Totals retired;   // Threads that have exited
+    Totals baseline;  // Totals at the last reset()
+
+    // Reference point for converting time-stamp counter ticks to ns
+    uint64_t origin_ticks = ticks();
+    uint64_t origin_ns = steady_ns();
+};
+
+// Never destroyed: worker threads of static pools may exit after other
+// statics are gone
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+// Registers this thread's counters on first use and folds them into the
+// retired totals when the thread exits
+struct ThreadSlot {
+    ThreadCounters counters;
+
+    ThreadSlot() {
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(&counters);
+    }
+
+    ~ThreadSlot() {
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        counters.add_to(r.retired);
+        std::erase(r.live, &counters);
+    }
+};
+
+ThreadCounters& local() {
+    thread_local ThreadSlot slot;
+    return slot.counters;
+}
+
+Totals totals(Registry& r) {
+    Totals t = r.retired;
+    for (const ThreadCounters* c : r.live) {
+        c->add_to(t);
+    }
+    return t;
+}
+
+// Nanoseconds per tick, from the ticks and steady-clock time elapsed since
+// the registry was created; both are read once, so a snapshot never waits
+double ns_per_tick(const Registry& r) {
+    if (!CPM_STATS_TSC) {
+        return 1.0;
+    }
+    const uint64_t ns = steady_ns();
+    const uint64_t elapsed_ticks = ticks() - r.origin_ticks;
+    return elapsed_ticks ? static_cast<double>(ns - r.origin_ns) / static_cast<double>(elapsed_ticks) : 0.0;
+}
+
+} // namespace
+
+const char* stage_name(Stage stage) {
+    switch (stage) {
+        case Stage::Extract: return "extract";
+        case Stage::Batch: return "batch";
+        case Stage::TimeStats: return "time_stats";
+        case Stage::Widen: return "widen";
+        case Stage::FFT: return "fft";
+        case Stage::Magnitudes: return "magnitudes";
+        case Stage::SpectralShape: return "spectral_shape";
+        case Stage::Bandpower: return "bandpower";
+        case Stage::Envelope: return "envelope";
+        case Stage::Resample: return "resample";
+        case Stage::Kurtogram: return "kurtogram";
+        case Stage::PythonInput: return "python_input";
+        case Stage::Count: break;
+    }
+    return "unknown";
+}
+
+Snapshot snapshot() {
+    if (!enabled()) {
+        return {};  // Nothing is ever recorded
+    }
+    auto& r = registry();
+    Totals t;
+    Totals base;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        t = totals(r);
+        base = r.baseline;
+    }
+    const double scale = ns_per_tick(r);
+
+    Snapshot out;
+    for (size_t s = 0; s < NUM_STAGES; ++s) {
+        const auto& v = t.stages[s];
+        const auto& b = base.stages[s];
+        const uint64_t elapsed = v[1] - b[1];
+        out.stages[s].calls = v[0] - b[0];
+        out.stages[s].nanoseconds = static_cast<uint64_t>(static_cast<double>(elapsed) * scale);
+        out.stages[s].cycles = CPM_STATS_TSC ? elapsed : 0;
+        out.stages[s].bytes = v[2] - b[2];
+    }
+    out.plan_cache_hits = t.hits - base.hits;
+    out.plan_cache_misses = t.misses - base.misses;
+    return out;
+}
+
+void reset() {
+    // Writers own their counters, so reset moves the baseline instead of
+    // zeroing them
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.baseline = totals(r);
+}
+
+uint64_t ticks() {
+#if CPM_STATS_TSC
+    return __rdtsc();
+#else
+    return steady_ns();
+#endif
+}
+
+void record(Stage stage, uint64_t start_ticks, uint64_t bytes) {
+    const uint64_t elapsed = ticks() - start_ticks;
+    auto& fields = local().stages[static_cast<size_t>(stage)];
+    bump(fields[0], 1);
+    bump(fields[1], elapsed);
+    bump(fields[2], bytes);
+}
+
+void record_plan_lookup(bool hit) {
+    auto& c = local();
+    bump(hit ? c.hits : c.misses, 1);
+}
+
+} // namespace cpm::stats
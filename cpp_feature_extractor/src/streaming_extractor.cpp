@@ -0,0 +1,183 @@
+#include "streaming_extractor.hpp"
+#include "simd_kernels.hpp"
+
+namespace cpm {
+
+namespace {
+
+size_t log2_floor(size_t n) {
+    size_t bits = 0;
+    while (n > 1) {
+        n >>= 1;
+        ++bits;
+    }
+    return bits;
+}
+
+} // namespace
+
+StreamingFeatureExtractor::StreamingFeatureExtractor(
+    double sample_rate, size_t window_size, size_t hop_size, SpectrumUpdate update)
+    : extractor_(sample_rate), window_size_(window_size), hop_size_(hop_size) {
+
+    if (window_size == 0) {
+        throw std::invalid_argument("Window size must be positive");
+    }
+    if (hop_size == 0 || hop_size > window_size || window_size % hop_size != 0) {
+        throw std::invalid_argument("Hop size must divide the window size");
+    }
+
+    // Sliding DFT costs hop * N/2 complex updates per hop against roughly
+    // N/4 * (log2 N + 1) for the FFT, so it only wins for very small hops
+    switch (update) {
+        case SpectrumUpdate::FFT:
+            sliding_dft_ = false;
+            break;
+        case SpectrumUpdate::SlidingDFT:
+            sliding_dft_ = true;
+            break;
+        case SpectrumUpdate::Auto:
+            sliding_dft_ = 2 * hop_size < log2_floor(window_size) + 1;
+            break;
+    }
+
+    // Exact-length plan, so the sliding recurrence and the FFT agree
+    const size_t n = window_size;
+    plan_ = FFTPlan::get(n);
+    const size_t half_n = plan_->num_bins();
+
+    bins_.assign(half_n, {0.0, 0.0});
+    if (sliding_dft_) {
+        rotations_.resize(half_n);
+        for (size_t k = 0; k < half_n; ++k) {
+            double angle = 2.0 * PI * static_cast<double>(k) / static_cast<double>(n);
+            rotations_[k] = std::complex<double>(std::cos(angle), std::sin(angle));
+        }
+    }
+
+    buffer_.assign(2 * window_size, 0.0);
+    blocks_.resize(window_size / hop_size);
+
+    features_.fft_magnitude.resize(half_n);
+    features_.fft_frequencies.resize(half_n);
+    double freq_resolution = sample_rate / static_cast<double>(n);
+    for (size_t i = 0; i < half_n; ++i) {
+        features_.fft_frequencies[i] = static_cast<double>(i) * freq_resolution;
+    }
+    layout_ = extractor_.band_layout(n, half_n);
+    features_.bandpowers.resize(layout_->size());
+    features_.band_names = extractor_.get_bands().names();
+}
+
+void StreamingFeatureExtractor::reset() {
+    std::fill(buffer_.begin(), buffer_.end(), 0.0);
+    std::fill(bins_.begin(), bins_.end(), std::complex<double>(0.0, 0.0));
+    std::fill(blocks_.begin(), blocks_.end(), BlockStats{});
+    write_pos_ = 0;
+    samples_seen_ = 0;
+    samples_in_hop_ = 0;
+    next_block_ = 0;
+    samples_since_resync_ = 0;
+}
+
+void StreamingFeatureExtractor::push_sample(double x) {
+    const double oldest = buffer_[write_pos_];
+    buffer_[write_pos_] = x;
+    buffer_[write_pos_ + window_size_] = x;
+    write_pos_ = (write_pos_ + 1) % window_size_;
+
+    ++samples_seen_;
+    ++samples_in_hop_;
+
+    if (sliding_dft_) {
+        // X_k <- (X_k - x_oldest + x_new) * e^{+2 pi i k / N}
+        const double delta = x - oldest;
+        for (size_t k = 0; k < bins_.size(); ++k) {
+            bins_[k] = (bins_[k] + delta) * rotations_[k];
+        }
+
+        // Rounding error accumulates in the recurrence; recompute exactly
+        // once per window turnover
+        if (++samples_since_resync_ >= window_size_ && samples_seen_ >= window_size_) {
+            plan_->forward_real({buffer_.data() + write_pos_, window_size_}, bins_);
+            samples_since_resync_ = 0;
+        }
+    }
+}
+
+void StreamingFeatureExtractor::close_block() {
+    // The newest hop_size_ samples end just before write_pos_ + window_size_
+    std::span<const double> block(buffer_.data() + write_pos_ + window_size_ - hop_size_, hop_size_);
+
+    BlockStats& stats = blocks_[next_block_];
+    stats.moments = MomentAccumulator::from_block(block);
+    stats.sum_sq = simd::active().sum_squares(block.data(), block.size());
+    stats.max_abs = simd::active().max_abs(block.data(), block.size());
+    next_block_ = (next_block_ + 1) % blocks_.size();
+
+    samples_in_hop_ = 0;
+}
+
+void StreamingFeatureExtractor::emit() {
+    // Time-domain features from the per-block statistics
+    MomentAccumulator moments;
+    double sum_sq = 0.0;
+    double max_abs = 0.0;
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        const BlockStats& b = blocks_[(next_block_ + i) % blocks_.size()];
+        moments.merge(b.moments);
+        sum_sq += b.sum_sq;
+        max_abs = std::max(max_abs, b.max_abs);
+    }
+
+    features_.rms = std::sqrt(sum_sq / static_cast<double>(window_size_));
+    features_.peak = max_abs;
+    features_.crest_factor = features_.rms < 1e-10 ? 0.0 : max_abs / features_.rms;
+    features_.kurtosis = moments.kurtosis();
+    features_.skewness = moments.skewness();
+
+    // Frequency-domain features
+    if (!sliding_dft_) {
+        plan_->forward_real({buffer_.data() + write_pos_, window_size_}, bins_);
+    }
+
+    const double scale = 2.0 / static_cast<double>(plan_->size());
+    simd::active().magnitudes(bins_.data(), bins_.size(), scale, features_.fft_magnitude.data());
+    if (!features_.fft_magnitude.empty()) {
+        features_.fft_magnitude[0] /= 2.0;
+    }
+
+    features_.spectral_centroid = extractor_.compute_spectral_centroid(
+        features_.fft_magnitude, features_.fft_frequencies);
+    features_.spectral_spread = extractor_.compute_spectral_spread(
+        features_.fft_magnitude, features_.fft_frequencies, features_.spectral_centroid);
+    std::fill(features_.bandpowers.begin(), features_.bandpowers.end(), 0.0);
+    layout_->accumulate(features_.fft_magnitude, features_.bandpowers);
+}
+
+size_t StreamingFeatureExtractor::push(std::span<const double> samples, const Callback& on_features) {
+    size_t emitted = 0;
+
+    for (double x : samples) {
+        push_sample(x);
+
+        if (samples_in_hop_ == hop_size_) {
+            close_block();
+            if (samples_seen_ >= window_size_) {
+                emit();
+                on_features(features_);
+                ++emitted;
+            }
+        }
+    }
+
+    return emitted;
+}
+
+std::vector<SignalFeatures> StreamingFeatureExtractor::push(std::span<const double> samples) {
+    std::vector<SignalFeatures> out;
+    push(samples, [&out](const SignalFeatures& f) { out.push_back(f); });
+    return out;
+}
+
+} // namespace cpm
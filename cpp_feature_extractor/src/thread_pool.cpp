@@ -0,0 +1,170 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <exception>
+#include <unordered_map>
+
+namespace cpm {
+
+namespace {
+thread_local bool t_pool_worker = false;
+}
+
+bool ThreadPool::on_worker_thread() {
+    return t_pool_worker;
+}
+
+size_t ThreadPool::resolve_threads(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+    }
+    return std::max<size_t>(num_threads, 1);
+}
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    const size_t n = resolve_threads(num_threads);
+
+    queues_.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+
+    workers_.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : workers_) {
+        t.join();
+    }
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::shared(size_t num_threads) {
+    static std::mutex mutex;
+    static std::unordered_map<size_t, std::shared_ptr<ThreadPool>> pools;
+
+    const size_t n = resolve_threads(num_threads);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& pool = pools[n];
+    if (!pool) {
+        pool = std::make_shared<ThreadPool>(n);
+    }
+    return pool;
+}
+
+void ThreadPool::push(Task task) {
+    // Spread submissions round-robin; idle workers steal the rest
+    const size_t q = next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+    // Count the task before it becomes visible so pending_ never underflows
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+        queues_[q]->tasks.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+bool ThreadPool::try_pop(size_t worker, Task& task) {
+    // Own queue first, newest task (cache-warm)
+    {
+        Queue& own = *queues_[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Steal the oldest task from another worker
+    for (size_t i = 1; i < queues_.size(); ++i) {
+        Queue& victim = *queues_[(worker + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::worker_loop(size_t worker) {
+    t_pool_worker = true;
+    for (;;) {
+        Task task;
+        if (try_pop(worker, task)) {
+            task(worker);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_.wait(lock, [this] {
+            return stopping_ || pending_.load(std::memory_order_relaxed) > 0;
+        });
+        if (stopping_ && pending_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallel_for(
+    size_t count, size_t grain,
+    const std::function<void(size_t begin, size_t end, size_t worker)>& body) {
+
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    const size_t num_chunks = (count + grain - 1) / grain;
+
+    std::mutex done_mutex;
+    std::condition_variable done;
+    size_t remaining = num_chunks;
+    std::exception_ptr error;
+
+    for (size_t c = 0; c < num_chunks; ++c) {
+        const size_t begin = c * grain;
+        const size_t end = std::min(begin + grain, count);
+
+        push([&, begin, end](size_t worker) {
+            std::exception_ptr chunk_error;
+            try {
+                body(begin, end, worker);
+            } catch (...) {
+                chunk_error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(done_mutex);
+            if (chunk_error && !error) {
+                error = chunk_error;
+            }
+            if (--remaining == 0) {
+                done.notify_all();
+            }
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done.wait(lock, [&] { return remaining == 0; });
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace cpm
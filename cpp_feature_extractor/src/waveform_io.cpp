@@ -0,0 +1,408 @@
+#include "waveform_io.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cpm {
+
+namespace {
+
+constexpr bool LITTLE_ENDIAN_HOST = std::endian::native == std::endian::little;
+
+// Load a little-endian value from possibly unaligned bytes
+template <typename T>
+T load_le(const unsigned char* p) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, p, sizeof(T));
+    if constexpr (!LITTLE_ENDIAN_HOST) {
+        for (size_t i = 0; i < sizeof(T) / 2; ++i) {
+            std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+        }
+    }
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+// CSV read size; large enough to amortise syscalls, small enough for L2
+constexpr size_t CSV_CHUNK_BYTES = 1 << 18;
+
+// Files below this are parsed on one thread regardless of the setting
+constexpr size_t CSV_PARALLEL_MIN_BYTES = 4 << 20;
+
+bool is_csv_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+size_t file_size(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    return static_cast<size_t>(st.st_size);
+}
+
+// Parse bytes [begin, end) of the file in chunks. Tokens cut by a chunk
+// boundary are carried over to the next read.
+void parse_csv_range(const std::string& path, size_t begin, size_t end, std::vector<double>& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    file.seekg(static_cast<std::streamoff>(begin));
+
+    std::vector<char> buf(CSV_CHUNK_BYTES);
+    size_t carry = 0;
+    size_t remaining = end - begin;
+    bool reserved = false;
+
+    while (remaining > 0) {
+        if (buf.size() < carry + CSV_CHUNK_BYTES) {
+            buf.resize(carry + CSV_CHUNK_BYTES);  // Token longer than a chunk
+        }
+        const size_t want = std::min(CSV_CHUNK_BYTES, remaining);
+        file.read(buf.data() + carry, static_cast<std::streamsize>(want));
+        const size_t got = static_cast<size_t>(file.gcount());
+        if (got == 0) {
+            break;
+        }
+        remaining -= got;
+
+        const size_t avail = carry + got;
+        size_t last = avail;
+        while (last > 0 && buf[last - 1] != '\n' && buf[last - 1] != ',') {
+            --last;
+        }
+        if (last == 0 && remaining > 0) {
+            carry = avail;
+            continue;
+        }
+        if (remaining == 0) {
+            last = avail;
+        }
+
+        parse_csv_samples({buf.data(), last}, out);
+
+        // Size the output from the density of the first chunk
+        if (!reserved) {
+            const double per_byte = static_cast<double>(out.size()) / static_cast<double>(last);
+            out.reserve(static_cast<size_t>(per_byte * static_cast<double>(end - begin) * 1.05) + 16);
+            reserved = true;
+        }
+
+        std::copy(buf.begin() + static_cast<std::ptrdiff_t>(last),
+                  buf.begin() + static_cast<std::ptrdiff_t>(avail), buf.begin());
+        carry = avail - last;
+    }
+
+    if (carry > 0) {
+        parse_csv_samples({buf.data(), carry}, out);
+    }
+}
+
+// Offset just past the first newline at or after pos (or size)
+size_t next_line_start(const std::string& path, size_t pos, size_t size) {
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(pos));
+    char c;
+    while (pos < size && file.get(c)) {
+        ++pos;
+        if (c == '\n') {
+            break;
+        }
+    }
+    return pos;
+}
+
+} // namespace
+
+void parse_csv_samples(std::string_view text, std::vector<double>& out) {
+    const char* p = text.data();
+    const char* const end = p + text.size();
+
+    while (p < end) {
+        const char* sep = p;
+        while (sep < end && *sep != ',' && *sep != '\n') {
+            ++sep;
+        }
+
+        const char* b = p;
+        const char* e = sep;
+        while (b < e && is_csv_space(*b)) ++b;
+        while (e > b && is_csv_space(e[-1])) --e;
+        if (b < e && *b == '+') {
+            ++b;  // from_chars does not accept a leading plus
+        }
+
+        // Leading numeric prefix counts, as with strtod; anything else is skipped
+        double value;
+        if (b < e && std::from_chars(b, e, value).ec == std::errc()) {
+            out.push_back(value);
+        }
+
+        p = sep + 1;
+    }
+}
+
+std::vector<double> read_csv_signal(const std::string& path, size_t num_threads) {
+    const size_t size = file_size(path);
+    std::vector<double> signal;
+
+    const size_t threads = size < CSV_PARALLEL_MIN_BYTES ? 1 : ThreadPool::resolve_threads(num_threads);
+    if (threads <= 1) {
+        parse_csv_range(path, 0, size, signal);
+        return signal;
+    }
+
+    // Split at line starts so no token straddles two pieces
+    std::vector<size_t> bounds{0};
+    for (size_t t = 1; t < threads; ++t) {
+        size_t pos = next_line_start(path, size * t / threads, size);
+        bounds.push_back(std::max(pos, bounds.back()));
+    }
+    bounds.push_back(size);
+
+    std::vector<std::vector<double>> pieces(threads);
+    ThreadPool::shared(num_threads)->parallel_for(threads, 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t t = begin; t < end; ++t) {
+            parse_csv_range(path, bounds[t], bounds[t + 1], pieces[t]);
+        }
+    });
+
+    size_t total = 0;
+    for (const auto& piece : pieces) {
+        total += piece.size();
+    }
+    signal.reserve(total);
+    for (const auto& piece : pieces) {
+        signal.insert(signal.end(), piece.begin(), piece.end());
+    }
+    return signal;
+}
+
+size_t sample_size(SampleType type) {
+    switch (type) {
+        case SampleType::Float32: return 4;
+        case SampleType::Float64: return 8;
+        case SampleType::Int16: return 2;
+    }
+    throw std::invalid_argument("Unknown sample type");
+}
+
+SampleType parse_sample_type(const std::string& name) {
+    if (name == "f32" || name == "float32") return SampleType::Float32;
+    if (name == "f64" || name == "float64") return SampleType::Float64;
+    if (name == "i16" || name == "int16") return SampleType::Int16;
+    throw std::invalid_argument("Unknown sample type: " + name);
+}
+
+MappedWaveform::MappedWaveform(MappedWaveform&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedWaveform& MappedWaveform::operator=(MappedWaveform&& other) noexcept {
+    if (this != &other) {
+        if (map_) {
+            munmap(map_, map_size_);
+        }
+        map_ = other.map_;
+        map_size_ = other.map_size_;
+        data_ = other.data_;
+        type_ = other.type_;
+        channels_ = other.channels_;
+        frames_ = other.frames_;
+        sample_rate_ = other.sample_rate_;
+        scale_ = other.scale_;
+        other.map_ = nullptr;
+        other.map_size_ = 0;
+        other.data_ = nullptr;
+    }
+    return *this;
+}
+
+MappedWaveform::~MappedWaveform() {
+    if (map_) {
+        munmap(map_, map_size_);
+    }
+}
+
+void MappedWaveform::map_file(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+
+    map_size_ = static_cast<size_t>(st.st_size);
+    if (map_size_ > 0) {
+        map_ = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map_ == MAP_FAILED) {
+            map_ = nullptr;
+            ::close(fd);
+            throw std::runtime_error("Cannot map file: " + path);
+        }
+        // Samples are read front to back exactly once
+        madvise(map_, map_size_, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+
+    data_ = static_cast<const unsigned char*>(map_);
+}
+
+MappedWaveform MappedWaveform::open_raw(const std::string& path, SampleType type, size_t channels) {
+    if (channels == 0) {
+        throw std::invalid_argument("Channel count must be positive");
+    }
+
+    MappedWaveform w;
+    w.type_ = type;
+    w.channels_ = channels;
+    w.map_file(path);
+
+    const size_t frame_bytes = sample_size(type) * channels;
+    if (w.map_size_ % frame_bytes != 0) {
+        throw std::runtime_error("File size is not a whole number of frames: " + path);
+    }
+    w.frames_ = w.map_size_ / frame_bytes;
+    return w;
+}
+
+bool MappedWaveform::has_header(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, "CPMW", 4) == 0;
+}
+
+MappedWaveform MappedWaveform::open(const std::string& path) {
+    MappedWaveform w;
+    w.map_file(path);
+
+    if (w.map_size_ < sizeof(WaveformHeader) || std::memcmp(w.data_, "CPMW", 4) != 0) {
+        throw std::runtime_error("Not a CPMW waveform file: " + path);
+    }
+
+    const unsigned char* h = w.data_;
+    const auto version = load_le<uint16_t>(h + offsetof(WaveformHeader, version));
+    const auto type = load_le<uint16_t>(h + offsetof(WaveformHeader, sample_type));
+    const auto channels = load_le<uint32_t>(h + offsetof(WaveformHeader, channels));
+    if (version != 1) {
+        throw std::runtime_error("Unsupported CPMW version " + std::to_string(version));
+    }
+    if (type < 1 || type > 3) {
+        throw std::runtime_error("Unknown CPMW sample type " + std::to_string(type));
+    }
+    if (channels == 0) {
+        throw std::runtime_error("CPMW file has no channels");
+    }
+
+    w.type_ = static_cast<SampleType>(type);
+    w.channels_ = channels;
+    w.sample_rate_ = load_le<double>(h + offsetof(WaveformHeader, sample_rate));
+    w.scale_ = load_le<double>(h + offsetof(WaveformHeader, scale));
+    w.frames_ = static_cast<size_t>(load_le<uint64_t>(h + offsetof(WaveformHeader, num_frames)));
+
+    const size_t payload = w.map_size_ - sizeof(WaveformHeader);
+    if (w.frames_ > payload / (sample_size(w.type_) * w.channels_)) {
+        throw std::runtime_error("CPMW file is truncated: " + path);
+    }
+
+    w.data_ += sizeof(WaveformHeader);
+    return w;
+}
+
+void MappedWaveform::write(const std::string& path, std::span<const double> samples,
+                           size_t channels, double sample_rate) {
+    if (channels == 0 || samples.size() % channels != 0) {
+        throw std::invalid_argument("Sample count must be a multiple of the channel count");
+    }
+    if constexpr (!LITTLE_ENDIAN_HOST) {
+        throw std::runtime_error("CPMW writing requires a little-endian host");
+    }
+
+    WaveformHeader header;
+    header.channels = static_cast<uint32_t>(channels);
+    header.sample_rate = sample_rate;
+    header.num_frames = samples.size() / channels;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open output file: " + path);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(samples.data()),
+               static_cast<std::streamsize>(samples.size_bytes()));
+    if (!file) {
+        throw std::runtime_error("Failed writing " + path);
+    }
+}
+
+bool MappedWaveform::zero_copy() const {
+    // mmap returns page-aligned memory and the header is 8-byte aligned
+    return LITTLE_ENDIAN_HOST && type_ == SampleType::Float64 && channels_ == 1 &&
+           reinterpret_cast<uintptr_t>(data_) % alignof(double) == 0;
+}
+
+std::span<const float> MappedWaveform::float_samples() const {
+    if (!LITTLE_ENDIAN_HOST || type_ != SampleType::Float32 || channels_ != 1 ||
+        reinterpret_cast<uintptr_t>(data_) % alignof(float) != 0) {
+        return {};
+    }
+    return {reinterpret_cast<const float*>(data_), frames_};
+}
+
+std::span<const int16_t> MappedWaveform::int16_samples() const {
+    if (!LITTLE_ENDIAN_HOST || type_ != SampleType::Int16 || channels_ != 1 ||
+        reinterpret_cast<uintptr_t>(data_) % alignof(int16_t) != 0) {
+        return {};
+    }
+    return {reinterpret_cast<const int16_t*>(data_), frames_};
+}
+
+std::span<const double> MappedWaveform::channel(size_t index, std::vector<double>& storage) const {
+    if (index >= channels_) {
+        throw std::out_of_range("Channel index out of range");
+    }
+    if (zero_copy()) {
+        return {reinterpret_cast<const double*>(data_), frames_};
+    }
+
+    // One widening pass; no text parsing
+    storage.resize(frames_);
+    const size_t step = sample_size(type_) * channels_;
+    const unsigned char* p = data_ + index * sample_size(type_);
+
+    switch (type_) {
+        case SampleType::Float32:
+            for (size_t i = 0; i < frames_; ++i, p += step) {
+                storage[i] = static_cast<double>(load_le<float>(p));
+            }
+            break;
+        case SampleType::Float64:
+            for (size_t i = 0; i < frames_; ++i, p += step) {
+                storage[i] = load_le<double>(p);
+            }
+            break;
+        case SampleType::Int16:
+            for (size_t i = 0; i < frames_; ++i, p += step) {
+                storage[i] = scale_ * static_cast<double>(load_le<int16_t>(p));
+            }
+            break;
+    }
+    return storage;
+}
+
+} // namespace cpm
@@ -0,0 +1,356 @@
+#include "waveform_synth.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+namespace cpm {
+
+namespace {
+
+constexpr size_t TONE_BLOCK = 64;  // Samples per exactly-phased tone block
+
+// Philox counter word 1 selects the stream of a row
+constexpr uint32_t PARAMETER_STREAM = 0;
+constexpr uint32_t NOISE_STREAM = 1;
+
+inline void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+    const uint64_t product = static_cast<uint64_t>(a) * b;
+    hi = static_cast<uint32_t>(product >> 32);
+    lo = static_cast<uint32_t>(product);
+}
+
+// [0, 1) with 53 random bits from two 32-bit words
+inline double to_unit(uint32_t hi, uint32_t lo) {
+    const uint64_t bits = (static_cast<uint64_t>(hi) << 32) | lo;
+    return static_cast<double>(bits >> 11) * 0x1.0p-53;
+}
+
+// Random draws of one row, addressed by (seed, row, stream, block index)
+class RowRandom {
+public:
+    RowRandom(uint64_t seed, size_t row)
+        : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+          row_lo_(static_cast<uint32_t>(row)),
+          row_hi_(static_cast<uint32_t>(static_cast<uint64_t>(row) >> 32)) {}
+
+    // Philox block index of stream
+    Philox4x32::Counter block(uint32_t stream, uint32_t index) const {
+        return Philox4x32::generate({index, stream, row_lo_, row_hi_}, key_);
+    }
+
+    // Next parameter uniform in [lo, hi)
+    double uniform(double lo, double hi) {
+        if (!buffered_) {
+            const auto r = block(PARAMETER_STREAM, next_block_++);
+            first_ = to_unit(r[0], r[1]);
+            second_ = to_unit(r[2], r[3]);
+            buffered_ = true;
+            return lo + (hi - lo) * first_;
+        }
+        buffered_ = false;
+        return lo + (hi - lo) * second_;
+    }
+
+private:
+    Philox4x32::Key key_;
+    uint32_t row_lo_;
+    uint32_t row_hi_;
+    uint32_t next_block_ = 0;
+    bool buffered_ = false;
+    double first_ = 0.0;
+    double second_ = 0.0;
+};
+
+// out += amplitude * sin(omega * j + phase). Each block starts from an exact
+// phase and applies sin(a + b) = sin a cos b + cos a sin b against a table
+// of the tone over one block, so the inner loop is a plain multiply-add
+// over contiguous arrays. The table comes from a rotation recurrence,
+// whose error over one block stays within a few ulp.
+void add_tone(std::span<double> out, double amplitude, double omega, double phase) {
+    thread_local std::vector<double> cos_table(TONE_BLOCK);
+    thread_local std::vector<double> sin_table(TONE_BLOCK);
+    const double step_cos = std::cos(omega);
+    const double step_sin = std::sin(omega);
+    double c = amplitude;
+    double s = 0.0;
+    for (size_t k = 0; k < TONE_BLOCK; ++k) {
+        cos_table[k] = c;
+        sin_table[k] = s;
+        const double next = c * step_cos - s * step_sin;
+        s = s * step_cos + c * step_sin;
+        c = next;
+    }
+    const double* ct_table = cos_table.data();
+    const double* st_table = sin_table.data();
+    for (size_t start = 0; start < out.size(); start += TONE_BLOCK) {
+        const double theta = phase + omega * static_cast<double>(start);
+        const double st = std::sin(theta);
+        const double ct = std::cos(theta);
+        const size_t count = std::min(TONE_BLOCK, out.size() - start);
+        double* y = out.data() + start;
+        for (size_t k = 0; k < count; ++k) {
+            y[k] += st * ct_table[k] + ct * st_table[k];
+        }
+    }
+}
+
+// ln(x) for normal x > 0: x = m 2^e with m in [sqrt(1/2), sqrt(2)) and
+// ln m = 2 atanh(t), t = (m - 1) / (m + 1), |t| < 0.172, summed to t^19.
+// Branch-free so the noise loop vectorises (libm calls do not).
+inline double log_positive(double x) {
+    constexpr double LN2 = 0.69314718055994530942;
+    constexpr double SQRT2 = 1.41421356237309504880;
+    constexpr double TWO_52 = 4503599627370496.0;
+    const uint64_t bits = std::bit_cast<uint64_t>(x);
+    // Exponent field to double by planting it in the mantissa of 2^52, which
+    // unlike an integer conversion has a vector form on every x86 target
+    double e = std::bit_cast<double>((bits >> 52) | std::bit_cast<uint64_t>(TWO_52)) - TWO_52 - 1023.0;
+    double m = std::bit_cast<double>((bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull);
+    const bool high = m > SQRT2;
+    // Select constants rather than results so if-conversion need not
+    // speculate a floating-point operation
+    m *= high ? 0.5 : 1.0;
+    e += high ? 1.0 : 0.0;
+    const double t = (m - 1.0) / (m + 1.0);
+    const double t2 = t * t;
+    double p = 1.0 / 19.0;
+    p = p * t2 + 1.0 / 17.0;
+    p = p * t2 + 1.0 / 15.0;
+    p = p * t2 + 1.0 / 13.0;
+    p = p * t2 + 1.0 / 11.0;
+    p = p * t2 + 1.0 / 9.0;
+    p = p * t2 + 1.0 / 7.0;
+    p = p * t2 + 1.0 / 5.0;
+    p = p * t2 + 1.0 / 3.0;
+    p = p * t2 + 1.0;
+    return e * LN2 + 2.0 * t * p;
+}
+
+// sin and cos of 2 pi u for u in [0, 1): reduced to the nearest quarter
+// turn, then Taylor series to r^15 (sine) and r^14 (cosine) on |r| <= pi / 4
+inline void sincos_turns(double u, double& sine, double& cosine) {
+    // Nearest quarter turn q in {0, ..., 4}; adding and removing 2^52 rounds
+    // without an integer conversion
+    constexpr double TWO_52 = 4503599627370496.0;
+    const double q = (4.0 * u + TWO_52) - TWO_52;
+    const double r = 2.0 * PI * (u - 0.25 * q);
+    const double r2 = r * r;
+    // Coefficients (-1)^k / (2k + 1)! and (-1)^k / (2k)!, k = 7 down to 0
+    double sp = -1.0 / 1307674368000.0;
+    sp = sp * r2 + 1.0 / 6227020800.0;
+    sp = sp * r2 - 1.0 / 39916800.0;
+    sp = sp * r2 + 1.0 / 362880.0;
+    sp = sp * r2 - 1.0 / 5040.0;
+    sp = sp * r2 + 1.0 / 120.0;
+    sp = sp * r2 - 1.0 / 6.0;
+    sp = sp * r2 + 1.0;
+    double cp = -1.0 / 87178291200.0;
+    cp = cp * r2 + 1.0 / 479001600.0;
+    cp = cp * r2 - 1.0 / 3628800.0;
+    cp = cp * r2 + 1.0 / 40320.0;
+    cp = cp * r2 - 1.0 / 720.0;
+    cp = cp * r2 + 1.0 / 24.0;
+    cp = cp * r2 - 1.0 / 2.0;
+    cp = cp * r2 + 1.0;
+    const double sr = r * sp;
+    const double cr = cp;
+    // Rotate by the quarter turns: 0 -> (s, c), 1 -> (c, -s), 2 -> (-s, -c), 3 -> (-c, s)
+    const bool swap = (q == 1.0) | (q == 3.0);
+    const double s_sign = (q == 2.0) | (q == 3.0) ? -1.0 : 1.0;
+    const double c_sign = (q == 1.0) | (q == 2.0) ? -1.0 : 1.0;
+    const double s_base = swap ? cr : sr;
+    const double c_base = swap ? sr : cr;
+    sine = s_sign * s_base;
+    cosine = c_sign * c_base;
+}
+
+// Gaussian noise of standard deviation sigma into out (overwritten). Each
+// Philox block gives four 32-bit uniforms, two Box-Muller pairs; the pairs
+// are drawn first and transformed in one branch-free pass.
+void add_noise(const RowRandom& random, double sigma, std::span<double> out) {
+    thread_local std::vector<double> radius_input;
+    thread_local std::vector<double> turns;
+    const size_t n = out.size();
+    const size_t pairs = (n + 1) / 2;
+    radius_input.resize(pairs + 1);
+    turns.resize(pairs + 1);
+    for (size_t p = 0; p < pairs; p += 2) {
+        const auto r = random.block(NOISE_STREAM, static_cast<uint32_t>(p / 2));
+        // (x + 0.5) / 2^32 keeps the log argument inside (0, 1)
+        radius_input[p] = (static_cast<double>(r[0]) + 0.5) * 0x1.0p-32;
+        turns[p] = static_cast<double>(r[1]) * 0x1.0p-32;
+        radius_input[p + 1] = (static_cast<double>(r[2]) + 0.5) * 0x1.0p-32;
+        turns[p + 1] = static_cast<double>(r[3]) * 0x1.0p-32;
+    }
+    for (size_t p = 0; p < pairs; ++p) {
+        const double radius = sigma * std::sqrt(-2.0 * log_positive(radius_input[p]));
+        double sine, cosine;
+        sincos_turns(turns[p], sine, cosine);
+        radius_input[p] = radius * cosine;
+        turns[p] = radius * sine;
+    }
+    for (size_t p = 0; p < n / 2; ++p) {
+        out[2 * p] = radius_input[p];
+        out[2 * p + 1] = turns[p];
+    }
+    if (n & 1) {
+        out[n - 1] = radius_input[pairs - 1];
+    }
+}
+
+void check_inputs(std::span<const double> vibration_levels, std::span<const double> speeds,
+                  std::span<const double> wear_levels) {
+    if (speeds.size() != vibration_levels.size() || wear_levels.size() != vibration_levels.size()) {
+        throw std::invalid_argument("Vibration, speed and wear series must have the same length");
+    }
+}
+
+} // namespace
+
+Philox4x32::Counter Philox4x32::generate(Counter counter, Key key) {
+    constexpr uint32_t M0 = 0xD2511F53u;
+    constexpr uint32_t M1 = 0xCD9E8D57u;
+    constexpr uint32_t W0 = 0x9E3779B9u;
+    constexpr uint32_t W1 = 0xBB67AE85u;
+    for (int round = 0; round < 10; ++round) {
+        uint32_t hi0, lo0, hi1, lo1;
+        mulhilo(M0, counter[0], hi0, lo0);
+        mulhilo(M1, counter[2], hi1, lo1);
+        counter = {hi1 ^ counter[1] ^ key[0], lo1, hi0 ^ counter[3] ^ key[1], lo0};
+        key[0] += W0;
+        key[1] += W1;
+    }
+    return counter;
+}
+
+WaveformSynthesizer::WaveformSynthesizer(const SynthesisConfig& config) : config_(config) {
+    if (!(config.sample_rate > 0.0)) {
+        throw std::invalid_argument("Sample rate must be positive");
+    }
+    if (config.samples == 0) {
+        throw std::invalid_argument("Waveforms need at least one sample");
+    }
+}
+
+void WaveformSynthesizer::generate_row(size_t row, double vibration_level, double speed, double wear,
+                                       std::span<double> out) const {
+    const size_t n = config_.samples;
+    if (out.size() < n) {
+        throw std::invalid_argument("Waveform buffer too small");
+    }
+    out = out.first(n);
+    RowRandom random(config_.seed, row);
+
+    const double amp = vibration_level / 10.0;
+    const double wear_factor = wear / 100.0;
+    const double omega = 2.0 * PI * (speed / 60.0) / config_.sample_rate;  // Radians per sample
+
+    // Noise first: it writes every sample, so the tones can accumulate onto it
+    add_noise(random, (0.1 + 0.2 * wear_factor) * amp, out);
+
+    add_tone(out, amp, omega, 0.0);
+    for (size_t h = 2; h <= config_.max_harmonic; ++h) {
+        const double harmonic_amp = amp * wear_factor * std::pow(0.5, static_cast<double>(h)) *
+                                    random.uniform(0.5, 1.5);
+        const double phase = random.uniform(0.0, 2.0 * PI);
+        add_tone(out, harmonic_amp, static_cast<double>(h) * omega, phase);
+    }
+    if (wear_factor > config_.defect_wear) {
+        add_tone(out, amp * wear_factor * 0.3, config_.bpfo_order * omega, 0.0);
+    }
+
+    // Occasional impact somewhere in the middle half
+    const double impact = random.uniform(0.0, 1.0);
+    const double where = random.uniform(0.0, 1.0);
+    if (impact < config_.impact_probability) {
+        const size_t lo = n / 4;
+        const size_t hi = std::max(lo + 1, 3 * n / 4);
+        const size_t pos = lo + static_cast<size_t>(where * static_cast<double>(hi - lo));
+        const size_t length = std::min(config_.impact_length, n - std::min(n, pos));
+        for (size_t k = 0; k < length; ++k) {
+            out[pos + k] += amp * 2.0 * std::exp(-static_cast<double>(k) / config_.impact_decay);
+        }
+    }
+}
+
+template <typename Body>
+void WaveformSynthesizer::for_rows(size_t num_rows, size_t num_threads, const Body& body) const {
+    const size_t threads = std::min(ThreadPool::resolve_threads(num_threads), num_rows);
+    if (threads <= 1) {
+        for (size_t r = 0; r < num_rows; ++r) {
+            body(r, 0);
+        }
+        return;
+    }
+    auto pool = ThreadPool::shared(num_threads);
+    const size_t grain = std::max<size_t>(1, num_rows / (pool->size() * 8));
+    pool->parallel_for(num_rows, grain, [&](size_t begin, size_t end, size_t worker) {
+        for (size_t r = begin; r < end; ++r) {
+            body(r, worker);
+        }
+    });
+}
+
+std::vector<double> WaveformSynthesizer::generate(std::span<const double> vibration_levels,
+                                                  std::span<const double> speeds,
+                                                  std::span<const double> wear_levels, size_t first_row,
+                                                  size_t num_threads) const {
+    check_inputs(vibration_levels, speeds, wear_levels);
+    const size_t n = config_.samples;
+    std::vector<double> out(vibration_levels.size() * n);
+    for_rows(vibration_levels.size(), num_threads, [&](size_t r, size_t) {
+        generate_row(first_row + r, vibration_levels[r], speeds[r], wear_levels[r],
+                     std::span<double>(out).subspan(r * n, n));
+    });
+    return out;
+}
+
+BatchFeatures WaveformSynthesizer::extract(const FeatureExtractor& extractor,
+                                           std::span<const double> vibration_levels,
+                                           std::span<const double> speeds,
+                                           std::span<const double> wear_levels, size_t first_row) const {
+    check_inputs(vibration_levels, speeds, wear_levels);
+    const size_t num_rows = vibration_levels.size();
+
+    BatchFeatures out;
+    out.num_rows = num_rows;
+    out.num_bands = extractor.get_bands().size();
+    out.band_names = extractor.get_bands().names();
+    if (const EnvelopeAnalyzer* envelope = extractor.get_envelope()) {
+        out.num_faults = envelope->num_faults();
+        out.fault_names = envelope->fault_names();
+    }
+    std::vector<double>* columns[] = {
+        &out.rms, &out.peak, &out.crest_factor, &out.kurtosis, &out.skewness,
+        &out.spectral_centroid, &out.spectral_spread};
+    for (auto* column : columns) {
+        column->assign(num_rows, 0.0);
+    }
+    out.bandpowers.assign(num_rows * out.num_bands, 0.0);
+    out.fault_amplitudes.assign(num_rows * out.num_faults, 0.0);
+
+    // One row buffer and workspace per worker; rows write disjoint slots
+    const size_t threads = std::min(ThreadPool::resolve_threads(extractor.get_num_threads()), num_rows);
+    const size_t workers = threads > 1 ? ThreadPool::shared(extractor.get_num_threads())->size() : 1;
+    std::vector<std::vector<double>> rows(workers, std::vector<double>(config_.samples));
+    std::vector<Workspace> workspaces(workers);
+
+    for_rows(num_rows, extractor.get_num_threads(), [&](size_t r, size_t worker) {
+        std::vector<double>& row = rows[worker];
+        generate_row(first_row + r, vibration_levels[r], speeds[r], wear_levels[r], row);
+        const SignalFeatures& f = extractor.extract_all(row, workspaces[worker], false);
+        const double scalars[] = {f.rms, f.peak, f.crest_factor, f.kurtosis, f.skewness,
+                                  f.spectral_centroid, f.spectral_spread};
+        for (size_t c = 0; c < std::size(columns); ++c) {
+            (*columns[c])[r] = scalars[c];
+        }
+        std::copy(f.bandpowers.begin(), f.bandpowers.end(), out.bandpowers.begin() + r * out.num_bands);
+        std::copy(f.fault_amplitudes.begin(), f.fault_amplitudes.end(),
+                  out.fault_amplitudes.begin() + r * out.num_faults);
+    });
+    return out;
+}
+
+} // namespace cpm
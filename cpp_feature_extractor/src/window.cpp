@@ -0,0 +1,79 @@
+#include "window.hpp"
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace cpm {
+
+namespace {
+
+constexpr double TWO_PI = 6.28318530717958647692;
+
+} // namespace
+
+WindowFunction parse_window(const std::string& name) {
+    if (name == "rectangular" || name == "boxcar") return WindowFunction::Rectangular;
+    if (name == "hann") return WindowFunction::Hann;
+    if (name == "hamming") return WindowFunction::Hamming;
+    if (name == "blackman") return WindowFunction::Blackman;
+    throw std::invalid_argument("Unknown window: " + name + " (use rectangular, hann, hamming or blackman)");
+}
+
+WindowTable::WindowTable(WindowFunction function, size_t length)
+    : function_(function), values_(length) {
+    if (length == 0) {
+        throw std::invalid_argument("Window length must be positive");
+    }
+
+    const double n = static_cast<double>(length);
+    for (size_t i = 0; i < length; ++i) {
+        const double phase = TWO_PI * static_cast<double>(i) / n;
+        double w = 1.0;
+        switch (function) {
+            case WindowFunction::Rectangular:
+                break;
+            case WindowFunction::Hann:
+                w = 0.5 - 0.5 * std::cos(phase);
+                break;
+            case WindowFunction::Hamming:
+                w = 0.54 - 0.46 * std::cos(phase);
+                break;
+            case WindowFunction::Blackman:
+                w = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+                break;
+        }
+        values_[i] = w;
+        sum_ += w;
+        sum_squares_ += w * w;
+    }
+}
+
+std::shared_ptr<const WindowTable> WindowTable::get(WindowFunction function, size_t length) {
+    // Same fast path as FFTPlan::get: most callers reuse one window
+    thread_local std::shared_ptr<const WindowTable> last;
+    if (last && last->function() == function && last->size() == length) {
+        return last;
+    }
+
+    // Welch windows signals shorter than a segment at their own length, so
+    // varying record lengths would grow the cache without bound; cap it
+    constexpr size_t MAX_ENTRIES = 256;
+
+    static std::mutex mutex;
+    static std::map<std::pair<WindowFunction, size_t>, std::shared_ptr<const WindowTable>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find({function, length});
+    if (it == cache.end()) {
+        if (cache.size() >= MAX_ENTRIES) {
+            cache.clear();
+        }
+        it = cache.emplace(std::make_pair(function, length),
+                           std::make_shared<const WindowTable>(function, length)).first;
+    }
+    last = it->second;
+    return it->second;
+}
+
+} // namespace cpm
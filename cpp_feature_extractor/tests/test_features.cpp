@@ -1,7 +1,32 @@
+#include "extraction_queue.hpp"
+#include "feature_codec.hpp"
 #include "feature_extractor.hpp"
+#include "feature_store.hpp"
+#include "feature_table.hpp"
+#include "fleet_table.hpp"
+#include "simd_kernels.hpp"
+#include "spectrum_reduction.hpp"
+#include "stats.hpp"
+#include "streaming_extractor.hpp"
+#include "waveform_io.hpp"
+#include "waveform_synth.hpp"
+#include "xxhash.hpp"
 #include <iostream>
 #include <cmath>
 #include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
 
 // Simple test framework
 #define TEST(name) void test_##name()
@@ -34,6 +59,20 @@
 int passed = 0;
 int failed = 0;
 
+// Count heap allocations so allocation-free paths can be checked
+std::atomic<size_t> allocation_count{0};
+
+void* operator new(size_t size) {
+    ++allocation_count;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
 // Generate a sine wave
 std::vector<double> generate_sine(double freq, double sample_rate, size_t n_samples, double amplitude = 1.0) {
     std::vector<double> signal(n_samples);
@@ -100,6 +139,77 @@ TEST(skewness_sine) {
     ASSERT_NEAR(skew, 0.0, 0.1);
 }
 
+TEST(time_stats_matches_individual) {
+    cpm::FeatureExtractor fe(5000.0);
+    // Length not a multiple of the block size
+    auto signal = generate_sine(37.0, 5000.0, 5003, 2.0);
+    for (size_t i = 0; i < signal.size(); i += 97) {
+        signal[i] += 3.0;  // impulses
+    }
+
+    auto stats = fe.compute_time_stats(signal);
+    ASSERT_NEAR(stats.rms, fe.compute_rms(signal), 1e-12);
+    ASSERT_NEAR(stats.peak, fe.compute_peak(signal), 1e-12);
+    ASSERT_NEAR(stats.crest_factor, fe.compute_crest_factor(signal), 1e-12);
+
+    // Reference two-pass moments
+    double mean = 0.0;
+    for (double s : signal) mean += s;
+    mean /= signal.size();
+    double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+    for (double s : signal) {
+        double d = s - mean;
+        m2 += d * d;
+        m3 += d * d * d;
+        m4 += d * d * d * d;
+    }
+    m2 /= signal.size();
+    m3 /= signal.size();
+    m4 /= signal.size();
+
+    ASSERT_NEAR(stats.mean, mean, 1e-12);
+    ASSERT_NEAR(stats.variance, m2, 1e-10);
+    ASSERT_NEAR(stats.skewness, m3 / std::pow(m2, 1.5), 1e-9);
+    ASSERT_NEAR(stats.kurtosis, m4 / (m2 * m2) - 3.0, 1e-9);
+}
+
+TEST(time_stats_dc_offset) {
+    cpm::FeatureExtractor fe(1000.0);
+    auto signal = generate_sine(50.0, 1000.0, 10000);
+    for (auto& s : signal) {
+        s += 1e6;
+    }
+
+    auto stats = fe.compute_time_stats(signal);
+    ASSERT_NEAR(stats.mean, 1e6, 1e-6);
+    ASSERT_NEAR(stats.kurtosis, -1.5, 1e-4);
+    ASSERT_NEAR(stats.skewness, 0.0, 1e-4);
+}
+
+TEST(moment_accumulator_merge) {
+    std::vector<double> values;
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(std::sin(0.1 * i) * (1 + i % 5) + 10.0);
+    }
+
+    cpm::MomentAccumulator sequential;
+    for (double v : values) {
+        sequential.add(v);
+    }
+
+    cpm::MomentAccumulator merged;
+    std::span<const double> all(values);
+    merged.merge(cpm::MomentAccumulator::from_block(all.subspan(0, 123)));
+    merged.merge(cpm::MomentAccumulator::from_block(all.subspan(123, 600)));
+    merged.merge(cpm::MomentAccumulator::from_block(all.subspan(723)));
+
+    ASSERT_TRUE(merged.count == sequential.count);
+    ASSERT_NEAR(merged.mean, sequential.mean, 1e-10);
+    ASSERT_NEAR(merged.variance(), sequential.variance(), 1e-9);
+    ASSERT_NEAR(merged.skewness(), sequential.skewness(), 1e-9);
+    ASSERT_NEAR(merged.kurtosis(), sequential.kurtosis(), 1e-9);
+}
+
 TEST(fft_single_frequency) {
     cpm::FeatureExtractor fe(1000.0);
 
@@ -123,6 +233,101 @@ TEST(fft_single_frequency) {
     ASSERT_NEAR(peak_freq, target_freq, 2.0);  // Within 2 Hz
 }
 
+TEST(fft_matches_dft) {
+    cpm::FeatureExtractor fe(1000.0);
+
+    // Non-power-of-two length is transformed at its exact length
+    std::vector<double> signal(300);
+    for (size_t i = 0; i < signal.size(); ++i) {
+        signal[i] = std::sin(0.37 * i) + 0.5 * std::cos(1.9 * i) + 0.25;
+    }
+
+    auto [mags, freqs] = fe.compute_fft(signal);
+    ASSERT_TRUE(mags.size() == 150);
+    ASSERT_NEAR(freqs[1], 1000.0 / 300.0, 1e-12);
+
+    // Reference: direct DFT over the signal length
+    const size_t n = signal.size();
+    for (size_t k = 0; k < mags.size(); ++k) {
+        std::complex<double> acc(0.0, 0.0);
+        for (size_t i = 0; i < signal.size(); ++i) {
+            double angle = -2.0 * cpm::PI * static_cast<double>(k * i) / n;
+            acc += signal[i] * std::complex<double>(std::cos(angle), std::sin(angle));
+        }
+        double expected = std::abs(acc) * (k == 0 ? 1.0 : 2.0) / n;
+        ASSERT_NEAR(mags[k], expected, 1e-9);
+    }
+}
+
+TEST(fft_plan_algorithms) {
+    using Algorithm = cpm::FFTPlan::Algorithm;
+
+    // Even and odd, 5-smooth and not: every size must match a direct DFT
+    const std::pair<size_t, Algorithm> cases[] = {
+        {1, Algorithm::PowerOfTwo}, {2, Algorithm::PowerOfTwo}, {3, Algorithm::MixedRadix}, {12, Algorithm::MixedRadix},
+        {250, Algorithm::MixedRadix}, {360, Algorithm::MixedRadix}, {375, Algorithm::MixedRadix},
+        {5000, Algorithm::MixedRadix}, {14, Algorithm::Bluestein}, {97, Algorithm::Bluestein},
+        {1018, Algorithm::Bluestein},
+    };
+
+    for (const auto& [n, algorithm] : cases) {
+        cpm::FFTPlan plan(n);
+        ASSERT_TRUE(plan.algorithm() == algorithm);
+
+        std::vector<double> signal(n);
+        for (size_t i = 0; i < n; ++i) {
+            signal[i] = std::sin(0.37 * static_cast<double>(i)) + 0.1 * static_cast<double>(i % 7);
+        }
+
+        std::vector<std::complex<double>> out(plan.num_bins());
+        plan.forward_real(signal, out);
+
+        for (size_t k = 0; k < plan.num_bins(); k += 1 + n / 64) {
+            std::complex<double> acc(0.0, 0.0);
+            for (size_t i = 0; i < n; ++i) {
+                double angle = -2.0 * cpm::PI * static_cast<double>((k * i) % n) / static_cast<double>(n);
+                acc += signal[i] * std::complex<double>(std::cos(angle), std::sin(angle));
+            }
+            ASSERT_NEAR(out[k].real(), acc.real(), 1e-9 * static_cast<double>(n));
+            ASSERT_NEAR(out[k].imag(), acc.imag(), 1e-9 * static_cast<double>(n));
+        }
+    }
+}
+
+TEST(fft_plan_cache) {
+    auto a = cpm::FFTPlan::get(2048);
+    auto b = cpm::FFTPlan::get(4096);
+    auto c = cpm::FFTPlan::get(2048);
+    ASSERT_TRUE(a == c);
+    ASSERT_TRUE(a != b);
+    ASSERT_TRUE(b->num_bins() == 2048);
+}
+
+TEST(fft_codelets_match_generic) {
+    // Fixed-size kernels against the generic radix-2 loop
+    for (size_t n : {1024, 2048, 4096, 8192}) {
+        cpm::FFTPlan fast(n);
+        cpm::FFTPlan generic(n, false);
+        ASSERT_TRUE(fast.specialized() && !generic.specialized());
+
+        std::vector<double> signal(n);
+        for (size_t i = 0; i < n; ++i) {
+            signal[i] = std::sin(0.37 * static_cast<double>(i)) +
+                        0.5 * std::cos(1.91 * static_cast<double>(i) + 0.3) +
+                        0.01 * static_cast<double>(i % 17);
+        }
+
+        std::vector<std::complex<double>> a(n / 2), b(n / 2);
+        fast.forward_real(signal, a);
+        generic.forward_real(signal, b);
+        for (size_t k = 0; k < n / 2; ++k) {
+            ASSERT_NEAR(a[k].real(), b[k].real(), 1e-9);
+            ASSERT_NEAR(a[k].imag(), b[k].imag(), 1e-9);
+        }
+    }
+    ASSERT_TRUE(!cpm::FFTPlan(512).specialized());
+}
+
 TEST(spectral_centroid) {
     cpm::FeatureExtractor fe(1000.0);
 
@@ -174,6 +379,49 @@ TEST(bandpower_high_freq) {
     ASSERT_TRUE(band_ratio > 0.9);  // At least 90% in correct band
 }
 
+TEST(band_layout_matches_bandpower) {
+    cpm::FeatureExtractor fe(5000.0);
+    fe.set_bands(cpm::BandSet::third_octave(25.0, 2000.0));
+    auto signal = generate_sine(437.0, 5000.0, 3000);
+
+    // Cached bin ranges must agree with the search over the frequency grid
+    auto [mags, freqs] = fe.compute_fft(signal);
+    auto expected = fe.compute_bandpower(mags, freqs);
+    auto features = fe.extract_all(signal);
+
+    ASSERT_TRUE(features.bandpowers.size() == expected.size());
+    for (size_t b = 0; b < expected.size(); ++b) {
+        ASSERT_NEAR(features.bandpowers[b], expected[b], 1e-9);
+    }
+    ASSERT_TRUE(fe.band_layout(4096, 2048) == fe.band_layout(4096, 2048));
+}
+
+TEST(band_sets) {
+    auto octave = cpm::BandSet::octave(30.0, 2000.0);
+    ASSERT_TRUE(octave.size() == 7);  // 31.25 Hz .. 2 kHz
+    ASSERT_NEAR(octave[5].low * std::sqrt(2.0), 1000.0, 1e-9);
+    ASSERT_TRUE(octave.names()[5] == "1 kHz");
+
+    auto bearing = cpm::BandSet::bearing_faults(25.0, {3.5, 5.5, 2.3, 0.4}, 2, 1.0);
+    ASSERT_TRUE(bearing.size() == 8);
+    ASSERT_TRUE(bearing.names()[1] == "BPFO 2x");
+    ASSERT_NEAR(bearing[1].low, 174.0, 1e-9);
+
+    // Results share the band set's name list instead of copying it
+    cpm::FeatureExtractor fe(5000.0);
+    auto a = fe.extract_all(generate_sine(50.0, 5000.0, 256));
+    auto b = fe.extract_all(generate_sine(60.0, 5000.0, 256));
+    ASSERT_TRUE(&a.band_names.vector() == &b.band_names.vector());
+
+    bool threw = false;
+    try {
+        cpm::BandSet({{"bad", 10.0, 10.0}});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+}
+
 TEST(extract_all) {
     cpm::FeatureExtractor fe(5000.0);
     auto signal = generate_sine(200.0, 5000.0, 2048);
@@ -190,6 +438,1463 @@ TEST(extract_all) {
     ASSERT_TRUE(features.band_names.size() == 5);
 }
 
+TEST(workspace_matches_extract_all) {
+    cpm::FeatureExtractor fe(5000.0);
+    auto signal = generate_sine(320.0, 5000.0, 3000);
+    auto expected = fe.extract_all(signal);
+
+    cpm::Workspace ws;
+    fe.extract_all(signal, ws);
+
+    // Steady state: same-length signals reuse every buffer
+    size_t before = allocation_count.load();
+    const auto& f = fe.extract_all(signal, ws);
+    ASSERT_TRUE(allocation_count.load() == before);
+
+    ASSERT_NEAR(f.rms, expected.rms, 1e-12);
+    ASSERT_NEAR(f.kurtosis, expected.kurtosis, 1e-12);
+    ASSERT_NEAR(f.spectral_centroid, expected.spectral_centroid, 1e-9);
+    ASSERT_NEAR(f.spectral_spread, expected.spectral_spread, 1e-9);
+    ASSERT_TRUE(f.fft_magnitude.size() == expected.fft_magnitude.size());
+    for (size_t i = 0; i < f.fft_magnitude.size(); ++i) {
+        ASSERT_NEAR(f.fft_magnitude[i], expected.fft_magnitude[i], 1e-12);
+        ASSERT_NEAR(f.fft_frequencies[i], expected.fft_frequencies[i], 1e-12);
+    }
+    for (size_t b = 0; b < expected.bandpowers.size(); ++b) {
+        ASSERT_NEAR(f.bandpowers[b], expected.bandpowers[b], 1e-9);
+    }
+
+    // Scalars only: spectra are not materialized
+    const auto& s = fe.extract_all(signal, ws, false);
+    ASSERT_TRUE(s.fft_magnitude.empty() && s.fft_frequencies.empty());
+    ASSERT_NEAR(s.spectral_centroid, expected.spectral_centroid, 1e-9);
+    ASSERT_NEAR(s.bandpowers[1], expected.bandpowers[1], 1e-9);
+}
+
+TEST(extract_batch_matches_extract_all) {
+    cpm::FeatureExtractor fe(5000.0);
+    const size_t rows = 4;
+    const size_t cols = 1000;
+
+    std::vector<double> data(rows * cols);
+    for (size_t r = 0; r < rows; ++r) {
+        auto row = generate_sine(100.0 * (r + 1), 5000.0, cols, 1.0 + r);
+        std::copy(row.begin(), row.end(), data.begin() + r * cols);
+    }
+
+    auto batch = fe.extract_batch(data, rows, cols);
+    ASSERT_TRUE(batch.num_rows == rows);
+    ASSERT_TRUE(batch.num_bands == 5);
+    ASSERT_TRUE(batch.bandpowers.size() == rows * 5);
+
+    for (size_t r = 0; r < rows; ++r) {
+        std::vector<double> row(data.begin() + r * cols, data.begin() + (r + 1) * cols);
+        auto single = fe.extract_all(row);
+        ASSERT_NEAR(batch.rms[r], single.rms, 1e-12);
+        ASSERT_NEAR(batch.peak[r], single.peak, 1e-12);
+        ASSERT_NEAR(batch.crest_factor[r], single.crest_factor, 1e-12);
+        ASSERT_NEAR(batch.kurtosis[r], single.kurtosis, 1e-12);
+        ASSERT_NEAR(batch.skewness[r], single.skewness, 1e-12);
+        ASSERT_NEAR(batch.spectral_centroid[r], single.spectral_centroid, 1e-9);
+        ASSERT_NEAR(batch.spectral_spread[r], single.spectral_spread, 1e-9);
+        for (size_t b = 0; b < batch.num_bands; ++b) {
+            ASSERT_NEAR(batch.bandpowers[r * batch.num_bands + b], single.bandpowers[b], 1e-12);
+        }
+    }
+}
+
+TEST(extract_batch_threaded) {
+    const size_t rows = 64;
+    const size_t cols = 512;
+
+    std::vector<double> data(rows * cols);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = std::sin(0.01 * i) + 0.1 * std::cos(0.7 * i * (i % 7));
+    }
+
+    cpm::FeatureExtractor serial(5000.0, 1);
+    cpm::FeatureExtractor threaded(5000.0, 4);
+    auto a = serial.extract_batch(data, rows, cols);
+    auto b = threaded.extract_batch(data, rows, cols);
+
+    for (size_t r = 0; r < rows; ++r) {
+        ASSERT_NEAR(a.rms[r], b.rms[r], 0.0);
+        ASSERT_NEAR(a.kurtosis[r], b.kurtosis[r], 0.0);
+        ASSERT_NEAR(a.spectral_centroid[r], b.spectral_centroid[r], 0.0);
+    }
+    for (size_t i = 0; i < a.bandpowers.size(); ++i) {
+        ASSERT_NEAR(a.bandpowers[i], b.bandpowers[i], 0.0);
+    }
+}
+
+TEST(thread_pool_parallel_for) {
+    cpm::ThreadPool pool(3);
+    std::vector<int> hits(1000, 0);
+    pool.parallel_for(hits.size(), 7, [&](size_t begin, size_t end, size_t worker) {
+        ASSERT_TRUE(worker < pool.size());
+        for (size_t i = begin; i < end; ++i) {
+            hits[i]++;
+        }
+    });
+    for (int h : hits) {
+        ASSERT_TRUE(h == 1);
+    }
+
+    bool caught = false;
+    try {
+        pool.parallel_for(10, 1, [](size_t begin, size_t, size_t) {
+            if (begin == 5) throw std::runtime_error("boom");
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    ASSERT_TRUE(caught);
+}
+
+void check_streaming_matches_windows(cpm::SpectrumUpdate update, size_t window, size_t hop,
+                                     double spectral_tol) {
+    const double sr = 5000.0;
+    std::vector<double> stream(window * 6 + 17);
+    for (size_t i = 0; i < stream.size(); ++i) {
+        double t = static_cast<double>(i) / sr;
+        stream[i] = std::sin(2.0 * cpm::PI * 120.0 * t) + 0.3 * std::sin(2.0 * cpm::PI * 900.0 * t)
+                  + (i % 211 == 0 ? 2.0 : 0.0) + 0.5;
+    }
+
+    cpm::StreamingFeatureExtractor streaming(sr, window, hop, update);
+    cpm::FeatureExtractor fe(sr);
+
+    // Feed in uneven chunks
+    std::vector<cpm::SignalFeatures> emitted;
+    size_t pos = 0, chunk = 1;
+    while (pos < stream.size()) {
+        size_t len = std::min(chunk, stream.size() - pos);
+        auto out = streaming.push(std::span<const double>(stream).subspan(pos, len));
+        emitted.insert(emitted.end(), out.begin(), out.end());
+        pos += len;
+        chunk = chunk * 3 + 1;
+    }
+
+    ASSERT_TRUE(emitted.size() == (stream.size() - window) / hop + 1);
+
+    for (size_t w = 0; w < emitted.size(); ++w) {
+        std::span<const double> win(stream.data() + w * hop, window);
+        auto expected = fe.extract_all(win);
+        const auto& got = emitted[w];
+
+        ASSERT_NEAR(got.rms, expected.rms, 1e-12);
+        ASSERT_NEAR(got.peak, expected.peak, 0.0);
+        ASSERT_NEAR(got.kurtosis, expected.kurtosis, 1e-9);
+        ASSERT_NEAR(got.skewness, expected.skewness, 1e-9);
+        ASSERT_TRUE(got.fft_magnitude.size() == expected.fft_magnitude.size());
+        for (size_t k = 0; k < got.fft_magnitude.size(); ++k) {
+            ASSERT_NEAR(got.fft_magnitude[k], expected.fft_magnitude[k], spectral_tol);
+        }
+        ASSERT_NEAR(got.spectral_centroid, expected.spectral_centroid, 1e-6);
+        for (size_t b = 0; b < got.bandpowers.size(); ++b) {
+            ASSERT_NEAR(got.bandpowers[b], expected.bandpowers[b], 1e-9);
+        }
+    }
+}
+
+TEST(streaming_fft_matches_extract_all) {
+    // Non-power-of-two window, transformed at its exact length like extract_all
+    check_streaming_matches_windows(cpm::SpectrumUpdate::FFT, 600, 150, 1e-12);
+}
+
+TEST(streaming_sliding_dft_matches_extract_all) {
+    cpm::StreamingFeatureExtractor auto_mode(5000.0, 256, 2);
+    ASSERT_TRUE(auto_mode.uses_sliding_dft());
+    check_streaming_matches_windows(cpm::SpectrumUpdate::SlidingDFT, 256, 8, 1e-10);
+    check_streaming_matches_windows(cpm::SpectrumUpdate::SlidingDFT, 300, 6, 1e-10);
+}
+
+TEST(streaming_rejects_bad_hop) {
+    bool caught = false;
+    try {
+        cpm::StreamingFeatureExtractor bad(5000.0, 1000, 300);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    ASSERT_TRUE(caught);
+}
+
+TEST(simd_kernels_match_scalar) {
+    const auto& ref = cpm::simd::scalar();
+
+    // Odd lengths exercise the remainder handling of every kernel
+    for (size_t n : {0, 1, 3, 7, 8, 13, 64, 1001}) {
+        std::vector<double> x(n), f(n);
+        std::vector<std::complex<double>> c(n);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = std::sin(0.3 * i) * 2.0 - 0.4 + (i % 3 == 0 ? -1.5 : 0.5);
+            f[i] = 2.5 * i;
+            c[i] = {std::cos(0.11 * i) * 3.0, std::sin(0.7 * i) - 0.2};
+        }
+
+        for (auto isa : {cpm::simd::Isa::AVX2, cpm::simd::Isa::AVX512, cpm::simd::Isa::NEON}) {
+            const cpm::simd::Kernels* k = cpm::simd::kernels_for(isa);
+            if (!k) continue;
+
+            double s0, q0, m0, s1, q1, m1;
+            ref.raw_sums(x.data(), n, s0, q0, m0);
+            k->raw_sums(x.data(), n, s1, q1, m1);
+            ASSERT_NEAR(s1, s0, 1e-9);
+            ASSERT_NEAR(q1, q0, 1e-9);
+            ASSERT_NEAR(m1, m0, 0.0);
+
+            double a2, a3, a4, b2, b3, b4;
+            ref.central_moments(x.data(), n, 0.25, a2, a3, a4);
+            k->central_moments(x.data(), n, 0.25, b2, b3, b4);
+            ASSERT_NEAR(b2, a2, 1e-9);
+            ASSERT_NEAR(b3, a3, 1e-9);
+            ASSERT_NEAR(b4, a4, 1e-8);
+
+            ASSERT_NEAR(k->sum_squares(x.data(), n), ref.sum_squares(x.data(), n), 1e-9);
+            ASSERT_NEAR(k->dot(x.data(), f.data(), n), ref.dot(x.data(), f.data(), n), 1e-6);
+            ASSERT_NEAR(k->max_abs(x.data(), n), ref.max_abs(x.data(), n), 0.0);
+
+            std::vector<double> ma(n), mb(n);
+            ref.magnitudes(c.data(), n, 0.5, ma.data());
+            k->magnitudes(c.data(), n, 0.5, mb.data());
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_NEAR(mb[i], ma[i], 1e-12);
+            }
+
+            double t0, w0, t1, w1;
+            ref.power_moments(x.data(), f.data(), n, t0, w0);
+            k->power_moments(x.data(), f.data(), n, t1, w1);
+            ASSERT_NEAR(t1, t0, 1e-9);
+            ASSERT_NEAR(w1, w0, 1e-6);
+
+            ref.power_spread(x.data(), f.data(), n, 100.0, t0, w0);
+            k->power_spread(x.data(), f.data(), n, 100.0, t1, w1);
+            ASSERT_NEAR(t1, t0, 1e-9);
+            ASSERT_NEAR(w1, w0, 1e-3);
+
+            // Widening is exact, so results must match bit for bit
+            std::vector<float> xf(x.begin(), x.end());
+            std::vector<int16_t> xi(n);
+            for (size_t i = 0; i < n; ++i) {
+                xi[i] = static_cast<int16_t>(x[i] * 10000.0);
+            }
+            ref.widen_f32(xf.data(), n, ma.data());
+            k->widen_f32(xf.data(), n, mb.data());
+            ASSERT_TRUE(ma == mb);
+            ref.widen_i16(xi.data(), n, 1e-4, ma.data());
+            k->widen_i16(xi.data(), n, 1e-4, mb.data());
+            ASSERT_TRUE(ma == mb);
+
+            // Half conversions round to nearest even everywhere
+            std::vector<uint16_t> ha(n), hb(n);
+            ref.narrow_f16(x.data(), n, 3.0, ha.data());
+            k->narrow_f16(x.data(), n, 3.0, hb.data());
+            ASSERT_TRUE(ha == hb);
+            ref.widen_f16(ha.data(), n, 0.5, ma.data());
+            k->widen_f16(ha.data(), n, 0.5, mb.data());
+            ASSERT_TRUE(ma == mb);
+        }
+    }
+}
+
+TEST(welch_spectrum) {
+    const double fs = 8192.0;
+    const size_t n = 32768;
+    cpm::FeatureExtractor extractor(fs);
+
+    // One rectangular segment covering the signal is the plain periodogram
+    auto sine = generate_sine(1000.0, fs, 4096, 2.0);
+    auto [fft_mag, fft_freq] = extractor.compute_fft(sine);
+    extractor.set_welch({4096, 0.0, cpm::WindowFunction::Rectangular});
+    auto [welch_mag, welch_freq] = extractor.compute_welch(sine);
+    ASSERT_TRUE(welch_mag.size() == fft_mag.size());
+    for (size_t k = 0; k < fft_mag.size(); ++k) {
+        ASSERT_NEAR(welch_mag[k], fft_mag[k], 1e-12);
+    }
+
+    // Power scaling keeps a tone's bandpower (A^2) for every window
+    auto tone = generate_sine(300.0, fs, n, 2.0);
+    for (auto window : {cpm::WindowFunction::Hann, cpm::WindowFunction::Hamming,
+                        cpm::WindowFunction::Blackman}) {
+        extractor.set_welch({1024, 0.5, window});
+        auto features = extractor.extract_all(tone);
+        ASSERT_TRUE(features.fft_magnitude.size() == 512);
+        ASSERT_NEAR(features.fft_frequencies[1], fs / 1024, 1e-12);
+        ASSERT_NEAR(features.bandpowers[1] / 4.0, 1.0, 0.01);
+        ASSERT_NEAR(features.spectral_centroid, 300.0, 1.0);
+    }
+
+    // Averaging 63 segments shrinks the bin-to-bin scatter of white noise
+    uint64_t state = 99;
+    std::vector<double> noise(n);
+    for (auto& x : noise) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        x = static_cast<double>(state >> 11) / 9007199254740992.0 - 0.5;
+    }
+    auto relative_scatter = [](const std::vector<double>& mags) {
+        double sum = 0.0, sum_sq = 0.0;
+        for (size_t k = 1; k < mags.size(); ++k) {
+            double p = mags[k] * mags[k];
+            sum += p;
+            sum_sq += p * p;
+        }
+        double count = static_cast<double>(mags.size() - 1);
+        double mean = sum / count;
+        return std::sqrt(sum_sq / count - mean * mean) / mean;
+    };
+    extractor.clear_welch();
+    double single = relative_scatter(extractor.extract_all(noise).fft_magnitude);
+    extractor.set_welch({1024, 0.5, cpm::WindowFunction::Hann});
+    double averaged = relative_scatter(extractor.extract_all(noise).fft_magnitude);
+    ASSERT_TRUE(single > 0.8 && averaged < 0.25);
+
+    // Batch rows and the workspace path agree, and steady state allocates nothing
+    auto batch = extractor.extract_batch(noise, 4, n / 4);
+    cpm::Workspace workspace;
+    auto row = std::span<const double>(noise).subspan(n / 4, n / 4);
+    const auto& first = extractor.extract_all(row, workspace, false);
+    ASSERT_NEAR(batch.spectral_centroid[1], first.spectral_centroid, 1e-9);
+    ASSERT_NEAR(batch.bandpowers[1 * batch.num_bands + 2], first.bandpowers[2], 1e-12);
+    size_t before = allocation_count.load();
+    extractor.extract_all(row, workspace, false);
+    ASSERT_TRUE(allocation_count.load() == before);
+
+    bool threw = false;
+    try {
+        extractor.set_welch({1024, 1.0, cpm::WindowFunction::Hann});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+}
+
+TEST(envelope_fault_amplitudes) {
+    // 2 kHz resonance amplitude-modulated at BPFO = 3.5 x 25 Hz
+    const double fs = 10000.0, shaft = 25.0, depth = 0.5;
+    const size_t n = 8000;
+    std::vector<double> signal(n);
+    for (size_t i = 0; i < n; ++i) {
+        double t = static_cast<double>(i) / fs;
+        signal[i] = (1.0 + depth * std::cos(2.0 * cpm::PI * 3.5 * shaft * t)) *
+                    std::sin(2.0 * cpm::PI * 2000.0 * t);
+    }
+
+    cpm::FeatureExtractor extractor(fs);
+    cpm::EnvelopeConfig config;
+    config.band_low = 1500.0;
+    config.band_high = 2500.0;
+    config.shaft_hz = shaft;
+    config.orders = {3.5, 5.4, 2.3, 0.4};
+    config.harmonics = 2;
+    extractor.set_envelope(config);
+
+    auto features = extractor.extract_all(signal);
+    ASSERT_TRUE(features.fault_amplitudes.size() == 8 && features.fault_names.size() == 8);
+    ASSERT_TRUE(features.fault_names[0] == "BPFO 1x" && features.fault_names[2] == "BPFI 1x");
+
+    // The envelope is 1 + depth * cos(...), so BPFO carries depth and the rest nothing
+    ASSERT_NEAR(features.fault_amplitudes[0], depth, 1e-6);
+    for (size_t f = 1; f < 8; ++f) {
+        ASSERT_NEAR(features.fault_amplitudes[f], 0.0, 1e-6);
+    }
+
+    auto [magnitudes, frequencies] = extractor.compute_envelope_spectrum(signal);
+    size_t peak = std::max_element(magnitudes.begin(), magnitudes.end()) - magnitudes.begin();
+    ASSERT_NEAR(frequencies[peak], 87.5, 1e-9);
+    ASSERT_NEAR(frequencies[1], fs / n, 1e-12);
+
+    // The batch path reports the same amplitudes
+    auto batch = extractor.extract_batch(signal, 1, n);
+    ASSERT_TRUE(batch.num_faults == 8);
+    for (size_t f = 0; f < 8; ++f) {
+        ASSERT_NEAR(batch.fault_amplitudes[f], features.fault_amplitudes[f], 1e-12);
+    }
+
+    extractor.clear_envelope();
+    ASSERT_TRUE(extractor.extract_all(signal).fault_amplitudes.empty());
+}
+
+TEST(multichannel_features) {
+    const size_t n = 4096;
+    const double fs = 5000.0;
+    cpm::FeatureExtractor extractor(fs);
+
+    // ch1 is a scaled copy of ch0; ch2 is unrelated noise
+    uint64_t state = 12345;
+    auto noise = [&state] {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>(state >> 11) / 9007199254740992.0 - 0.5;
+    };
+    auto sine = generate_sine(200.0, fs, n);
+    std::vector<double> planar(3 * n), interleaved(3 * n);
+    for (size_t t = 0; t < n; ++t) {
+        double x = sine[t] + noise();
+        double ch[3] = {x, 2.0 * x, noise()};
+        for (size_t c = 0; c < 3; ++c) {
+            planar[c * n + t] = ch[c];
+            interleaved[t * 3 + c] = ch[c];
+        }
+    }
+
+    auto p = extractor.extract_multichannel(planar, 3, cpm::ChannelLayout::Planar);
+    auto q = extractor.extract_multichannel(interleaved, 3, cpm::ChannelLayout::Interleaved, 256);
+    ASSERT_TRUE(p.num_channels == 3 && p.num_samples == n && p.coherence.empty());
+
+    double sum_sq = 0.0;
+    for (size_t c = 0; c < 3; ++c) {
+        auto single = extractor.extract_all(std::span<const double>(planar).subspan(c * n, n));
+        ASSERT_NEAR(p.channels.rms[c], single.rms, 1e-12);
+        ASSERT_NEAR(q.channels.kurtosis[c], single.kurtosis, 1e-12);
+        ASSERT_NEAR(q.channels.spectral_centroid[c], single.spectral_centroid, 1e-9);
+        for (size_t t = 0; t < n; ++t) {
+            sum_sq += planar[c * n + t] * planar[c * n + t];
+        }
+    }
+    ASSERT_NEAR(q.vector_rms, std::sqrt(sum_sq / n), 1e-9);
+
+    // The vector RMS does not depend on the per-channel RMS being selected
+    cpm::FeatureExtractor kurtosis_only(fs);
+    kurtosis_only.set_features(cpm::Feature::Kurtosis);
+    auto k = kurtosis_only.extract_multichannel(planar, 3);
+    ASSERT_TRUE(std::isnan(k.channels.rms[0]));
+    ASSERT_NEAR(k.vector_rms, q.vector_rms, 1e-9);
+
+    // 50% overlap: (4096 - 256) / 128 + 1 segments of 128 bins
+    ASSERT_TRUE(q.segment_length == 256 && q.num_segments == 31);
+    ASSERT_TRUE(q.channel_pairs.size() == 3 && q.channel_pairs[1].first == 0 && q.channel_pairs[1].second == 2);
+    const size_t bins = q.frequencies.size();
+    ASSERT_TRUE(bins == 128 && q.psd.size() == 3 * bins && q.coherence.size() == 3 * bins);
+
+    // Integrated density recovers the variance (Parseval)
+    double df = q.frequencies[1];
+    double band_power = 0.0;
+    for (size_t k = 0; k < bins; ++k) {
+        band_power += q.psd[k] * df;
+    }
+    auto stats = extractor.compute_time_stats(std::span<const double>(planar).first(n));
+    ASSERT_NEAR(band_power / stats.variance, 1.0, 0.05);
+
+    // Linearly related channels are fully coherent, unrelated ones are not
+    double mean_unrelated = 0.0;
+    for (size_t k = 1; k < bins; ++k) {
+        ASSERT_NEAR(q.coherence[k], 1.0, 1e-9);
+        ASSERT_NEAR(q.csd[k].real(), 2.0 * q.psd[k], 1e-9 * q.psd[k] + 1e-15);
+        mean_unrelated += q.coherence[bins + k] / (bins - 1);
+    }
+    ASSERT_TRUE(mean_unrelated < 0.15);
+
+    bool threw = false;
+    try {
+        extractor.extract_multichannel(std::span<const double>(planar).first(3 * n - 1), 3);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+}
+
+TEST(feature_mask) {
+    const double fs = 5000.0;
+    auto signal = generate_sine(120.0, fs, 3001, 1.5);
+    for (size_t i = 0; i < signal.size(); i += 7) {
+        signal[i] += 0.3;
+    }
+
+    cpm::FeatureExtractor full(fs);
+    auto reference = full.extract_all(signal);
+
+    // Time-domain only: matching values, NaN elsewhere, and no transform taken
+    cpm::FeatureExtractor extractor(fs);
+    extractor.set_features(cpm::Feature::Rms | cpm::Feature::Kurtosis);
+    cpm::Workspace workspace;
+    const auto& timed = extractor.extract_all(signal, workspace);
+    ASSERT_NEAR(timed.rms, reference.rms, 1e-12);
+    ASSERT_NEAR(timed.kurtosis, reference.kurtosis, 1e-12);
+    ASSERT_TRUE(std::isnan(timed.peak) && std::isnan(timed.skewness));
+    ASSERT_TRUE(std::isnan(timed.spectral_centroid) && std::isnan(timed.bandpowers[0]));
+    ASSERT_TRUE(timed.fft_magnitude.empty() && timed.bandpowers.size() == reference.bandpowers.size());
+    ASSERT_TRUE(workspace.grid_fft_size == 0 && workspace.spectrum.empty());
+
+    // Raw stats alone skip the moment pass but agree with it
+    extractor.set_features(cpm::Feature::Rms | cpm::Feature::Peak | cpm::Feature::CrestFactor);
+    auto raw = extractor.extract_all(signal);
+    ASSERT_NEAR(raw.crest_factor, reference.crest_factor, 1e-12);
+    ASSERT_TRUE(std::isnan(raw.kurtosis));
+
+    // Spectrum only, as the dashboard asks for it
+    extractor.set_features(cpm::Feature::Spectrum);
+    auto spectrum = extractor.extract_all(signal);
+    ASSERT_TRUE(spectrum.fft_magnitude.size() == reference.fft_magnitude.size());
+    ASSERT_NEAR(spectrum.fft_magnitude[72], reference.fft_magnitude[72], 1e-12);
+    ASSERT_TRUE(std::isnan(spectrum.rms) && std::isnan(spectrum.spectral_spread));
+
+    // Batch columns follow the same mask
+    extractor.set_features(cpm::Feature::TimeDomain | cpm::Feature::Bandpowers);
+    std::vector<double> rows(signal.begin(), signal.end());
+    rows.insert(rows.end(), signal.begin(), signal.end());
+    auto batch = extractor.extract_batch(rows, 2, signal.size());
+    ASSERT_NEAR(batch.skewness[1], reference.skewness, 1e-12);
+    ASSERT_NEAR(batch.bandpowers[batch.num_bands + 1], reference.bandpowers[1], 1e-12);
+    ASSERT_TRUE(std::isnan(batch.spectral_centroid[0]) && std::isnan(batch.spectral_spread[1]));
+
+    ASSERT_TRUE(cpm::parse_features("rms,kurtosis") == (cpm::Feature::Rms | cpm::Feature::Kurtosis));
+    ASSERT_TRUE(cpm::parse_features("time,frequency") == cpm::Feature::All);
+    bool threw = false;
+    try {
+        cpm::parse_features("rms,fft");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+}
+
+TEST(narrow_sample_types) {
+    const double fs = 5000.0;
+    const double scale = 1.0 / 8192.0;
+    const size_t n = 4000;
+
+    // int16 counts, and the same values exactly as float and double
+    std::vector<int16_t> counts(n);
+    for (size_t i = 0; i < n; ++i) {
+        double x = 1.2 * std::sin(2 * cpm::PI * 180.0 * i / fs) + 0.4 * std::sin(2 * cpm::PI * 1300.0 * i / fs)
+                 + (i % 97 == 0 ? 1.5 : 0.0) + 0.2;
+        counts[i] = static_cast<int16_t>(std::lround(x / scale));
+    }
+    std::vector<double> samples(n);
+    std::vector<float> narrow(n);
+    for (size_t i = 0; i < n; ++i) {
+        samples[i] = counts[i] * scale;
+        narrow[i] = static_cast<float>(samples[i]);
+    }
+
+    cpm::FeatureExtractor extractor(fs);
+    auto reference = extractor.extract_all(samples);
+    for (const auto& features : {extractor.extract_all(std::span<const float>(narrow)),
+                                 extractor.extract_all(std::span<const int16_t>(counts), scale)}) {
+        ASSERT_NEAR(features.rms, reference.rms, 1e-12);
+        ASSERT_NEAR(features.kurtosis, reference.kurtosis, 1e-12);
+        ASSERT_NEAR(features.skewness, reference.skewness, 1e-12);
+        ASSERT_NEAR(features.spectral_centroid, reference.spectral_centroid, 1e-9);
+        ASSERT_NEAR(features.bandpowers[1], reference.bandpowers[1], 1e-12);
+        ASSERT_TRUE(features.fft_magnitude.size() == reference.fft_magnitude.size());
+    }
+
+    auto stats = extractor.compute_time_stats(std::span<const int16_t>(counts), scale);
+    ASSERT_NEAR(stats.mean, extractor.compute_time_stats(samples).mean, 1e-12);
+
+    // Batch rows of every type agree, threaded or not
+    std::vector<int16_t> rows(counts.begin(), counts.end());
+    rows.insert(rows.end(), counts.rbegin(), counts.rend());
+    std::vector<float> float_rows(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        float_rows[i] = static_cast<float>(rows[i] * scale);
+    }
+    extractor.set_num_threads(2);
+    auto from_counts = extractor.extract_batch(std::span<const int16_t>(rows), scale, 2, n);
+    auto from_floats = extractor.extract_batch(std::span<const float>(float_rows), 2, n);
+    ASSERT_NEAR(from_counts.peak[0], reference.peak, 1e-12);
+    ASSERT_NEAR(from_counts.kurtosis[1], reference.kurtosis, 1e-9);
+    ASSERT_NEAR(from_floats.spectral_spread[1], from_counts.spectral_spread[1], 1e-9);
+    ASSERT_NEAR(from_floats.bandpowers[4], reference.bandpowers[4], 1e-12);
+
+    // Time-domain masks widen block by block: no full-length copy
+    extractor.set_features(cpm::Feature::TimeDomain);
+    cpm::Workspace workspace;
+    const auto& timed = extractor.extract_all(std::span<const int16_t>(counts), scale, workspace);
+    ASSERT_NEAR(timed.crest_factor, reference.crest_factor, 1e-12);
+    ASSERT_TRUE(workspace.samples.empty());
+    auto time_batch = extractor.extract_batch(std::span<const float>(float_rows), 2, n);
+    ASSERT_NEAR(time_batch.rms[1], reference.rms, 1e-12);
+    ASSERT_TRUE(std::isnan(time_batch.spectral_centroid[0]));
+}
+
+TEST(stage_statistics) {
+    using cpm::stats::Stage;
+    const double fs = 5000.0;
+    const size_t n = 4096;
+    std::vector<double> signal(2 * n);
+    for (size_t i = 0; i < signal.size(); ++i) {
+        signal[i] = std::sin(2 * cpm::PI * 250.0 * i / fs) + (i % 50 == 0 ? 1.0 : 0.0);
+    }
+    std::span<const double> first(signal.data(), n);
+
+    cpm::FeatureExtractor extractor(fs);
+    extractor.extract_all(first);  // Builds the plan before counting starts
+    cpm::stats::reset();
+    ASSERT_TRUE(cpm::stats::snapshot()[Stage::Extract].calls == 0);
+
+    cpm::Workspace workspace;
+    for (int i = 0; i < 3; ++i) {
+        extractor.extract_all(first, workspace);
+    }
+    extractor.set_num_threads(2);
+    extractor.extract_batch(signal, 2, n);
+    const auto snapshot = cpm::stats::snapshot();
+
+    if (!cpm::stats::enabled()) {
+        for (const auto& stage : snapshot.stages) {
+            ASSERT_TRUE(stage.calls == 0 && stage.nanoseconds == 0);
+        }
+        ASSERT_TRUE(snapshot.plan_cache_hits + snapshot.plan_cache_misses == 0);
+        return;
+    }
+
+    ASSERT_TRUE(snapshot[Stage::Extract].calls == 3);
+    ASSERT_TRUE(snapshot[Stage::Extract].bytes == 3 * n * sizeof(double));
+    ASSERT_TRUE(snapshot[Stage::Extract].nanoseconds > 0);
+    ASSERT_TRUE(snapshot[Stage::Batch].calls == 1);
+    ASSERT_TRUE(snapshot[Stage::Batch].bytes == 2 * n * sizeof(double));
+
+    // Batch rows run on pool workers; their counters are summed in too
+    ASSERT_TRUE(snapshot[Stage::TimeStats].calls == 5);
+    ASSERT_TRUE(snapshot[Stage::FFT].calls == 5);
+    ASSERT_TRUE(snapshot[Stage::Magnitudes].calls == 5);
+    ASSERT_TRUE(snapshot[Stage::Bandpower].calls == 5);
+    ASSERT_TRUE(snapshot[Stage::SpectralShape].calls == 10);
+    ASSERT_TRUE(snapshot[Stage::Widen].calls == 0);
+
+    // Every lookup after the first extraction finds the plan cached
+    ASSERT_TRUE(snapshot.plan_cache_hits == 4 && snapshot.plan_cache_misses == 0);
+    ASSERT_NEAR(snapshot.plan_cache_hit_rate(), 1.0, 1e-12);
+
+    ASSERT_TRUE(std::string(cpm::stats::stage_name(Stage::FFT)) == "fft");
+    cpm::stats::reset();
+    ASSERT_TRUE(cpm::stats::snapshot()[Stage::FFT].calls == 0);
+}
+
+TEST(mapped_waveform_io) {
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::string cpmw = (dir / "cpm_test_waveform.cpmw").string();
+    const std::string raw = (dir / "cpm_test_waveform.i16").string();
+
+    // Headered float64 mono maps straight onto the samples
+    auto signal = generate_sine(120.0, 2000.0, 1000);
+    cpm::MappedWaveform::write(cpmw, signal, 1, 2000.0);
+    {
+        ASSERT_TRUE(cpm::MappedWaveform::has_header(cpmw));
+        auto w = cpm::MappedWaveform::open(cpmw);
+        ASSERT_TRUE(w.zero_copy());
+        ASSERT_NEAR(w.sample_rate(), 2000.0, 0.0);
+
+        std::vector<double> storage;
+        auto view = w.channel(0, storage);
+        ASSERT_TRUE(storage.empty() && view.size() == signal.size());
+        ASSERT_TRUE(reinterpret_cast<const unsigned char*>(view.data()) == w.data());
+        for (size_t i = 0; i < signal.size(); ++i) {
+            ASSERT_NEAR(view[i], signal[i], 0.0);
+        }
+    }
+
+    // Raw interleaved int16 is widened per channel
+    const int16_t interleaved[] = {1, -10, 2, -20, 3, -30};
+    {
+        std::ofstream out(raw, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(interleaved), sizeof(interleaved));
+    }
+    {
+        ASSERT_TRUE(!cpm::MappedWaveform::has_header(raw));
+        auto w = cpm::MappedWaveform::open_raw(raw, cpm::SampleType::Int16, 2);
+        ASSERT_TRUE(w.num_frames() == 3 && !w.zero_copy());
+
+        std::vector<double> storage;
+        auto ch1 = w.channel(1, storage);
+        ASSERT_TRUE(ch1.size() == 3);
+        ASSERT_NEAR(ch1[2], -30.0, 0.0);
+
+        bool threw = false;
+        try {
+            cpm::MappedWaveform::open_raw(raw, cpm::SampleType::Float64);
+        } catch (const std::runtime_error&) {
+            threw = true;  // 12 bytes is not a whole number of doubles
+        }
+        ASSERT_TRUE(threw);
+    }
+
+    std::filesystem::remove(cpmw);
+    std::filesystem::remove(raw);
+}
+
+TEST(feature_table_roundtrip) {
+    const std::string path = (std::filesystem::temp_directory_path() / "cpm_test_features.cpmf").string();
+    cpm::FeatureExtractor extractor(5000.0);
+
+    // Row 1 is left unset and reads back as NaN
+    auto a = extractor.extract_all(generate_sine(100.0, 5000.0, 1000));
+    auto b = extractor.extract_all(generate_sine(700.0, 5000.0, 1000));
+    {
+        cpm::FeatureTableWriter writer(path, 3, a.band_names, a.fft_frequencies, {"a", "missing", "b"});
+        writer.set_row(0, a, 1000, 5000.0);
+        writer.set_row(2, b, 1000, 5000.0);
+
+        auto short_signal = extractor.extract_all(generate_sine(100.0, 5000.0, 500));
+        bool threw = false;
+        try {
+            writer.set_row(1, short_signal, 500, 5000.0);
+        } catch (const std::invalid_argument&) {
+            threw = true;  // Spectrum width differs from the table
+        }
+        ASSERT_TRUE(threw);
+    }
+
+    auto table = cpm::FeatureTable::open(path);
+    ASSERT_TRUE(table.num_rows() == 3 && table.num_bins() == a.fft_magnitude.size());
+    ASSERT_TRUE(table.num_bands() == a.bandpowers.size());
+    ASSERT_TRUE(table.row_labels().size() == 3 && table.row_labels()[2] == "b");
+
+    auto rms = table.column("rms");
+    ASSERT_NEAR(rms[0], a.rms, 0.0);
+    ASSERT_TRUE(std::isnan(rms[1]));
+    ASSERT_NEAR(rms[2], b.rms, 0.0);
+    ASSERT_NEAR(table.column("num_samples")[2], 1000.0, 0.0);
+
+    // Columns start on 64-byte boundaries for zero-copy consumers
+    ASSERT_TRUE(reinterpret_cast<uintptr_t>(rms.data()) % 64 == 0);
+
+    for (size_t k = 0; k < a.bandpowers.size(); ++k) {
+        ASSERT_NEAR(table.bandpower(k)[2], b.bandpowers[k], 0.0);
+    }
+    ASSERT_NEAR(table.frequencies()[5], a.fft_frequencies[5], 0.0);
+    ASSERT_NEAR(table.spectrum(2)[140], b.fft_magnitude[140], 0.0);
+
+    // Batch results without a spectrum block
+    std::vector<double> rows;
+    for (double f : {50.0, 300.0}) {
+        auto s = generate_sine(f, 5000.0, 1000);
+        rows.insert(rows.end(), s.begin(), s.end());
+    }
+    auto batch = extractor.extract_batch(rows, 2, 1000);
+    cpm::write_feature_table(path, batch, 1000, 5000.0);
+    auto batch_table = cpm::FeatureTable::open(path);
+    ASSERT_TRUE(batch_table.num_bins() == 0 && batch_table.row_labels().empty());
+    ASSERT_NEAR(batch_table.column("kurtosis")[1], batch.kurtosis[1], 0.0);
+    ASSERT_NEAR(batch_table.bandpower(1)[1], batch.bandpowers[1 * batch.num_bands + 1], 0.0);
+
+    std::filesystem::remove(path);
+}
+
+TEST(csv_parser) {
+    std::vector<double> values;
+    cpm::parse_csv_samples("time,value\n 1.5 , -2e3\r\n+4,abc,\n\n7", values);
+    ASSERT_TRUE(values.size() == 4);
+    ASSERT_NEAR(values[0], 1.5, 0.0);
+    ASSERT_NEAR(values[1], -2000.0, 0.0);
+    ASSERT_NEAR(values[2], 4.0, 0.0);
+    ASSERT_NEAR(values[3], 7.0, 0.0);
+
+    // Large enough to cross read chunks and to be split across threads
+    const std::string path = (std::filesystem::temp_directory_path() / "cpm_test_signal.csv").string();
+    std::vector<double> expected;
+    {
+        std::ofstream out(path);
+        out << "sample,value\n";
+        for (size_t i = 0; i < 300000; ++i) {
+            double v = std::sin(0.001 * static_cast<double>(i)) * 1234.5678901;
+            out << i << "," << std::setprecision(17) << v << "\n";
+            expected.push_back(static_cast<double>(i));
+            expected.push_back(v);
+        }
+    }
+
+    for (size_t threads : {1, 4}) {
+        auto parsed = cpm::read_csv_signal(path, threads);
+        ASSERT_TRUE(parsed.size() == expected.size());
+        for (size_t i = 0; i < parsed.size(); ++i) {
+            ASSERT_NEAR(parsed[i], expected[i], 0.0);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(feature_store_cache) {
+    // Reference XXH64 values
+    ASSERT_TRUE(cpm::xxh64("", 0) == 0xEF46DB3751D8E999ULL);
+    ASSERT_TRUE(cpm::xxh64("abc", 3) == 0x44BC2CF5AD770999ULL);
+    const std::string long_input = "Nobody inspects the spammish repetition";
+    ASSERT_TRUE(cpm::xxh64(long_input.data(), long_input.size()) == 0xFBCEA83C8A378BF1ULL);
+
+    const std::string path = (std::filesystem::temp_directory_path() / "cpm_test_store.cpms").string();
+    std::filesystem::remove(path);
+    cpm::FeatureExtractor extractor(5000.0);
+    const size_t n = 1000;
+
+    std::vector<double> rows;
+    for (double f : {50.0, 300.0, 1200.0}) {
+        auto s = generate_sine(f, 5000.0, n);
+        rows.insert(rows.end(), s.begin(), s.end());
+    }
+    std::span<const double> first(rows.data(), n);
+    auto reference = extractor.extract_all(first);
+    auto reference_batch = extractor.extract_batch(rows, 3, n);
+
+    {
+        auto store = cpm::FeatureStore::open(path, extractor.get_bands().size());
+        cpm::Workspace workspace;
+        const auto& miss = store.extract(extractor, first, workspace);
+        ASSERT_NEAR(miss.kurtosis, reference.kurtosis, 0.0);
+        ASSERT_TRUE(store.size() == 1 && store.misses() == 1);
+
+        // A hit returns the stored values bit for bit, without a spectrum
+        const auto& hit = store.extract(extractor, first, workspace);
+        ASSERT_TRUE(store.hits() == 1 && store.size() == 1);
+        ASSERT_NEAR(hit.spectral_centroid, reference.spectral_centroid, 0.0);
+        ASSERT_NEAR(hit.bandpowers[1], reference.bandpowers[1], 0.0);
+        ASSERT_TRUE(hit.fft_magnitude.empty() && hit.band_names.size() == 5);
+
+        // Batch: row 0 is already stored, rows 1 and 2 are extracted together
+        auto batch = store.extract_batch(extractor, rows, 3, n);
+        ASSERT_TRUE(store.hits() == 2 && store.misses() == 3 && store.size() == 3);
+        for (size_t r = 0; r < 3; ++r) {
+            ASSERT_NEAR(batch.rms[r], reference_batch.rms[r], 0.0);
+            ASSERT_NEAR(batch.bandpowers[r * 5 + 2], reference_batch.bandpowers[r * 5 + 2], 0.0);
+        }
+
+        // Another config is another key
+        cpm::FeatureExtractor masked(5000.0);
+        masked.set_features(cpm::Feature::TimeDomain);
+        ASSERT_TRUE(cpm::feature_config_hash(masked) != cpm::feature_config_hash(extractor));
+        ASSERT_TRUE(std::isnan(store.extract(masked, first, workspace).spectral_centroid));
+        ASSERT_TRUE(store.size() == 4);
+
+        // The same values as float32 hash differently
+        std::vector<float> narrow(first.begin(), first.end());
+        ASSERT_TRUE(cpm::waveform_hash(std::span<const float>(narrow)) != cpm::waveform_hash(first));
+    }
+
+    // Appends from another process become visible to an open store
+    auto reader = cpm::FeatureStore::open_readonly(path);
+    ASSERT_TRUE(reader.size() == 4 && reader.num_bands() == 5);
+    auto other = generate_sine(2200.0, 5000.0, n);
+    pid_t child = fork();
+    if (child == 0) {
+        auto writer = cpm::FeatureStore::open(path, 5);
+        cpm::Workspace workspace;
+        writer.extract(extractor, other, workspace);
+        _exit(writer.size() == 5 ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    const cpm::FeatureRecord* record = reader.find(cpm::waveform_hash(std::span<const double>(other)),
+                                                   cpm::feature_config_hash(extractor));
+    ASSERT_TRUE(record != nullptr && record->num_samples == n);
+    ASSERT_NEAR(record->rms, extractor.compute_rms(other), 1e-12);
+
+    // Layout mismatches are rejected
+    bool threw = false;
+    try {
+        cpm::FeatureStore::open(path, 3);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    std::filesystem::remove(path);
+}
+
+TEST(fleet_feature_table) {
+    const size_t n = 1024;
+    cpm::FeatureExtractor extractor(5000.0, 2);
+    std::vector<double> history;
+    for (size_t r = 0; r < 100; ++r) {
+        auto row = generate_sine(100.0 + 10.0 * static_cast<double>(r), 5000.0, n, 1.0 + 0.01 * static_cast<double>(r));
+        history.insert(history.end(), row.begin(), row.end());
+    }
+    const cpm::BatchFeatures reference = extractor.extract_batch(history, 100, n);
+
+    cpm::FleetFeatureTable table;
+    cpm::RowRange added = table.update("pump", extractor, std::span<const double>(history).first(40 * n), 40, n);
+    ASSERT_TRUE(added.begin == 0 && added.end == 40);
+
+    // A view taken now keeps its rows while the column grows underneath it
+    cpm::FleetColumn early = table.column("pump", "rms");
+    ASSERT_TRUE(early.rows == 40);
+
+    // Only the dirty window is extracted on the next update, and an
+    // up-to-date asset is a no-op
+    added = table.update("pump", extractor, history, 100, n);
+    ASSERT_TRUE(added.begin == 40 && added.end == 100);
+    ASSERT_TRUE(table.update("pump", extractor, history, 100, n).empty());
+    ASSERT_TRUE(table.rows("pump") == 100 && early.rows == 40);
+
+    cpm::FleetColumn rms = table.column("pump", "rms");
+    cpm::FleetColumn bands = table.column("pump", "bandpowers");
+    ASSERT_TRUE(rms.rows == 100 && bands.width == 5);
+    for (size_t r = 0; r < 100; ++r) {
+        ASSERT_NEAR(rms.data[r], reference.rms[r], 0.0);
+        ASSERT_NEAR(bands.data[r * 5 + 3], reference.bandpowers[r * 5 + 3], 0.0);
+    }
+    for (size_t r = 0; r < 40; ++r) {
+        ASSERT_NEAR(early.data[r], reference.rms[r], 0.0);
+    }
+    ASSERT_NEAR(table.column("pump", "num_samples").data[99], static_cast<double>(n), 0.0);
+
+    // Appends add rows as given; other settings and a shrinking history are rejected
+    added = table.append("fan", extractor, std::span<const double>(history).first(3 * n), 3, n);
+    ASSERT_TRUE(added.size() == 3 && table.assets().size() == 2);
+    cpm::FeatureExtractor other(8000.0);
+    bool threw = false;
+    try {
+        table.append("fan", other, std::span<const double>(history).first(n), 1, n);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    threw = false;
+    try {
+        table.update("pump", extractor, history, 50, n);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+
+    ASSERT_TRUE(table.erase("fan") && !table.contains("fan"));
+}
+
+TEST(extraction_queue_batches) {
+    cpm::FeatureExtractor extractor(5000.0, 4);
+    const size_t num_signals = 200;
+    std::vector<std::vector<double>> signals;
+    for (size_t i = 0; i < num_signals; ++i) {
+        signals.push_back(generate_sine(50.0 + 5.0 * static_cast<double>(i), 5000.0, 2048));
+    }
+
+    std::vector<std::future<cpm::SignalFeatures>> results(num_signals);
+    {
+        cpm::ExtractionQueue queue(extractor, 32);
+        std::vector<std::thread> clients;
+        for (size_t t = 0; t < 4; ++t) {
+            clients.emplace_back([&, t] {
+                for (size_t i = t; i < num_signals; i += 4) {
+                    results[i] = queue.submit(signals[i], i % 2 == 0);
+                }
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+        for (size_t i = 0; i < num_signals; ++i) {
+            const cpm::SignalFeatures f = results[i].get();
+            const cpm::SignalFeatures reference = extractor.extract_all(signals[i]);
+            ASSERT_NEAR(f.rms, reference.rms, 0.0);
+            ASSERT_NEAR(f.spectral_centroid, reference.spectral_centroid, 0.0);
+            ASSERT_NEAR(f.bandpowers[2], reference.bandpowers[2], 0.0);
+            ASSERT_TRUE(f.fft_magnitude.size() == (i % 2 == 0 ? reference.fft_magnitude.size() : 0));
+        }
+        ASSERT_TRUE(queue.completed() == num_signals);
+        ASSERT_TRUE(queue.batches() >= 1 && queue.batches() <= num_signals);
+
+        // Requests queued before close() still complete; later ones are refused
+        std::atomic<int> done{0};
+        for (size_t i = 0; i < 10; ++i) {
+            queue.submit(signals[i], false, [&](cpm::SignalFeatures&& f, std::exception_ptr error) {
+                if (!error && f.rms > 0.0) {
+                    done.fetch_add(1);
+                }
+            });
+        }
+        queue.close();
+        ASSERT_TRUE(done.load() == 10);
+        bool threw = false;
+        try {
+            queue.submit(signals[0]);
+        } catch (const std::logic_error&) {
+            threw = true;
+        }
+        ASSERT_TRUE(threw);
+    }
+}
+
+TEST(extraction_queue_close_from_callback) {
+    cpm::FeatureExtractor extractor(5000.0, 4);
+    const std::vector<double> signal = generate_sine(120.0, 5000.0, 2048);
+
+    // Callbacks run on pool workers while the dispatcher waits on the batch;
+    // closing from one must not wait on the dispatcher
+    cpm::ExtractionQueue queue(extractor, 16);
+    std::atomic<int> done{0};
+    std::mutex submitting;
+    {
+        // Holds the callbacks off until every request is queued
+        std::lock_guard<std::mutex> lock(submitting);
+        for (size_t i = 0; i < 16; ++i) {
+            queue.submit(signal, false, [&](cpm::SignalFeatures&&, std::exception_ptr error) {
+                { std::lock_guard<std::mutex> wait(submitting); }
+                queue.close();
+                if (!error) {
+                    done.fetch_add(1);
+                }
+            });
+        }
+    }
+    queue.close();
+    ASSERT_TRUE(done.load() == 16);
+
+    // Destroying the queue from its own callback detaches the dispatcher
+    auto owned = std::make_unique<cpm::ExtractionQueue>(extractor, 16);
+    std::mutex owned_mutex;
+    std::promise<void> destroyed;
+    {
+        // Holds the callback off until submit has returned
+        std::lock_guard<std::mutex> lock(owned_mutex);
+        for (size_t i = 0; i < 8; ++i) {
+            owned->submit(signal, false, [&, i](cpm::SignalFeatures&&, std::exception_ptr) {
+                if (i == 7) {
+                    std::lock_guard<std::mutex> lock(owned_mutex);
+                    owned.reset();
+                    destroyed.set_value();
+                }
+            });
+        }
+    }
+    destroyed.get_future().wait();
+    std::lock_guard<std::mutex> lock(owned_mutex);
+    ASSERT_TRUE(!owned);
+}
+
+TEST(spectrum_reduction) {
+    cpm::FeatureExtractor extractor(5000.0);
+    auto signal = generate_sine(440.0, 5000.0, 8192);
+    auto second = generate_sine(1800.0, 5000.0, 8192, 0.25);
+    for (size_t i = 0; i < signal.size(); ++i) {
+        signal[i] += second[i];
+    }
+    const cpm::SignalFeatures f = extractor.extract_all(signal);
+    const size_t bins = f.fft_magnitude.size();
+
+    cpm::SpectrumReductionConfig config;
+    config.points = 256;
+    config.num_peaks = 2;
+    const cpm::ReducedSpectrum minmax = cpm::reduce_spectrum(f, config);
+    ASSERT_TRUE(minmax.num_bins == bins && minmax.magnitudes.size() <= 256 && minmax.magnitudes.size() > 128);
+    ASSERT_TRUE(std::is_sorted(minmax.frequencies.begin(), minmax.frequencies.end()));
+
+    // Both tones survive decimation at full height
+    const double top = *std::max_element(f.fft_magnitude.begin() + 1, f.fft_magnitude.end());
+    ASSERT_NEAR(*std::max_element(minmax.magnitudes.begin(), minmax.magnitudes.end()), top, 0.0);
+    ASSERT_NEAR(minmax.dominant_frequency, 440.0, 5000.0 / 8192.0);
+    ASSERT_TRUE(minmax.peaks.size() == 2);
+    ASSERT_NEAR(minmax.peaks[0].frequency, 440.0, 5000.0 / 8192.0);
+    ASSERT_NEAR(minmax.peaks[1].frequency, 1800.0, 5000.0 / 8192.0);
+    ASSERT_TRUE(minmax.peaks[0].magnitude > minmax.peaks[1].magnitude);
+
+    double power = 0.0;
+    for (double m : f.fft_magnitude) {
+        power += m * m;
+    }
+    ASSERT_NEAR(minmax.total_power, power, 1e-9 * power);
+
+    config.method = cpm::parse_decimation("lttb");
+    const cpm::ReducedSpectrum lttb = cpm::reduce_spectrum(f, config);
+    ASSERT_TRUE(lttb.magnitudes.size() == 256);
+    ASSERT_NEAR(lttb.frequencies.front(), f.fft_frequencies.front(), 0.0);
+    ASSERT_NEAR(lttb.frequencies.back(), f.fft_frequencies.back(), 0.0);
+    ASSERT_NEAR(*std::max_element(lttb.magnitudes.begin(), lttb.magnitudes.end()), top, 0.0);
+
+    config.log_frequency = true;
+    config.min_frequency = 10.0;
+    const cpm::ReducedSpectrum log = cpm::reduce_spectrum(f, config);
+    ASSERT_TRUE(log.magnitudes.size() == 256);
+    ASSERT_NEAR(log.frequencies.front(), 10.0, 0.2);
+    ASSERT_NEAR(std::log(log.frequencies[101] / log.frequencies[100]),
+                std::log(log.frequencies[201] / log.frequencies[200]), 1e-9);
+    ASSERT_NEAR(*std::max_element(log.magnitudes.begin(), log.magnitudes.end()), top, 0.0);
+
+    // Within the budget the spectrum is returned unchanged
+    config = {};
+    config.points = bins;
+    ASSERT_TRUE(cpm::reduce_spectrum(f, config).magnitudes == f.fft_magnitude);
+
+    // A one-point budget keeps only the largest bin
+    config.points = 1;
+    const cpm::ReducedSpectrum single = cpm::reduce_spectrum(f, config);
+    ASSERT_TRUE(single.magnitudes.size() == 1 && single.frequencies.size() == 1);
+    ASSERT_NEAR(single.magnitudes[0], *std::max_element(f.fft_magnitude.begin(), f.fft_magnitude.end()), 0.0);
+
+    bool threw = false;
+    try {
+        cpm::parse_decimation("median");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+}
+
+TEST(order_tracking) {
+    const double fs = 5000.0;
+    const size_t n = 4096;
+    cpm::FeatureExtractor extractor(fs);
+
+    // Shaft at 1x plus a 3x harmonic, at two constant speeds: the order
+    // bands agree although the Hz bins differ
+    auto harmonics = [&](auto angle) {
+        std::vector<double> x(n);
+        for (size_t i = 0; i < n; ++i) {
+            const double theta = angle(static_cast<double>(i) / fs);
+            x[i] = std::sin(2.0 * cpm::PI * theta) + 0.5 * std::sin(2.0 * cpm::PI * 3.0 * theta);
+        }
+        return x;
+    };
+    for (double rpm : {1500.0, 2400.0}) {
+        auto signal = harmonics([&](double t) { return rpm / 60.0 * t; });
+        auto orders = extractor.compute_order_spectrum(signal, rpm);
+        ASSERT_TRUE(orders.revolutions == static_cast<size_t>(std::floor(rpm / 60.0 * (n - 1) / fs)));
+        ASSERT_TRUE(orders.magnitudes.size() == orders.revolutions * 64 / 2);
+        ASSERT_NEAR(orders.orders[orders.revolutions], 1.0, 1e-12);
+        ASSERT_NEAR(orders.magnitudes[orders.revolutions], 1.0, 1e-2);
+        ASSERT_NEAR(orders.magnitudes[3 * orders.revolutions], 0.5, 1e-2);
+        ASSERT_NEAR(orders.mean_rpm, rpm, 1e-9);
+        ASSERT_TRUE(orders.band_names.vector() == std::vector<std::string>({"0.5x", "1x", "2x", "3x", "4x+"}));
+        ASSERT_NEAR(orders.band_powers[1], 1.0, 2e-2);
+        ASSERT_NEAR(orders.band_powers[3], 0.25, 1e-2);
+        ASSERT_NEAR(orders.band_powers[2], 0.0, 1e-3);
+    }
+
+    // A run-up smears the Hz spectrum but not the order spectrum
+    const double r0 = 1200.0, r1 = 2400.0;
+    const double duration = static_cast<double>(n - 1) / fs;
+    auto sweep = harmonics([&](double t) { return (r0 * t + (r1 - r0) * t * t / (2.0 * duration)) / 60.0; });
+    const std::vector<double> trace = {r0, r1};
+    auto tracked = extractor.compute_order_spectrum(sweep, trace);
+    ASSERT_NEAR(tracked.mean_rpm, 0.5 * (r0 + r1), 1e-6);
+    ASSERT_NEAR(tracked.magnitudes[tracked.revolutions], 1.0, 2e-2);
+    ASSERT_NEAR(tracked.magnitudes[3 * tracked.revolutions], 0.5, 2e-2);
+    auto [hz_mag, hz_freq] = extractor.compute_fft(sweep);
+    ASSERT_TRUE(*std::max_element(hz_mag.begin(), hz_mag.end()) < 0.5);
+
+    // The batch path matches per-signal results
+    std::vector<double> data;
+    const std::vector<double> speeds = {1500.0, 2400.0};
+    for (double rpm : speeds) {
+        auto signal = harmonics([&](double t) { return rpm / 60.0 * t; });
+        data.insert(data.end(), signal.begin(), signal.end());
+    }
+    auto batch = extractor.extract_order_batch(data, speeds, 2, n);
+    ASSERT_TRUE(batch.num_bands == 5);
+    for (size_t r = 0; r < 2; ++r) {
+        auto single = extractor.compute_order_spectrum(std::span<const double>(data).subspan(r * n, n), speeds[r]);
+        ASSERT_TRUE(batch.revolutions[r] == single.revolutions);
+        for (size_t b = 0; b < batch.num_bands; ++b) {
+            ASSERT_NEAR(batch.band_powers[r * batch.num_bands + b], single.band_powers[b], 1e-12);
+        }
+    }
+
+    // Settings: finer angular sampling doubles the order range
+    extractor.set_order_tracking({128, 16, 256, {{"1x", 0.5, 1.5}}});
+    auto fine = extractor.compute_order_spectrum(data, 1500.0);
+    ASSERT_TRUE(fine.band_names.size() == 1);
+    ASSERT_NEAR(fine.orders.back(), 64.0 - 1.0 / static_cast<double>(fine.revolutions), 1e-9);
+    extractor.clear_order_tracking();
+    ASSERT_TRUE(extractor.get_order_tracker() == nullptr);
+
+    bool threw = false;
+    try {
+        extractor.compute_order_spectrum(sweep, 0.0);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+}
+
+TEST(waveform_synthesis) {
+    // Known-answer vector of the Random123 reference implementation
+    auto kat = cpm::Philox4x32::generate({0, 0, 0, 0}, {0, 0});
+    ASSERT_TRUE(kat == cpm::Philox4x32::Counter({0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}));
+
+    // 1 Hz bins, so shaft lines fall exactly on bins
+    cpm::SynthesisConfig config;
+    config.sample_rate = 5000.0;
+    config.samples = 5000;
+    config.impact_probability = 0.0;
+    cpm::WaveformSynthesizer synth(config);
+    cpm::FeatureExtractor extractor(config.sample_rate);
+
+    // No wear: fundamental at amp = 1 plus noise of sigma 0.1
+    std::vector<double> row(config.samples);
+    synth.generate_row(0, 10.0, 1800.0, 0.0, row);
+    auto [mag, freq] = extractor.compute_fft(row);
+    ASSERT_NEAR(freq[30], 30.0, 1e-12);
+    ASSERT_NEAR(mag[30], 1.0, 0.01);
+    ASSERT_NEAR(mag[60], 0.0, 0.01);
+
+    // Worn: harmonics and the outer-race line at 3.5x appear
+    synth.generate_row(0, 10.0, 1800.0, 80.0, row);
+    std::tie(mag, freq) = extractor.compute_fft(row);
+    ASSERT_NEAR(mag[105], 0.8 * 0.3, 0.01);
+    ASSERT_TRUE(mag[60] > 0.8 * 0.25 * 0.5 - 0.01 && mag[60] < 0.8 * 0.25 * 1.5 + 0.01);
+
+    // At zero speed only the noise is left
+    synth.generate_row(3, 10.0, 0.0, 0.0, row);
+    ASSERT_NEAR(extractor.compute_rms(row), 0.1, 0.005);
+    ASSERT_NEAR(std::accumulate(row.begin(), row.end(), 0.0) / static_cast<double>(row.size()), 0.0, 0.005);
+
+    // Same output for any thread count and any split into chunks
+    const std::vector<double> vibration = {8.0, 10.0, 12.0, 9.0, 11.0};
+    const std::vector<double> speed = {1200.0, 1500.0, 1800.0, 1650.0, 1900.0};
+    const std::vector<double> wear = {5.0, 20.0, 45.0, 60.0, 90.0};
+    auto serial = synth.generate(vibration, speed, wear, 0, 1);
+    auto parallel = synth.generate(vibration, speed, wear, 0, 4);
+    ASSERT_TRUE(serial == parallel);
+    auto tail = synth.generate(std::span(vibration).subspan(2), std::span(speed).subspan(2),
+                               std::span(wear).subspan(2), 2, 1);
+    ASSERT_TRUE(std::equal(tail.begin(), tail.end(), serial.begin() + 2 * config.samples));
+    ASSERT_TRUE(!std::equal(serial.begin(), serial.begin() + config.samples,
+                            serial.begin() + config.samples));
+
+    // Fused synthesis and extraction matches extract_batch on the matrix
+    extractor.set_num_threads(2);
+    auto fused = synth.extract(extractor, vibration, speed, wear);
+    auto batch = extractor.extract_batch(serial, vibration.size(), config.samples);
+    ASSERT_TRUE(fused.num_rows == 5 && fused.num_bands == batch.num_bands);
+    for (size_t r = 0; r < fused.num_rows; ++r) {
+        ASSERT_NEAR(fused.rms[r], batch.rms[r], 1e-12);
+        ASSERT_NEAR(fused.kurtosis[r], batch.kurtosis[r], 1e-9);
+        ASSERT_NEAR(fused.spectral_centroid[r], batch.spectral_centroid[r], 1e-9);
+    }
+    for (size_t i = 0; i < fused.bandpowers.size(); ++i) {
+        ASSERT_NEAR(fused.bandpowers[i], batch.bandpowers[i], 1e-9);
+    }
+
+    bool threw = false;
+    try {
+        synth.generate(vibration, speed, std::span(wear).first(2));
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+}
+
+TEST(kurtogram) {
+    const double fs = 5000.0;
+    const size_t n = 8192;
+    cpm::FeatureExtractor extractor(fs);
+
+    // Gaussian background (sigma 0.1) from the synthesiser with no shaft tones
+    cpm::SynthesisConfig noise_config;
+    noise_config.samples = n;
+    noise_config.impact_probability = 0.0;
+    std::vector<double> noise(n);
+    cpm::WaveformSynthesizer(noise_config).generate_row(0, 10.0, 0.0, 0.0, noise);
+
+    // Levels 0, 1, 1.6, 2, ..., 6; 8192 points leave 64 bins per finest band
+    auto flat = extractor.compute_kurtogram(noise);
+    ASSERT_TRUE(flat.num_levels() == 12);
+    ASSERT_NEAR(flat.levels[2], 1.6, 1e-12);
+    ASSERT_NEAR(flat.levels[11], 6.0, 1e-12);
+    ASSERT_TRUE(flat.row(2).size() == 3 && flat.row(11).size() == 64);
+    ASSERT_TRUE(flat.offsets.back() == flat.kurtosis.size());
+    double mean = 0.0;
+    for (double k : flat.kurtosis) {
+        mean += k;
+    }
+    ASSERT_NEAR(mean / static_cast<double>(flat.kurtosis.size()), 0.0, 0.2);
+
+    // A tone on bin 64 has a constant envelope: SK = -1 in its band
+    std::vector<double> tone(n);
+    for (size_t i = 0; i < n; ++i) {
+        tone[i] = std::sin(2.0 * cpm::PI * 64.0 * static_cast<double>(i) / static_cast<double>(n));
+    }
+    ASSERT_NEAR(extractor.compute_kurtogram(tone).row(11)[1], -1.0, 1e-9);
+
+    // Impacts every 250 samples (20 Hz, with some jitter) ringing a 1500 Hz
+    // resonance, under shaft tones that hide them from whole-signal kurtosis
+    std::vector<double> impulsive = noise;
+    for (size_t i = 0; i < n; ++i) {
+        const double t = static_cast<double>(i) / fs;
+        impulsive[i] += std::sin(2.0 * cpm::PI * 50.0 * t) + 0.5 * std::sin(2.0 * cpm::PI * 150.0 * t);
+    }
+    for (size_t hit = 0; hit * 250 < n; ++hit) {
+        const size_t start = hit * 250 + (hit * 7919) % 11;
+        for (size_t k = 0; k < 50 && start + k < n; ++k) {
+            const double t = static_cast<double>(k) / fs;
+            impulsive[start + k] += 0.5 * std::exp(-600.0 * t) * std::sin(2.0 * cpm::PI * 1500.0 * t);
+        }
+    }
+    auto peaked = extractor.compute_kurtogram(impulsive);
+    ASSERT_TRUE(peaked.band_low <= 1500.0 && 1500.0 < peaked.band_high);
+    ASSERT_TRUE(peaked.best_kurtosis > 1.0 && peaked.row(0)[0] < 0.0);
+    ASSERT_NEAR(peaked.row(static_cast<size_t>(
+                    std::find(peaked.levels.begin(), peaked.levels.end(), peaked.best_level) -
+                    peaked.levels.begin()))[peaked.best_band], peaked.best_kurtosis, 0.0);
+
+    // Without envelope settings only the envelope spectrum is reported
+    auto spectrum_only = extractor.compute_kurtogram_envelope(impulsive);
+    ASSERT_TRUE(spectrum_only.fault_names.empty() && spectrum_only.fault_amplitudes.empty());
+    ASSERT_TRUE(spectrum_only.envelope_magnitudes.size() == spectrum_only.envelope_frequencies.size());
+    ASSERT_TRUE(!spectrum_only.envelope_magnitudes.empty());
+
+    // The configured band misses the resonance; the kurtogram's best band,
+    // demodulated from the same FFT, recovers the impact rate
+    cpm::EnvelopeConfig config;
+    config.band_low = 100.0;
+    config.band_high = 400.0;
+    config.shaft_hz = 20.0 / 3.5;
+    config.orders = {3.5, 0.0, 0.0, 0.0};
+    config.harmonics = 1;
+    extractor.set_envelope(config);
+    const double fixed_band = extractor.extract_all(impulsive).fault_amplitudes[0];
+    auto demodulated = extractor.compute_kurtogram_envelope(impulsive);
+    ASSERT_NEAR(demodulated.kurtogram.best_kurtosis, peaked.best_kurtosis, 1e-12);
+    ASSERT_TRUE(demodulated.fault_names.size() == 1 && demodulated.fault_names[0] == "BPFO 1x");
+    ASSERT_TRUE(demodulated.fault_amplitudes[0] > 3.0 * fixed_band);
+    const auto& env = demodulated.envelope_magnitudes;
+    size_t peak = std::max_element(env.begin() + 1, env.end()) - env.begin();
+    ASSERT_NEAR(demodulated.envelope_frequencies[peak], 20.0, 1.0);
+}
+
+TEST(feature_codec) {
+    const double fs = 5000.0;
+    const size_t n = 4096;
+    cpm::FeatureExtractor extractor(fs);
+
+    // Tones over a Gaussian floor: about 60 dB of spectral range
+    cpm::SynthesisConfig config;
+    config.samples = n;
+    config.impact_probability = 0.0;
+    std::vector<double> signal(n);
+    cpm::WaveformSynthesizer(config).generate_row(0, 10.0, 1800.0, 40.0, signal);
+    const auto features = extractor.extract_all(signal);
+    const auto& mags = features.fft_magnitude;
+    const size_t bins = mags.size();
+    const double largest = *std::max_element(mags.begin(), mags.end());
+
+    struct Case {
+        cpm::SpectrumEncoding encoding;
+        double tolerance;  // Relative, above the encoding's floor
+        double floor;
+        size_t max_size;
+    };
+    const Case cases[] = {
+        {cpm::SpectrumEncoding::Float64, 0.0, 0.0, 16 + 8 * bins},
+        {cpm::SpectrumEncoding::Float16, 4.9e-4, 6.2e-5, 16 + 2 * bins},
+        {cpm::SpectrumEncoding::Log8, 0.0225, 1.6e-5, 16 + bins},
+        {cpm::SpectrumEncoding::Log16, 1.5e-4, 1e-8, 16 + 2 * bins},
+    };
+    for (const Case& c : cases) {
+        auto block = cpm::encode_spectrum(mags, c.encoding);
+        ASSERT_TRUE(block.size() == cpm::encoded_spectrum_size(c.encoding, bins));
+        ASSERT_TRUE(block.size() <= c.max_size);
+        ASSERT_TRUE(cpm::spectrum_length(block) == bins);
+        auto decoded = cpm::decode_spectrum(block);
+        for (size_t k = 0; k < bins; ++k) {
+            if (mags[k] >= c.floor * largest) {
+                ASSERT_NEAR(decoded[k] / mags[k], 1.0, c.tolerance);
+            } else {
+                ASSERT_TRUE(decoded[k] <= c.floor * largest);
+            }
+        }
+    }
+    ASSERT_TRUE(cpm::parse_spectrum_encoding("log8") == cpm::SpectrumEncoding::Log8);
+
+    // All-zero spectra survive; negative magnitudes have no log code
+    std::vector<double> zeros(10, 0.0);
+    auto zero_back = cpm::decode_spectrum(cpm::encode_spectrum(zeros, cpm::SpectrumEncoding::Log8));
+    ASSERT_TRUE(zero_back == zeros);
+    bool threw = false;
+    try {
+        cpm::encode_spectrum(std::vector<double>{1.0, -1.0}, cpm::SpectrumEncoding::Log16);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+
+    // A drifting feature series with gaps packs to a few bits per value
+    std::vector<double> series(1000);
+    for (size_t i = 0; i < series.size(); ++i) {
+        series[i] = 2.0 + 0.001 * static_cast<double>(i) + 0.0005 * std::sin(0.1 * static_cast<double>(i));
+    }
+    series[17] = series[500] = std::numeric_limits<double>::quiet_NaN();
+    const double resolution = 1e-4;
+    auto packed = cpm::encode_series(series, resolution);
+    ASSERT_TRUE(packed.size() * 8 < series.size() * sizeof(double));
+    ASSERT_TRUE(cpm::series_length(packed) == series.size());
+    auto unpacked = cpm::decode_series(packed);
+    for (size_t i = 0; i < series.size(); ++i) {
+        if (std::isnan(series[i])) {
+            ASSERT_TRUE(std::isnan(unpacked[i]));
+        } else {
+            ASSERT_NEAR(unpacked[i], series[i], 0.5 * resolution + 1e-12);
+        }
+    }
+    packed.resize(packed.size() - 20);
+    threw = false;
+    try {
+        cpm::decode_series(packed);
+    } catch (const std::invalid_argument&) {
+        threw = true;  // Truncated
+    }
+    ASSERT_TRUE(threw);
+
+    // Encoded CPMF spectra: version 2, decoded per row, unset rows NaN
+    const std::string table_path = (std::filesystem::temp_directory_path() / "cpm_test_codec.cpmf").string();
+    {
+        cpm::FeatureTableWriter writer(table_path, 2, features.band_names, features.fft_frequencies, {},
+                                       cpm::SpectrumEncoding::Float16);
+        writer.set_row(0, features, n, fs);
+    }
+    {
+        auto table = cpm::FeatureTable::open(table_path);
+        ASSERT_TRUE(table.spectrum_encoding() == cpm::SpectrumEncoding::Float16);
+        ASSERT_TRUE(table.encoded_spectrum(0).size() == cpm::encoded_spectrum_size(cpm::SpectrumEncoding::Float16, bins));
+        std::vector<double> row(bins);
+        table.decode_spectrum(0, row);
+        ASSERT_NEAR(row[100] / mags[100], 1.0, 4.9e-4);
+        table.decode_spectrum(1, row);
+        ASSERT_TRUE(std::isnan(row[0]));
+        ASSERT_NEAR(table.column("rms")[0], features.rms, 0.0);
+        threw = false;
+        try {
+            table.spectrum(0);
+        } catch (const std::logic_error&) {
+            threw = true;
+        }
+        ASSERT_TRUE(threw);
+    }
+    std::filesystem::remove(table_path);
+
+    // A store that keeps spectra returns them decoded on a hit
+    const std::string store_path = (std::filesystem::temp_directory_path() / "cpm_test_codec.cpms").string();
+    std::filesystem::remove(store_path);
+    {
+        auto store = cpm::FeatureStore::open(store_path, extractor.get_bands().size(), 0, bins,
+                                             cpm::SpectrumEncoding::Log16);
+        cpm::Workspace workspace;
+        store.extract(extractor, signal, workspace);
+        const auto& hit = store.extract(extractor, signal, workspace);
+        ASSERT_TRUE(store.hits() == 1 && hit.fft_magnitude.size() == bins);
+        ASSERT_NEAR(hit.fft_frequencies[7], features.fft_frequencies[7], 1e-9);
+        ASSERT_NEAR(hit.fft_magnitude[100] / mags[100], 1.0, 1.5e-4);
+        ASSERT_NEAR(hit.rms, features.rms, 0.0);
+
+        // A record batch-appended without a spectrum is re-extracted for one
+        std::vector<double> shifted(signal.begin(), signal.end());
+        shifted[0] += 1.0;
+        store.extract_batch(extractor, shifted, 1, shifted.size());
+        const auto& refilled = store.extract(extractor, shifted, workspace);
+        ASSERT_TRUE(store.misses() == 3 && refilled.fft_magnitude.size() == bins);
+
+        // ...once: the superseding record serves the spectrum from then on
+        const size_t stored = store.size();
+        const auto& superseded = store.extract(extractor, shifted, workspace);
+        ASSERT_TRUE(store.misses() == 3 && store.hits() == 2 && store.size() == stored);
+        ASSERT_NEAR(superseded.fft_magnitude[100] / refilled.fft_magnitude[100], 1.0, 1.5e-4);
+
+        // A spectrum of another length is not stored, and not retried
+        std::vector<double> longer(signal.begin(), signal.end());
+        longer.insert(longer.end(), signal.begin(), signal.end());
+        ASSERT_TRUE(store.extract(extractor, longer, workspace).fft_magnitude.size() != bins);
+        const size_t with_longer = store.size();
+        ASSERT_TRUE(store.extract(extractor, longer, workspace).fft_magnitude.empty());
+        ASSERT_TRUE(store.misses() == 4 && store.hits() == 3 && store.size() == with_longer);
+    }
+    threw = false;
+    try {
+        cpm::FeatureStore::open(store_path, extractor.get_bands().size(), 0, bins / 2);
+    } catch (const std::invalid_argument&) {
+        threw = true;  // Another spectrum layout
+    }
+    ASSERT_TRUE(threw);
+    std::filesystem::remove(store_path);
+}
+
 TEST(empty_signal) {
     cpm::FeatureExtractor fe(1000.0);
     std::vector<double> empty;
@@ -208,7 +1913,8 @@ TEST(sample_rate_change) {
 }
 
 int main() {
-    std::cout << "=== CPM Feature Extractor Tests ===\n\n";
+    std::cout << "=== CPM Feature Extractor Tests ===\n";
+    std::cout << "SIMD kernels: " << cpm::simd::isa_name(cpm::simd::active().isa) << "\n\n";
 
     RUN_TEST(rms_constant);
     RUN_TEST(rms_sine);
@@ -216,11 +1922,46 @@ int main() {
     RUN_TEST(crest_factor_sine);
     RUN_TEST(kurtosis_normal);
     RUN_TEST(skewness_sine);
+    RUN_TEST(time_stats_matches_individual);
+    RUN_TEST(time_stats_dc_offset);
+    RUN_TEST(moment_accumulator_merge);
     RUN_TEST(fft_single_frequency);
+    RUN_TEST(fft_matches_dft);
+    RUN_TEST(fft_plan_algorithms);
+    RUN_TEST(fft_plan_cache);
+    RUN_TEST(fft_codelets_match_generic);
     RUN_TEST(spectral_centroid);
     RUN_TEST(bandpower_low_freq);
     RUN_TEST(bandpower_high_freq);
+    RUN_TEST(band_layout_matches_bandpower);
+    RUN_TEST(band_sets);
     RUN_TEST(extract_all);
+    RUN_TEST(workspace_matches_extract_all);
+    RUN_TEST(extract_batch_matches_extract_all);
+    RUN_TEST(extract_batch_threaded);
+    RUN_TEST(thread_pool_parallel_for);
+    RUN_TEST(streaming_fft_matches_extract_all);
+    RUN_TEST(streaming_sliding_dft_matches_extract_all);
+    RUN_TEST(streaming_rejects_bad_hop);
+    RUN_TEST(simd_kernels_match_scalar);
+    RUN_TEST(welch_spectrum);
+    RUN_TEST(envelope_fault_amplitudes);
+    RUN_TEST(multichannel_features);
+    RUN_TEST(feature_mask);
+    RUN_TEST(narrow_sample_types);
+    RUN_TEST(stage_statistics);
+    RUN_TEST(mapped_waveform_io);
+    RUN_TEST(csv_parser);
+    RUN_TEST(feature_table_roundtrip);
+    RUN_TEST(feature_store_cache);
+    RUN_TEST(fleet_feature_table);
+    RUN_TEST(extraction_queue_batches);
+    RUN_TEST(extraction_queue_close_from_callback);
+    RUN_TEST(spectrum_reduction);
+    RUN_TEST(order_tracking);
+    RUN_TEST(waveform_synthesis);
+    RUN_TEST(kurtogram);
+    RUN_TEST(feature_codec);
     RUN_TEST(empty_signal);
     RUN_TEST(sample_rate_change);
 
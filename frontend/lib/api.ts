@@ -60,6 +60,8 @@ export interface FFTData {
   timestamp: string
   frequencies: number[]
   magnitudes: number[]
+  num_bins?: number  // Bins before server-side decimation
+  peaks?: { frequency: number; magnitude: number }[]
   dominant_frequency: number
   total_power: number
 }
@@ -172,8 +174,8 @@ export const api = {
     return fetchAPI(`/assets/${id}/features${params}`)
   },
 
-  async getFFT(id: string, timestep: number = -1): Promise<FFTData> {
-    return fetchAPI(`/assets/${id}/fft?timestep=${timestep}`)
+  async getFFT(id: string, timestep: number = -1, points: number = 256): Promise<FFTData> {
+    return fetchAPI(`/assets/${id}/fft?timestep=${timestep}&points=${points}`)
   },
 
   // Predictions